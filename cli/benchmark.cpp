@@ -0,0 +1,419 @@
+/*#-------------------------------------------------
+#
+#       Headless "benchmark" command
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.3 - 2026/10/19
+#
+#   - image-match benchmark [<image or folder>...] [--algorithms list] [--sizes list] [--threads list]
+#                           [--images n] [--min-time s] [--output file] [--checks-only]
+#   - each algorithm of lib/image-compare is measured alone, with the same calls as the GUI :
+#       extract = hash, palette, features or DNN classes of one image, from its working image
+#       compare = score of one pair of images, from their extracted values
+#   - for each working image size and each threads count : images or pairs are processed in parallel
+#     like in the GUI, repeated until the minimum time is reached
+#   - JSON output in the format of Google Benchmark, to compare releases with its tools
+#   - without images, synthetic ones are generated : the results are comparable between computers
+#   - the DNN is measured only if its model is in the models folder
+#   - v1.1 : extraction and comparison calls moved to cli.cpp, shared with the evaluate command
+#   - v1.2 : cv::Mat allocations counted per image or pair, to check the per-thread buffers stay reused
+#   - v1.3 : accuracy checks of the fast kernels against their reference versions - exit code 1 if one fails
+#
+#-------------------------------------------------*/
+
+#include "cli.h"
+#include "../lib/image-compare.h"
+#include "../lib/image-files.h"
+#include "../lib/image-color.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <thread>
+#include <algorithm>
+#include <atomic>
+
+#include <omp.h>
+#include <unistd.h>
+
+
+///////////////////////////////////////////////////////////
+//// Images
+///////////////////////////////////////////////////////////
+
+static std::vector<cv::Mat> SyntheticImages(const int &count) // reproducible images : noise, shapes, and every other one a modified copy of the previous one
+{
+    std::vector<cv::Mat> images;
+    cv::RNG rng(20261019);
+
+    for (int n = 0; n < count; n++) {
+        if (n % 2 == 1) { // similar to the previous image : brighter, cropped a little, like a re-encoded copy
+            cv::Mat copy = images.back()(cv::Rect(16, 12, images.back().cols - 32, images.back().rows - 24)) + cv::Scalar(12, 12, 12);
+            images.push_back(copy.clone());
+            continue;
+        }
+
+        const bool portrait = (n % 4 == 2);
+        cv::Mat image(portrait ? 1024 : 768, portrait ? 768 : 1024, CV_8UC3);
+        rng.fill(image, cv::RNG::UNIFORM, cv::Scalar(0, 0, 0), cv::Scalar(256, 256, 256));
+        cv::GaussianBlur(image, image, cv::Size(0, 0), 12); // smooth background : a photograph, not noise
+        for (int s = 0; s < 24; s++) { // shapes give corners and edges to the features
+            const cv::Scalar color(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+            const cv::Point center(rng.uniform(0, image.cols), rng.uniform(0, image.rows));
+            if (s % 2 == 0)
+                cv::circle(image, center, rng.uniform(10, 120), color, cv::FILLED, cv::LINE_AA);
+            else
+                cv::rectangle(image, cv::Rect(center.x, center.y, rng.uniform(20, 200), rng.uniform(20, 200)), color, cv::FILLED);
+        }
+        images.push_back(image);
+    }
+
+    return images;
+}
+
+static std::vector<cv::Mat> LoadImages(const std::vector<std::string> &arguments, const int &count) // images from files and folders, no more than count
+{
+    std::vector<std::string> files;
+    for (const std::string &argument : arguments) {
+        std::error_code error;
+        if (std::filesystem::is_directory(argument, error)) {
+            std::vector<std::string> found = ListImageFiles(argument, false);
+            std::sort(found.begin(), found.end()); // same images each time
+            files.insert(files.end(), found.begin(), found.end());
+        }
+        else
+            files.push_back(argument);
+    }
+
+    std::vector<cv::Mat> images;
+    for (const std::string &file : files) {
+        if (int(images.size()) >= count)
+            break;
+        std::string type, loadwith;
+        ImageFileType(stringutils::GetFilenameExtension(file), type, loadwith);
+        cv::Mat image = LoadImageFile(file, loadwith);
+        if (image.empty())
+            std::cerr << "benchmark : the image could not be read : " << file << std::endl;
+        else
+            images.push_back(image);
+    }
+
+    return images;
+}
+
+///////////////////////////////////////////////////////////
+//// Measures
+///////////////////////////////////////////////////////////
+
+class MatAllocationCounter : public cv::MatAllocator // OpenCV's default allocator, counting the new buffers of all threads
+{
+public:
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step, cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override
+    {
+        cv::UMatData* u = cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags); // the buffer belongs to the standard allocator, it frees it
+        if ((u) and (!data)) { // data given = header over existing memory, nothing allocated
+            allocations++;
+            bytes += (long long)(u->size);
+        }
+        return u;
+    }
+    bool allocate(cv::UMatData* data, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override
+    {
+        return cv::Mat::getStdAllocator()->allocate(data, accessFlags, usageFlags);
+    }
+    void deallocate(cv::UMatData* data) const override
+    {
+        cv::Mat::getStdAllocator()->deallocate(data);
+    }
+
+    static MatAllocationCounter& Instance() // installed once as cv::Mat's default allocator
+    {
+        static MatAllocationCounter counter;
+        static bool installed = false;
+        if (!installed) {
+            cv::Mat::setDefaultAllocator(&counter);
+            installed = true;
+        }
+        return counter;
+    }
+
+    mutable std::atomic<long long> allocations {0};
+    mutable std::atomic<long long> bytes {0};
+};
+
+struct struct_benchmark_result { // one line of the JSON output
+    std::string algorithm;
+    std::string phase; // extract or compare
+    int reducedSize;
+    int threads;
+    long long iterations; // images or pairs processed
+    double realTime; // ns per image or pair, wall clock
+    double cpuTime; // ns per image or pair, all threads
+    double allocations; // new cv::Mat buffers per image or pair
+    double allocatedBytes; // their size per image or pair
+};
+
+static void Measure(const int &items, const int &threads, const double &minTime, const std::function<void(const int &item, const int &thread)> &run,
+                    long long &iterations, double &realTime, double &cpuTime, double &allocations, double &allocatedBytes) // run all items in parallel until minTime seconds - times and allocations per item
+{
+    iterations = 0;
+    double elapsed = 0;
+    double cpu = 0;
+
+    run(0, 0); // warm up : first call allocations, caches
+
+    MatAllocationCounter &counter = MatAllocationCounter::Instance();
+    const long long allocationsStart = counter.allocations;
+    const long long bytesStart = counter.bytes;
+
+    while ((elapsed < minTime) or (iterations == 0)) {
+        const auto start = std::chrono::steady_clock::now();
+        const std::clock_t cpuStart = std::clock(); // process time : all threads
+
+        #pragma omp parallel for num_threads(threads) schedule(dynamic)
+        for (int item = 0; item < items; item++)
+            run(item, omp_get_thread_num());
+
+        cpu += double(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+        elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        iterations += items;
+    }
+
+    realTime = elapsed * 1e9 / double(iterations);
+    cpuTime = cpu * 1e9 / double(iterations);
+    allocations = double(counter.allocations - allocationsStart) / double(iterations); // results (hashes, scores...) are new buffers : never 0, but should not grow with image size
+    allocatedBytes = double(counter.bytes - bytesStart) / double(iterations);
+}
+
+static std::string JsonString(const std::string &text) // quoted and escaped
+{
+    std::string result = "\"";
+    for (const char &c : text) {
+        if ((c == '"') or (c == '\\'))
+            result += '\\';
+        if ((unsigned char)(c) < 0x20)
+            result += ' ';
+        else
+            result += c;
+    }
+
+    return result + "\"";
+}
+
+///////////////////////////////////////////////////////////
+//// Checks
+///////////////////////////////////////////////////////////
+
+    // a fast kernel is only worth its speed if it gives the same results as its reference version
+
+static const double labFastTolerance = 1e-5; // max absolute error of the fast float Lab conversions, values in [0..1] - measured : ~3e-6
+
+static bool CheckLabFastAccuracy() // fast float OKLAB and CIELab conversions against the double ones, over the RGB cube
+{
+    bool passed = true;
+    for (const bool &oklab : {true, false}) {
+        const double error = TestConvertImageLabFastAccuracy(oklab, 4); // one blue value out of 4 : ~4M colors
+        const bool ok = (error <= labFastTolerance); // also false for NaN
+        std::cerr << "check : " << (oklab ? "OKLAB" : "CIELab") << " fast conversion max error " << error
+                  << " (tolerance " << labFastTolerance << ") - " << (ok ? "ok" : "FAILED") << std::endl;
+        passed = passed and ok;
+    }
+
+    return passed;
+}
+
+static bool CheckPatchFrequencyHash(const std::vector<cv::Mat> &originals, const std::vector<int> &sizes) // batched PatchFrequencyHash against one DFT per patch, on the working images of each size
+    // working images keep the aspect ratio : most are not made of full patches
+{
+    int tests = 0;
+    int mismatches = 0;
+    for (const int &reducedSize : sizes)
+        for (size_t n = 0; n < originals.size(); n++) {
+            const struct_algorithm_image image = PrepareAlgorithmImage(originals[n], reducedSize);
+            double timeNaive, timeFast;
+            tests++;
+            if (!TestPatchFrequencyHash(image.gray, 1, timeNaive, timeFast)) {
+                mismatches++;
+                std::cerr << "check : patch frequency hash mismatch - image " << n << " " << image.gray.cols << "x" << image.gray.rows << std::endl;
+            }
+        }
+
+    const bool passed = (mismatches == 0);
+    std::cerr << "check : patch frequency hash " << mismatches << " mismatch(es) in " << tests << " images - " << (passed ? "ok" : "FAILED") << std::endl;
+
+    return passed;
+}
+
+///////////////////////////////////////////////////////////
+//// Command
+///////////////////////////////////////////////////////////
+
+int CommandBenchmark(const struct_command_line &commandLine) // cost of each algorithm, JSON results
+{
+    // options
+    std::vector<int> algorithms;
+    for (const std::string &name : commandLine.OptionList("algorithms", "all")) {
+        bool found = false;
+        for (int algorithm = 0; algorithm < img_similarity_count; algorithm++)
+            if ((name == "all") or (name == AlgorithmName(algorithm))) {
+                algorithms.push_back(algorithm);
+                found = true;
+            }
+        if (!found) {
+            std::cerr << "benchmark : unknown algorithm " << name << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<int> sizes, threadsCounts;
+    try {
+        for (const std::string &size : commandLine.OptionList("sizes", "128,256,512"))
+            sizes.push_back(std::stoi(size));
+        const int cores = std::max(1, int(std::thread::hardware_concurrency()));
+        for (const std::string &threads : commandLine.OptionList("threads", (cores > 1) ? "1," + std::to_string(cores) : "1"))
+            threadsCounts.push_back(std::max(1, std::stoi(threads)));
+    }
+    catch (...) {
+        std::cerr << "benchmark : --sizes and --threads are comma-separated integers" << std::endl;
+        return 1;
+    }
+    const double minTime = commandLine.OptionDouble("min-time", 0.5);
+    const int imagesCount = std::max(2, commandLine.OptionInt("images", 16));
+
+    // images
+    std::vector<cv::Mat> originals = commandLine.arguments.empty() ? SyntheticImages(imagesCount) : LoadImages(commandLine.arguments, imagesCount);
+    if (originals.size() < 2) {
+        std::cerr << "benchmark : at least 2 images are needed" << std::endl;
+        return 1;
+    }
+
+    // accuracy checks first : timings of wrong results are useless
+    bool checksPassed = CheckLabFastAccuracy();
+    checksPassed = CheckPatchFrequencyHash(originals, sizes) and checksPassed;
+    if (commandLine.OptionBool("checks-only"))
+        return checksPassed ? 0 : 1;
+
+    // DNN model : one network per thread, a network is not thread-safe
+    const std::string model = "models/Inception21k.caffemodel";
+    const std::string proto = "models/Inception21k-bn.prototxt";
+    int maxThreads = *std::max_element(threadsCounts.begin(), threadsCounts.end());
+    std::vector<cv::dnn::Net> nets(maxThreads);
+    std::error_code error;
+    const bool dnnAvailable = std::filesystem::exists(model, error);
+    if (dnnAvailable) {
+        for (cv::dnn::Net &net : nets)
+            DNNPrepare(net, model, proto);
+    }
+    else if (std::find(algorithms.begin(), algorithms.end(), int(img_similarity_dnn_classify)) != algorithms.end()) {
+        std::cerr << "benchmark : " << model << " not found, dnnclassify is not measured" << std::endl;
+        algorithms.erase(std::remove(algorithms.begin(), algorithms.end(), int(img_similarity_dnn_classify)), algorithms.end());
+    }
+
+    std::vector<std::pair<int, int>> pairs; // all pairs of images, like the GUI
+    for (int i = 0; i < int(originals.size()); i++)
+        for (int j = i + 1; j < int(originals.size()); j++)
+            pairs.push_back(std::make_pair(i, j));
+
+    std::vector<struct_benchmark_result> results;
+    for (const int &reducedSize : sizes) {
+        std::vector<struct_algorithm_image> images;
+        for (const cv::Mat &original : originals)
+            images.push_back(PrepareAlgorithmImage(original, reducedSize));
+
+        for (const int &algorithm : algorithms)
+            for (const int &threads : threadsCounts) {
+                cv::setNumThreads(threads); // OpenCV's own threads too : the same total as asked
+                std::vector<struct_algorithm_values> values(images.size());
+                std::cerr << AlgorithmName(algorithm) << " - size " << reducedSize << " - " << threads << " thread(s)" << std::endl;
+
+                struct_benchmark_result extract = {AlgorithmName(algorithm), "extract", reducedSize, threads, 0, 0, 0, 0, 0};
+                Measure(int(images.size()), threads, minTime, [&](const int &item, const int &thread) {
+                    ExtractAlgorithm(algorithm, images[item], values[item], reducedSize, nets[thread]);
+                }, extract.iterations, extract.realTime, extract.cpuTime, extract.allocations, extract.allocatedBytes);
+                results.push_back(extract);
+
+                struct_benchmark_result compare = {AlgorithmName(algorithm), "compare", reducedSize, threads, 0, 0, 0, 0, 0};
+                Measure(int(pairs.size()), threads, minTime, [&](const int &item, const int &) {
+                    const int i = pairs[item].first;
+                    const int j = pairs[item].second;
+                    CompareAlgorithm(algorithm, images[i], images[j], values[i], values[j], reducedSize);
+                }, compare.iterations, compare.realTime, compare.cpuTime, compare.allocations, compare.allocatedBytes);
+                results.push_back(compare);
+            }
+    }
+    cv::setNumThreads(-1); // back to OpenCV default
+
+    // JSON, like Google Benchmark
+    char hostname[256] = "";
+    gethostname(hostname, sizeof(hostname) - 1);
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(1);
+    json << "{\n"
+         << "  \"context\": {\n"
+         << "    \"date\": " << JsonString(CurrentDateTime()) << ",\n"
+         << "    \"host_name\": " << JsonString(hostname) << ",\n"
+         << "    \"executable\": \"image-match benchmark\",\n"
+         << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+         << "    \"opencv_version\": " << JsonString(CV_VERSION) << ",\n"
+         << "    \"images\": " << originals.size() << ",\n"
+         << "    \"pairs\": " << pairs.size() << ",\n"
+         << "    \"synthetic_images\": " << (commandLine.arguments.empty() ? "true" : "false") << ",\n"
+         << "    \"checks\": " << (checksPassed ? "\"passed\"" : "\"failed\"") << ",\n"
+         << "    \"library_build_type\": " <<
+#ifdef NDEBUG
+            "\"release\""
+#else
+            "\"debug\""
+#endif
+         << "\n"
+         << "  },\n"
+         << "  \"benchmarks\": [\n";
+    for (size_t n = 0; n < results.size(); n++) {
+        const struct_benchmark_result &result = results[n];
+        const std::string name = result.algorithm + "/" + result.phase + "/" + std::to_string(result.reducedSize) + "/threads:" + std::to_string(result.threads);
+        json << "    {\n"
+             << "      \"name\": " << JsonString(name) << ",\n"
+             << "      \"run_name\": " << JsonString(name) << ",\n"
+             << "      \"run_type\": \"iteration\",\n"
+             << "      \"algorithm\": " << JsonString(result.algorithm) << ",\n"
+             << "      \"phase\": " << JsonString(result.phase) << ",\n"
+             << "      \"reduced_size\": " << result.reducedSize << ",\n"
+             << "      \"threads\": " << result.threads << ",\n"
+             << "      \"iterations\": " << result.iterations << ",\n"
+             << "      \"real_time\": " << result.realTime << ",\n"
+             << "      \"cpu_time\": " << result.cpuTime << ",\n"
+             << "      \"time_unit\": \"ns\",\n"
+             << "      \"items_per_second\": " << ((result.realTime > 0) ? 1e9 / result.realTime : 0.0) << ",\n"
+             << "      \"allocs_per_item\": " << result.allocations << ",\n"
+             << "      \"alloc_bytes_per_item\": " << result.allocatedBytes << "\n"
+             << "    }" << ((n + 1 < results.size()) ? "," : "") << "\n";
+    }
+    json << "  ]\n"
+         << "}\n";
+
+    const std::string output = commandLine.Option("output");
+    if (output.empty())
+        std::cout << json.str();
+    else {
+        std::ofstream file(output);
+        file << json.str();
+        if (!file) {
+            std::cerr << "benchmark : the results could not be written to " << output << std::endl;
+            return 1;
+        }
+        std::cerr << "Results written to " << output << std::endl;
+    }
+
+    if (!checksPassed) {
+        std::cerr << "benchmark : some accuracy checks failed" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,437 @@
+/*#-------------------------------------------------
+#
+#       Headless commands - without the GUI
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.8 - 2026/10/19
+#
+#   - image-match <command> [arguments] [--option value]...
+#   - commands share the signatures catalog (lib/image-catalog) with the same settings as the GUI
+#
+#-------------------------------------------------*/
+
+#include "cli.h"
+#include "../lib/config-file.h"
+#include "../lib/image-compare.h"
+#include "../lib/image-files.h"
+#include "../lib/thumbnail-cache.h"
+#include "../lib/image-transform.h"
+#include "../lib/image-pyramid.h"
+#include "../lib/image-color.h"
+#include "../lib/dominant-colors.h"
+
+#include <iostream>
+#include <ctime>
+#include <clocale>
+#include <fstream>
+#include <filesystem>
+#include <unordered_set>
+#include <algorithm>
+
+
+///////////////////////////////////////////////////////////
+//// Command line
+///////////////////////////////////////////////////////////
+
+std::string struct_command_line::Option(const std::string &name, const std::string &defaultValue) const // option value or default
+{
+    auto found = options.find(name);
+    if (found == options.end())
+        return defaultValue;
+
+    return found->second;
+}
+
+int struct_command_line::OptionInt(const std::string &name, const int &defaultValue) const
+{
+    auto found = options.find(name);
+    if (found == options.end())
+        return defaultValue;
+
+    try {
+        return std::stoi(found->second);
+    }
+    catch (...) {
+        std::cerr << "Option --" << name << " : integer expected, default value " << defaultValue << " used" << std::endl;
+        return defaultValue;
+    }
+}
+
+double struct_command_line::OptionDouble(const std::string &name, const double &defaultValue) const
+{
+    auto found = options.find(name);
+    if (found == options.end())
+        return defaultValue;
+
+    try {
+        return std::stod(found->second);
+    }
+    catch (...) {
+        std::cerr << "Option --" << name << " : number expected, default value " << defaultValue << " used" << std::endl;
+        return defaultValue;
+    }
+}
+
+bool struct_command_line::OptionBool(const std::string &name) const // option given ?
+{
+    auto found = options.find(name);
+
+    return (found != options.end()) and (found->second != "false") and (found->second != "0");
+}
+
+std::vector<std::string> struct_command_line::OptionList(const std::string &name, const std::string &defaultValue) const // comma-separated values
+{
+    std::vector<std::string> values;
+    std::string list = Option(name, defaultValue);
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos)
+            end = list.size();
+        if (end > start)
+            values.push_back(list.substr(start, end - start));
+        start = end + 1;
+    }
+
+    return values;
+}
+
+static const std::vector<std::string> commands = {"watch", "index", "query", "serve", "request", "benchmark", "generate", "evaluate", "calibrate"}; // all headless commands
+static const std::vector<std::string> flags = {"no-recursive", "checks-only", "dihedral", "write"}; // options without a value : the next argument is never theirs
+
+static void ShowUsage() // list of commands
+{
+    std::cout << "Usage : image-match <command> [arguments] [--option value]..." << std::endl
+              << "Without a command, the GUI is started." << std::endl << std::endl
+              << "Commands :" << std::endl
+              << "  watch <folder>...      keep the signatures of the folders up to date, log new matches" << std::endl
+              << "        --catalog file   signatures catalog (default data/signatures.catalog)" << std::endl
+              << "        --log file       matches log (default data/matches.log)" << std::endl
+              << "        --phash %        pHash similarity threshold (default : \"similar\" level of data/thresholds.cfg)" << std::endl
+              << "        --dhash %        dHash similarity threshold (default : \"similar\" level of data/thresholds.cfg)" << std::endl
+              << "        --reduced size   working image size (default 256)" << std::endl
+              << "        --no-recursive   don't watch sub-folders" << std::endl
+              << "  index <folder>...      add the images of the folders to the catalog, remove deleted ones" << std::endl
+              << "        --index file     signatures catalog (default data/signatures.catalog)" << std::endl
+              << "        --reduced size   working image size (default 256)" << std::endl
+              << "        --no-recursive   don't read sub-folders" << std::endl
+              << "  query <image>...       catalog images that match each probe image, best first" << std::endl
+              << "        --index file     signatures catalog (default data/signatures.catalog)" << std::endl
+              << "        --corpus folder  index this folder first (new or modified files only)" << std::endl
+              << "        --top n          maximum results per probe (default 20, 0 = all)" << std::endl
+              << "        --phash %        pHash similarity threshold" << std::endl
+              << "        --dhash %        dHash similarity threshold" << std::endl
+              << "        --reduced size   working image size, must be the one used to index (default 256)" << std::endl
+              << "  serve                  answer PING, QUERY, INSERT, DELETE and STATS requests on a local socket" << std::endl
+              << "        --socket path    Unix domain socket (default /tmp/image-match.sock)" << std::endl
+              << "        --index file     signatures catalog (default data/signatures.catalog)" << std::endl
+              << "        --corpus folder  index this folder first (new or modified files only)" << std::endl
+              << "        --phash %, --dhash %, --reduced size : like query" << std::endl
+              << "  request <words>...     send one request to the server and print the response" << std::endl
+              << "        --socket path    Unix domain socket (default /tmp/image-match.sock)" << std::endl
+              << "  benchmark [<image or folder>...]  cost of each algorithm : extraction per image, comparison per pair" << std::endl
+              << "        --algorithms list  comma-separated names like in data/thresholds.cfg (default all)" << std::endl
+              << "        --sizes list     working image sizes (default 128,256,512)" << std::endl
+              << "        --threads list   threads counts (default 1 and all cores)" << std::endl
+              << "        --images n       images used, synthetic ones if none given (default 16)" << std::endl
+              << "        --min-time s     minimum measure time of each benchmark (default 0.5)" << std::endl
+              << "        --output file    JSON results (default stdout)" << std::endl
+              << "        --checks-only    only check the fast kernels against their reference versions (exit code 1 if one fails)" << std::endl
+              << "  generate [<seed image or folder>...]  synthetic near-duplicates with ground truth (images.tsv, pairs.tsv)" << std::endl
+              << "        --output folder  where to write the corpus (needed)" << std::endl
+              << "        --count n        number of images (default 1000)" << std::endl
+              << "        --variants n     transformed copies of each original (default 4)" << std::endl
+              << "        --transformations list  rescale,crop,jpeg,color,rotate,mirror,watermark (default all)" << std::endl
+              << "        --size pixels    size of originals (default 1024)" << std::endl
+              << "        --quality q      JPEG quality of written files (default 95)" << std::endl
+              << "        --seed n         same seed = same corpus (default 1)" << std::endl
+              << "  evaluate <pairs file>  precision, recall, F1, time and memory of each algorithm on labeled pairs" << std::endl
+              << "        --root folder    images folder (default : folder of the pairs file)" << std::endl
+              << "        --algorithms list  like in data/thresholds.cfg, combined included (default all)" << std::endl
+              << "        --negatives n    non-duplicate pairs drawn per duplicate pair, if the file has no label column (default 4)" << std::endl
+              << "        --seed n         same seed = same non-duplicate pairs (default 1)" << std::endl
+              << "        --reduced size   working image size (default 256)" << std::endl
+              << "        --output file    TSV results (default stdout)" << std::endl
+              << "        --scores file    write the score of every pair, to use later as a baseline" << std::endl
+              << "        --baseline file  scores of a previous version : exit code 2 if results changed" << std::endl
+              << "        --tolerance %    score difference allowed with the baseline (default 0.5)" << std::endl
+              << "        --max-changes n  changed pairs allowed with the baseline (default 0)" << std::endl
+              << "        --dihedral       pHash, dHash and idHash find rotated and mirrored copies" << std::endl
+              << "  calibrate <pairs file>  levels of data/thresholds.cfg from labeled pairs, and the best prefilter" << std::endl
+              << "        --root, --algorithms, --negatives, --seed, --reduced, --output, --dihedral : like evaluate" << std::endl
+              << "        --precision list  target precision of the different, similar and exact levels (default 0.5,0.95,0.999)" << std::endl
+              << "        --recall r       recall a prefilter must keep (default 0.99)" << std::endl
+              << "        --prefilters list  cheap algorithms tried as prefilter (default ahash,phash,dhash,idhash,blockmean,marrhildreth,radialvariance,dominantcolors)" << std::endl
+              << "        --write          save the new levels to data/thresholds.cfg (previous one kept as .bak)" << std::endl;
+}
+
+bool IsCommand(const std::string &name) // is this a headless command ?
+{
+    if ((name == "help") or (name == "--help") or (name == "-h"))
+        return true;
+    for (const std::string &command : commands)
+        if (command == name)
+            return true;
+
+    return false;
+}
+
+int RunCommand(int argc, char *argv[]) // parse the command line and run the command - returns the exit code
+{
+    std::setlocale(LC_NUMERIC, "C"); // '.' as decimal separator, for the config file and the options
+
+    struct_command_line commandLine;
+    if (argc > 1)
+        commandLine.command = argv[1];
+    for (int n = 2; n < argc; n++) {
+        std::string argument = argv[n];
+        if ((argument.size() > 2) and (argument.compare(0, 2, "--") == 0)) { // option
+            std::string name = argument.substr(2);
+            const bool flag = std::find(flags.begin(), flags.end(), name) != flags.end();
+            if ((!flag) and (n + 1 < argc) and (std::string(argv[n + 1]).compare(0, 2, "--") != 0)) // with a value
+                commandLine.options[name] = argv[++n];
+            else
+                commandLine.options[name] = "true";
+        }
+        else
+            commandLine.arguments.push_back(argument);
+    }
+
+    if (commandLine.command == "watch")
+        return CommandWatch(commandLine);
+    if (commandLine.command == "index")
+        return CommandIndex(commandLine);
+    if (commandLine.command == "query")
+        return CommandQuery(commandLine);
+    if (commandLine.command == "serve")
+        return CommandServe(commandLine);
+    if (commandLine.command == "request")
+        return CommandRequest(commandLine);
+    if (commandLine.command == "benchmark")
+        return CommandBenchmark(commandLine);
+    if (commandLine.command == "generate")
+        return CommandGenerate(commandLine);
+    if (commandLine.command == "evaluate")
+        return CommandEvaluate(commandLine);
+    if (commandLine.command == "calibrate")
+        return CommandCalibrate(commandLine);
+
+    ShowUsage();
+
+    return ((commandLine.command == "help") or (commandLine.command == "--help") or (commandLine.command == "-h")) ? 0 : 1;
+}
+
+///////////////////////////////////////////////////////////
+//// Shared by commands
+///////////////////////////////////////////////////////////
+
+struct_catalog_thresholds LoadCatalogThresholds(const struct_command_line &commandLine) // "similar" level of data/thresholds.cfg for pHash and dHash, or --phash / --dhash options (%)
+{
+    // categories : 0 < dissimilar < different < similar < ∞ (exact) -> index 2 = "similar"
+    const std::vector<std::vector<float>> levels = LoadThresholdLevels();
+    const double pHash = levels[img_similarity_pHash].empty() ? 80.0 : levels[img_similarity_pHash][2]; // defaults if the config file can't be read
+    const double dHash = levels[img_similarity_dHash].empty() ? 80.0 : levels[img_similarity_dHash][2];
+
+    struct_catalog_thresholds thresholds;
+    thresholds.pHash = SimilarityToDistance(float(commandLine.OptionDouble("phash", pHash)));
+    thresholds.dHash = SimilarityToDistance(float(commandLine.OptionDouble("dhash", dHash)));
+
+    return thresholds;
+}
+
+std::vector<std::vector<float>> LoadThresholdLevels() // 4 levels of each algorithm from data/thresholds.cfg, empty if not found - categories : 0 < dissimilar < different < similar < ∞ (exact)
+{
+    std::vector<std::vector<float>> levels(img_similarity_count + 1); // + combined
+
+    std::ifstream configFile;
+    if (!configfile::OpenFile(configFile, "data/thresholds.cfg"))
+        return levels;
+
+    configfile::struct_config configData;
+    while (configfile::ReadLine(configFile, configData)) {
+        if ((configData.type != "value") or (configData.valueType != "number") or (configData.valuesNumber.size() != 4))
+            continue;
+        for (int algorithm = 0; algorithm <= img_similarity_count; algorithm++)
+            if (configData.name == AlgorithmName(algorithm))
+                levels[algorithm] = std::vector<float>(configData.valuesNumber.begin(), configData.valuesNumber.end());
+    }
+    configfile::CloseFile(configFile);
+
+    return levels;
+}
+
+bool OpenCatalog(ImageCatalog &catalog, const struct_command_line &commandLine) // catalog file from --catalog (or --index) option, default data/signatures.catalog
+{
+    const std::string filename = commandLine.Option("catalog", commandLine.Option("index", "data/signatures.catalog"));
+    if (!catalog.Open(filename)) {
+        std::cerr << "The catalog file could not be opened : " << filename << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+std::vector<std::string> CatalogFolders(const struct_command_line &commandLine, const size_t &first) // arguments from first as absolute folders - empty if one is not a folder
+{
+    std::vector<std::string> folders;
+    for (size_t n = first; n < commandLine.arguments.size(); n++) {
+        std::error_code error;
+        std::filesystem::path folder = std::filesystem::canonical(commandLine.arguments[n], error); // catalog paths are absolute
+        if ((error) or (!std::filesystem::is_directory(folder, error))) {
+            std::cerr << commandLine.command << " : not a folder : " << commandLine.arguments[n] << std::endl;
+            return {};
+        }
+        folders.push_back(folder.string());
+    }
+
+    return folders;
+}
+
+std::vector<std::string> FindCatalogChanges(ImageCatalog &catalog, const std::vector<std::string> &folders, const bool &recursive, long long &removed) // remove deleted files from the catalog, return new or modified image files
+{
+    std::vector<std::string> toRead;
+    for (const std::string &folder : folders) {
+        std::vector<std::string> files = ListImageFiles(folder, recursive);
+        std::unordered_set<std::string> onDisk(files.begin(), files.end());
+
+        for (const int &id : catalog.Ids(folder)) { // deleted since last time
+            const std::string path = catalog.Signature(id).path;
+            if (onDisk.count(path) == 0) {
+                catalog.Remove(path);
+                removed++;
+            }
+        }
+
+        for (const std::string &file : files) { // new or modified since last time
+            long long fileSize, modified;
+            if ((ThumbnailCache::FileStamp(file, fileSize, modified)) and (!catalog.IsUpToDate(file, fileSize, modified)))
+                toRead.push_back(file);
+        }
+    }
+
+    return toRead;
+}
+
+long long AddToCatalog(ImageCatalog &catalog, const std::vector<std::string> &files, const int &reducedSize, const bool &showProgress) // compute signatures in parallel and add them - returns the number of readable images
+{
+    const size_t chunkSize = 1024; // signatures in memory at the same time, and progress step
+    long long added = 0;
+
+    for (size_t start = 0; start < files.size(); start += chunkSize) {
+        const size_t end = std::min(files.size(), start + chunkSize);
+        std::vector<struct_image_signature> signatures(end - start);
+        std::vector<char> valid(end - start, 0);
+
+        #pragma omp parallel for schedule(dynamic)
+        for (int n = 0; n < int(end - start); n++) // read and hash
+            valid[n] = ComputeImageSignature(files[start + n], reducedSize, signatures[n]);
+
+        for (size_t n = 0; n < end - start; n++) // catalog is not thread-safe
+            if (valid[n]) {
+                catalog.Put(signatures[n]);
+                added++;
+            }
+            else if (signatures[n].fileSize >= 0) // unreadable : kept with width = 0, not read again until the file changes
+                catalog.Put(signatures[n]);
+            else
+                catalog.Remove(files[start + n]); // deleted before it was read
+
+        catalog.Flush(); // an interrupted indexing keeps what was done
+        if (showProgress)
+            std::cout << "\r" << end << " / " << files.size() << std::flush;
+    }
+    if ((showProgress) and (!files.empty()))
+        std::cout << std::endl;
+
+    return added;
+}
+
+std::string CurrentDateTime() // "yyyy-mm-dd hh:mm:ss" for logs
+{
+    std::time_t now = std::time(nullptr);
+    std::tm local;
+    localtime_r(&now, &local);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local);
+
+    return buffer;
+}
+
+std::string AlgorithmName(const int &algorithm) // short name of an algorithm, like in data/thresholds.cfg
+{
+    if ((algorithm < 0) or (algorithm > img_similarity_count))
+        return "unknown";
+
+    return imageSimilarityName[algorithm];
+}
+
+struct_algorithm_image PrepareAlgorithmImage(const cv::Mat &original, const int &reducedSize) // working images, like the images list of the GUI
+{
+    struct_algorithm_image image;
+    image.original = original;
+    ImagePyramid &pyramid = ImagePyramid::ForThread(); // same preprocessing as the GUI
+    pyramid.Build(original, reducedSize);
+    image.reduced = pyramid.Reduced().clone(); // kept : out of the arena
+    image.gray = pyramid.Gray().clone();
+
+    return image;
+}
+
+void ExtractAlgorithm(const int &algorithm, const struct_algorithm_image &image, struct_algorithm_values &values, const int &reducedSize, cv::dnn::Net &net, const bool &dihedral) // hash, palette, features or DNN classes of an image - same calls as the GUI
+{
+    const int nbFeatures = 250; // GUI default
+
+    switch (algorithm) {
+        case img_similarity_checksum: // original image
+            values.hash = ImageHash(image.original, img_similarity_checksum);
+            break;
+        case img_similarity_dominant_colors: { // tiny color image in OKLAB
+            cv::Mat reduced = ResizeImageAspectRatio(image.reduced, cv::Size(64, 64));
+            reduced = ConvertImageRGBtoOKLABFast(reduced);
+            cv::Mat quantized;
+            values.palette = DominantColorsEigenFast(reduced, 8, quantized, false);
+            break;
+        }
+        case img_similarity_features:
+        case img_similarity_homography:
+            values.keypoints.clear();
+            ComputeImageDescriptors(image.gray, values.keypoints, values.descriptors, false, reducedSize, nbFeatures);
+            break;
+        case img_similarity_dnn_classify:
+            values.hash = DNNHash(image.reduced, net, 224, cv::Scalar(117, 117, 117), 16);
+            break;
+        default: // hashes : gray image
+            values.hash = ImageHash(image.gray, imageSimilarityAlgorithm(algorithm), dihedral);
+    }
+}
+
+float CompareAlgorithm(const int &algorithm, const struct_algorithm_image &image1, const struct_algorithm_image &image2,
+                       struct_algorithm_values &values1, struct_algorithm_values &values2, const int &reducedSize) // % of similarity of a pair - same calls as the GUI
+{
+    const int nbFeatures = 250;
+
+    switch (algorithm) {
+        case img_similarity_dominant_colors:
+            return (1.0f - CompareImagesDominantColorsFromEigen(values1.palette, values2.palette)) * 100.0f;
+        case img_similarity_features:
+            return CompareImagesDescriptors(values1.descriptors, values2.descriptors, 0.8f, nbFeatures) * 100.0f;
+        case img_similarity_homography: {
+            if ((values1.keypoints.empty()) or (values2.keypoints.empty()))
+                return 0;
+            std::vector<cv::Point2f> goodPoints1, goodPoints2;
+            float score = 0;
+            if (image1.gray.cols * image1.gray.rows <= image2.gray.cols * image2.gray.rows) // 2nd image bigger, like the GUI
+                GetHomographyFromImagesFeatures(image1.gray, image2.gray, values1.keypoints, values2.keypoints, values1.descriptors, values2.descriptors,
+                                                goodPoints1, goodPoints2, score, false, reducedSize, false, 0.8f, nbFeatures);
+            else
+                GetHomographyFromImagesFeatures(image2.gray, image1.gray, values2.keypoints, values1.keypoints, values2.descriptors, values1.descriptors,
+                                                goodPoints1, goodPoints2, score, false, reducedSize, false, 0.8f, nbFeatures);
+            return score * 100.0f;
+        }
+        case img_similarity_dnn_classify:
+            return DNNCompare(values1.hash, values2.hash) * 100.0f;
+        default:
+            return ImageHashCompare(values1.hash, values2.hash, imageSimilarityAlgorithm(algorithm));
+    }
+}
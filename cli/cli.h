@@ -0,0 +1,94 @@
+/*#-------------------------------------------------
+#
+#       Headless commands - without the GUI
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.8 - 2026/10/19
+#
+#   - image-match <command> [arguments] [--option value]...
+#   - commands share the signatures catalog (lib/image-catalog) with the same settings as the GUI
+#
+#   commands :
+#       watch   : keep a catalog of watched folders up to date and log new matches
+#       index   : add folders to a catalog (v1.1)
+#       query   : find the catalog images that match probe images (v1.1)
+#       serve   : share a catalog between clients of a local socket (v1.2)
+#       request : send one request to the server (v1.2)
+#       benchmark : cost of each algorithm, JSON results (v1.3)
+#       generate : synthetic corpus of near-duplicates with ground truth (v1.4)
+#       evaluate : precision, recall and time of each algorithm on labeled pairs, regression check against a baseline (v1.5)
+#       calibrate : levels of data/thresholds.cfg that reach a target precision, best prefilter (v1.6)
+#       evaluate and calibrate : --dihedral, hashes invariant to rotations and mirrors (v1.7)
+#       benchmark : accuracy checks of the fast kernels, --checks-only (v1.8)
+#
+#-------------------------------------------------*/
+
+#ifndef CLI_H
+#define CLI_H
+
+#include "../lib/image-catalog.h"
+
+#include "opencv2/opencv.hpp"
+#include <opencv2/dnn.hpp>
+
+#include <string>
+#include <vector>
+#include <map>
+
+
+struct struct_command_line { // parsed command line
+    std::string command; // first argument
+    std::vector<std::string> arguments; // other arguments that are not options
+    std::map<std::string, std::string> options; // --name value, or --name alone = "true"
+
+    std::string Option(const std::string &name, const std::string &defaultValue = "") const; // option value or default
+    int OptionInt(const std::string &name, const int &defaultValue) const;
+    double OptionDouble(const std::string &name, const double &defaultValue) const;
+    bool OptionBool(const std::string &name) const; // option given ?
+    std::vector<std::string> OptionList(const std::string &name, const std::string &defaultValue = "") const; // comma-separated values
+};
+
+struct struct_algorithm_image { // an image at one working size, like in the images list of the GUI
+    cv::Mat original; // for checksum
+    cv::Mat reduced; // color working image
+    cv::Mat gray; // gray working image
+};
+
+struct struct_algorithm_values { // what an algorithm extracts from an image
+    cv::Mat hash; // hashes and DNN classes
+    std::vector<cv::Vec3d> palette; // dominant colors
+    std::vector<cv::KeyPoint> keypoints; // features and homography
+    cv::Mat descriptors;
+};
+
+bool IsCommand(const std::string &name); // is this a headless command ?
+int RunCommand(int argc, char *argv[]); // parse the command line and run the command - returns the exit code
+
+struct_catalog_thresholds LoadCatalogThresholds(const struct_command_line &commandLine); // "similar" level of data/thresholds.cfg for pHash and dHash, or --phash / --dhash options (%)
+bool OpenCatalog(ImageCatalog &catalog, const struct_command_line &commandLine); // catalog file from --catalog (or --index) option, default data/signatures.catalog
+std::vector<std::string> CatalogFolders(const struct_command_line &commandLine, const size_t &first = 0); // arguments from first as absolute folders - empty if one is not a folder
+std::vector<std::string> FindCatalogChanges(ImageCatalog &catalog, const std::vector<std::string> &folders, const bool &recursive, long long &removed); // remove deleted files from the catalog, return new or modified image files
+long long AddToCatalog(ImageCatalog &catalog, const std::vector<std::string> &files, const int &reducedSize, const bool &showProgress); // compute signatures in parallel and add them - returns the number of readable images
+std::string CurrentDateTime(); // "yyyy-mm-dd hh:mm:ss" for logs
+std::string AlgorithmName(const int &algorithm); // short name of an algorithm, like in data/thresholds.cfg
+std::vector<std::vector<float>> LoadThresholdLevels(); // 4 levels of each algorithm from data/thresholds.cfg, empty if not found - categories : 0 < dissimilar < different < similar < ∞ (exact)
+struct_algorithm_image PrepareAlgorithmImage(const cv::Mat &original, const int &reducedSize); // working images, like the images list of the GUI
+void ExtractAlgorithm(const int &algorithm, const struct_algorithm_image &image, struct_algorithm_values &values, const int &reducedSize, cv::dnn::Net &net,
+                      const bool &dihedral=false); // hash, palette, features or DNN classes of an image - same calls as the GUI - dihedral : see HashIsDihedral()
+float CompareAlgorithm(const int &algorithm, const struct_algorithm_image &image1, const struct_algorithm_image &image2,
+                       struct_algorithm_values &values1, struct_algorithm_values &values2, const int &reducedSize); // % of similarity of a pair - same calls as the GUI
+
+// commands
+int CommandWatch(const struct_command_line &commandLine); // cli/watch.cpp
+int CommandIndex(const struct_command_line &commandLine); // cli/query.cpp
+int CommandQuery(const struct_command_line &commandLine); // cli/query.cpp
+int CommandServe(const struct_command_line &commandLine); // cli/serve.cpp
+int CommandRequest(const struct_command_line &commandLine); // cli/serve.cpp
+int CommandBenchmark(const struct_command_line &commandLine); // cli/benchmark.cpp
+int CommandGenerate(const struct_command_line &commandLine); // cli/generate.cpp
+int CommandEvaluate(const struct_command_line &commandLine); // cli/evaluate.cpp
+int CommandCalibrate(const struct_command_line &commandLine); // cli/evaluate.cpp
+
+
+#endif // CLI_H
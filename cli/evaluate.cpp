@@ -0,0 +1,836 @@
+/*#-------------------------------------------------
+#
+#       Headless "evaluate" command
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.2 - 2026/10/19
+#
+#   - image-match evaluate <pairs file> [--root folder] [--algorithms list] [--negatives n] [--seed n] [--reduced size]
+#                          [--output file] [--scores file] [--baseline file] [--tolerance %] [--max-changes n]
+#   - accuracy versus speed of each algorithm and of the combined score, on labeled pairs of images :
+#       precision, recall and F1 at each level of data/thresholds.cfg, extraction and comparison times, peak memory
+#   - pairs file : tab-separated, with a header line
+#       "file1 file2 ..." columns : all pairs are duplicates, like the pairs.tsv of the generate command -
+#                                   non-duplicate pairs are drawn at random between images that are not linked by a pair
+#       with a "label" column : 1 = duplicates, 0 = not duplicates - only these pairs are used
+#   - files are relative to --root, default = folder of the pairs file
+#   - same calls and rules as the GUI : working images, orientation test, checksum needs the same image sizes,
+#     combined = scores weighted by their level
+#   - regression check : --scores writes every pair's score, --baseline reads such a file from a previous version
+#     the command fails (exit code 2) if more than --max-changes pairs have a score that moved by more than --tolerance,
+#     or a duplicate decision that changed at the "similar" level
+#   - v1.1 : image-match calibrate <pairs file> [--precision list] [--recall r] [--prefilters list] [--write], same pairs options
+#       levels of data/thresholds.cfg from the same scores : the lowest threshold that reaches a target precision,
+#       for the different, similar and exact levels - the combined score is calibrated last, with the new levels
+#       prefilter : for cheap algorithms, the highest cut-off that keeps the target recall, and the share of pairs it prunes
+#   - v1.2 : --dihedral, for both commands : pHash, dHash and idHash in canonical orientation, and no orientation test for them,
+#            like the "rotated and mirrored copies" option of the GUI
+#
+#-------------------------------------------------*/
+
+#include "cli.h"
+#include "../lib/image-compare.h"
+#include "../lib/image-files.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <set>
+#include <cmath>
+#include <stdexcept>
+
+#include <omp.h>
+#include <sys/resource.h>
+
+
+///////////////////////////////////////////////////////////
+//// Pairs
+///////////////////////////////////////////////////////////
+
+struct struct_evaluated_pair { // one labeled pair
+    int image1; // index in the images list
+    int image2;
+    bool duplicate; // ground truth
+};
+
+static std::vector<std::string> SplitTabs(const std::string &line) // fields of a TSV line
+{
+    std::vector<std::string> fields;
+    std::stringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, '\t'))
+        fields.push_back(field);
+
+    return fields;
+}
+
+static int ImageIndex(const std::string &file, std::vector<std::string> &files, std::unordered_map<std::string, int> &indexes) // index of a file in the images list, added if new
+{
+    auto found = indexes.find(file);
+    if (found != indexes.end())
+        return found->second;
+    files.push_back(file);
+    indexes[file] = int(files.size()) - 1;
+
+    return int(files.size()) - 1;
+}
+
+static int Root(std::vector<int> &parents, int image) // union-find : group of an image
+{
+    while (parents[image] != image) {
+        parents[image] = parents[parents[image]];
+        image = parents[image];
+    }
+
+    return image;
+}
+
+static bool ReadPairs(const std::string &filename, std::vector<std::string> &files, std::vector<struct_evaluated_pair> &pairs,
+                      const int &negatives, const int &seed, std::string &error) // labeled pairs - negatives are drawn if the file has no label
+{
+    std::ifstream file(filename);
+    std::string line;
+    if ((!file) or (!std::getline(file, line))) {
+        error = "the pairs file could not be read";
+        return false;
+    }
+
+    const std::vector<std::string> header = SplitTabs(line);
+    int column1 = 0, column2 = 1, columnLabel = -1;
+    for (int n = 0; n < int(header.size()); n++) {
+        if (header[n] == "file1")
+            column1 = n;
+        else if (header[n] == "file2")
+            column2 = n;
+        else if (header[n] == "label")
+            columnLabel = n;
+    }
+    const int columns = std::max(std::max(column1, column2), columnLabel) + 1;
+
+    std::unordered_map<std::string, int> indexes;
+    std::set<std::pair<int, int>> known; // ordered pairs already in the list
+    while (std::getline(file, line)) {
+        if ((!line.empty()) and (line.back() == '\r'))
+            line.pop_back();
+        const std::vector<std::string> fields = SplitTabs(line);
+        if (int(fields.size()) < columns) // empty or incomplete line
+            continue;
+        struct_evaluated_pair pair;
+        pair.image1 = ImageIndex(fields[column1], files, indexes);
+        pair.image2 = ImageIndex(fields[column2], files, indexes);
+        pair.duplicate = (columnLabel == -1) or (fields[columnLabel] == "1") or (fields[columnLabel] == "true");
+        if ((pair.image1 == pair.image2) or (!known.insert(std::minmax(pair.image1, pair.image2)).second)) // same image or pair already seen
+            continue;
+        pairs.push_back(pair);
+    }
+
+    if ((columnLabel == -1) and (negatives > 0) and (files.size() > 2)) { // only duplicates : non-duplicates are pairs of images from different groups
+        std::vector<int> parents(files.size());
+        for (int n = 0; n < int(files.size()); n++)
+            parents[n] = n;
+        for (const struct_evaluated_pair &pair : pairs)
+            parents[Root(parents, pair.image1)] = Root(parents, pair.image2);
+
+        std::mt19937_64 random(seed); // same seed = same pairs
+        std::uniform_int_distribution<int> draw(0, int(files.size()) - 1);
+        const long long wanted = (long long)(pairs.size()) * negatives;
+        long long drawn = 0;
+        for (long long attempt = 0; (drawn < wanted) and (attempt < wanted * 20); attempt++) { // the number of attempts is limited : small corpus
+            const int image1 = draw(random);
+            const int image2 = draw(random);
+            if ((image1 == image2) or (Root(parents, image1) == Root(parents, image2)) or (!known.insert(std::minmax(image1, image2)).second))
+                continue;
+            pairs.push_back({image1, image2, false});
+            drawn++;
+        }
+    }
+
+    if (pairs.empty()) {
+        error = "no pair found in the pairs file";
+        return false;
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////
+//// Scores and measures
+///////////////////////////////////////////////////////////
+
+struct struct_evaluation { // results of one algorithm
+    int algorithm;
+    std::vector<float> scores; // one per pair, % of similarity
+    double extractTime = 0; // seconds, wall clock
+    double compareTime = 0;
+    long long peakMemory = 0; // KB, peak resident memory while the algorithm ran
+};
+
+struct struct_confusion { // counts at one threshold
+    long long truePositives = 0;
+    long long falsePositives = 0;
+    long long falseNegatives = 0;
+    long long trueNegatives = 0;
+
+    double Precision() const { return (truePositives + falsePositives > 0) ? double(truePositives) / double(truePositives + falsePositives) : 1.0; }
+    double Recall() const { return (truePositives + falseNegatives > 0) ? double(truePositives) / double(truePositives + falseNegatives) : 1.0; }
+    double F1() const { const double p = Precision(), r = Recall(); return (p + r > 0) ? 2.0 * p * r / (p + r) : 0.0; }
+};
+
+static bool dihedralHashes = false; // --dihedral : the same for all algorithms of the command
+
+static bool OrientationsMatch(const int &algorithm, const cv::Size &size1, const cv::Size &size2) // same test as the GUI : hashes need images oriented the same way
+{
+    if ((dihedralHashes) and (HashIsDihedral(algorithm))) // rotated and mirrored copies get the same hash
+        return true;
+
+    switch (algorithm) {
+        case img_similarity_checksum:
+        case img_similarity_pHash:
+        case img_similarity_dHash:
+        case img_similarity_idHash:
+        case img_similarity_block_mean:
+        case img_similarity_marr_hildreth:
+        case img_similarity_radial_variance: {
+            const bool portrait1 = (float(size1.width) / float(size1.height) <= 1.05f); // 5% of difference is not a difference
+            const bool portrait2 = (float(size2.width) / float(size2.height) <= 1.05f);
+            return portrait1 == portrait2;
+        }
+    }
+
+    return true;
+}
+
+static bool IsDuplicate(const int &algorithm, const float &score, const float &threshold, const cv::Size &size1, const cv::Size &size2) // decision of the GUI
+{
+    if ((score < threshold) or (!OrientationsMatch(algorithm, size1, size2)))
+        return false;
+    if ((algorithm == img_similarity_checksum) and (size1 != size2)) // checksum collision
+        return false;
+
+    return true;
+}
+
+static int Level(const std::vector<float> &levels, const float &score) // like MainWindow::GetLevelFromScore
+{
+    int level = 0;
+    while ((level < 3) and (levels[level] < score))
+        level++;
+
+    return level;
+}
+
+static long long PeakMemory() // KB, peak resident memory of the process since the last reset
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return std::atoll(line.c_str() + 6);
+
+    struct rusage usage; // no /proc : peak since the start
+    getrusage(RUSAGE_SELF, &usage);
+
+    return usage.ru_maxrss;
+}
+
+static void ResetPeakMemory() // measure each algorithm alone - Linux only, does nothing elsewhere
+{
+    std::ofstream clear("/proc/self/clear_refs");
+    clear << "5";
+}
+
+static struct_confusion Confusion(const std::vector<struct_evaluated_pair> &pairs, const std::vector<cv::Size> &sizes,
+                                  const int &algorithm, const std::vector<float> &scores, const float &threshold) // counts of one algorithm at one threshold
+{
+    struct_confusion confusion;
+    for (size_t n = 0; n < pairs.size(); n++) {
+        if (scores[n] < 0) // not compared
+            continue;
+        const bool found = IsDuplicate(algorithm, scores[n], threshold, sizes[pairs[n].image1], sizes[pairs[n].image2]);
+        if (pairs[n].duplicate)
+            (found ? confusion.truePositives : confusion.falseNegatives)++;
+        else
+            (found ? confusion.falsePositives : confusion.trueNegatives)++;
+    }
+
+    return confusion;
+}
+
+///////////////////////////////////////////////////////////
+//// Baseline
+///////////////////////////////////////////////////////////
+
+static bool ReadBaseline(const std::string &filename, std::map<std::string, std::unordered_map<std::string, float>> &baseline, std::string &error) // algorithm -> "file1\tfile2" -> score, from a --scores file
+{
+    std::ifstream file(filename);
+    std::string line;
+    if ((!file) or (!std::getline(file, line))) {
+        error = "the baseline file could not be read";
+        return false;
+    }
+
+    const std::vector<std::string> header = SplitTabs(line);
+    if ((header.size() < 4) or (header[0] != "file1") or (header[1] != "file2") or (header[2] != "label")) {
+        error = "the baseline file was not written by evaluate --scores";
+        return false;
+    }
+    int lineNumber = 1; // header
+    while (std::getline(file, line)) {
+        lineNumber++;
+        const std::vector<std::string> fields = SplitTabs(line);
+        if (fields.size() != header.size())
+            continue;
+        for (size_t column = 3; column < fields.size(); column++)
+            try {
+                baseline[header[column]][fields[0] + "\t" + fields[1]] = std::stof(fields[column]);
+            }
+            catch (const std::invalid_argument &) {
+                error = "line " + std::to_string(lineNumber) + ", " + header[column] + " : \"" + fields[column] + "\" is not a number";
+                return false;
+            }
+            catch (const std::out_of_range &) {
+                error = "line " + std::to_string(lineNumber) + ", " + header[column] + " : " + fields[column] + " is out of range";
+                return false;
+            }
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////
+//// Scores of all pairs
+///////////////////////////////////////////////////////////
+
+struct struct_evaluation_set { // what evaluate and calibrate work on
+    std::vector<std::string> files; // images, relative to the root folder
+    std::vector<struct_evaluated_pair> pairs;
+    std::vector<cv::Size> sizes; // original sizes, 0x0 = not readable
+    std::vector<std::vector<float>> levels; // data/thresholds.cfg
+    std::vector<struct_evaluation> evaluations; // one per algorithm, combined last
+    long long unreadable = 0; // images
+    double totalTime = 0; // seconds
+};
+
+static std::vector<float> CombinedScores(const struct_evaluation_set &set) // scores of the other algorithms weighted by their level, like MainWindow::CombinedScore
+{
+    std::vector<float> scores(set.pairs.size(), -1);
+    for (size_t n = 0; n < set.pairs.size(); n++) {
+        int count = 0;
+        float sum = 0;
+        for (const struct_evaluation &other : set.evaluations)
+            if ((other.algorithm != img_similarity_count) and (other.scores[n] != -1)) {
+                count++;
+                sum += other.scores[n] * float(Level(set.levels[other.algorithm], other.scores[n]));
+            }
+        if (count > 0)
+            scores[n] = sum / (float(count) * 3.0f);
+    }
+
+    return scores;
+}
+
+static int ScorePairs(const struct_command_line &commandLine, struct_evaluation_set &set) // read the pairs and their images, score them with each algorithm - returns 0 or an exit code
+{
+    const std::string &command = commandLine.command;
+    if (commandLine.arguments.size() != 1) {
+        std::cerr << command << " : one pairs file is needed" << std::endl;
+        return 1;
+    }
+    const std::string pairsFile = commandLine.arguments[0];
+    const std::string root = commandLine.Option("root", std::filesystem::path(pairsFile).parent_path().string());
+    const int reducedSize = commandLine.OptionInt("reduced", 256);
+    dihedralHashes = commandLine.OptionBool("dihedral");
+    // algorithms : the combined score is computed from the other ones
+    std::vector<int> algorithms;
+    bool combined = false;
+    for (const std::string &name : commandLine.OptionList("algorithms", "checksum,phash,dhash,idhash,blockmean,marrhildreth,radialvariance,dominantcolors,features,homography,dnnclassify,combined")) {
+        bool found = false;
+        for (int algorithm = 0; algorithm <= img_similarity_count; algorithm++)
+            if (name == AlgorithmName(algorithm)) {
+                if (algorithm == img_similarity_count)
+                    combined = true;
+                else
+                    algorithms.push_back(algorithm);
+                found = true;
+            }
+        if (!found) {
+            std::cerr << command + " : unknown algorithm " << name << std::endl;
+            return 1;
+        }
+    }
+
+    set.levels = LoadThresholdLevels();
+    const std::vector<std::vector<float>> &levels = set.levels;
+    for (size_t n = 0; n < algorithms.size(); n++)
+        if (levels[algorithms[n]].empty()) {
+            std::cerr << command + " : no thresholds for " << AlgorithmName(algorithms[n]) << " in data/thresholds.cfg" << std::endl;
+            return 1;
+        }
+    if ((combined) and ((levels[img_similarity_count].empty()) or (algorithms.empty()))) {
+        std::cerr << command + " : combined needs its thresholds in data/thresholds.cfg and at least one other algorithm" << std::endl;
+        return 1;
+    }
+
+    // DNN model : one network per thread, a network is not thread-safe
+    const std::string model = "models/Inception21k.caffemodel";
+    std::vector<cv::dnn::Net> nets(omp_get_max_threads());
+    if (std::find(algorithms.begin(), algorithms.end(), int(img_similarity_dnn_classify)) != algorithms.end()) {
+        std::error_code exists;
+        if (std::filesystem::exists(model, exists)) {
+            for (cv::dnn::Net &net : nets)
+                DNNPrepare(net, model, "models/Inception21k-bn.prototxt");
+        }
+        else {
+            std::cerr << command + " : " << model << " not found, dnnclassify is not evaluated" << std::endl;
+            algorithms.erase(std::remove(algorithms.begin(), algorithms.end(), int(img_similarity_dnn_classify)), algorithms.end());
+        }
+    }
+
+    // pairs
+    std::vector<std::string> &files = set.files;
+    std::vector<struct_evaluated_pair> &pairs = set.pairs;
+    std::string error;
+    if (!ReadPairs(pairsFile, files, pairs, std::max(0, commandLine.OptionInt("negatives", 4)), commandLine.OptionInt("seed", 1), error)) {
+        std::cerr << command + " : " << error << " : " << pairsFile << std::endl;
+        return 1;
+    }
+    long long duplicates = 0;
+    for (const struct_evaluated_pair &pair : pairs)
+        duplicates += pair.duplicate;
+    std::cerr << files.size() << " images, " << pairs.size() << " pairs (" << duplicates << " duplicates)" << std::endl;
+
+    // working images, like the images list of the GUI - originals are not kept, checksum reads them again like the GUI
+    const auto startTime = std::chrono::steady_clock::now();
+    std::vector<struct_algorithm_image> images(files.size());
+    std::vector<cv::Size> &sizes = set.sizes;
+    sizes.assign(files.size(), cv::Size());
+    std::vector<std::string> paths(files.size());
+    std::vector<std::string> loadWith(files.size());
+    #pragma omp parallel for schedule(dynamic)
+    for (int n = 0; n < int(files.size()); n++) {
+        paths[n] = (std::filesystem::path(root) / files[n]).string();
+        std::string type;
+        ImageFileType(stringutils::GetFilenameExtension(paths[n]), type, loadWith[n]);
+        cv::Mat original = LoadImageFile(paths[n], loadWith[n]);
+        if (original.empty())
+            continue;
+        sizes[n] = original.size();
+        images[n] = PrepareAlgorithmImage(original, reducedSize);
+        images[n].original.release();
+    }
+    const double loadTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    for (int n = 0; n < int(files.size()); n++)
+        if (sizes[n].area() == 0) {
+            std::cerr << command + " : the image could not be read : " << paths[n] << std::endl;
+            set.unreadable++;
+        }
+    std::cerr << "Images read in " << std::fixed << std::setprecision(2) << loadTime << " s" << std::endl;
+
+    // each algorithm alone : extraction of all images, then comparison of all pairs
+    std::vector<struct_evaluation> &evaluations = set.evaluations;
+    for (const int &algorithm : algorithms) {
+        std::cerr << AlgorithmName(algorithm) << "..." << std::endl;
+        ResetPeakMemory();
+        struct_evaluation evaluation;
+        evaluation.algorithm = algorithm;
+        std::vector<struct_algorithm_values> values(files.size());
+
+        auto start = std::chrono::steady_clock::now();
+        #pragma omp parallel for schedule(dynamic)
+        for (int n = 0; n < int(files.size()); n++) {
+            if (sizes[n].area() == 0)
+                continue;
+            if (algorithm == img_similarity_checksum) { // original file
+                struct_algorithm_image image;
+                image.original = LoadImageFile(paths[n], loadWith[n]);
+                ExtractAlgorithm(algorithm, image, values[n], reducedSize, nets[omp_get_thread_num()], dihedralHashes);
+            }
+            else
+                ExtractAlgorithm(algorithm, images[n], values[n], reducedSize, nets[omp_get_thread_num()], dihedralHashes);
+        }
+        evaluation.extractTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        evaluation.scores.assign(pairs.size(), -1); // -1 = not compared, like the scores cache of the GUI
+        start = std::chrono::steady_clock::now();
+        #pragma omp parallel for schedule(dynamic)
+        for (int n = 0; n < int(pairs.size()); n++) {
+            const int i = pairs[n].image1;
+            const int j = pairs[n].image2;
+            if ((sizes[i].area() == 0) or (sizes[j].area() == 0))
+                continue;
+            if (!OrientationsMatch(algorithm, sizes[i], sizes[j])) { // the GUI doesn't compare these pairs
+                evaluation.scores[n] = 0;
+                continue;
+            }
+            evaluation.scores[n] = CompareAlgorithm(algorithm, images[i], images[j], values[i], values[j], reducedSize);
+        }
+        evaluation.compareTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        evaluation.peakMemory = PeakMemory();
+        evaluations.push_back(evaluation);
+    }
+
+    if (combined) { // from the scores of the other algorithms
+        struct_evaluation evaluation;
+        evaluation.algorithm = img_similarity_count;
+        const auto start = std::chrono::steady_clock::now();
+        evaluation.scores = CombinedScores(set);
+        evaluation.compareTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (const struct_evaluation &other : evaluations) { // the combined score needs all the others
+            evaluation.extractTime += other.extractTime;
+            evaluation.compareTime += other.compareTime;
+            evaluation.peakMemory = std::max(evaluation.peakMemory, other.peakMemory);
+        }
+        evaluations.push_back(evaluation);
+    }
+    set.totalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////
+//// Calibration
+///////////////////////////////////////////////////////////
+
+struct struct_cutoff { // a threshold found from the scores
+    float threshold = 0; // pairs with score >= threshold are duplicates
+    bool reached = false; // the target was reached
+    struct_confusion confusion; // at this threshold
+};
+
+static std::vector<std::pair<float, bool>> SortedScores(const struct_evaluation_set &set, const int &algorithm, const std::vector<float> &scores, long long &positives) // scores of the pairs that can be duplicates, best first, with their label
+    // positives = all duplicate pairs, even the ones this algorithm can't find (orientation, image size)
+{
+    std::vector<std::pair<float, bool>> sorted;
+    positives = 0;
+    for (size_t n = 0; n < set.pairs.size(); n++) {
+        if (scores[n] < 0) // not compared
+            continue;
+        positives += set.pairs[n].duplicate;
+        if (IsDuplicate(algorithm, 100.0f, 0.0f, set.sizes[set.pairs[n].image1], set.sizes[set.pairs[n].image2])) // can be a duplicate
+            sorted.push_back(std::make_pair(scores[n], set.pairs[n].duplicate));
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const std::pair<float, bool> &a, const std::pair<float, bool> &b) { return a.first > b.first; });
+
+    return sorted;
+}
+
+static struct_cutoff PrecisionCutoff(const struct_evaluation_set &set, const int &algorithm, const std::vector<float> &scores, const double &precision) // lowest threshold with at least this precision : the best recall
+{
+    long long positives;
+    const std::vector<std::pair<float, bool>> sorted = SortedScores(set, algorithm, scores, positives);
+
+    struct_cutoff cutoff;
+    cutoff.threshold = sorted.empty() ? 100.0f : std::min(100.0f, sorted.front().first + 0.01f); // not reached : nothing is a duplicate
+    long long truePositives = 0, falsePositives = 0;
+    for (size_t n = 0; n < sorted.size(); n++) {
+        (sorted[n].second ? truePositives : falsePositives)++;
+        if ((n + 1 < sorted.size()) and (sorted[n + 1].first == sorted[n].first)) // same score : same decision
+            continue;
+        if (double(truePositives) >= precision * double(truePositives + falsePositives)) {
+            cutoff.threshold = sorted[n].first;
+            cutoff.reached = true;
+        }
+    }
+    cutoff.confusion = Confusion(set.pairs, set.sizes, algorithm, scores, cutoff.threshold);
+
+    return cutoff;
+}
+
+static struct_cutoff RecallCutoff(const struct_evaluation_set &set, const int &algorithm, const std::vector<float> &scores, const double &recall) // highest threshold with at least this recall : the most pairs pruned
+{
+    long long positives;
+    const std::vector<std::pair<float, bool>> sorted = SortedScores(set, algorithm, scores, positives);
+
+    struct_cutoff cutoff;
+    cutoff.threshold = sorted.empty() ? 0.0f : sorted.back().first; // not reached : all pairs that can be duplicates are kept
+    long long truePositives = 0;
+    for (size_t n = 0; n < sorted.size(); n++) {
+        truePositives += sorted[n].second;
+        if ((n + 1 < sorted.size()) and (sorted[n + 1].first == sorted[n].first))
+            continue;
+        if (double(truePositives) >= recall * double(positives)) {
+            cutoff.threshold = sorted[n].first;
+            cutoff.reached = true;
+            break;
+        }
+    }
+    cutoff.confusion = Confusion(set.pairs, set.sizes, algorithm, scores, cutoff.threshold);
+
+    return cutoff;
+}
+
+static bool WriteThresholdLevels(const std::string &filename, const std::vector<int> &algorithms, const std::vector<std::vector<float>> &levels, std::string &error) // replace the lines of these algorithms, keep the rest of the file
+{
+    std::ifstream input(filename);
+    if (!input) {
+        error = "the file could not be read";
+        return false;
+    }
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(input, line))
+        lines.push_back(line);
+    input.close();
+
+    for (const int &algorithm : algorithms) {
+        std::ostringstream values;
+        values << std::fixed << std::setprecision(2) << "\t" << AlgorithmName(algorithm) << "=\t\t" << std::setw(6) << levels[algorithm][0];
+        for (int level = 1; level < 4; level++)
+            values << ",\t\t" << std::setw(6) << levels[algorithm][level];
+
+        bool found = false;
+        for (std::string &current : lines) {
+            const size_t first = current.find_first_not_of(" \t");
+            if ((first != std::string::npos) and (current.compare(first, AlgorithmName(algorithm).size() + 1, AlgorithmName(algorithm) + "=") == 0)) {
+                current = values.str();
+                found = true;
+            }
+        }
+        if (!found) { // new algorithm : before the end comment
+            auto end = std::find(lines.begin(), lines.end(), "# end of config");
+            lines.insert(end, values.str());
+        }
+    }
+
+    std::error_code copyError; // previous version kept
+    std::filesystem::copy_file(filename, filename + ".bak", std::filesystem::copy_options::overwrite_existing, copyError);
+    std::ofstream output(filename);
+    for (const std::string &current : lines)
+        output << current << "\n";
+    if (!output) {
+        error = "the file could not be written";
+        return false;
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////
+//// Commands
+///////////////////////////////////////////////////////////
+
+int CommandEvaluate(const struct_command_line &commandLine) // precision, recall and time of each algorithm on labeled pairs
+{
+    const double tolerance = commandLine.OptionDouble("tolerance", 0.5);
+    const long long maxChanges = commandLine.OptionInt("max-changes", 0);
+
+    struct_evaluation_set set;
+    const int result = ScorePairs(commandLine, set);
+    if (result != 0)
+        return result;
+    const std::vector<std::string> &files = set.files;
+    const std::vector<struct_evaluated_pair> &pairs = set.pairs;
+    const std::vector<cv::Size> &sizes = set.sizes;
+    const std::vector<std::vector<float>> &levels = set.levels;
+    const std::vector<struct_evaluation> &evaluations = set.evaluations;
+
+    // results : one line per algorithm and level
+    static const std::string levelNames[4] = {"dissimilar", "different", "similar", "exact"};
+    std::ostringstream results;
+    results << std::fixed;
+    results << "algorithm\tlevel\tthreshold\tprecision\trecall\tf1\ttp\tfp\tfn\ttn\textract_s\tcompare_s\tpeak_rss_mb\n";
+    for (const struct_evaluation &evaluation : evaluations)
+        for (int level = 0; level < 4; level++) {
+            const float threshold = levels[evaluation.algorithm][level];
+            const struct_confusion confusion = Confusion(pairs, sizes, evaluation.algorithm, evaluation.scores, threshold);
+            results << AlgorithmName(evaluation.algorithm) << "\t" << levelNames[level] << "\t" << std::setprecision(2) << threshold
+                    << "\t" << std::setprecision(4) << confusion.Precision() << "\t" << confusion.Recall() << "\t" << confusion.F1()
+                    << "\t" << confusion.truePositives << "\t" << confusion.falsePositives << "\t" << confusion.falseNegatives << "\t" << confusion.trueNegatives
+                    << "\t" << std::setprecision(3) << evaluation.extractTime << "\t" << evaluation.compareTime
+                    << "\t" << std::setprecision(1) << double(evaluation.peakMemory) / 1024.0 << "\n";
+        }
+
+    const std::string output = commandLine.Option("output");
+    if (output.empty())
+        std::cout << results.str();
+    else {
+        std::ofstream file(output);
+        file << results.str();
+        if (!file) {
+            std::cerr << "evaluate : the results could not be written to " << output << std::endl;
+            return 1;
+        }
+    }
+    std::cerr << "Total " << std::setprecision(2) << set.totalTime << " s, peak memory " << std::setprecision(1) << double(PeakMemory()) / 1024.0 << " MB"
+              << (set.unreadable > 0 ? ", " + std::to_string(set.unreadable) + " unreadable image(s)" : "") << std::endl;
+
+    // scores of all pairs, for a later regression check
+    const std::string scoresFile = commandLine.Option("scores");
+    if (!scoresFile.empty()) {
+        std::ofstream file(scoresFile);
+        file << "file1\tfile2\tlabel";
+        for (const struct_evaluation &evaluation : evaluations)
+            file << "\t" << AlgorithmName(evaluation.algorithm);
+        file << "\n" << std::fixed << std::setprecision(4);
+        for (size_t n = 0; n < pairs.size(); n++) {
+            file << files[pairs[n].image1] << "\t" << files[pairs[n].image2] << "\t" << (pairs[n].duplicate ? 1 : 0);
+            for (const struct_evaluation &evaluation : evaluations)
+                file << "\t" << evaluation.scores[n];
+            file << "\n";
+        }
+        if (!file) {
+            std::cerr << "evaluate : the scores could not be written to " << scoresFile << std::endl;
+            return 1;
+        }
+    }
+
+    // regression check : scores of this version against a baseline
+    const std::string baselineFile = commandLine.Option("baseline");
+    if (baselineFile.empty())
+        return 0;
+    std::map<std::string, std::unordered_map<std::string, float>> baseline;
+    std::string error;
+    if (!ReadBaseline(baselineFile, baseline, error)) {
+        std::cerr << "evaluate : " << error << " : " << baselineFile << std::endl;
+        return 1;
+    }
+
+    long long totalChanges = 0;
+    for (const struct_evaluation &evaluation : evaluations) {
+        auto algorithm = baseline.find(AlgorithmName(evaluation.algorithm));
+        if (algorithm == baseline.end()) {
+            std::cerr << "Baseline : " << AlgorithmName(evaluation.algorithm) << " not in the baseline" << std::endl;
+            continue;
+        }
+        const float similar = levels[evaluation.algorithm][2];
+        long long compared = 0, changes = 0;
+        float maxDifference = 0;
+        std::vector<float> before(pairs.size(), -1); // baseline scores of the same pairs
+        for (size_t n = 0; n < pairs.size(); n++) {
+            auto score = algorithm->second.find(files[pairs[n].image1] + "\t" + files[pairs[n].image2]);
+            if (score == algorithm->second.end())
+                continue;
+            compared++;
+            before[n] = score->second;
+            const float difference = std::fabs(evaluation.scores[n] - score->second);
+            maxDifference = std::max(maxDifference, difference);
+            const cv::Size &size1 = sizes[pairs[n].image1];
+            const cv::Size &size2 = sizes[pairs[n].image2];
+            if ((difference > tolerance)
+                    or (IsDuplicate(evaluation.algorithm, evaluation.scores[n], similar, size1, size2) != IsDuplicate(evaluation.algorithm, score->second, similar, size1, size2)))
+                changes++;
+        }
+        const double f1Before = Confusion(pairs, sizes, evaluation.algorithm, before, similar).F1();
+        const double f1After = Confusion(pairs, sizes, evaluation.algorithm, evaluation.scores, similar).F1();
+        std::cerr << "Baseline : " << AlgorithmName(evaluation.algorithm) << " - " << compared << " pairs, " << changes << " changed, max difference "
+                  << std::setprecision(3) << maxDifference << "%, F1 at similar " << std::setprecision(4) << f1Before << " -> " << f1After << std::endl;
+        totalChanges += changes;
+    }
+
+    if (totalChanges > maxChanges) {
+        std::cerr << "Regression : " << totalChanges << " pair(s) changed, " << maxChanges << " allowed (tolerance " << std::setprecision(2) << tolerance << "%)" << std::endl;
+        return 2;
+    }
+
+    return 0;
+}
+
+int CommandCalibrate(const struct_command_line &commandLine) // thresholds of data/thresholds.cfg from labeled pairs, and the best prefilter
+{
+    std::vector<double> precisions; // target precision of the "different", "similar" and "exact" levels
+    try {
+        for (const std::string &precision : commandLine.OptionList("precision", "0.5,0.95,0.999"))
+            precisions.push_back(std::stod(precision));
+    }
+    catch (...) {}
+    if ((precisions.size() != 3) or (*std::min_element(precisions.begin(), precisions.end()) <= 0) or (*std::max_element(precisions.begin(), precisions.end()) > 1)) {
+        std::cerr << "calibrate : --precision needs 3 values in ]0..1], for the different, similar and exact levels" << std::endl;
+        return 1;
+    }
+    const double recall = commandLine.OptionDouble("recall", 0.99);
+    const std::vector<std::string> prefilters = commandLine.OptionList("prefilters", "ahash,phash,dhash,idhash,blockmean,marrhildreth,radialvariance,dominantcolors");
+
+    struct_evaluation_set set;
+    const int result = ScorePairs(commandLine, set);
+    if (result != 0)
+        return result;
+    const std::vector<std::vector<float>> current = set.levels;
+
+    // levels : dissimilar stays the lowest value, the others are the lowest thresholds that reach their precision
+    static const std::string levelNames[4] = {"dissimilar", "different", "similar", "exact"};
+    std::ostringstream results;
+    results << std::fixed;
+    results << "algorithm\tlevel\tcurrent\tcalibrated\ttarget_precision\tprecision\trecall\treached\n";
+    std::vector<int> calibrated;
+    for (struct_evaluation &evaluation : set.evaluations) {
+        if (evaluation.algorithm == img_similarity_count) // the combined score depends on the levels of the others : last
+            evaluation.scores = CombinedScores(set);
+        std::vector<float> levels = current[evaluation.algorithm];
+        for (int level = 1; level < 4; level++) {
+            const struct_cutoff cutoff = PrecisionCutoff(set, evaluation.algorithm, evaluation.scores, precisions[level - 1]);
+            levels[level] = std::max(std::max(levels[0], levels[level - 1]), std::floor(cutoff.threshold * 100.0f) / 100.0f); // levels are sorted
+            const struct_confusion confusion = Confusion(set.pairs, set.sizes, evaluation.algorithm, evaluation.scores, levels[level]);
+            results << AlgorithmName(evaluation.algorithm) << "\t" << levelNames[level] << "\t" << std::setprecision(2) << current[evaluation.algorithm][level] << "\t" << levels[level]
+                    << "\t" << std::setprecision(4) << precisions[level - 1] << "\t" << confusion.Precision() << "\t" << confusion.Recall()
+                    << "\t" << (cutoff.reached ? "yes" : "no") << "\n";
+        }
+        set.levels[evaluation.algorithm] = levels;
+        calibrated.push_back(evaluation.algorithm);
+    }
+
+    // prefilter : a cheap algorithm that keeps almost all duplicates and prunes the most pairs before the expensive ones
+    struct struct_prefilter {
+        int algorithm;
+        struct_cutoff cutoff;
+        double pruned; // share of all pairs
+    };
+    std::vector<struct_prefilter> candidates;
+    for (const struct_evaluation &evaluation : set.evaluations) {
+        if (std::find(prefilters.begin(), prefilters.end(), AlgorithmName(evaluation.algorithm)) == prefilters.end())
+            continue;
+        struct_prefilter candidate;
+        candidate.algorithm = evaluation.algorithm;
+        candidate.cutoff = RecallCutoff(set, evaluation.algorithm, evaluation.scores, recall);
+        const struct_confusion &confusion = candidate.cutoff.confusion;
+        const long long total = confusion.truePositives + confusion.falsePositives + confusion.falseNegatives + confusion.trueNegatives;
+        candidate.pruned = (total > 0) ? double(confusion.falseNegatives + confusion.trueNegatives) / double(total) : 0.0;
+        candidates.push_back(candidate);
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const struct_prefilter &a, const struct_prefilter &b) { return a.pruned > b.pruned; });
+
+    results << "\nprefilter\tcutoff\ttarget_recall\trecall\tpruned\treached\textract_s\tcompare_s\n";
+    for (const struct_prefilter &candidate : candidates) {
+        const struct_evaluation &evaluation = *std::find_if(set.evaluations.begin(), set.evaluations.end(), [&](const struct_evaluation &e) { return e.algorithm == candidate.algorithm; });
+        results << AlgorithmName(candidate.algorithm) << "\t" << std::setprecision(2) << candidate.cutoff.threshold
+                << "\t" << std::setprecision(4) << recall << "\t" << candidate.cutoff.confusion.Recall() << "\t" << candidate.pruned
+                << "\t" << (candidate.cutoff.reached ? "yes" : "no")
+                << "\t" << std::setprecision(3) << evaluation.extractTime << "\t" << evaluation.compareTime << "\n";
+    }
+
+    const std::string output = commandLine.Option("output");
+    if (output.empty())
+        std::cout << results.str();
+    else {
+        std::ofstream file(output);
+        file << results.str();
+        if (!file) {
+            std::cerr << "calibrate : the results could not be written to " << output << std::endl;
+            return 1;
+        }
+    }
+    if (!candidates.empty())
+        std::cerr << "Best prefilter : " << AlgorithmName(candidates.front().algorithm) << " >= " << std::setprecision(2) << candidates.front().cutoff.threshold
+                  << " prunes " << std::setprecision(1) << candidates.front().pruned * 100.0 << "% of the pairs at recall " << std::setprecision(4) << candidates.front().cutoff.confusion.Recall() << std::endl;
+
+    // new levels
+    if (commandLine.OptionBool("write")) {
+        std::string error;
+        if (!WriteThresholdLevels("data/thresholds.cfg", calibrated, set.levels, error)) {
+            std::cerr << "calibrate : data/thresholds.cfg : " << error << std::endl;
+            return 1;
+        }
+        std::cerr << "data/thresholds.cfg updated, previous version in data/thresholds.cfg.bak" << std::endl;
+    }
+    else
+        std::cerr << "Use --write to save these levels to data/thresholds.cfg" << std::endl;
+
+    return 0;
+}
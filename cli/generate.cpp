@@ -0,0 +1,343 @@
+/*#-------------------------------------------------
+#
+#       Headless "generate" command
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.0 - 2026/10/19
+#
+#   - image-match generate [<seed image or folder>...] --output folder [--count n] [--variants n]
+#                          [--transformations list] [--size pixels] [--quality q] [--seed n]
+#   - a synthetic corpus of near-duplicates, with the truth about them :
+#       * groups of images : one original, made from a random part of a seed image (or drawn if no seed is given)
+#         with random shapes on it so that two groups never look alike
+#       * variants of the original, each with 1 to 3 labeled transformations :
+#         rescale, crop, jpeg (re-encode), color (shift in OKLAB), rotate, mirror, watermark
+#   - output folder :
+#       images/0000/g0000000-v0.jpg... : 1000 groups per sub-folder
+#       images.tsv : file, group, variant, width, height, transformations
+#       pairs.tsv  : all the duplicate pairs (same group) - any other pair is NOT a duplicate
+#   - reproducible : the same seed and options give the same corpus, whatever the number of threads
+#
+#-------------------------------------------------*/
+
+#include "cli.h"
+#include "../lib/image-files.h"
+#include "../lib/image-transform.h"
+#include "../lib/image-color.h"
+#include "../lib/image-utils.h"
+#include "../lib/randomizer.h"
+#include "../lib/angles.h"
+#include "../lib/string-utils.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+
+
+enum generatorTransformation {generate_rescale, generate_crop, generate_jpeg, generate_color, generate_rotate, generate_mirror, generate_watermark, generate_count};
+static const std::string generatorTransformationNames[generate_count] = {"rescale", "crop", "jpeg", "color", "rotate", "mirror", "watermark"};
+
+struct struct_generated_image { // one line of images.tsv
+    std::string file; // relative to output folder
+    int group;
+    int variant; // 0 = original
+    int width;
+    int height;
+    std::string transformations; // "name=value" separated by ";", empty for originals
+};
+
+///////////////////////////////////////////////////////////
+//// Images
+///////////////////////////////////////////////////////////
+
+static cv::Scalar RandomColor()
+{
+    return cv::Scalar(Randomize<int>(0, 255), Randomize<int>(0, 255), Randomize<int>(0, 255));
+}
+
+static cv::Mat GenerateOriginal(const std::vector<cv::Mat> &seeds, const int &size) // a random part of a seed image, with shapes - or only shapes
+{
+    cv::Mat image;
+    if (!seeds.empty()) { // a random crop of a seed : 35 to 70% of its sides
+        const cv::Mat &seed = seeds[Randomize<int>(0, int(seeds.size()) - 1)];
+        const double part = Randomize<double>(0.35, 0.7);
+        const int width = std::max(16, int(seed.cols * part * Randomize<double>(0.8, 1.2)));
+        const int height = std::max(16, int(seed.rows * part * Randomize<double>(0.8, 1.2)));
+        const cv::Rect frame(Randomize<int>(0, std::max(0, seed.cols - width)), Randomize<int>(0, std::max(0, seed.rows - height)), width, height);
+        image = CopyFromImage(seed, frame);
+        image = QualityResizeImageAspectRatio(image, cv::Size(size, size));
+    }
+    else { // drawn : smooth gradient background
+        const bool portrait = (Randomize<int>(0, 2) == 0);
+        image = cv::Mat(portrait ? size : size * 3 / 4, portrait ? size * 3 / 4 : size, CV_8UC3);
+        const cv::Scalar color1 = RandomColor();
+        const cv::Scalar color2 = RandomColor();
+        for (int row = 0; row < image.rows; row++) {
+            const double t = double(row) / image.rows;
+            image.row(row).setTo(color1 * (1.0 - t) + color2 * t);
+        }
+    }
+
+    const int shapes = seeds.empty() ? Randomize<int>(16, 32) : Randomize<int>(4, 10); // shapes make each original unique, even from the same seed
+    const int scale = std::max(image.cols, image.rows);
+    for (int s = 0; s < shapes; s++) {
+        const cv::Point center(Randomize<int>(0, image.cols - 1), Randomize<int>(0, image.rows - 1));
+        switch (Randomize<int>(0, 2)) {
+            case 0:
+                cv::circle(image, center, Randomize<int>(scale / 60 + 1, scale / 8 + 2), RandomColor(), cv::FILLED, cv::LINE_AA);
+                break;
+            case 1:
+                cv::rectangle(image, cv::Rect(center.x, center.y, Randomize<int>(scale / 40 + 1, scale / 5 + 2), Randomize<int>(scale / 40 + 1, scale / 5 + 2)), RandomColor(), cv::FILLED);
+                break;
+            default:
+                cv::line(image, center, cv::Point(Randomize<int>(0, image.cols - 1), Randomize<int>(0, image.rows - 1)), RandomColor(), Randomize<int>(1, scale / 100 + 2), cv::LINE_AA);
+        }
+    }
+
+    return image;
+}
+
+static cv::Mat Transform(const cv::Mat &source, const int &transformation, std::string &label) // apply one transformation with random parameters - label = "name=value"
+{
+    std::ostringstream value;
+    value << std::fixed << std::setprecision(2);
+    cv::Mat result;
+
+    switch (transformation) {
+        case generate_rescale: { // 35% to 150% of the size
+            const double scale = Randomize<double>(0.35, 1.5);
+            result = ResizeImageAspectRatio(source, cv::Size(std::max(8, int(std::round(source.cols * scale))), std::max(8, int(std::round(source.rows * scale)))));
+            value << scale;
+            break;
+        }
+        case generate_crop: { // 70% to 95% of each side kept
+            const double keep = Randomize<double>(0.7, 0.95);
+            const int width = std::max(8, int(source.cols * keep));
+            const int height = std::max(8, int(source.rows * keep));
+            result = CopyFromImage(source, cv::Rect(Randomize<int>(0, source.cols - width), Randomize<int>(0, source.rows - height), width, height));
+            value << keep;
+            break;
+        }
+        case generate_jpeg: { // re-encoded with a low quality
+            const int quality = Randomize<int>(20, 85);
+            std::vector<uchar> buffer;
+            cv::imencode(".jpg", source, buffer, {cv::IMWRITE_JPEG_QUALITY, quality});
+            result = cv::imdecode(buffer, cv::IMREAD_COLOR);
+            value << quality;
+            break;
+        }
+        case generate_color: { // lightness and hue shift in OKLAB, perceptually even - out of gamut colors are clipped
+            const double L = Randomize<double>(-0.08, 0.08);
+            const double a = Randomize<double>(-0.03, 0.03);
+            const double b = Randomize<double>(-0.03, 0.03);
+            cv::Mat lab = ConvertImageRGBtoOKLAB(source);
+            lab += cv::Scalar(L, a, b);
+            result = ConvertImageOKLABtoRGB(lab, true);
+            value << "L" << std::showpos << L << ",a" << a << ",b" << b;
+            break;
+        }
+        case generate_rotate: { // a quarter turn, or a small angle like a scan
+            if (Randomize<int>(0, 1) == 0) {
+                const int turn = Randomize<int>(1, 3);
+                cv::rotate(source, result, (turn == 1) ? cv::ROTATE_90_CLOCKWISE : ((turn == 2) ? cv::ROTATE_180 : cv::ROTATE_90_COUNTERCLOCKWISE));
+                value << turn * 90;
+            }
+            else {
+                double angle = Randomize<double>(2.0, 12.0) * ((Randomize<int>(0, 1) == 0) ? 1 : -1);
+                int dX, dY;
+                result = RotateImage(source, DegToRad(angle), source.cols / 2, source.rows / 2, dX, dY); // the corners are black
+                value << angle;
+            }
+            break;
+        }
+        case generate_mirror: {
+            result = MirrorImage(source, true, false);
+            value << "horizontal";
+            break;
+        }
+        case generate_watermark: { // semi-transparent text in a corner
+            const double opacity = Randomize<double>(0.4, 0.8);
+            const double fontScale = std::max(0.4, source.cols / 900.0);
+            const std::string text = "(c) image-match " + std::to_string(Randomize<int>(1000, 9999));
+            int baseline;
+            const cv::Size textSize = cv::getTextSize(text, cv::FONT_HERSHEY_SIMPLEX, fontScale, 2, &baseline);
+            cv::Mat mark(textSize.height + baseline + 8, textSize.width + 8, CV_8UC4, cv::Scalar(0, 0, 0, 0));
+            cv::putText(mark, text, cv::Point(4, textSize.height + 4), cv::FONT_HERSHEY_SIMPLEX, fontScale, cv::Scalar(255, 255, 255, 255 * opacity), 2, cv::LINE_AA);
+            result = source.clone();
+            const int corner = Randomize<int>(0, 3);
+            const cv::Point position((corner % 2 == 0) ? 8 : result.cols - mark.cols - 8, (corner < 2) ? 8 : result.rows - mark.rows - 8);
+            PasteImageAlphaFast(result, mark, position);
+            value << opacity;
+            break;
+        }
+    }
+
+    label = generatorTransformationNames[transformation] + "=" + value.str();
+
+    return result;
+}
+
+static std::vector<cv::Mat> LoadSeeds(const std::vector<std::string> &arguments) // seed images from files and folders
+{
+    std::vector<std::string> files;
+    for (const std::string &argument : arguments) {
+        std::error_code error;
+        if (std::filesystem::is_directory(argument, error)) {
+            std::vector<std::string> found = ListImageFiles(argument, true);
+            std::sort(found.begin(), found.end()); // same order each time : the corpus depends on it
+            files.insert(files.end(), found.begin(), found.end());
+        }
+        else
+            files.push_back(argument);
+    }
+
+    std::vector<cv::Mat> seeds;
+    for (const std::string &file : files) {
+        std::string type, loadwith;
+        ImageFileType(stringutils::GetFilenameExtension(file), type, loadwith);
+        cv::Mat image = LoadImageFile(file, loadwith);
+        if (image.empty())
+            std::cerr << "generate : the image could not be read : " << file << std::endl;
+        else
+            seeds.push_back(image);
+    }
+
+    return seeds;
+}
+
+///////////////////////////////////////////////////////////
+//// Command
+///////////////////////////////////////////////////////////
+
+int CommandGenerate(const struct_command_line &commandLine) // synthetic corpus of near-duplicates with ground truth
+{
+    const std::string output = commandLine.Option("output");
+    if (output.empty()) {
+        std::cerr << "generate : --output folder is needed" << std::endl;
+        return 1;
+    }
+    const int count = std::max(1, commandLine.OptionInt("count", 1000));
+    const int variants = std::max(0, commandLine.OptionInt("variants", 4));
+    const int size = std::max(64, commandLine.OptionInt("size", 1024));
+    const int quality = std::min(100, std::max(1, commandLine.OptionInt("quality", 95)));
+    const uint64_t seed = uint64_t(commandLine.OptionInt("seed", 1));
+
+    std::vector<int> transformations;
+    for (const std::string &name : commandLine.OptionList("transformations", "all")) {
+        bool found = false;
+        for (int t = 0; t < generate_count; t++)
+            if ((name == "all") or (name == generatorTransformationNames[t])) {
+                transformations.push_back(t);
+                found = true;
+            }
+        if (!found) {
+            std::cerr << "generate : unknown transformation " << name << std::endl;
+            return 1;
+        }
+    }
+
+    const std::vector<cv::Mat> seeds = LoadSeeds(commandLine.arguments);
+    if ((!commandLine.arguments.empty()) and (seeds.empty()))
+        return 1;
+
+    const int groupSize = variants + 1;
+    const int groups = (count + groupSize - 1) / groupSize;
+    std::vector<std::vector<struct_generated_image>> generated(groups);
+
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(output) / "images", error);
+    for (int folder = 0; folder <= (groups - 1) / 1000; folder++) {
+        std::ostringstream name;
+        name << std::setw(4) << std::setfill('0') << folder;
+        std::filesystem::create_directories(std::filesystem::path(output) / "images" / name.str(), error);
+    }
+    if (error) {
+        std::cerr << "generate : the output folder could not be created : " << error.message() << std::endl;
+        return 1;
+    }
+
+    std::cerr << "Generating " << count << " images : " << groups << " groups of " << groupSize << (seeds.empty() ? ", drawn" : ", from seeds") << std::endl;
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic<int> done {0};
+    std::atomic<int> errors {0};
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int group = 0; group < groups; group++) {
+        RandomizeSeed(seed * 0x9E3779B97F4A7C15ULL + uint64_t(group)); // each group has its own sequence : same corpus with any number of threads
+
+        std::ostringstream folder, prefix;
+        folder << "images/" << std::setw(4) << std::setfill('0') << group / 1000;
+        prefix << folder.str() << "/g" << std::setw(7) << std::setfill('0') << group << "-v";
+
+        const cv::Mat original = GenerateOriginal(seeds, size);
+        const int inGroup = std::min(groupSize, count - group * groupSize); // the last group can be smaller
+        for (int variant = 0; variant < inGroup; variant++) {
+            struct_generated_image image;
+            image.file = prefix.str() + std::to_string(variant) + ".jpg";
+            image.group = group;
+            image.variant = variant;
+
+            cv::Mat result = original;
+            if ((variant > 0) and (!transformations.empty())) {
+                std::vector<int> chosen = transformations; // 1 to 3 different transformations, in random order
+                for (int n = int(chosen.size()) - 1; n > 0; n--)
+                    std::swap(chosen[n], chosen[Randomize<int>(0, n)]);
+                chosen.resize(std::min(int(chosen.size()), Randomize<int>(1, 3)));
+                for (const int &transformation : chosen) {
+                    std::string label;
+                    result = Transform(result, transformation, label);
+                    image.transformations += (image.transformations.empty() ? "" : ";") + label;
+                }
+            }
+
+            image.width = result.cols;
+            image.height = result.rows;
+            if (cv::imwrite((std::filesystem::path(output) / image.file).string(), result, {cv::IMWRITE_JPEG_QUALITY, quality}))
+                generated[group].push_back(image);
+            else
+                errors++;
+        }
+
+        const int finished = ++done;
+        if (finished % std::max(1, groups / 100) == 0) {
+            #pragma omp critical
+            std::cerr << "\r" << finished << " / " << groups << " groups" << std::flush;
+        }
+    }
+    std::cerr << std::endl;
+
+    // ground truth
+    std::ofstream images((std::filesystem::path(output) / "images.tsv").string());
+    std::ofstream pairs((std::filesystem::path(output) / "pairs.tsv").string());
+    images << "file\tgroup\tvariant\twidth\theight\ttransformations\n";
+    pairs << "file1\tfile2\ttransformations1\ttransformations2\n";
+    long long imagesCount = 0, pairsCount = 0;
+    for (const std::vector<struct_generated_image> &group : generated) {
+        for (size_t i = 0; i < group.size(); i++) {
+            images << group[i].file << "\t" << group[i].group << "\t" << group[i].variant << "\t" << group[i].width << "\t" << group[i].height << "\t" << group[i].transformations << "\n";
+            imagesCount++;
+            for (size_t j = i + 1; j < group.size(); j++) { // all pairs of a group are duplicates, also between variants
+                pairs << group[i].file << "\t" << group[j].file << "\t" << group[i].transformations << "\t" << group[j].transformations << "\n";
+                pairsCount++;
+            }
+        }
+    }
+    if ((!images) or (!pairs)) {
+        std::cerr << "generate : the ground truth files could not be written" << std::endl;
+        return 1;
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Generated " << imagesCount << " images (" << pairsCount << " duplicate pairs) in " << output << " - "
+              << std::fixed << std::setprecision(1) << seconds << " s, " << double(imagesCount) / std::max(0.001, seconds) << " images/s" << std::endl;
+    if (errors > 0)
+        std::cerr << "generate : " << errors << " images could not be written" << std::endl;
+
+    return (errors > 0) ? 1 : 0;
+}
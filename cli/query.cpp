@@ -0,0 +1,120 @@
+/*#-------------------------------------------------
+#
+#       Headless "index" and "query" commands
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.0 - 2026/10/19
+#
+#   - image-match index <folder>... [--index file] [--reduced size] [--no-recursive]
+#       the catalog is brought up to date with the folders : only new or modified files are read
+#   - image-match query <image>... [--index file] [--corpus folder] [--top n] [--phash %] [--dhash %]
+#       "does this picture already exist ?" : the probe signature is computed with the same code as the GUI
+#       and looked up in the catalog indexes, not compared to each image
+#   - query output, tab-separated on stdout : probe, rank, score, exact, phash %, dhash %, catalog image
+#     timings on stderr
+#
+#-------------------------------------------------*/
+
+#include "cli.h"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+
+///////////////////////////////////////////////////////////
+//// Index
+///////////////////////////////////////////////////////////
+
+int CommandIndex(const struct_command_line &commandLine) // add folders to a catalog
+{
+    if (commandLine.arguments.empty()) {
+        std::cerr << "index : at least one folder is needed" << std::endl;
+        return 1;
+    }
+    const std::vector<std::string> folders = CatalogFolders(commandLine);
+    if (folders.empty())
+        return 1;
+
+    ImageCatalog catalog;
+    if (!OpenCatalog(catalog, commandLine))
+        return 1;
+
+    long long removed = 0;
+    const std::vector<std::string> files = FindCatalogChanges(catalog, folders, !commandLine.OptionBool("no-recursive"), removed);
+    std::cout << "Catalog : " << catalog.Count() << " images, " << files.size() << " new or modified files to read, " << removed << " removed" << std::endl;
+
+    const long long added = AddToCatalog(catalog, files, commandLine.OptionInt("reduced", 256), true);
+    catalog.Close();
+    std::cout << "Added : " << added << " images, unreadable : " << files.size() - added << std::endl;
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////
+//// Query
+///////////////////////////////////////////////////////////
+
+int CommandQuery(const struct_command_line &commandLine) // find the catalog images that match probe images
+{
+    if (commandLine.arguments.empty()) {
+        std::cerr << "query : at least one image is needed" << std::endl;
+        return 1;
+    }
+
+    ImageCatalog catalog;
+    if (!OpenCatalog(catalog, commandLine))
+        return 1;
+
+    const int reducedSize = commandLine.OptionInt("reduced", 256);
+    const std::string corpus = commandLine.Option("corpus");
+    if (!corpus.empty()) { // index the corpus first
+        struct_command_line corpusLine;
+        corpusLine.command = "query";
+        corpusLine.arguments.push_back(corpus);
+        const std::vector<std::string> folders = CatalogFolders(corpusLine);
+        if (folders.empty())
+            return 1;
+        long long removed = 0;
+        const std::vector<std::string> files = FindCatalogChanges(catalog, folders, true, removed);
+        if (!files.empty())
+            std::cerr << "Indexing " << files.size() << " new or modified files of the corpus" << std::endl;
+        AddToCatalog(catalog, files, reducedSize, false);
+    }
+
+    const struct_catalog_thresholds thresholds = LoadCatalogThresholds(commandLine);
+    const int top = commandLine.OptionInt("top", 20);
+
+    std::cout << "probe\trank\tscore\texact\tphash\tdhash\timage" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    int errors = 0;
+    for (const std::string &argument : commandLine.arguments) {
+        const std::string path = CatalogPath(argument); // like the paths in catalog : a probe reached through a symbolic link is found too
+
+        auto start = std::chrono::steady_clock::now();
+        struct_image_signature signature;
+        if (!ComputeImageSignature(path, reducedSize, signature)) {
+            std::cerr << "query : the image could not be read : " << argument << std::endl;
+            errors++;
+            continue;
+        }
+        auto computed = std::chrono::steady_clock::now();
+
+        const std::vector<struct_catalog_result> results = catalog.QueryRanked(signature, thresholds, top, catalog.Find(path)); // a probe already in catalog doesn't match itself
+        auto searched = std::chrono::steady_clock::now();
+
+        for (size_t n = 0; n < results.size(); n++)
+            std::cout << argument << "\t" << n + 1 << "\t" << results[n].score << "\t" << (results[n].exact ? "yes" : "no") << "\t"
+                      << results[n].pHash << "\t" << results[n].dHash << "\t" << catalog.Signature(results[n].id).path << "\n";
+        std::cout << std::flush;
+
+        std::cerr << argument << " : " << results.size() << " match(es) in " << catalog.Count() << " images - signature "
+                  << std::chrono::duration<double, std::milli>(computed - start).count() << " ms, search "
+                  << std::chrono::duration<double, std::milli>(searched - computed).count() << " ms" << std::endl;
+    }
+
+    catalog.Close();
+
+    return (errors > 0) ? 1 : 0;
+}
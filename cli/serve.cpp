@@ -0,0 +1,157 @@
+/*#-------------------------------------------------
+#
+#       Headless "serve" and "request" commands
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.0 - 2026/10/19
+#
+#   - image-match serve [--socket path] [--index file] [--corpus folder] [--phash %] [--dhash %] [--reduced size]
+#       the catalog is loaded once and shared by all the clients of the socket, see lib/match-server.h for the protocol
+#   - image-match request [--socket path] <request words>...
+#       sends one request and prints the response : to test or script the server from a shell
+#       the image path of QUERY, INSERT and DELETE is resolved here : relative to the folder of the client, not of the server
+#
+#-------------------------------------------------*/
+
+#include "cli.h"
+#include "../lib/match-server.h"
+
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+static const std::string defaultSocket = "/tmp/image-match.sock";
+
+///////////////////////////////////////////////////////////
+//// Server
+///////////////////////////////////////////////////////////
+
+static volatile std::sig_atomic_t serveStop = 0; // set by SIGINT and SIGTERM
+
+static void ServeSignal(int) // stop the server
+{
+    serveStop = 1;
+}
+
+int CommandServe(const struct_command_line &commandLine) // answer match requests on a local socket
+{
+    ImageCatalog catalog;
+    if (!OpenCatalog(catalog, commandLine))
+        return 1;
+
+    const int reducedSize = commandLine.OptionInt("reduced", 256);
+    const std::string corpus = commandLine.Option("corpus");
+    if (!corpus.empty()) { // index the corpus first
+        struct_command_line corpusLine;
+        corpusLine.command = "serve";
+        corpusLine.arguments.push_back(corpus);
+        const std::vector<std::string> folders = CatalogFolders(corpusLine);
+        if (folders.empty())
+            return 1;
+        long long removed = 0;
+        const std::vector<std::string> files = FindCatalogChanges(catalog, folders, true, removed);
+        std::cout << "Indexing " << files.size() << " new or modified files of the corpus" << std::endl;
+        AddToCatalog(catalog, files, reducedSize, true);
+    }
+
+    MatchServer server(catalog, LoadCatalogThresholds(commandLine), reducedSize);
+    const std::string socketPath = commandLine.Option("socket", defaultSocket);
+    std::string error;
+    if (!server.Start(socketPath, error)) {
+        std::cerr << "serve : " << socketPath << " : " << error << std::endl;
+        return 1;
+    }
+
+    std::signal(SIGINT, ServeSignal);
+    std::signal(SIGTERM, ServeSignal);
+    std::cout << "Serving " << catalog.Count() << " images on " << socketPath << " - Ctrl+C to stop" << std::endl;
+
+    int seconds = 0;
+    while (!serveStop) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        if (++seconds % 10 == 0) // inserts and deletes are on disk after a crash
+            server.Flush();
+    }
+
+    const std::string stats = server.Stats();
+    server.Stop();
+    catalog.Close();
+    std::cout << "Stopped" << std::endl << stats;
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////
+//// Client
+///////////////////////////////////////////////////////////
+
+int CommandRequest(const struct_command_line &commandLine) // send one request to a server and print the response
+{
+    if (commandLine.arguments.empty()) {
+        std::cerr << "request : a request is needed, for example : request STATS" << std::endl;
+        return 1;
+    }
+
+    std::string request;
+    for (const std::string &argument : commandLine.arguments)
+        request += (request.empty() ? "" : " ") + argument;
+
+    // image path : the server has its own current folder
+    const std::string &command = commandLine.arguments[0];
+    const size_t pathStart = (command == "QUERY") ? 2 : (((command == "INSERT") or (command == "DELETE")) ? 1 : 0);
+    if ((pathStart > 0) and (commandLine.arguments.size() > pathStart)) {
+        std::string path;
+        for (size_t n = pathStart; n < commandLine.arguments.size(); n++)
+            path += (path.empty() ? "" : " ") + commandLine.arguments[n];
+        request.clear();
+        for (size_t n = 0; n < pathStart; n++)
+            request += commandLine.arguments[n] + " ";
+        request += CatalogPath(path);
+    }
+    request += "\n";
+
+    const std::string socketPath = commandLine.Option("socket", defaultSocket);
+    struct sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    int server = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if ((server < 0) or (connect(server, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0)) {
+        std::cerr << "request : " << socketPath << " : " << std::strerror(errno) << std::endl;
+        if (server >= 0)
+            close(server);
+        return 1;
+    }
+
+    bool failed = (send(server, request.data(), request.size(), MSG_NOSIGNAL) != ssize_t(request.size()));
+    std::string response;
+    char data[4096];
+    while ((!failed) and (response.find("\n\n") == std::string::npos) and (response != "\n")) { // an empty line ends the response
+        ssize_t length = read(server, data, sizeof(data));
+        if (length <= 0)
+            failed = true;
+        else
+            response.append(data, length);
+    }
+    close(server);
+
+    if (failed) {
+        std::cerr << "request : the server closed the connection" << std::endl;
+        return 1;
+    }
+
+    response.pop_back(); // the empty line
+    std::cout << response;
+
+    return (response.compare(0, 2, "OK") == 0) ? 0 : 1;
+}
@@ -0,0 +1,297 @@
+/*#-------------------------------------------------
+#
+#       Headless "watch" command
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.0 - 2026/10/19
+#
+#   - image-match watch <folder>... [--catalog file] [--log file] [--phash %] [--dhash %] [--reduced size] [--no-recursive]
+#   - first, the catalog is brought up to date with the folders : only new or modified files are read
+#   - then inotify tells which files are written, moved or deleted : each new image is matched
+#     against the whole catalog with the indexes, so its cost doesn't grow with the collection
+#   - matches are appended to a tab-separated log : date, algorithm, similarity, new image, catalog image
+#   - stops on Ctrl+C (SIGINT) or SIGTERM, the catalog is saved
+#
+#   Linux only (inotify)
+#
+#-------------------------------------------------*/
+
+#include "cli.h"
+#include "../lib/image-files.h"
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+#include <chrono>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+
+
+///////////////////////////////////////////////////////////
+//// Folders watcher
+///////////////////////////////////////////////////////////
+
+static volatile std::sig_atomic_t watchStop = 0; // set by SIGINT and SIGTERM
+
+static void WatchSignal(int) // stop the main loop
+{
+    watchStop = 1;
+}
+
+class FolderWatcher // inotify watches on folders and their sub-folders
+{
+public:
+    FolderWatcher() { fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC); }
+    ~FolderWatcher() { if (fd >= 0) close(fd); }
+
+    bool IsValid() const { return fd >= 0; }
+    int Descriptor() const { return fd; }
+
+    void AddFolder(const std::string &folder, const bool &recursive) // watch a folder - and its sub-folders if recursive
+    {
+        AddWatch(folder);
+        if (!recursive)
+            return;
+
+        std::error_code error;
+        for (std::filesystem::recursive_directory_iterator it(folder, std::filesystem::directory_options::skip_permission_denied, error), end; (!error) and (it != end); it.increment(error))
+            if (it->is_directory(error))
+                AddWatch(it->path().string());
+    }
+
+    std::string Folder(const int &wd) const // watched folder of a watch descriptor - empty if unknown
+    {
+        auto found = folders.find(wd);
+        if (found == folders.end())
+            return "";
+
+        return found->second;
+    }
+
+    void Forget(const int &wd) // the folder was deleted : the kernel removed the watch
+    {
+        folders.erase(wd);
+    }
+
+private:
+    void AddWatch(const std::string &folder)
+    {
+        int wd = inotify_add_watch(fd, folder.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_CREATE | IN_DELETE_SELF | IN_ONLYDIR);
+        if (wd < 0)
+            std::cerr << "Can't watch folder " << folder << " : " << std::strerror(errno) << std::endl; // probably fs.inotify.max_user_watches
+        else
+            folders[wd] = folder;
+    }
+
+    int fd = -1; // inotify instance
+    std::unordered_map<int, std::string> folders; // watch descriptor -> folder
+};
+
+///////////////////////////////////////////////////////////
+//// Matching
+///////////////////////////////////////////////////////////
+
+struct struct_watch_context { // shared by the steps of the command
+    ImageCatalog catalog;
+    struct_catalog_thresholds thresholds;
+    int reducedSize = 256;
+    std::ofstream log; // matches
+    long long filesRead = 0; // statistics
+    long long matchesFound = 0;
+    long long filesRemoved = 0;
+};
+
+static void ProcessFiles(struct_watch_context &context, const std::vector<std::string> &files) // compute signatures in parallel, then match and add them to the catalog
+{
+    if (files.empty())
+        return;
+
+    std::vector<struct_image_signature> signatures(files.size());
+    std::vector<char> valid(files.size(), 0);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int n = 0; n < int(files.size()); n++) // the expensive part : read and hash
+        valid[n] = ComputeImageSignature(files[n], context.reducedSize, signatures[n]);
+
+    for (size_t n = 0; n < files.size(); n++) { // catalog is not thread-safe : sequential, but each query only looks at a few candidates
+        if (!valid[n]) {
+            if (signatures[n].fileSize >= 0) // unreadable : kept with width = 0, not read again until the file changes
+                context.catalog.Put(signatures[n]);
+            else
+                context.catalog.Remove(files[n]); // deleted before it was read
+            continue;
+        }
+        context.filesRead++;
+
+        std::vector<struct_catalog_match> matches = context.catalog.Query(signatures[n], context.thresholds, context.catalog.Find(files[n])); // a modified file doesn't match its old version
+        for (const struct_catalog_match &found : matches) {
+            context.log << CurrentDateTime() << "\t" << AlgorithmName(found.algorithm) << "\t" << found.similarity << "\t"
+                        << files[n] << "\t" << context.catalog.Signature(found.id).path << "\n";
+            context.matchesFound++;
+        }
+
+        context.catalog.Put(signatures[n]);
+    }
+
+    context.log.flush();
+    context.catalog.Flush();
+}
+
+static void ScanFolders(struct_watch_context &context, const std::vector<std::string> &folders, const bool &recursive) // bring the catalog up to date with the folders, new files are matched
+{
+    std::vector<std::string> toRead = FindCatalogChanges(context.catalog, folders, recursive, context.filesRemoved);
+
+    std::cout << "Reading " << toRead.size() << " new or modified image files" << std::endl;
+    ProcessFiles(context, toRead);
+}
+
+///////////////////////////////////////////////////////////
+//// Command
+///////////////////////////////////////////////////////////
+
+int CommandWatch(const struct_command_line &commandLine) // watch folders and log new matches
+{
+    if (commandLine.arguments.empty()) {
+        std::cerr << "watch : at least one folder is needed" << std::endl;
+        return 1;
+    }
+
+    const std::vector<std::string> folders = CatalogFolders(commandLine);
+    if (folders.empty())
+        return 1;
+    const bool recursive = !commandLine.OptionBool("no-recursive");
+
+    struct_watch_context context;
+    context.thresholds = LoadCatalogThresholds(commandLine);
+    context.reducedSize = commandLine.OptionInt("reduced", 256);
+    if (!OpenCatalog(context.catalog, commandLine))
+        return 1;
+
+    const std::string logFilename = commandLine.Option("log", "data/matches.log");
+    std::error_code error;
+    const bool newLog = !std::filesystem::exists(logFilename, error);
+    context.log.open(logFilename, std::ios::out | std::ios::app);
+    if (!context.log.is_open()) {
+        std::cerr << "watch : the log file could not be opened : " << logFilename << std::endl;
+        return 1;
+    }
+    if (newLog)
+        context.log << "date\talgorithm\tsimilarity\timage\tmatches\n";
+
+    FolderWatcher watcher; // watches first : files written during the scan are not lost
+    if (!watcher.IsValid()) {
+        std::cerr << "watch : inotify is not available : " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    for (const std::string &folder : folders)
+        watcher.AddFolder(folder, recursive);
+
+    std::signal(SIGINT, WatchSignal);
+    std::signal(SIGTERM, WatchSignal);
+
+    std::cout << "Catalog : " << context.catalog.Count() << " images" << std::endl;
+    ScanFolders(context, folders, recursive);
+    std::cout << "Watching " << folders.size() << " folder(s) - Ctrl+C to stop" << std::endl;
+
+    // events are gathered for a short time : a copy of many files is processed in parallel, and a file written twice is read once
+    const auto debounce = std::chrono::milliseconds(1000);
+    const size_t maxPending = 256; // process at once when so many files are waiting
+    std::vector<std::string> pending;
+    std::unordered_set<std::string> pendingSet;
+    auto lastEvent = std::chrono::steady_clock::now();
+    alignas(struct inotify_event) char buffer[64 * 1024];
+
+    while (!watchStop) {
+        struct pollfd descriptor = {watcher.Descriptor(), POLLIN, 0};
+        int ready = poll(&descriptor, 1, 500); // wake up regularly for debounce and signals
+        if ((ready < 0) and (errno != EINTR)) {
+            std::cerr << "watch : " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        bool rescan = false;
+        if ((ready > 0) and (descriptor.revents & POLLIN)) {
+            ssize_t length;
+            while ((length = read(watcher.Descriptor(), buffer, sizeof(buffer))) > 0) { // all available events
+                for (char *p = buffer; p < buffer + length; ) {
+                    const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(p);
+                    p += sizeof(struct inotify_event) + event->len;
+
+                    if (event->mask & IN_Q_OVERFLOW) { // events were lost : look at everything again
+                        rescan = true;
+                        continue;
+                    }
+                    if (event->mask & (IN_DELETE_SELF | IN_IGNORED)) {
+                        watcher.Forget(event->wd);
+                        continue;
+                    }
+
+                    const std::string folder = watcher.Folder(event->wd);
+                    if ((folder.empty()) or (event->len == 0))
+                        continue;
+                    const std::string path = folder + "/" + event->name;
+
+                    if (event->mask & IN_ISDIR) { // a new folder : watch it, its files were maybe written before the watch
+                        if ((recursive) and (event->mask & (IN_CREATE | IN_MOVED_TO))) {
+                            watcher.AddFolder(path, true);
+                            for (const std::string &file : ListImageFiles(path, true))
+                                if (pendingSet.insert(file).second)
+                                    pending.push_back(file);
+                        }
+                        else if ((event->mask & IN_MOVED_FROM)) // a whole folder moved away
+                            for (const int &id : context.catalog.Ids(path)) {
+                                context.catalog.Remove(context.catalog.Signature(id).path);
+                                context.filesRemoved++;
+                            }
+                        continue;
+                    }
+
+                    if (!IsImageFile(path))
+                        continue;
+
+                    if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) { // complete file : IN_CREATE alone would be an empty file
+                        if (pendingSet.insert(path).second)
+                            pending.push_back(path);
+                    }
+                    else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                        if (context.catalog.Find(path) >= 0) {
+                            context.catalog.Remove(path);
+                            context.filesRemoved++;
+                        }
+                    }
+                }
+                lastEvent = std::chrono::steady_clock::now();
+            }
+        }
+
+        if (rescan) {
+            pending.clear();
+            pendingSet.clear();
+            ScanFolders(context, folders, recursive);
+        }
+
+        if ((!pending.empty()) and ((pending.size() >= maxPending) or (std::chrono::steady_clock::now() - lastEvent >= debounce))) {
+            std::vector<std::string> files;
+            files.swap(pending);
+            pendingSet.clear();
+            const long long matchesBefore = context.matchesFound;
+            ProcessFiles(context, files);
+            std::cout << CurrentDateTime() << " : " << files.size() << " file(s), " << context.matchesFound - matchesBefore << " match(es)" << std::endl;
+        }
+    }
+
+    ProcessFiles(context, pending); // last files
+    context.catalog.Close();
+    std::cout << "Stopped - images read : " << context.filesRead << ", removed : " << context.filesRemoved
+              << ", matches : " << context.matchesFound << " (see " << logFilename << ")" << std::endl;
+
+    return 0;
+}
@@ -31,9 +31,21 @@ SOURCES +=  main.cpp\
             lib/string-utils.cpp \
             lib/contours.cpp \
             #lib/image-effects.cpp \
-            #lib/image-transform.cpp \
+            lib/image-transform.cpp \
             lib/image-color.cpp \
             lib/image-compare.cpp \
+            lib/features-matcher.cpp \
+            lib/visual-words.cpp \
+            lib/clustering.cpp \
+            lib/thumbnail-cache.cpp \
+            lib/file-operations.cpp \
+            lib/image-files.cpp \
+            lib/signature-index.cpp \
+            lib/image-catalog.cpp \
+            lib/match-server.cpp \
+            lib/stage-timer.cpp \
+            lib/image-pyramid.cpp \
+            lib/tile-hash.cpp \
             #lib/image-filter.cpp \
             #lib/image-draw.cpp \
             #lib/image-lut.cpp \
@@ -41,6 +53,16 @@ SOURCES +=  main.cpp\
             #lib/EDLine/EDColor.cpp \
             #lib/EDLine/ED.cpp \
             #lib/polypartition/polypartition.cpp \
+            widgets/images-list-model.cpp \
+            widgets/duplicates-tree-model.cpp \
+            widgets/icon-decoder.cpp \
+            cli/cli.cpp \
+            cli/watch.cpp \
+            cli/query.cpp \
+            cli/serve.cpp \
+            cli/benchmark.cpp \
+            cli/generate.cpp \
+            cli/evaluate.cpp \
             #widgets/image-viewer.cpp \
             #widgets/dial-range.cpp \
             #dialogs/file-dialog.cpp
@@ -56,9 +78,21 @@ HEADERS  += mainwindow.h \
             lib/string-utils.h \
             lib/contours.h \
             #lib/image-effects.h \
-            #lib/image-transform.h \
+            lib/image-transform.h \
             lib/image-color.h \
             lib/image-compare.h \
+            lib/features-matcher.h \
+            lib/visual-words.h \
+            lib/clustering.h \
+            lib/thumbnail-cache.h \
+            lib/file-operations.h \
+            lib/image-files.h \
+            lib/signature-index.h \
+            lib/image-catalog.h \
+            lib/match-server.h \
+            lib/stage-timer.h \
+            lib/image-pyramid.h \
+            lib/tile-hash.h \
             #lib/image-filter.h \
             #lib/image-draw.h \
             #lib/image-lut.h \
@@ -67,6 +101,10 @@ HEADERS  += mainwindow.h \
             #lib/EDLine/EDColor.h \
             #lib/EDLine/ED.h \
             #lib/polypartition/polypartition.h \
+            widgets/images-list-model.h \
+            widgets/duplicates-tree-model.h \
+            widgets/icon-decoder.h \
+            cli/cli.h \
             #widgets/image-viewer.h \
             #widgets/dial-range.h \
             #dialogs/file-dialog.h
@@ -0,0 +1,595 @@
+/*#-------------------------------------------------
+#
+#          Graph clustering library
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.1 - 2026/10/19
+#
+#   - undirected weighted graph stored as CSR (compressed sparse rows)
+#   - parallel lock-free union-find : connected components
+#   - agglomerative refinement of components with linkage :
+#       single, average, complete, majority
+#   - score-sorted edges + maximum spanning forest (Kruskal) :
+#       clusters for any threshold, only changed components are recomputed
+#
+#   standard C++ + OpenMP only
+#
+#-------------------------------------------------*/
+
+#include "clustering.h"
+
+#include <atomic>
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+
+///////////////////////////////////////////////////////////
+//// Graph
+///////////////////////////////////////////////////////////
+
+struct_csr_graph BuildCSRGraph(const int &nbNodes, const std::vector<struct_cluster_edge> &edges) // build CSR graph from a list of edges - duplicate edges and self-loops are ignored
+{
+    struct_csr_graph graph;
+    graph.nbNodes = nbNodes;
+    graph.offsets.assign(nbNodes + 1, 0);
+
+    // degree of each node
+    std::vector<std::atomic<long long>> degrees(nbNodes);
+    #pragma omp parallel for
+    for (int n = 0; n < nbNodes; n++)
+        degrees[n].store(0, std::memory_order_relaxed);
+    #pragma omp parallel for
+    for (long long e = 0; e < (long long)(edges.size()); e++) {
+        if (edges[e].a == edges[e].b)
+            continue;
+        degrees[edges[e].a].fetch_add(1, std::memory_order_relaxed);
+        degrees[edges[e].b].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // offsets = prefix sum of degrees
+    for (int n = 0; n < nbNodes; n++)
+        graph.offsets[n + 1] = graph.offsets[n] + degrees[n].load(std::memory_order_relaxed);
+
+    // fill : "degrees" becomes the next free position of each node
+    #pragma omp parallel for
+    for (int n = 0; n < nbNodes; n++)
+        degrees[n].store(graph.offsets[n], std::memory_order_relaxed);
+    graph.neighbours.resize(graph.offsets[nbNodes]);
+    graph.scores.resize(graph.offsets[nbNodes]);
+    #pragma omp parallel for
+    for (long long e = 0; e < (long long)(edges.size()); e++) {
+        const struct_cluster_edge &edge = edges[e];
+        if (edge.a == edge.b)
+            continue;
+        long long position = degrees[edge.a].fetch_add(1, std::memory_order_relaxed);
+        graph.neighbours[position] = edge.b;
+        graph.scores[position] = edge.score;
+        position = degrees[edge.b].fetch_add(1, std::memory_order_relaxed);
+        graph.neighbours[position] = edge.a;
+        graph.scores[position] = edge.score;
+    }
+
+    // sort neighbours of each node (the fill order depends on threads) and remove duplicate edges, keeping the best score
+    std::vector<long long> sizes(nbNodes);
+    #pragma omp parallel
+    {
+        std::vector<std::pair<int, float>> list;
+        #pragma omp for schedule(dynamic, 1024)
+        for (int n = 0; n < nbNodes; n++) {
+            const long long begin = graph.offsets[n];
+            const long long end = graph.offsets[n + 1];
+            list.clear();
+            for (long long p = begin; p < end; p++)
+                list.emplace_back(graph.neighbours[p], graph.scores[p]);
+            std::sort(list.begin(), list.end(), [](const std::pair<int, float> &x, const std::pair<int, float> &y) {
+                return (x.first < y.first) or ((x.first == y.first) and (x.second > y.second)); });
+            long long size = 0;
+            for (size_t l = 0; l < list.size(); l++)
+                if ((l == 0) or (list[l].first != list[l - 1].first)) {
+                    graph.neighbours[begin + size] = list[l].first;
+                    graph.scores[begin + size] = list[l].second;
+                    size++;
+                }
+            sizes[n] = size;
+        }
+    }
+
+    // compact if duplicate edges were removed
+    long long position = 0;
+    for (int n = 0; n < nbNodes; n++) {
+        const long long begin = graph.offsets[n];
+        graph.offsets[n] = position;
+        if (begin != position)
+            for (long long p = 0; p < sizes[n]; p++) {
+                graph.neighbours[position + p] = graph.neighbours[begin + p];
+                graph.scores[position + p] = graph.scores[begin + p];
+            }
+        position += sizes[n];
+    }
+    graph.offsets[nbNodes] = position;
+    graph.neighbours.resize(position);
+    graph.scores.resize(position);
+
+    return graph;
+}
+
+///////////////////////////////////////////////////////////
+//// Connected components
+///////////////////////////////////////////////////////////
+
+    // lock-free union-find : roots are always linked to the smallest index, with compare-and-swap
+    // path halving during "find" : concurrent writes only replace a parent by one of its ancestors, so it stays valid
+
+int UnionFindRoot(std::vector<std::atomic<int>> &parent, int node) // root of a node, with path halving
+{
+    while (true) {
+        int p = parent[node].load(std::memory_order_relaxed);
+        if (p == node)
+            return node;
+        const int grandParent = parent[p].load(std::memory_order_relaxed);
+        if (grandParent != p)
+            parent[node].compare_exchange_weak(p, grandParent, std::memory_order_relaxed); // halving - failure is harmless
+        node = grandParent;
+    }
+}
+
+void UnionFindUnite(std::vector<std::atomic<int>> &parent, int a, int b) // merge the sets of a and b
+{
+    while (true) {
+        a = UnionFindRoot(parent, a);
+        b = UnionFindRoot(parent, b);
+        if (a == b)
+            return;
+        if (a > b) // the biggest root goes under the smallest
+            std::swap(a, b);
+        int expected = b;
+        if (parent[b].compare_exchange_strong(expected, a, std::memory_order_relaxed)) // b is still a root ?
+            return;
+        // else another thread changed b meanwhile : try again
+    }
+}
+
+std::vector<int> ConnectedComponents(const struct_csr_graph &graph) // parallel union-find -> label of each node = smallest node index of its component
+{
+    const int nbNodes = graph.nbNodes;
+    std::vector<std::atomic<int>> parent(nbNodes);
+    #pragma omp parallel for
+    for (int n = 0; n < nbNodes; n++)
+        parent[n].store(n, std::memory_order_relaxed);
+
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int n = 0; n < nbNodes; n++)
+        for (long long p = graph.offsets[n]; p < graph.offsets[n + 1]; p++)
+            if (graph.neighbours[p] > n) // each edge once
+                UnionFindUnite(parent, n, graph.neighbours[p]);
+
+    std::vector<int> labels(nbNodes);
+    #pragma omp parallel for
+    for (int n = 0; n < nbNodes; n++)
+        labels[n] = UnionFindRoot(parent, n);
+
+    return labels;
+}
+
+///////////////////////////////////////////////////////////
+//// Linkage refinement
+///////////////////////////////////////////////////////////
+
+    // inside each connected component, agglomerative clustering :
+    //   - each node is a cluster, edges are processed from best to worst score
+    //   - 2 clusters are merged if the linkage accepts them
+    //   - for each cluster, the links to other clusters (number of edges, sum of scores) are kept in a hash map,
+    //     the smallest map is merged into the biggest one : no rescan of clusters members
+    // components are independent : processed in parallel
+
+struct struct_cluster_link { // all edges between 2 clusters
+    long long count = 0; // number of edges
+    double sum = 0; // sum of their scores
+};
+
+bool LinkageAccepts(const clusterLinkage &linkage, const struct_cluster_link &link, const long long &sizeA, const long long &sizeB,
+                    const float &threshold, const float &minRatio) // can clusters A and B be merged ?
+{
+    const double pairsCount = double(sizeA) * double(sizeB); // all pairs between A and B, with or without edge
+
+    switch (linkage) {
+        case cluster_linkage_single:    return link.count > 0;
+        case cluster_linkage_average:   return link.sum / pairsCount >= threshold;
+        case cluster_linkage_complete:  return double(link.count) >= pairsCount;
+        case cluster_linkage_majority:  return double(link.count) / pairsCount > minRatio;
+    }
+
+    return false;
+}
+
+void RefineSmallComponent(const struct_csr_graph &graph, const std::vector<int> &nodes, const float &threshold, const clusterLinkage &linkage,
+                          const float &minRatio, std::vector<int> &clusterOf) // same as RefineComponent for at most 64 nodes : links in a dense matrix, no hash map
+    // most duplicates groups are small, this is what re-clustering mostly runs
+{
+    const int size = nodes.size();
+
+    // edges of the component, best first - nodes are sorted so a binary search gives the local index
+    std::vector<struct_cluster_edge> edges;
+    for (int n = 0; n < size; n++)
+        for (long long p = graph.offsets[nodes[n]]; p < graph.offsets[nodes[n] + 1]; p++)
+            if (graph.neighbours[p] > nodes[n])
+                edges.push_back({n, int(std::lower_bound(nodes.begin(), nodes.end(), graph.neighbours[p]) - nodes.begin()), graph.scores[p]});
+    std::sort(edges.begin(), edges.end(), [](const struct_cluster_edge &x, const struct_cluster_edge &y) {
+        return (x.score > y.score) or ((x.score == y.score) and ((x.a < y.a) or ((x.a == y.a) and (x.b < y.b)))); });
+
+    // links between clusters : row = cluster root
+    std::vector<struct_cluster_link> links(size * size);
+    for (size_t e = 0; e < edges.size(); e++) {
+        links[edges[e].a * size + edges[e].b].count++;
+        links[edges[e].a * size + edges[e].b].sum += edges[e].score;
+        links[edges[e].b * size + edges[e].a] = links[edges[e].a * size + edges[e].b];
+    }
+
+    int root[64]; // no union-find needed : all members point directly to their root
+    long long members[64];
+    for (int n = 0; n < size; n++) {
+        root[n] = n;
+        members[n] = 1;
+    }
+
+    for (size_t e = 0; e < edges.size(); e++) {
+        const int a = root[edges[e].a];
+        const int b = root[edges[e].b];
+        if (a == b) // already in the same cluster
+            continue;
+
+        if (!LinkageAccepts(linkage, links[a * size + b], members[a], members[b], threshold, minRatio))
+            continue;
+
+        // merge b into a
+        for (int k = 0; k < size; k++) {
+            if ((k == a) or (k == b))
+                continue;
+            links[a * size + k].count += links[b * size + k].count;
+            links[a * size + k].sum += links[b * size + k].sum;
+            links[k * size + a] = links[a * size + k];
+        }
+        for (int n = 0; n < size; n++)
+            if (root[n] == b)
+                root[n] = a;
+        members[a] += members[b];
+    }
+
+    // label = smallest node of the cluster - nodes are sorted so the first one found is the smallest
+    int label[64];
+    for (int n = 0; n < size; n++)
+        label[n] = -1;
+    for (int n = 0; n < size; n++) {
+        if (label[root[n]] == -1)
+            label[root[n]] = nodes[n];
+        clusterOf[nodes[n]] = label[root[n]];
+    }
+}
+
+void RefineComponent(const struct_csr_graph &graph, const std::vector<int> &nodes, const float &threshold, const clusterLinkage &linkage,
+                     const float &minRatio, std::vector<int> &clusterOf) // agglomerative clustering of one connected component - clusterOf[node] = smallest node of its cluster
+{
+    const int size = nodes.size();
+
+    if (size <= 64) {
+        RefineSmallComponent(graph, nodes, threshold, linkage, minRatio, clusterOf);
+        return;
+    }
+
+    // local indexes
+    std::unordered_map<int, int> local;
+    local.reserve(size);
+    for (int n = 0; n < size; n++)
+        local[nodes[n]] = n;
+
+    // edges of the component, best first - ties sorted by nodes for a deterministic result
+    std::vector<struct_cluster_edge> edges;
+    for (int n = 0; n < size; n++)
+        for (long long p = graph.offsets[nodes[n]]; p < graph.offsets[nodes[n] + 1]; p++)
+            if (graph.neighbours[p] > nodes[n])
+                edges.push_back({n, local[graph.neighbours[p]], graph.scores[p]});
+    std::sort(edges.begin(), edges.end(), [](const struct_cluster_edge &x, const struct_cluster_edge &y) {
+        return (x.score > y.score) or ((x.score == y.score) and ((x.a < y.a) or ((x.a == y.a) and (x.b < y.b)))); });
+
+    // clusters
+    std::vector<int> parent(size); // sequential union-find inside the component
+    std::iota(parent.begin(), parent.end(), 0);
+    std::vector<long long> members(size, 1);
+    std::vector<std::unordered_map<int, struct_cluster_link>> links(size); // root -> (other root -> link)
+    for (size_t e = 0; e < edges.size(); e++) {
+        links[edges[e].a][edges[e].b].count++;
+        links[edges[e].a][edges[e].b].sum += edges[e].score;
+        links[edges[e].b][edges[e].a].count++;
+        links[edges[e].b][edges[e].a].sum += edges[e].score;
+    }
+
+    auto root = [&parent](int n) {
+        while (parent[n] != n) {
+            parent[n] = parent[parent[n]];
+            n = parent[n];
+        }
+        return n;
+    };
+
+    for (size_t e = 0; e < edges.size(); e++) {
+        int a = root(edges[e].a);
+        int b = root(edges[e].b);
+        if (a == b) // already in the same cluster
+            continue;
+
+        if (!LinkageAccepts(linkage, links[a][b], members[a], members[b], threshold, minRatio))
+            continue;
+
+        // merge smallest links map into biggest
+        if (links[a].size() < links[b].size())
+            std::swap(a, b);
+        links[a].erase(b);
+        links[b].erase(a);
+        for (auto &link : links[b]) {
+            struct_cluster_link &merged = links[a][link.first];
+            merged.count += link.second.count;
+            merged.sum += link.second.sum;
+            std::unordered_map<int, struct_cluster_link> &other = links[link.first]; // update the other side
+            struct_cluster_link &otherToA = other[a];
+            otherToA.count += link.second.count;
+            otherToA.sum += link.second.sum;
+            other.erase(b);
+        }
+        std::unordered_map<int, struct_cluster_link>().swap(links[b]);
+        parent[b] = a;
+        members[a] += members[b];
+    }
+
+    // label = smallest node of the cluster - nodes are sorted so the first one found is the smallest
+    std::vector<int> label(size, -1);
+    for (int n = 0; n < size; n++) {
+        const int r = root(n);
+        if (label[r] == -1)
+            label[r] = nodes[n];
+        clusterOf[nodes[n]] = label[r];
+    }
+}
+
+void ClusterComponent(const struct_csr_graph &graph, const std::vector<int> &nodes, const float &threshold, const clusterLinkage &linkage,
+                      const float &minRatio, const bool &attachLeftovers, std::vector<int> &clusterOf) // refinement + leftovers of one connected component
+{
+    RefineComponent(graph, nodes, threshold, linkage, minRatio, clusterOf);
+
+    if (!attachLeftovers)
+        return;
+
+    // leftovers : nodes with edges but alone in their cluster join the cluster of their best neighbour in a real cluster
+    // all neighbours are in the same component, so only its nodes are needed
+    // labels are nodes of the component : cluster sizes are indexed by the local index of their label
+    auto local = [&nodes](const int &node) { return std::lower_bound(nodes.begin(), nodes.end(), node) - nodes.begin(); };
+    std::vector<int> clusterSize(nodes.size(), 0);
+    for (size_t n = 0; n < nodes.size(); n++)
+        clusterSize[local(clusterOf[nodes[n]])]++;
+
+    std::vector<std::pair<int, int>> attached; // (node, new label) - applied at the end : a leftover can't join another leftover
+    for (size_t n = 0; n < nodes.size(); n++) {
+        const int node = nodes[n];
+        if ((clusterSize[local(clusterOf[node])] > 1) or (graph.offsets[node] == graph.offsets[node + 1]))
+            continue;
+        float best = -1;
+        int label = -1;
+        for (long long p = graph.offsets[node]; p < graph.offsets[node + 1]; p++) {
+            const int neighbour = graph.neighbours[p];
+            if ((clusterSize[local(clusterOf[neighbour])] > 1) and (graph.scores[p] > best)) {
+                best = graph.scores[p];
+                label = clusterOf[neighbour];
+            }
+        }
+        if (label != -1)
+            attached.emplace_back(node, label);
+    }
+
+    for (size_t n = 0; n < attached.size(); n++)
+        clusterOf[attached[n].first] = attached[n].second;
+}
+
+void ClusterComponents(const struct_csr_graph &graph, const std::vector<int> &labels, const std::vector<char> &selected, const float &threshold,
+                       const clusterLinkage &linkage, const float &minRatio, const bool &attachLeftovers, std::vector<int> &clusterOf) // cluster the selected components
+    // labels : component label of each node - selected : by label, empty = all components
+    // clusterOf is only written for the nodes of selected components of at least 3 nodes : 2 nodes linked by an edge are always accepted
+{
+    const int nbNodes = graph.nbNodes;
+
+    // nodes of each component - counting sort by label
+    std::vector<int> componentStart(nbNodes + 1, 0);
+    for (int n = 0; n < nbNodes; n++)
+        componentStart[labels[n] + 1]++;
+    for (int n = 0; n < nbNodes; n++)
+        componentStart[n + 1] += componentStart[n];
+    std::vector<int> componentNodes(nbNodes);
+    std::vector<int> position(componentStart.begin(), componentStart.end() - 1);
+    for (int n = 0; n < nbNodes; n++)
+        componentNodes[position[labels[n]]++] = n; // nodes are sorted in each component
+
+    std::vector<int> components;
+    for (int n = 0; n < nbNodes; n++)
+        if ((componentStart[n + 1] - componentStart[n] > 2) and ((selected.empty()) or (selected[n])))
+            components.push_back(n);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int c = 0; c < int(components.size()); c++) {
+        const int label = components[c];
+        std::vector<int> nodes(componentNodes.begin() + componentStart[label], componentNodes.begin() + componentStart[label + 1]);
+        ClusterComponent(graph, nodes, threshold, linkage, minRatio, attachLeftovers, clusterOf); // each thread writes only the nodes of its component
+    }
+}
+
+std::vector<std::vector<int>> ClustersList(const std::vector<int> &clusterOf) // clusters of at least 2 nodes from the label of each node, each sorted, sorted by first node
+{
+    const int nbNodes = clusterOf.size();
+
+    std::vector<int> clusterIndex(nbNodes, -1);
+    std::vector<std::vector<int>> clusters;
+    for (int n = 0; n < nbNodes; n++) {
+        const int label = clusterOf[n];
+        if (clusterIndex[label] == -1) {
+            clusterIndex[label] = clusters.size();
+            clusters.emplace_back();
+        }
+        clusters[clusterIndex[label]].push_back(n);
+    }
+
+    // only real clusters - nodes were added in increasing order so everything is already sorted
+    clusters.erase(std::remove_if(clusters.begin(), clusters.end(), [](const std::vector<int> &cluster) { return cluster.size() < 2; }), clusters.end());
+
+    return clusters;
+}
+
+std::vector<std::vector<int>> ClusterGraph(const struct_csr_graph &graph, const float &threshold, const clusterLinkage &linkage,
+                                           const float &minRatio, const bool &attachLeftovers) // clusters of at least 2 nodes, each sorted, sorted by first node
+{
+    //// connected components
+    std::vector<int> clusterOf = ConnectedComponents(graph);
+
+    //// refinement
+    if (linkage != cluster_linkage_single) {
+        const std::vector<int> labels = clusterOf;
+        ClusterComponents(graph, labels, std::vector<char>(), threshold, linkage, minRatio, attachLeftovers, clusterOf);
+    }
+
+    return ClustersList(clusterOf);
+}
+
+///////////////////////////////////////////////////////////
+//// Threshold sweep
+///////////////////////////////////////////////////////////
+
+    // edges are sorted once, best first : the graph for threshold t is the prefix of edges >= t
+    // Kruskal on this list gives the maximum spanning forest : components at any threshold only need its n-1 edges at most
+    // between two thresholds, only the components touched by the edges in-between can change, the others keep their clusters
+
+bool EdgeIsBetter(const struct_cluster_edge &x, const struct_cluster_edge &y) // best score first - ties sorted by nodes for a deterministic order
+{
+    return (x.score > y.score) or ((x.score == y.score) and ((x.a < y.a) or ((x.a == y.a) and (x.b < y.b))));
+}
+
+int SequentialRoot(std::vector<int> &parent, int n) // union-find root with path halving, single thread
+{
+    while (parent[n] != n) {
+        parent[n] = parent[parent[n]];
+        n = parent[n];
+    }
+    return n;
+}
+
+void ThresholdClustering::SetEdges(const int &nodes, std::vector<struct_cluster_edge> list) // give ALL scored edges, whatever their score - sorts them and computes the maximum spanning forest
+{
+    nbNodes = nodes;
+    edges.swap(list);
+    std::sort(edges.begin(), edges.end(), EdgeIsBetter);
+
+    // Kruskal : an edge is in the forest if it links 2 different trees - roots are always the smallest node
+    forest.clear();
+    std::vector<int> parent(nbNodes);
+    std::iota(parent.begin(), parent.end(), 0);
+    for (size_t e = 0; (e < edges.size()) and (int(forest.size()) < nbNodes - 1); e++) {
+        int a = SequentialRoot(parent, edges[e].a);
+        int b = SequentialRoot(parent, edges[e].b);
+        if (a == b) // already linked by better edges (or self-loop)
+            continue;
+        if (a > b)
+            std::swap(a, b);
+        parent[b] = a;
+        forest.push_back(edges[e]);
+    }
+
+    cached = false;
+}
+
+void ThresholdClustering::Clear() // no edges, no cache
+{
+    nbNodes = 0;
+    std::vector<struct_cluster_edge>().swap(edges);
+    std::vector<struct_cluster_edge>().swap(forest);
+    std::vector<int>().swap(cachedClusterOf);
+    cached = false;
+}
+
+bool ThresholdClustering::Empty() const // no edges set ?
+{
+    return nbNodes == 0;
+}
+
+long long ThresholdClustering::EdgesAbove(const float &threshold) const // number of edges with score >= threshold = length of the prefix
+{
+    return std::partition_point(edges.begin(), edges.end(), [&threshold](const struct_cluster_edge &edge) { return edge.score >= threshold; }) - edges.begin(); // binary search
+}
+
+const std::vector<struct_cluster_edge>& ThresholdClustering::SortedEdges() const // best first
+{
+    return edges;
+}
+
+std::vector<int> ThresholdClustering::Components(const float &threshold) const // same as ConnectedComponents() for edges >= threshold, from the spanning forest only
+{
+    std::vector<int> labels(nbNodes);
+    std::iota(labels.begin(), labels.end(), 0);
+
+    for (size_t e = 0; (e < forest.size()) and (forest[e].score >= threshold); e++) { // forest is sorted too
+        int a = SequentialRoot(labels, forest[e].a);
+        int b = SequentialRoot(labels, forest[e].b);
+        if (a > b)
+            std::swap(a, b);
+        labels[b] = a; // roots stay the smallest node
+    }
+
+    for (int n = 0; n < nbNodes; n++)
+        labels[n] = SequentialRoot(labels, n);
+
+    return labels;
+}
+
+std::vector<std::vector<int>> ThresholdClustering::Clusters(const float &threshold, const clusterLinkage &linkage, const float &minRatio, const bool &attachLeftovers) // same as ClusterGraph() for edges >= threshold
+{
+    const long long count = EdgesAbove(threshold);
+    const std::vector<int> labels = Components(threshold);
+
+    //// components to cluster again
+    const bool all = (!cached) or (linkage != cachedLinkage) or (minRatio != cachedMinRatio) or (attachLeftovers != cachedAttachLeftovers)
+                  or ((linkage == cluster_linkage_average) and (threshold != cachedThreshold)); // average linkage uses the threshold itself
+    std::vector<char> dirty;
+    if (!all) {
+        // edges between the 2 thresholds : their components (at the new threshold) changed, the other components have exactly the same edges as before
+        dirty.assign(nbNodes, 0);
+        for (long long e = std::min(count, cachedCount); e < std::max(count, cachedCount); e++) {
+            dirty[labels[edges[e].a]] = 1;
+            dirty[labels[edges[e].b]] = 1;
+        }
+    }
+
+    //// clusters
+    std::vector<int> clusterOf = labels;
+    if (linkage != cluster_linkage_single) {
+        if (!all)
+            for (int n = 0; n < nbNodes; n++)
+                if (!dirty[labels[n]]) // unchanged component : previous result
+                    clusterOf[n] = cachedClusterOf[n];
+
+        // graph of the components to cluster again only
+        std::vector<struct_cluster_edge> changed;
+        for (long long e = 0; e < count; e++)
+            if ((all) or (dirty[labels[edges[e].a]]))
+                changed.push_back(edges[e]);
+        const struct_csr_graph graph = BuildCSRGraph(nbNodes, changed);
+
+        ClusterComponents(graph, labels, dirty, threshold, linkage, minRatio, attachLeftovers, clusterOf);
+    }
+
+    //// keep the result for the next call
+    cached = true;
+    cachedCount = count;
+    cachedThreshold = threshold;
+    cachedLinkage = linkage;
+    cachedMinRatio = minRatio;
+    cachedAttachLeftovers = attachLeftovers;
+    cachedClusterOf = clusterOf;
+
+    return ClustersList(clusterOf);
+}
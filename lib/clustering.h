@@ -0,0 +1,85 @@
+/*#-------------------------------------------------
+#
+#          Graph clustering library
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.1 - 2026/10/19
+#
+#   - undirected weighted graph stored as CSR (compressed sparse rows)
+#   - parallel lock-free union-find : connected components
+#   - agglomerative refinement of components with linkage :
+#       single, average, complete, majority
+#   - score-sorted edges + maximum spanning forest (Kruskal) :
+#       clusters for any threshold, only changed components are recomputed
+#
+#   standard C++ + OpenMP only
+#
+#-------------------------------------------------*/
+
+#ifndef CLUSTERING_H
+#define CLUSTERING_H
+
+#include <vector>
+
+
+// linkage used to merge two clusters A and B, from the edges between them (pairs without edge count as score 0)
+enum clusterLinkage {cluster_linkage_single, // at least one edge : same as connected components
+                     cluster_linkage_average, // mean score of all |A|x|B| pairs >= threshold
+                     cluster_linkage_complete, // all |A|x|B| pairs have an edge
+                     cluster_linkage_majority // more than "minRatio" of all |A|x|B| pairs have an edge
+                    };
+
+struct struct_cluster_edge { // one edge of the graph - only edges with score >= threshold should be given
+    int a, b; // nodes
+    float score; // similarity
+};
+
+struct struct_csr_graph { // undirected graph, each edge is stored for both nodes
+    int nbNodes = 0;
+    std::vector<long long> offsets; // neighbours of node n are in [offsets[n]..offsets[n+1][
+    std::vector<int> neighbours; // sorted for each node
+    std::vector<float> scores; // same index as neighbours
+};
+
+//// Graph
+struct_csr_graph BuildCSRGraph(const int &nbNodes, const std::vector<struct_cluster_edge> &edges); // build CSR graph from a list of edges - duplicate edges and self-loops are ignored
+
+//// Clustering
+std::vector<int> ConnectedComponents(const struct_csr_graph &graph); // parallel union-find -> label of each node = smallest node index of its component
+std::vector<std::vector<int>> ClusterGraph(const struct_csr_graph &graph, const float &threshold, const clusterLinkage &linkage,
+                                           const float &minRatio=0.5f, const bool &attachLeftovers=true); // clusters of at least 2 nodes, each sorted, sorted by first node
+    // threshold : only used by average linkage - minRatio : only used by majority linkage
+    // attachLeftovers : a node left alone by the linkage joins the cluster of its best neighbour
+
+//// Threshold sweep
+class ThresholdClustering // all scored edges sorted best first : the graph for a threshold is a prefix of this list
+{
+public:
+    void SetEdges(const int &nbNodes, std::vector<struct_cluster_edge> edges); // give ALL scored edges, whatever their score - sorts them and computes the maximum spanning forest
+    void Clear(); // no edges, no cache
+    bool Empty() const; // no edges set ?
+    long long EdgesAbove(const float &threshold) const; // number of edges with score >= threshold = length of the prefix
+    const std::vector<struct_cluster_edge>& SortedEdges() const; // best first
+    std::vector<int> Components(const float &threshold) const; // same as ConnectedComponents() for edges >= threshold, from the spanning forest only
+    std::vector<std::vector<int>> Clusters(const float &threshold, const clusterLinkage &linkage,
+                                           const float &minRatio=0.5f, const bool &attachLeftovers=true); // same as ClusterGraph() for edges >= threshold
+        // the result of the previous call is kept : only components having edges between the previous and the new threshold are clustered again
+
+private:
+    int nbNodes = 0;
+    std::vector<struct_cluster_edge> edges; // best first
+    std::vector<struct_cluster_edge> forest; // maximum spanning forest, best first : 2 nodes are in the same component at threshold t if they are linked by forest edges >= t
+
+    // previous call of Clusters()
+    bool cached = false;
+    long long cachedCount; // number of edges used
+    float cachedThreshold;
+    clusterLinkage cachedLinkage;
+    float cachedMinRatio;
+    bool cachedAttachLeftovers;
+    std::vector<int> cachedClusterOf; // cluster label of each node
+};
+
+
+#endif // CLUSTERING_H
@@ -4,11 +4,11 @@
 #
 #    by AbsurdePhoton - www.absurdephoton.fr
 #
-#                v1.4 - 2022/12/12
+#                v1.5 - 2026/10/19
 #
 #   - all in OKLAB color space
 #   - sectored means (my own) algorithm
-#   - eigen vectors algorithm
+#   - eigen vectors algorithm - also fast version with fixed-size math
 #   - K-means algorithm
 #
 #-------------------------------------------------*/
@@ -637,6 +637,252 @@ std::vector<cv::Vec3d> DominantColorsEigen(const cv::Mat &img, const int &nb_col
     return colors;
 }
 
+////////////////////////////////////////////////////////////
+////          Eigen vectors algorithm - fast version
+////////////////////////////////////////////////////////////
+
+// same algorithm as above, same palette order, but :
+//   - statistics are accumulated in fixed-size cv::Vec3d / cv::Matx33d, no cv::Mat per pixel
+//   - each class keeps the list of its pixels : a split only reads the pixels of the class being split, and computes both children statistics in the same pass
+//   - the largest eigen value and vector of a class are computed once (closed form), not for each leaf at each split
+//   - the quantized image is optional
+
+void LargestEigenSymmetric3x3(const cv::Matx33d &A, double &eigenValue, cv::Vec3d &eigenVector) // closed-form largest eigen value and vector of a symmetric 3x3 matrix
+    // eigen value : trigonometric solution of the characteristic polynomial (Smith, 1961)
+    // eigen vector : largest cross product of two rows of (A - lambda.I)
+    // the sign of the vector is fixed : its largest component is always positive
+{
+    const double p1 = A(0, 1) * A(0, 1) + A(0, 2) * A(0, 2) + A(1, 2) * A(1, 2); // off-diagonal
+
+    if (p1 < 1e-30) { // diagonal matrix
+        int axis = 0;
+        if (A(1, 1) > A(axis, axis))
+            axis = 1;
+        if (A(2, 2) > A(axis, axis))
+            axis = 2;
+        eigenValue = A(axis, axis);
+        eigenVector = cv::Vec3d(0, 0, 0);
+        eigenVector[axis] = 1.0;
+        return;
+    }
+
+    // largest eigen value
+    const double q = (A(0, 0) + A(1, 1) + A(2, 2)) / 3.0; // trace / 3
+    const double p2 = (A(0, 0) - q) * (A(0, 0) - q) + (A(1, 1) - q) * (A(1, 1) - q) + (A(2, 2) - q) * (A(2, 2) - q) + 2.0 * p1;
+    const double p = std::sqrt(p2 / 6.0);
+    const cv::Matx33d B = (A - q * cv::Matx33d::eye()) * (1.0 / p);
+    double r = cv::determinant(B) / 2.0;
+    r = std::min(1.0, std::max(-1.0, r)); // rounding errors
+    const double phi = std::acos(r) / 3.0;
+    eigenValue = q + 2.0 * p * std::cos(phi);
+
+    // eigen vector : orthogonal to the rows of (A - lambda.I)
+    const cv::Matx33d M = A - eigenValue * cv::Matx33d::eye();
+    const cv::Vec3d r0(M(0, 0), M(0, 1), M(0, 2));
+    const cv::Vec3d r1(M(1, 0), M(1, 1), M(1, 2));
+    const cv::Vec3d r2(M(2, 0), M(2, 1), M(2, 2));
+    const cv::Vec3d c01 = r0.cross(r1);
+    const cv::Vec3d c02 = r0.cross(r2);
+    const cv::Vec3d c12 = r1.cross(r2);
+    const double n01 = c01.dot(c01);
+    const double n02 = c02.dot(c02);
+    const double n12 = c12.dot(c12);
+
+    if (std::max(n01, std::max(n02, n12)) > 1e-30 * p2 * p2) { // simple eigen value
+        if ((n01 >= n02) and (n01 >= n12))
+            eigenVector = c01 / std::sqrt(n01);
+        else if (n02 >= n12)
+            eigenVector = c02 / std::sqrt(n02);
+        else
+            eigenVector = c12 / std::sqrt(n12);
+    }
+    else { // double eigen value : (A - lambda.I) is of rank 1, any vector orthogonal to its largest row is good
+        cv::Vec3d row = r0;
+        if (r1.dot(r1) > row.dot(row))
+            row = r1;
+        if (r2.dot(r2) > row.dot(row))
+            row = r2;
+        int axis = 0; // axis least aligned with the row
+        if (std::abs(row[1]) < std::abs(row[axis]))
+            axis = 1;
+        if (std::abs(row[2]) < std::abs(row[axis]))
+            axis = 2;
+        cv::Vec3d unit(0, 0, 0);
+        unit[axis] = 1.0;
+        eigenVector = row.cross(unit);
+        eigenVector /= cv::norm(eigenVector);
+    }
+
+    // deterministic sign
+    int axis = 0;
+    if (std::abs(eigenVector[1]) > std::abs(eigenVector[axis]))
+        axis = 1;
+    if (std::abs(eigenVector[2]) > std::abs(eigenVector[axis]))
+        axis = 2;
+    if (eigenVector[axis] < 0)
+        eigenVector = -eigenVector;
+}
+
+struct struct_eigen_class { // one node of the classes tree, for DominantColorsEigenFast
+    cv::Vec3d mean; // mean color
+    double eigenValue; // largest eigen value of the scatter matrix
+    cv::Vec3d eigenVector; // and its eigen vector
+    int left, right; // children index in tree, -1 for leaves
+    std::vector<int> pixels; // pixels indexes of this class - only for leaves
+};
+
+void SetEigenClassStatistics(struct_eigen_class &node, const cv::Vec3d &sum, const cv::Matx33d &sumSquares, const int &count, const cv::Vec3d &parentMean) // mean and eigen values of a class from its sums
+    // scatter matrix is NOT divided by the number of pixels, as in GetClassMeanCov : big classes are split first
+{
+    node.left = -1;
+    node.right = -1;
+
+    if (count == 0) { // empty class (all pixels of the parent on the same side) : keep parent color, never split again
+        node.mean = parentMean;
+        node.eigenValue = 0;
+        node.eigenVector = cv::Vec3d(1.0, 0, 0);
+        return;
+    }
+
+    node.mean = sum / double(count);
+    const cv::Matx33d scatter = sumSquares - cv::Matx33d(sum[0] * sum[0], sum[0] * sum[1], sum[0] * sum[2],
+                                                         sum[1] * sum[0], sum[1] * sum[1], sum[1] * sum[2],
+                                                         sum[2] * sum[0], sum[2] * sum[1], sum[2] * sum[2]) * (1.0 / double(count));
+    LargestEigenSymmetric3x3(scatter, node.eigenValue, node.eigenVector);
+}
+
+std::vector<int> GetEigenClassLeaves(const std::vector<struct_eigen_class> &tree) // leaves in breadth-first order, same order as GetLeaves
+{
+    std::vector<int> leaves;
+    std::vector<int> queue(1, 0); // root
+    for (size_t n = 0; n < queue.size(); n++) {
+        const struct_eigen_class &node = tree[queue[n]];
+        if (node.left >= 0) {
+            queue.push_back(node.left);
+            queue.push_back(node.right);
+        }
+        else
+            leaves.push_back(queue[n]);
+    }
+
+    return leaves;
+}
+
+std::vector<cv::Vec3d> DominantColorsEigenFast(const cv::Mat &img, const int &nb_colors, cv::Mat &quantized, const bool &computeQuantized) // same with fixed-size math and one pass per split - quantized image is optional
+    // input image in CIELab or OKLAB values of range [0..1], CV_64FC3 or CV_32FC3 (e.g. from ConvertImageRGBtoOKLABFast)
+    // returns a list of dominant colors in values of range [0..1], and if computeQuantized is true the quantized image (CV_64FC3)
+{
+    quantized = cv::Mat();
+    if ((img.empty()) or (img.channels() != 3))
+        return std::vector<cv::Vec3d>();
+
+    // particular cases are all white or all black image
+    cv::Scalar mean = cv::mean(img);
+    if (mean[0] > 0.99999999)
+        mean[0] = 1.0;
+    if (mean[1] < 0.000001)
+        mean[1] = 0;
+    if (mean[2] < 0.000001)
+        mean[2] = 0;
+
+    if ((mean == cv::Scalar(1.0, 0, 0)) or (mean == cv::Scalar(0.0, 0.0, 0.0))) {
+        cv::Vec3d result = (mean == cv::Scalar(1.0, 0, 0)) ? cv::Vec3d(1.0, 0, 0) : cv::Vec3d(0, 0, 0);
+        if (computeQuantized)
+            quantized = cv::Mat(img.rows, img.cols, CV_64FC3, cv::Scalar(result[0], result[1], result[2]));
+
+        return std::vector<cv::Vec3d>(nb_colors, result);
+    }
+
+    // pixels as a list of colors
+    cv::Mat colorsMat;
+    if (img.depth() == CV_64F)
+        colorsMat = img.isContinuous() ? img : img.clone();
+    else
+        img.convertTo(colorsMat, CV_64F);
+    const cv::Vec3d *colors = colorsMat.ptr<cv::Vec3d>(0);
+    const int nbPixels = img.rows * img.cols;
+
+    // root class : all pixels
+    std::vector<struct_eigen_class> tree;
+    tree.reserve(2 * nb_colors);
+    tree.emplace_back();
+    tree[0].pixels.resize(nbPixels);
+    cv::Vec3d sum(0, 0, 0);
+    cv::Matx33d sumSquares = cv::Matx33d::zeros();
+    for (int n = 0; n < nbPixels; n++) {
+        tree[0].pixels[n] = n;
+        const cv::Vec3d &c = colors[n];
+        sum += c;
+        sumSquares += cv::Matx33d(c[0] * c[0], c[0] * c[1], c[0] * c[2],
+                                  c[1] * c[0], c[1] * c[1], c[1] * c[2],
+                                  c[2] * c[0], c[2] * c[1], c[2] * c[2]);
+    }
+    SetEigenClassStatistics(tree[0], sum, sumSquares, nbPixels, cv::Vec3d(0, 0, 0));
+
+    for (int i = 0; i < nb_colors - 1; i++) {
+        // leaf with the largest eigen value - first one in breadth-first order if equal, as in GetMaxEigenValueNode
+        std::vector<int> leaves = GetEigenClassLeaves(tree);
+        int next = leaves[0];
+        double maxEigen = -1;
+        for (size_t l = 0; l < leaves.size(); l++)
+            if (tree[leaves[l]].eigenValue > maxEigen) {
+                maxEigen = tree[leaves[l]].eigenValue;
+                next = leaves[l];
+            }
+
+        // partition the class along its main axis, and compute both children statistics at the same time
+        const cv::Vec3d eig = tree[next].eigenVector;
+        const double comparisonValue = eig.dot(tree[next].mean);
+        struct_eigen_class left, right;
+        cv::Vec3d sumLeft(0, 0, 0), sumRight(0, 0, 0);
+        cv::Matx33d sumSquaresLeft = cv::Matx33d::zeros(), sumSquaresRight = cv::Matx33d::zeros();
+        left.pixels.reserve(tree[next].pixels.size());
+        right.pixels.reserve(tree[next].pixels.size());
+        for (const int &n : tree[next].pixels) {
+            const cv::Vec3d &c = colors[n];
+            const cv::Matx33d square(c[0] * c[0], c[0] * c[1], c[0] * c[2],
+                                     c[1] * c[0], c[1] * c[1], c[1] * c[2],
+                                     c[2] * c[0], c[2] * c[1], c[2] * c[2]);
+            if (eig.dot(c) <= comparisonValue) {
+                left.pixels.push_back(n);
+                sumLeft += c;
+                sumSquaresLeft += square;
+            }
+            else {
+                right.pixels.push_back(n);
+                sumRight += c;
+                sumSquaresRight += square;
+            }
+        }
+        SetEigenClassStatistics(left, sumLeft, sumSquaresLeft, left.pixels.size(), tree[next].mean);
+        SetEigenClassStatistics(right, sumRight, sumSquaresRight, right.pixels.size(), tree[next].mean);
+
+        std::vector<int>().swap(tree[next].pixels); // only leaves keep their pixels
+        tree[next].left = tree.size();
+        tree[next].right = tree.size() + 1;
+        tree.push_back(std::move(left)); // tree[next] can't be used after this
+        tree.push_back(std::move(right));
+    }
+
+    // palette
+    const std::vector<int> leaves = GetEigenClassLeaves(tree);
+    std::vector<cv::Vec3d> palette;
+    palette.reserve(leaves.size());
+    for (size_t l = 0; l < leaves.size(); l++)
+        palette.push_back(tree[leaves[l]].mean);
+
+    // quantized image, only if needed
+    if (computeQuantized) {
+        quantized = cv::Mat(img.rows, img.cols, CV_64FC3);
+        cv::Vec3d *ptr = quantized.ptr<cv::Vec3d>(0);
+        for (size_t l = 0; l < leaves.size(); l++)
+            for (const int &n : tree[leaves[l]].pixels)
+                ptr[n] = tree[leaves[l]].mean;
+    }
+
+    return palette;
+}
+
 ////////////////////////////////////////////////////////////
 ////                K_means algorithm
 ////////////////////////////////////////////////////////////
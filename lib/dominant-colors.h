@@ -4,11 +4,11 @@
 #
 #    by AbsurdePhoton - www.absurdephoton.fr
 #
-#                v1.4 - 2022/12/12
+#                v1.5 - 2026/10/19
 #
 #   - all in OKLAB color space
 #   - sectored means (my own) algorithm
-#   - eigen vectors algorithm
+#   - eigen vectors algorithm - also fast version with fixed-size math
 #   - K-means algorithm
 #
 #-------------------------------------------------*/
@@ -160,6 +160,8 @@ typedef struct color_node { // for eigen algorithm
 } color_node;
 
 std::vector<cv::Vec3d> DominantColorsEigen(const cv::Mat &img, const int &nb_colors, cv::Mat &quantized); // Eigen algorithm with CIELab or OKLAB values in range [0..1]
+std::vector<cv::Vec3d> DominantColorsEigenFast(const cv::Mat &img, const int &nb_colors, cv::Mat &quantized, const bool &computeQuantized=true); // same with fixed-size math and one pass per split - quantized image is optional
+void LargestEigenSymmetric3x3(const cv::Matx33d &A, double &eigenValue, cv::Vec3d &eigenVector); // closed-form largest eigen value and vector of a symmetric 3x3 matrix
 
 ///////////////////////////////////////////////
 ////                K-means
@@ -0,0 +1,282 @@
+/*#-------------------------------------------------
+#
+#    Binary descriptors matching library with openCV
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.0 - 2026/10/19
+#
+#   - SIMD Hamming distance for packed binary descriptors (512-bit BEBLID)
+#   - brute-force 2-NN matcher + Lowe's ratio test with early exit
+#   - one reusable matcher per thread : no allocation per image pair
+#   - LSH index (FLANN) for one-vs-many queries
+#
+#-------------------------------------------------*/
+
+#include "features-matcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include <map>
+
+#if defined(__AVX2__) or defined(__AVX512VPOPCNTDQ__)
+    #include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+
+///////////////////////////////////////////////////////////
+//// Hamming distance
+///////////////////////////////////////////////////////////
+
+int HammingDistance(const uchar *a, const uchar *b, const int &bytes) // Hamming distance between two binary descriptors of any size
+{
+    int distance = 0;
+    int n = 0;
+
+    for (; n + 8 <= bytes; n += 8) { // 64 bits at a time
+        uint64_t wa, wb;
+        std::memcpy(&wa, a + n, 8); // memcpy : no alignment needed, compiled to a simple load
+        std::memcpy(&wb, b + n, 8);
+        distance += __builtin_popcountll(wa ^ wb); // one POPCNT instruction with -msse4.2
+    }
+    for (; n < bytes; n++) // remaining bytes
+        distance += __builtin_popcount(a[n] ^ b[n]);
+
+    return distance;
+}
+
+int HammingDistance512(const uchar *a, const uchar *b) // Hamming distance between two packed 512-bit (64 bytes) descriptors
+    // BEBLID SIZE_512_BITS descriptors are 64 bytes per row, this is the hot loop of features matching
+{
+#if defined(__AVX512VPOPCNTDQ__) and defined(__AVX512F__)
+    // AVX-512 : the whole descriptor in one register
+    const __m512i x = _mm512_xor_si512(_mm512_loadu_si512((const void*)a), _mm512_loadu_si512((const void*)b));
+    return int(_mm512_reduce_add_epi64(_mm512_popcnt_epi64(x)));
+#elif defined(__AVX2__)
+    // AVX2 : popcount with a 4-bit lookup table (vpshufb), then horizontal sum with vpsadbw
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4); // number of bits in each nibble
+    const __m256i low4 = _mm256_set1_epi8(0x0f);
+
+    const __m256i x0 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)a), _mm256_loadu_si256((const __m256i*)b)); // first 256 bits
+    const __m256i x1 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(a + 32)), _mm256_loadu_si256((const __m256i*)(b + 32))); // last 256 bits
+
+    __m256i count = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, _mm256_and_si256(x0, low4)),
+                                    _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(x0, 4), low4))); // max 8 per byte
+    count = _mm256_add_epi8(count, _mm256_shuffle_epi8(lookup, _mm256_and_si256(x1, low4)));
+    count = _mm256_add_epi8(count, _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(x1, 4), low4))); // max 16 per byte, no overflow
+
+    const __m256i sums = _mm256_sad_epu8(count, _mm256_setzero_si256()); // 4 x 64-bit partial sums
+    return _mm256_extract_epi64(sums, 0) + _mm256_extract_epi64(sums, 1) + _mm256_extract_epi64(sums, 2) + _mm256_extract_epi64(sums, 3);
+#elif defined(__ARM_NEON)
+    // NEON : vcnt counts bits per byte
+    uint16x8_t count = vdupq_n_u16(0);
+    for (int n = 0; n < 64; n += 16)
+        count = vpadalq_u8(count, vcntq_u8(veorq_u8(vld1q_u8(a + n), vld1q_u8(b + n))));
+    return int(vaddvq_u16(count));
+#else
+    // scalar : 8 x 64-bit words, POPCNT
+    uint64_t wa[8], wb[8];
+    std::memcpy(wa, a, 64);
+    std::memcpy(wb, b, 64);
+    return __builtin_popcountll(wa[0] ^ wb[0]) + __builtin_popcountll(wa[1] ^ wb[1])
+         + __builtin_popcountll(wa[2] ^ wb[2]) + __builtin_popcountll(wa[3] ^ wb[3])
+         + __builtin_popcountll(wa[4] ^ wb[4]) + __builtin_popcountll(wa[5] ^ wb[5])
+         + __builtin_popcountll(wa[6] ^ wb[6]) + __builtin_popcountll(wa[7] ^ wb[7]);
+#endif
+}
+
+///////////////////////////////////////////////////////////
+//// Brute-force matcher
+///////////////////////////////////////////////////////////
+
+    // same results as cv::BFMatcher(NORM_HAMMING) + knnMatch(k=2) + Lowe's ratio test, without :
+    //   - creating a matcher and a vector of vectors of DMatch for each pair of images
+    //   - computing the whole distance matrix when the answer is already known
+
+bool DescriptorsMatcher::Nearest2(const uchar *queryRow, const cv::Mat &train, const float &ratio, int &trainIdx, int &distance) // 2 nearest neighbours of one descriptor, returns true if it passes the ratio test
+{
+    int best1 = INT_MAX; // nearest
+    int best2 = INT_MAX; // 2nd nearest
+    int idx1 = -1;
+
+    if (train.cols == 64) { // packed 512-bit descriptors : SIMD kernel
+        for (int t = 0; t < train.rows; t++) {
+            const int d = HammingDistance512(queryRow, train.ptr<uchar>(t));
+            if (d < best1) {
+                best2 = best1;
+                best1 = d;
+                idx1 = t;
+            }
+            else if (d < best2)
+                best2 = d;
+        }
+    }
+    else { // any other size
+        for (int t = 0; t < train.rows; t++) {
+            const int d = HammingDistance(queryRow, train.ptr<uchar>(t), train.cols);
+            if (d < best1) {
+                best2 = best1;
+                best1 = d;
+                idx1 = t;
+            }
+            else if (d < best2)
+                best2 = d;
+        }
+    }
+
+    trainIdx = idx1;
+    distance = best1;
+
+    return float(best1) < ratio * float(best2); // Lowe's ratio test
+}
+
+int DescriptorsMatcher::CountGoodMatches(const cv::Mat &query, const cv::Mat &train, const float &ratio, const int &stopAt, const int &minNeeded) // count good matches
+    // stopAt    : stop as soon as this number of good matches is found (-1 = never) -> the result is a lower bound
+    // minNeeded : stop as soon as this number of good matches can't be reached anymore -> the result is an upper bound of what was found so far
+    // "complete" tells if all descriptors were tested
+{
+    complete = true;
+
+    if ((query.empty()) or (train.rows < 2) or (query.type() != CV_8U) or (train.type() != CV_8U) or (query.cols != train.cols)) // the ratio test needs 2 neighbours
+        return 0;
+
+    int good = 0;
+    for (int q = 0; q < query.rows; q++) {
+        if ((stopAt >= 0) and (good >= stopAt)) { // enough good matches found
+            complete = false;
+            return good;
+        }
+        if (good + query.rows - q < minNeeded) { // even if all remaining descriptors match, the threshold is not reachable
+            complete = false;
+            return good;
+        }
+
+        int trainIdx, distance;
+        if (Nearest2(query.ptr<uchar>(q), train, ratio, trainIdx, distance))
+            good++;
+    }
+
+    return good;
+}
+
+const std::vector<cv::DMatch>& DescriptorsMatcher::GoodMatches(const cv::Mat &query, const cv::Mat &train, const float &ratio, const int &minNeeded) // get all good matches
+    // the result is valid until the next call from the same thread
+{
+    complete = true;
+    goodMatches.clear(); // capacity is kept between calls
+
+    if ((query.empty()) or (train.rows < 2) or (query.type() != CV_8U) or (train.type() != CV_8U) or (query.cols != train.cols))
+        return goodMatches;
+
+    for (int q = 0; q < query.rows; q++) {
+        if (int(goodMatches.size()) + query.rows - q < minNeeded) { // can't reach the minimum : no need to go further
+            complete = false;
+            goodMatches.clear();
+            return goodMatches;
+        }
+
+        int trainIdx, distance;
+        if (Nearest2(query.ptr<uchar>(q), train, ratio, trainIdx, distance))
+            goodMatches.emplace_back(q, trainIdx, float(distance)); // same DMatch as knnMatch would give
+    }
+
+    return goodMatches;
+}
+
+DescriptorsMatcher& ThreadDescriptorsMatcher() // matcher instance of the calling thread
+{
+    thread_local DescriptorsMatcher matcher; // one per OpenMP thread, created once
+    return matcher;
+}
+
+///////////////////////////////////////////////////////////
+//// One-vs-many : LSH index
+///////////////////////////////////////////////////////////
+
+    // approximate : use it to get candidates, then verify them with DescriptorsMatcher
+
+DescriptorsLSHIndex::DescriptorsLSHIndex(const int &tableNumber, const int &keySize, const int &multiProbeLevel) // LSH parameters - see cv::flann::LshIndexParams
+{
+    matcher = cv::makePtr<cv::FlannBasedMatcher>(cv::makePtr<cv::flann::LshIndexParams>(tableNumber, keySize, multiProbeLevel));
+    trained = false;
+}
+
+void DescriptorsLSHIndex::Add(const int &imageId, const cv::Mat &descriptors) // add the descriptors of one image
+{
+    if ((descriptors.empty()) or (descriptors.type() != CV_8U)) // LSH only works with binary descriptors
+        return;
+
+    matcher->add(std::vector<cv::Mat>(1, descriptors));
+    imageIds.push_back(imageId);
+    trained = false;
+}
+
+void DescriptorsLSHIndex::Train() // build the index
+{
+    if (imageIds.empty())
+        return;
+
+    matcher->train();
+    trained = true;
+}
+
+void DescriptorsLSHIndex::Clear() // empty index
+{
+    matcher->clear();
+    imageIds.clear();
+    trained = false;
+}
+
+int DescriptorsLSHIndex::Size() const // number of indexed images
+{
+    return int(imageIds.size());
+}
+
+std::vector<std::pair<int, int>> DescriptorsLSHIndex::Query(const cv::Mat &descriptors, const float &ratio, const int &minGoodMatches) // get (imageId, good matches) pairs, best first
+    // each query descriptor votes once for every image having a neighbour clearly nearer than the farthest one found
+    // (a plain ratio test between the 2 nearest would reject near-duplicates, their descriptors being all nearly the same)
+{
+    std::vector<std::pair<int, int>> result;
+
+    if ((descriptors.empty()) or (imageIds.empty()))
+        return result;
+    if (!trained)
+        Train();
+
+    std::vector<std::vector<cv::DMatch>> knnMatches;
+    matcher->knnMatch(descriptors, knnMatches, 4); // 4 nearest in all images
+
+    std::map<int, int> votes; // image id -> good matches
+    std::vector<int> voted; // images already voted for by the current descriptor
+    for (size_t q = 0; q < knnMatches.size(); q++) {
+        const std::vector<cv::DMatch> &neighbours = knnMatches[q];
+        if (neighbours.size() < 2) // LSH can return less neighbours than asked
+            continue;
+
+        const float farthest = neighbours.back().distance;
+        voted.clear();
+        for (size_t n = 0; n < neighbours.size() - 1; n++) {
+            if (neighbours[n].distance >= ratio * farthest) // sorted : the next ones won't pass either
+                break;
+            const int id = imageIds[neighbours[n].imgIdx];
+            if (std::find(voted.begin(), voted.end(), id) == voted.end()) { // one vote per image
+                voted.push_back(id);
+                votes[id]++;
+            }
+        }
+    }
+
+    for (auto &vote : votes)
+        if (vote.second >= minGoodMatches)
+            result.push_back(vote);
+
+    std::sort(result.begin(), result.end(), [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.second > b.second; }); // best first
+
+    return result;
+}
@@ -0,0 +1,66 @@
+/*#-------------------------------------------------
+#
+#    Binary descriptors matching library with openCV
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.0 - 2026/10/19
+#
+#   - SIMD Hamming distance for packed binary descriptors (512-bit BEBLID)
+#   - brute-force 2-NN matcher + Lowe's ratio test with early exit
+#   - one reusable matcher per thread : no allocation per image pair
+#   - LSH index (FLANN) for one-vs-many queries
+#
+#-------------------------------------------------*/
+
+#ifndef FEATURESMATCHER_H
+#define FEATURESMATCHER_H
+
+#include "opencv2/opencv.hpp"
+
+#include <vector>
+
+
+//// Hamming distance
+int HammingDistance512(const uchar *a, const uchar *b); // Hamming distance between two packed 512-bit (64 bytes) descriptors
+int HammingDistance(const uchar *a, const uchar *b, const int &bytes); // Hamming distance between two binary descriptors of any size
+
+//// Brute-force matcher
+class DescriptorsMatcher // brute-force Hamming 2-NN matcher with Lowe's ratio test - keep one per thread, see ThreadDescriptorsMatcher()
+{
+public:
+    int CountGoodMatches(const cv::Mat &query, const cv::Mat &train, const float &ratio,
+                         const int &stopAt=-1, const int &minNeeded=0); // count good matches - stop as soon as "stopAt" is reached or when "minNeeded" can't be reached anymore
+    const std::vector<cv::DMatch>& GoodMatches(const cv::Mat &query, const cv::Mat &train, const float &ratio,
+                                               const int &minNeeded=0); // get all good matches - returns an empty list as soon as "minNeeded" can't be reached anymore
+
+    bool complete; // false if the last call stopped early : the result is then only a bound
+
+private:
+    bool Nearest2(const uchar *queryRow, const cv::Mat &train, const float &ratio, int &trainIdx, int &distance); // 2 nearest neighbours of one descriptor, returns true if it passes the ratio test
+
+    std::vector<cv::DMatch> goodMatches; // reused between calls
+};
+
+DescriptorsMatcher& ThreadDescriptorsMatcher(); // matcher instance of the calling thread
+
+//// One-vs-many
+class DescriptorsLSHIndex // FLANN LSH index over the descriptors of many images
+{
+public:
+    DescriptorsLSHIndex(const int &tableNumber=12, const int &keySize=20, const int &multiProbeLevel=2); // LSH parameters - see cv::flann::LshIndexParams
+
+    void Add(const int &imageId, const cv::Mat &descriptors); // add the descriptors of one image - call Train() once all images are added
+    void Train(); // build the index
+    void Clear(); // empty index
+    int Size() const; // number of indexed images
+    std::vector<std::pair<int, int>> Query(const cv::Mat &descriptors, const float &ratio, const int &minGoodMatches=1); // get (imageId, good matches) pairs, best first
+
+private:
+    cv::Ptr<cv::FlannBasedMatcher> matcher;
+    std::vector<int> imageIds; // FLANN image index -> caller image id
+    bool trained;
+};
+
+
+#endif // FEATURESMATCHER_H
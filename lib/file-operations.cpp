@@ -0,0 +1,682 @@
+/*#-------------------------------------------------
+#
+#        Bulk file operations library
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.1 - 2026/10/19
+#
+#   - copy, move or delete a list of files on a bounded pool of worker threads
+#   - conflicts (destination already exists) are all found before anything is done :
+#     the caller asks the user once, then runs the batch
+#   - move = rename on the same file system, copy + delete across devices
+#   - copy = copy_file_range (or sendfile) on Linux : the data stays in the kernel
+#   - progress and cancellation from the caller's thread while the workers run
+#   - v1.1 : link = replace a byte-identical duplicate by a reflink (FICLONE) or a hard link to the kept file,
+#            every link is written to a log that can undo it
+#
+#   standard C++ and POSIX only
+#
+#-------------------------------------------------*/
+
+#include "file-operations.h"
+
+#include <filesystem>
+#include <unordered_set>
+#include <algorithm>
+#include <system_error>
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <sstream>
+#include <cstring>
+
+#if defined(__linux__)
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/stat.h>
+    #include <sys/sendfile.h>
+    #include <sys/ioctl.h>
+    #include <linux/fs.h>
+#endif
+
+
+///////////////////////////////////////////////////////////
+//// Links log
+///////////////////////////////////////////////////////////
+
+    // text file, first line = header, then one line per linked duplicate, fields separated by tabs :
+    // method (reflink or hardlink) + permissions (octal) + owner + group + modification time (seconds, nanoseconds) + size + kept file + duplicate
+    // a line is written and flushed as soon as the duplicate is replaced : the log is complete even after a crash
+
+static const std::string linksLogHeader = "image-match links log v1";
+
+static std::string EscapePath(const std::string &path) // tabs and new lines can't break a log line
+{
+    std::string result;
+    result.reserve(path.size());
+    for (char c : path) {
+        if (c == '\\')
+            result += "\\\\";
+        else if (c == '\t')
+            result += "\\t";
+        else if (c == '\n')
+            result += "\\n";
+        else
+            result += c;
+    }
+
+    return result;
+}
+
+static std::string UnescapePath(const std::string &path)
+{
+    std::string result;
+    result.reserve(path.size());
+    for (size_t n = 0; n < path.size(); n++) {
+        if ((path[n] == '\\') and (n + 1 < path.size())) {
+            n++;
+            result += (path[n] == 't') ? '\t' : (path[n] == 'n') ? '\n' : path[n];
+        }
+        else
+            result += path[n];
+    }
+
+    return result;
+}
+
+///////////////////////////////////////////////////////////
+//// Batch
+///////////////////////////////////////////////////////////
+
+FileOperations::FileOperations(const int &threads)
+{
+    threadsCount = threads;
+    if (threadsCount <= 0) { // automatic
+        threadsCount = int(std::thread::hardware_concurrency());
+        if (threadsCount > 8) // more parallel requests don't make a disk faster
+            threadsCount = 8;
+        if (threadsCount < 1)
+            threadsCount = 1;
+    }
+}
+
+FileOperations::~FileOperations()
+{
+    Cancel();
+    Join();
+}
+
+void FileOperations::Clear() // remove all operations - not while running
+{
+    Join();
+    operations.clear();
+    next = 0;
+    done = 0;
+    cancelled = false;
+}
+
+void FileOperations::Add(const int &id, const std::string &source, const std::string &destination) // add a file to the batch - no destination for delete
+{
+    struct_file_operation operation;
+    operation.id = id;
+    operation.source = source;
+    operation.destination = destination;
+    operations.push_back(operation);
+}
+
+int FileOperations::Count() const
+{
+    return int(operations.size());
+}
+
+struct_file_operation &FileOperations::Operation(const int &n)
+{
+    return operations[n];
+}
+
+const struct_file_operation &FileOperations::Operation(const int &n) const
+{
+    return operations[n];
+}
+
+int FileOperations::FindConflicts() // check all destinations in parallel : number of operations that would replace a file
+{
+    // two files of the batch with the same destination : only the first one can be written
+    std::unordered_set<std::string> destinations;
+    destinations.reserve(operations.size());
+    for (int n = 0; n < int(operations.size()); n++)
+        if ((operations[n].destination != "") and (!destinations.insert(operations[n].destination).second)) // already used ?
+            operations[n].sameDestination = true;
+
+    // existing destinations - one stat per file, on the workers : much faster on network drives
+    std::atomic<int> index {0};
+    auto check = [this, &index]() {
+        int n;
+        while ((n = index++) < int(operations.size())) {
+            struct_file_operation &operation = operations[n];
+            if (operation.destination == "")
+                continue;
+            std::error_code error;
+            operation.exists = std::filesystem::exists(operation.destination, error);
+            if ((operation.exists) and (std::filesystem::equivalent(operation.source, operation.destination, error))) { // moving or copying a file to itself
+                operation.exists = false;
+                operation.result = file_result_skipped;
+                operation.error = "source and destination are the same file";
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    const int count = std::min(threadsCount, int(operations.size()));
+    for (int t = 1; t < count; t++)
+        threads.emplace_back(check);
+    check(); // this thread works too
+    for (auto &thread : threads)
+        thread.join();
+
+    int conflicts = 0;
+    for (int n = 0; n < int(operations.size()); n++)
+        if ((operations[n].exists) and (!operations[n].sameDestination) and (operations[n].result == file_result_waiting))
+            conflicts++;
+
+    return conflicts;
+}
+
+void FileOperations::SetReplace(const bool &replace) // replace existing destinations or skip them, for all conflicts
+{
+    for (int n = 0; n < int(operations.size()); n++)
+        operations[n].replace = replace;
+}
+
+void FileOperations::SetDeleteFunction(const std::function<bool(const std::string &path)> &function) // how to delete a file, for example to the trash bin - default = unlink
+{
+    deleteFunction = function;
+}
+
+bool FileOperations::SetLinksLog(const std::string &filename) // link : each replaced file is appended to this log, as soon as it is done
+{
+    linksLog.open(filename, std::ios::out | std::ios::app);
+    if (!linksLog.is_open())
+        return false;
+    if (linksLog.tellp() == 0) // new log
+        linksLog << linksLogHeader << "\n";
+
+    return bool(linksLog);
+}
+
+bool FileOperations::LoadLinksLog(const std::string &filename) // unlink : add the operations that undo a links log
+{
+    std::ifstream in(filename);
+    std::string line;
+    if ((!std::getline(in, line)) or (line != linksLogHeader)) // not a links log
+        return false;
+
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, '\t'))
+            fields.push_back(field);
+        if (fields.size() != 9) // incomplete line : the log was cut while writing it
+            continue;
+
+        struct_file_operation operation;
+        operation.source = UnescapePath(fields[7]);
+        operation.destination = UnescapePath(fields[8]);
+        operation.link = (fields[0] == "reflink") ? file_link_reflink : file_link_hardlink;
+        try {
+            operation.original.mode = std::stoul(fields[1], nullptr, 8);
+            operation.original.owner = std::stoi(fields[2]);
+            operation.original.group = std::stoi(fields[3]);
+            operation.original.modifiedSeconds = std::stoll(fields[4]);
+            operation.original.modifiedNanoseconds = std::stoll(fields[5]);
+            operation.original.size = std::stoll(fields[6]);
+        }
+        catch (...) { // damaged line
+            continue;
+        }
+        operations.push_back(operation);
+    }
+
+    return true;
+}
+
+void FileOperations::Start(const fileOperationType &operationType) // run the batch on the workers, returns immediately
+{
+    Join();
+    type = operationType;
+    next = 0;
+    done = 0;
+    cancelled = false;
+
+    const int count = std::min(threadsCount, int(operations.size()));
+    running = count;
+    for (int t = 0; t < count; t++)
+        workers.emplace_back(&FileOperations::Worker, this);
+}
+
+bool FileOperations::Wait(const int &milliseconds) // wait for the end of the batch : true when finished
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!finished.wait_for(lock, std::chrono::milliseconds(milliseconds), [this]() { return running == 0; }))
+            return false;
+    }
+    Join();
+
+    return true;
+}
+
+void FileOperations::Cancel() // operations not started yet are cancelled, running ones finish
+{
+    cancelled = true;
+}
+
+int FileOperations::Done() const // number of processed operations, for progress
+{
+    return done;
+}
+
+bool FileOperations::IsRunning() const
+{
+    return !workers.empty();
+}
+
+void FileOperations::Worker() // take the next operation until the end of the batch
+{
+    int n;
+    while ((n = next++) < int(operations.size())) {
+        if (cancelled)
+            operations[n].result = file_result_cancelled;
+        else {
+            Process(operations[n]);
+            if ((type == file_operation_link) and (operations[n].result == file_result_done))
+                WriteLog(operations[n]);
+        }
+        done++;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    running--;
+    finished.notify_all();
+}
+
+void FileOperations::Process(struct_file_operation &operation) // one operation
+{
+    if (operation.result != file_result_waiting) // already decided by FindConflicts()
+        return;
+    if (operation.sameDestination) {
+        operation.result = file_result_skipped;
+        operation.error = "another file has the same name";
+        return;
+    }
+    if ((operation.exists) and (!operation.replace)) { // user chose to keep the existing file
+        operation.result = file_result_skipped;
+        return;
+    }
+
+    bool ok = false;
+    switch (type) {
+        case file_operation_copy:   ok = CopyFile(operation.source, operation.destination, operation.replace, operation.error);break;
+        case file_operation_move:   ok = MoveFile(operation.source, operation.destination, operation.replace, operation.error);break;
+        case file_operation_link:   ok = LinkFile(operation.source, operation.destination, operation.link, operation.original, operation.error);break;
+        case file_operation_unlink: ok = UnlinkFile(operation.source, operation.destination, operation.link, operation.original, operation.error);break;
+        case file_operation_delete: {
+            if (deleteFunction)
+                ok = deleteFunction(operation.source);
+            else
+                ok = (std::remove(operation.source.c_str()) == 0);
+            if (!ok)
+                operation.error = "could not be deleted";
+            break;
+        }
+    }
+
+    operation.result = ok ? file_result_done : file_result_error;
+}
+
+void FileOperations::Join() // wait for the worker threads
+{
+    for (auto &worker : workers)
+        worker.join();
+    workers.clear();
+}
+
+void FileOperations::WriteLog(const struct_file_operation &operation) // one line in the links log
+{
+    std::ostringstream line;
+    line << ((operation.link == file_link_reflink) ? "reflink" : "hardlink") << "\t"
+         << std::oct << operation.original.mode << std::dec << "\t"
+         << operation.original.owner << "\t" << operation.original.group << "\t"
+         << operation.original.modifiedSeconds << "\t" << operation.original.modifiedNanoseconds << "\t"
+         << operation.original.size << "\t"
+         << EscapePath(operation.source) << "\t" << EscapePath(operation.destination) << "\n";
+
+    std::lock_guard<std::mutex> lock(logMutex);
+    if (linksLog.is_open()) {
+        linksLog << line.str();
+        linksLog.flush(); // now : the log must know this link even if the program stops
+    }
+}
+
+///////////////////////////////////////////////////////////
+//// Single file
+///////////////////////////////////////////////////////////
+
+static std::string ErrorMessage(const int &code) // readable system error - thread-safe, unlike strerror
+{
+    return std::error_code(code, std::generic_category()).message();
+}
+
+bool FileOperations::CopyFile(const std::string &source, const std::string &destination, const bool &replace, std::string &error, const bool &shareBlocks) // copy the data, permissions and modification time of a file
+{
+#if defined(__linux__)
+    const int in = open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        error = ErrorMessage(errno);
+        return false;
+    }
+    struct stat sourceStat;
+    if (fstat(in, &sourceStat) != 0) {
+        error = ErrorMessage(errno);
+        close(in);
+        return false;
+    }
+    struct stat destinationStat;
+    if ((stat(destination.c_str(), &destinationStat) == 0)
+            and (destinationStat.st_dev == sourceStat.st_dev) and (destinationStat.st_ino == sourceStat.st_ino)) { // truncating the destination would destroy the source
+        error = "source and destination are the same file";
+        close(in);
+        return false;
+    }
+
+    const int out = open(destination.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (replace ? O_TRUNC : O_EXCL), sourceStat.st_mode & 0777);
+    if (out < 0) {
+        error = ErrorMessage(errno);
+        close(in);
+        return false;
+    }
+
+    // copy the data in the kernel : copy_file_range can even share blocks (reflink) on some file systems,
+    // sendfile for older kernels or different file systems, read/write as a last resort
+    // -> !shareBlocks : starts with sendfile, the data is really written
+    int method = shareBlocks ? 0 : 1; // 0 = copy_file_range, 1 = sendfile, 2 = read/write
+    long long remaining = sourceStat.st_size;
+    long long copied = 0;
+    bool ok = true;
+    std::vector<char> buffer;
+    while (remaining > 0) {
+        ssize_t count = -1;
+        if (method == 0) {
+            count = copy_file_range(in, nullptr, out, nullptr, size_t(remaining), 0);
+            if ((count < 0) and (copied == 0) and ((errno == EXDEV) or (errno == EINVAL) or (errno == ENOSYS) or (errno == EOPNOTSUPP))) { // not supported here
+                method = 1;
+                continue;
+            }
+        }
+        else if (method == 1) {
+            count = sendfile(out, in, nullptr, size_t(remaining));
+            if ((count < 0) and (copied == 0) and ((errno == EINVAL) or (errno == ENOSYS))) {
+                method = 2;
+                continue;
+            }
+        }
+        else {
+            buffer.resize(1 << 20);
+            count = read(in, buffer.data(), buffer.size());
+            for (ssize_t written = 0; (count > 0) and (written < count); ) {
+                const ssize_t w = write(out, buffer.data() + written, size_t(count - written));
+                if (w < 0) {
+                    count = -1;
+                    break;
+                }
+                written += w;
+            }
+        }
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            error = ErrorMessage(errno);
+            ok = false;
+            break;
+        }
+        if (count == 0) // the source got shorter since fstat
+            break;
+        remaining -= count;
+        copied += count;
+    }
+    if ((ok) and (copied != sourceStat.st_size)) { // truncated copy : a move would delete the only complete file
+        error = "the source file changed during the copy";
+        ok = false;
+    }
+
+    if (ok) { // same permissions and dates as the original
+        fchmod(out, sourceStat.st_mode & 07777);
+        const struct timespec times[2] = {sourceStat.st_atim, sourceStat.st_mtim};
+        futimens(out, times);
+    }
+    if ((close(out) != 0) and (ok)) { // delayed write error (network drive, disk full)
+        error = ErrorMessage(errno);
+        ok = false;
+    }
+    close(in);
+
+    if (!ok) // don't leave a partial file
+        unlink(destination.c_str());
+
+    return ok;
+#else
+    std::error_code code;
+    std::filesystem::copy_file(source, destination, replace ? std::filesystem::copy_options::overwrite_existing : std::filesystem::copy_options::none, code);
+    if (code) {
+        error = code.message();
+        return false;
+    }
+    std::filesystem::last_write_time(destination, std::filesystem::last_write_time(source, code), code);
+
+    return true;
+#endif
+}
+
+bool FileOperations::MoveFile(const std::string &source, const std::string &destination, const bool &replace, std::string &error) // rename, or copy + delete across devices
+{
+    int result;
+#if defined(__linux__)
+    if (replace)
+        result = rename(source.c_str(), destination.c_str());
+    else {
+        result = renameat2(AT_FDCWD, source.c_str(), AT_FDCWD, destination.c_str(), RENAME_NOREPLACE); // never replace a file created since FindConflicts()
+        if ((result != 0) and (errno == EINVAL)) { // file system without RENAME_NOREPLACE
+            std::error_code code;
+            if (std::filesystem::exists(destination, code)) {
+                error = ErrorMessage(EEXIST);
+                return false;
+            }
+            result = rename(source.c_str(), destination.c_str());
+        }
+    }
+#else
+    std::error_code code;
+    if ((!replace) and (std::filesystem::exists(destination, code))) {
+        error = ErrorMessage(EEXIST);
+        return false;
+    }
+    result = std::rename(source.c_str(), destination.c_str());
+#endif
+    if (result == 0) // same file system : nothing to copy
+        return true;
+    if (errno != EXDEV) {
+        error = ErrorMessage(errno);
+        return false;
+    }
+
+    // another device : copy then delete the original
+    if (!CopyFile(source, destination, replace, error))
+        return false;
+    if (std::remove(source.c_str()) != 0) { // the original must go, or this is not a move
+        error = ErrorMessage(errno);
+        std::remove(destination.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+int FileOperations::CompareFiles(const std::string &file1, const std::string &file2, std::string &error) // 1 = same bytes, 0 = different, 2 = already the same file, -1 = error
+{
+    std::error_code code;
+    if (std::filesystem::equivalent(file1, file2, code)) // hard links to the same data
+        return 2;
+    const std::uintmax_t size1 = std::filesystem::file_size(file1, code);
+    if (code) {
+        error = code.message();
+        return -1;
+    }
+    const std::uintmax_t size2 = std::filesystem::file_size(file2, code);
+    if (code) {
+        error = code.message();
+        return -1;
+    }
+    if (size1 != size2)
+        return 0;
+
+    // streaming comparison : images can be huge, only two small buffers in memory
+    std::ifstream in1(file1, std::ios::binary);
+    std::ifstream in2(file2, std::ios::binary);
+    if ((!in1.is_open()) or (!in2.is_open())) {
+        error = "could not be read";
+        return -1;
+    }
+    const std::size_t bufferSize = 1 << 18;
+    std::vector<char> buffer1(bufferSize), buffer2(bufferSize);
+    std::uintmax_t remaining = size1;
+    while (remaining > 0) {
+        const std::size_t count = std::size_t(std::min(remaining, std::uintmax_t(bufferSize)));
+        if ((!in1.read(buffer1.data(), count)) or (!in2.read(buffer2.data(), count))) {
+            error = "could not be read";
+            return -1;
+        }
+        if (std::memcmp(buffer1.data(), buffer2.data(), count) != 0)
+            return 0;
+        remaining -= count;
+    }
+
+    return 1;
+}
+
+bool FileOperations::LinkFile(const std::string &kept, const std::string &duplicate, int &method, struct_file_stamp &original, std::string &error) // replace a duplicate with a reflink or a hard link to the kept file
+    // the new file is made next to the duplicate, then renamed over it : the duplicate is never missing, even after a crash
+{
+#if defined(__linux__)
+    const int compare = CompareFiles(kept, duplicate, error); // never link files that are not exactly the same
+    if (compare == 2) {
+        error = "already linked";
+        return false;
+    }
+    if (compare != 1) {
+        if (compare == 0)
+            error = "the files are different";
+        return false;
+    }
+
+    struct stat duplicateStat;
+    if (lstat(duplicate.c_str(), &duplicateStat) != 0) {
+        error = ErrorMessage(errno);
+        return false;
+    }
+    original.mode = duplicateStat.st_mode & 07777;
+    original.owner = int(duplicateStat.st_uid);
+    original.group = int(duplicateStat.st_gid);
+    original.modifiedSeconds = duplicateStat.st_mtim.tv_sec;
+    original.modifiedNanoseconds = duplicateStat.st_mtim.tv_nsec;
+    original.size = duplicateStat.st_size;
+
+    const std::string temporary = duplicate + ".image-match-link";
+    unlink(temporary.c_str()); // left by a crash
+
+    // reflink first : the duplicate keeps its own metadata and stays independent, only the blocks are shared (btrfs, XFS...)
+    method = file_link_none;
+    const int in = open(kept.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        error = ErrorMessage(errno);
+        return false;
+    }
+    const int out = open(temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, original.mode);
+    if (out >= 0) {
+        if (ioctl(out, FICLONE, in) == 0) {
+            fchmod(out, original.mode);
+            if (fchown(out, original.owner, original.group) != 0) {} // only root can give a file to another user
+            const struct timespec times[2] = {duplicateStat.st_atim, duplicateStat.st_mtim};
+            futimens(out, times);
+            method = file_link_reflink;
+        }
+        close(out);
+        if (method == file_link_none)
+            unlink(temporary.c_str());
+    }
+    close(in);
+
+    // hard link : works on any file system, but the duplicate now shares the permissions and dates of the kept file
+    if (method == file_link_none) {
+        if (link(kept.c_str(), temporary.c_str()) != 0) {
+            error = (errno == EXDEV) ? "not on the same file system as the kept file" : ErrorMessage(errno);
+            return false;
+        }
+        method = file_link_hardlink;
+    }
+
+    struct stat checkStat; // the duplicate changed while it was compared ?
+    if ((lstat(duplicate.c_str(), &checkStat) != 0) or (checkStat.st_size != duplicateStat.st_size)
+            or (checkStat.st_mtim.tv_sec != duplicateStat.st_mtim.tv_sec) or (checkStat.st_mtim.tv_nsec != duplicateStat.st_mtim.tv_nsec)) {
+        unlink(temporary.c_str());
+        error = "the file changed during the comparison";
+        return false;
+    }
+    if (rename(temporary.c_str(), duplicate.c_str()) != 0) {
+        error = ErrorMessage(errno);
+        unlink(temporary.c_str());
+        return false;
+    }
+
+    return true;
+#else
+    error = "links are only available on Linux";
+    return false;
+#endif
+}
+
+bool FileOperations::UnlinkFile(const std::string &kept, const std::string &duplicate, const int &method, const struct_file_stamp &original, std::string &error) // give back its own copy of the data to a linked duplicate
+{
+#if defined(__linux__)
+    std::error_code code;
+    if (std::filesystem::exists(duplicate, code)) { // only restore a file that is still what the link made of it
+        const bool stillLinked = (method == file_link_hardlink) ? std::filesystem::equivalent(kept, duplicate, code)
+                                                                : (CompareFiles(kept, duplicate, error) == 1);
+        if (!stillLinked) {
+            error = "the file changed since it was linked";
+            return false;
+        }
+    }
+
+    const std::string temporary = duplicate + ".image-match-link";
+    unlink(temporary.c_str());
+    if (!CopyFile(kept, temporary, false, error, false)) // a real copy of the data, not a reflink : the files are independent again
+        return false;
+
+    chmod(temporary.c_str(), original.mode);
+    if (lchown(temporary.c_str(), original.owner, original.group) != 0) {} // only root can give a file to another user
+    const struct timespec times[2] = {{original.modifiedSeconds, original.modifiedNanoseconds}, {original.modifiedSeconds, original.modifiedNanoseconds}};
+    utimensat(AT_FDCWD, temporary.c_str(), times, 0);
+
+    if (rename(temporary.c_str(), duplicate.c_str()) != 0) {
+        error = ErrorMessage(errno);
+        unlink(temporary.c_str());
+        return false;
+    }
+
+    return true;
+#else
+    error = "links are only available on Linux";
+    return false;
+#endif
+}
@@ -0,0 +1,121 @@
+/*#-------------------------------------------------
+#
+#        Bulk file operations library
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.1 - 2026/10/19
+#
+#   - copy, move or delete a list of files on a bounded pool of worker threads
+#   - conflicts (destination already exists) are all found before anything is done :
+#     the caller asks the user once, then runs the batch
+#   - move = rename on the same file system, copy + delete across devices
+#   - copy = copy_file_range (or sendfile) on Linux : the data stays in the kernel
+#   - progress and cancellation from the caller's thread while the workers run
+#   - v1.1 : link = replace a byte-identical duplicate by a reflink (FICLONE) or a hard link to the kept file,
+#            every link is written to a log that can undo it
+#
+#   standard C++ and POSIX only
+#
+# Example :
+#   FileOperations operations;
+#   operations.Add(image, source, destination);
+#   int conflicts = operations.FindConflicts(); // ask the user, then SetReplace()
+#   operations.Start(file_operation_move);
+#   while (!operations.Wait(100)) { ... operations.Done() ... operations.Cancel() ... }
+#
+#-------------------------------------------------*/
+
+#ifndef FILEOPERATIONS_H
+#define FILEOPERATIONS_H
+
+#include <vector>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <fstream>
+
+
+enum fileOperationType {file_operation_copy, file_operation_move, file_operation_delete, file_operation_link, file_operation_unlink}; // what to do with the files
+enum fileOperationResult {file_result_waiting, file_result_done, file_result_skipped, file_result_error, file_result_cancelled}; // what was done to a file
+enum fileLinkMethod {file_link_none, file_link_reflink, file_link_hardlink}; // how a duplicate was replaced
+
+struct struct_file_stamp { // what a replaced file looked like, to restore it
+    unsigned int mode = 0; // permissions
+    int owner = -1; // user and group ids
+    int group = -1;
+    long long modifiedSeconds = 0; // last modification time
+    long long modifiedNanoseconds = 0;
+    long long size = 0; // bytes
+};
+
+struct struct_file_operation { // one file to process
+    int id = -1; // caller's reference, for example an image index
+    std::string source; // file to copy, move or delete
+    std::string destination; // full path of the new file - empty for delete
+    bool exists = false; // destination already exists : set by FindConflicts()
+    bool sameDestination = false; // another operation of the batch already writes to this destination : never replaced
+    bool replace = false; // replace an existing destination ? - if false, the file is skipped
+    int result = file_result_waiting; // see fileOperationResult
+    std::string error; // why it failed
+    int link = file_link_none; // link and unlink : how destination (the duplicate) shares the data of source (the kept file)
+    struct_file_stamp original; // link and unlink : the duplicate before it was linked
+};
+
+class FileOperations // a batch of file operations run in background
+{
+public:
+    explicit FileOperations(const int &threads = 0); // 0 = number of cores, but no more than 8 : disks don't like too many parallel requests
+    ~FileOperations(); // running operations are cancelled
+
+    void Clear(); // remove all operations - not while running
+    void Add(const int &id, const std::string &source, const std::string &destination = ""); // add a file to the batch - no destination for delete
+    int Count() const;
+    struct_file_operation &Operation(const int &n);
+    const struct_file_operation &Operation(const int &n) const;
+
+    int FindConflicts(); // check all destinations in parallel : number of operations that would replace a file
+    void SetReplace(const bool &replace); // replace existing destinations or skip them, for all conflicts
+    void SetDeleteFunction(const std::function<bool(const std::string &path)> &function); // how to delete a file, for example to the trash bin - default = unlink
+    bool SetLinksLog(const std::string &filename); // link : each replaced file is appended to this log, as soon as it is done
+    bool LoadLinksLog(const std::string &filename); // unlink : add the operations that undo a links log
+
+    void Start(const fileOperationType &type); // run the batch on the workers, returns immediately
+    bool Wait(const int &milliseconds); // wait for the end of the batch : true when finished
+    void Cancel(); // operations not started yet are cancelled, running ones finish
+    int Done() const; // number of processed operations, for progress
+    bool IsRunning() const;
+
+    static bool CopyFile(const std::string &source, const std::string &destination, const bool &replace, std::string &error,
+                         const bool &shareBlocks=true); // copy the data, permissions and modification time of a file - shareBlocks : the copy can be a reflink
+    static bool MoveFile(const std::string &source, const std::string &destination, const bool &replace, std::string &error); // rename, or copy + delete across devices
+    static int CompareFiles(const std::string &file1, const std::string &file2, std::string &error); // 1 = same bytes, 0 = different, 2 = already the same file, -1 = error
+    static bool LinkFile(const std::string &kept, const std::string &duplicate, int &method, struct_file_stamp &original, std::string &error); // replace a duplicate with a reflink or a hard link to the kept file
+    static bool UnlinkFile(const std::string &kept, const std::string &duplicate, const int &method, const struct_file_stamp &original, std::string &error); // give back its own copy of the data to a linked duplicate
+
+private:
+    void Worker(); // take the next operation until the end of the batch
+    void Process(struct_file_operation &operation); // one operation
+    void Join(); // wait for the worker threads
+    void WriteLog(const struct_file_operation &operation); // one line in the links log
+
+    int threadsCount;
+    std::vector<struct_file_operation> operations;
+    std::vector<std::thread> workers;
+    std::function<bool(const std::string &path)> deleteFunction;
+    fileOperationType type = file_operation_copy;
+    std::atomic<int> next {0}; // next operation to take
+    std::atomic<int> done {0}; // processed operations
+    std::atomic<bool> cancelled {false};
+    int running = 0; // workers not finished yet
+    std::mutex mutex; // for running
+    std::condition_variable finished;
+    std::ofstream linksLog;
+    std::mutex logMutex; // one log for all workers
+};
+
+
+#endif // FILEOPERATIONS_H
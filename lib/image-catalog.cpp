@@ -0,0 +1,491 @@
+/*#-------------------------------------------------
+#
+#        Image signatures catalog library
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.3 - 2026/10/19
+#
+#   - signatures of image files : checksum of pixels (MD5), pHash, dHash, image size
+#   - kept on disk in one packed file : records appended one after the other, compacted when
+#     more than half of the file is old records - an image file is known by its path, size and modification time
+#   - all signatures in memory, with indexes : exact checksums, and multi-index hashing for pHash and dHash
+#     -> matching a new image costs about the same with 1000 or 1000000 images in the catalog
+#   - v1.1 : ranked query - one result per catalog image with the score of each algorithm
+#   - v1.2 : batch of ranked queries, for a server answering several clients at once
+#   - v1.3 : working images from the per-thread preprocessing pyramid
+#
+#   uses OpenCV Contrib (img_hash)
+#
+#-------------------------------------------------*/
+
+#include "image-catalog.h"
+#include "image-files.h"
+#include "image-compare.h"
+#include "image-pyramid.h"
+#include "thumbnail-cache.h"
+#include "string-utils.h"
+
+#include <filesystem>
+#include <cstring>
+#include <algorithm>
+
+
+///////////////////////////////////////////////////////////
+//// Signatures
+///////////////////////////////////////////////////////////
+
+static uint64_t HashToUint64(const cv::Mat &hash) // 8-byte CV_8U hash to integer
+{
+    uint64_t value = 0;
+    if ((!hash.empty()) and (hash.total() * hash.elemSize() >= 8))
+        std::memcpy(&value, hash.ptr(), 8);
+
+    return value;
+}
+
+bool ComputeImageSignature(const std::string &path, const int &reducedSize, struct_image_signature &signature) // read an image file and compute its signature - false if it can't be read (width = 0)
+{
+    signature = struct_image_signature();
+    signature.path = path;
+    if (!ThumbnailCache::FileStamp(path, signature.fileSize, signature.modified)) // file doesn't exist
+        return false;
+
+    std::string type, loadwith;
+    ImageFileType(stringutils::GetFilenameExtension(path), type, loadwith);
+    cv::Mat image = LoadImageFile(path, loadwith);
+    if (image.empty()) // can't be read : kept in catalog with width = 0, not read again until the file changes
+        return false;
+
+    signature.width = image.cols;
+    signature.height = image.rows;
+
+    // same steps as the images list in the GUI : checksum on the original, hashes on the gray working image
+    cv::Mat checksum = ImageHash(image, img_similarity_checksum);
+    if (!checksum.empty())
+        std::memcpy(signature.checksum.data(), checksum.ptr(), std::min(size_t(16), checksum.total() * checksum.elemSize()));
+
+    ImagePyramid &pyramid = ImagePyramid::ForThread(); // intermediate images in the arena of this thread
+    pyramid.Build(image, reducedSize);
+    signature.pHash = HashToUint64(ImageHash(pyramid.Gray(), img_similarity_pHash));
+    signature.dHash = HashToUint64(ImageHash(pyramid.Gray(), img_similarity_dHash));
+
+    return true;
+}
+
+int SimilarityToDistance(const float &similarity) // maximum different bits of 64-bit hashes for a % of similarity
+{
+    return std::max(0, int(64.0f - similarity * 0.64f)); // inverse of ImageHashCompare() for 64-bit hashes
+}
+
+std::string CatalogPath(const std::string &path) // path of an image file like in the catalog : canonical (absolute, symbolic links resolved)
+    // catalog folders are canonical, so are their files - a file that doesn't exist can't be resolved : absolute and normalized only
+{
+    std::error_code error;
+    const std::filesystem::path canonical = std::filesystem::canonical(path, error);
+    if (!error)
+        return canonical.string();
+
+    const std::filesystem::path absolute = std::filesystem::absolute(path, error);
+    if (error)
+        return path;
+
+    return absolute.lexically_normal().string();
+}
+
+static bool OrientationsMatch(const struct_image_signature &a, const struct_image_signature &b) // same rule as the GUI : hashes don't work on images oriented differently
+{
+    if ((a.height == 0) or (b.height == 0))
+        return false;
+    const bool portraitA = float(a.width) / float(a.height) <= 1.05f; // some algorithms use a heavy resizing of images so 5% of difference is not a difference
+    const bool portraitB = float(b.width) / float(b.height) <= 1.05f;
+
+    return portraitA == portraitB;
+}
+
+///////////////////////////////////////////////////////////
+//// File format
+///////////////////////////////////////////////////////////
+
+    // header : magic "IMSC" + version (uint32)
+    // record : removed (uint8) + pathLength (uint32) + fileSize (int64) + modified (int64) + width, height (int32) + checksum (16 bytes) + pHash, dHash (uint64) + path
+    // all numbers as written by the CPU : the catalog is local to this computer
+    // a record cut by a crash at the end of the file is removed when the catalog is opened
+
+static const char catalogMagic[4] = {'I', 'M', 'S', 'C'};
+static const uint32_t catalogVersion = 1;
+static const long long catalogHeaderSize = 8;
+static const long long recordHeaderSize = 1 + 4 + 8 + 8 + 4 + 4 + 16 + 8 + 8;
+
+///////////////////////////////////////////////////////////
+//// Catalog
+///////////////////////////////////////////////////////////
+
+ImageCatalog::~ImageCatalog()
+{
+    Close();
+}
+
+bool ImageCatalog::Open(const std::string &name) // load an existing catalog file, or create it - false if the file can't be used
+{
+    Close();
+
+    filename = name;
+    signatures.clear();
+    valid.clear();
+    ids.clear();
+    checksums.clear();
+    pHashIndex.Clear();
+    dHashIndex.Clear();
+    count = 0;
+    liveBytes = 0;
+
+    bool isCatalog = false;
+    long long end = catalogHeaderSize; // end of the last complete record
+    std::ifstream in(filename, std::ios::binary);
+    if (in.is_open()) {
+        char magic[4];
+        uint32_t version = 0;
+        if ((in.read(magic, 4)) and (in.read(reinterpret_cast<char*>(&version), 4))
+                and (std::memcmp(magic, catalogMagic, 4) == 0) and (version == catalogVersion)) {
+            isCatalog = true;
+            char buffer[recordHeaderSize];
+            while (in.read(buffer, recordHeaderSize)) {
+                struct_image_signature signature;
+                uint8_t removed;
+                uint32_t pathLength;
+                std::memcpy(&removed, buffer, 1);
+                std::memcpy(&pathLength, buffer + 1, 4);
+                std::memcpy(&signature.fileSize, buffer + 5, 8);
+                std::memcpy(&signature.modified, buffer + 13, 8);
+                std::memcpy(&signature.width, buffer + 21, 4);
+                std::memcpy(&signature.height, buffer + 25, 4);
+                std::memcpy(signature.checksum.data(), buffer + 29, 16);
+                std::memcpy(&signature.pHash, buffer + 45, 8);
+                std::memcpy(&signature.dHash, buffer + 53, 8);
+                signature.path.resize(pathLength);
+                if (!in.read(&signature.path[0], pathLength)) // cut record
+                    break;
+                end += recordHeaderSize + pathLength;
+
+                if (removed)
+                    Remove(signature.path); // file is not open yet : nothing is written
+                else
+                    Put(signature);
+            }
+        }
+        in.close();
+    }
+
+    std::error_code error;
+    if (isCatalog) { // keep the records
+        if (std::filesystem::file_size(filename, error) > std::uintmax_t(end)) // a cut record : remove it
+            std::filesystem::resize_file(filename, end, error);
+        file.open(filename, std::ios::binary | std::ios::out | std::ios::app);
+    }
+    else { // new file - or unknown format : start again
+        end = catalogHeaderSize;
+        file.open(filename, std::ios::binary | std::ios::out | std::ios::trunc);
+        if (file.is_open()) {
+            file.write(catalogMagic, 4);
+            file.write(reinterpret_cast<const char*>(&catalogVersion), 4);
+        }
+    }
+    fileEnd = end;
+
+    return file.is_open();
+}
+
+void ImageCatalog::Close() // flush and close the file, compact it if needed
+{
+    if (!file.is_open())
+        return;
+
+    file.flush();
+    if (fileEnd - catalogHeaderSize > 2 * liveBytes) // more than half of the file is old records
+        Compact();
+    file.close();
+}
+
+bool ImageCatalog::IsOpen() const
+{
+    return file.is_open();
+}
+
+void ImageCatalog::Flush() // write buffered records to disk
+{
+    if (file.is_open())
+        file.flush();
+}
+
+int ImageCatalog::Find(const std::string &path) const // id of an image file, -1 if not in catalog
+{
+    auto found = ids.find(path);
+    if ((found == ids.end()) or (!valid[found->second]))
+        return -1;
+
+    return found->second;
+}
+
+bool ImageCatalog::IsUpToDate(const std::string &path, const long long &fileSize, const long long &modified) const // in catalog with the same file size and modification time ?
+{
+    const int id = Find(path);
+
+    return (id != -1) and (signatures[id].fileSize == fileSize) and (signatures[id].modified == modified);
+}
+
+int ImageCatalog::Put(const struct_image_signature &signature) // add or replace the signature of an image file - returns its id, which doesn't change while the catalog is open
+{
+    int id;
+    auto found = ids.find(signature.path);
+    if (found != ids.end()) { // known path : same id
+        id = found->second;
+        if (valid[id]) {
+            IndexRemove(id);
+            liveBytes -= recordHeaderSize + signatures[id].path.size();
+            count--;
+        }
+        signatures[id] = signature;
+    }
+    else {
+        id = int(signatures.size());
+        signatures.push_back(signature);
+        valid.push_back(false);
+        ids[signature.path] = id;
+    }
+    valid[id] = true;
+    count++;
+    IndexAdd(id);
+
+    WriteRecord(false, signature);
+    liveBytes += recordHeaderSize + signature.path.size();
+
+    return id;
+}
+
+void ImageCatalog::Remove(const std::string &path) // the image file was deleted
+{
+    const int id = Find(path);
+    if (id == -1)
+        return;
+
+    IndexRemove(id);
+    valid[id] = false; // the id is kept for this path : it will be the same if the file comes back
+    count--;
+    liveBytes -= recordHeaderSize + path.size();
+
+    WriteRecord(true, signatures[id]);
+}
+
+bool ImageCatalog::IsValid(const int &id) const // id still in catalog ?
+{
+    return (id >= 0) and (id < int(valid.size())) and (valid[id]);
+}
+
+const struct_image_signature& ImageCatalog::Signature(const int &id) const
+{
+    return signatures[id];
+}
+
+int ImageCatalog::Count() const // number of images in catalog
+{
+    return count;
+}
+
+int ImageCatalog::IdsCount() const // ids are 0 .. IdsCount() - 1, some are not valid anymore
+{
+    return int(signatures.size());
+}
+
+static bool IsInFolder(const std::string &path, const std::string &folder) // path is in folder or one of its sub-folders - whole path components only : /photos/ab is not in /photos/a
+{
+    if (path.compare(0, folder.size(), folder) != 0)
+        return false;
+
+    return (folder.back() == '/') or ((path.size() > folder.size()) and (path[folder.size()] == '/'));
+}
+
+std::vector<int> ImageCatalog::Ids(const std::string &folder) const // valid ids, optionally only images under a folder
+{
+    std::vector<int> result;
+    for (int id = 0; id < int(signatures.size()); id++)
+        if ((valid[id]) and ((folder == "") or (IsInFolder(signatures[id].path, folder))))
+            result.push_back(id);
+
+    return result;
+}
+
+std::vector<struct_catalog_match> ImageCatalog::Query(const struct_image_signature &signature, const struct_catalog_thresholds &thresholds, const int &exclude) const // catalog images that match a signature, best first - exclude = an id to ignore
+{
+    if (signature.width == 0) // unreadable image
+        return {};
+
+    // perceptual hashes : only the candidates near the query are read, see SignatureIndex
+    return Matches(signature, thresholds, exclude, pHashIndex.Query(signature.pHash, thresholds.pHash), dHashIndex.Query(signature.dHash, thresholds.dHash));
+}
+
+std::vector<struct_catalog_result> ImageCatalog::QueryRanked(const struct_image_signature &signature, const struct_catalog_thresholds &thresholds, const int &maxResults, const int &exclude) const // same matches, one per catalog image, best score first - 0 = all results
+{
+    return Rank(signature, Query(signature, thresholds, exclude), maxResults);
+}
+
+std::vector<std::vector<struct_catalog_result>> ImageCatalog::QueryRankedBatch(const std::vector<struct_image_signature> &batch, const struct_catalog_thresholds &thresholds, const int &maxResults, const std::vector<int> &excludes) const // QueryRanked() for several signatures at once - excludes = id to ignore for each signature, optional
+{
+    std::vector<uint64_t> pHashes, dHashes;
+    for (const struct_image_signature &signature : batch) {
+        pHashes.push_back(signature.pHash);
+        dHashes.push_back(signature.dHash);
+    }
+    const std::vector<std::vector<std::pair<int, int>>> pHashFound = pHashIndex.QueryBatch(pHashes, thresholds.pHash);
+    const std::vector<std::vector<std::pair<int, int>>> dHashFound = dHashIndex.QueryBatch(dHashes, thresholds.dHash);
+
+    std::vector<std::vector<struct_catalog_result>> results(batch.size());
+    for (size_t n = 0; n < batch.size(); n++)
+        if (batch[n].width > 0)
+            results[n] = Rank(batch[n], Matches(batch[n], thresholds, (n < excludes.size()) ? excludes[n] : -1, pHashFound[n], dHashFound[n]), maxResults);
+
+    return results;
+}
+
+std::vector<struct_catalog_match> ImageCatalog::Matches(const struct_image_signature &signature, const struct_catalog_thresholds &thresholds, const int &exclude,
+                                                        const std::vector<std::pair<int, int>> &pHashFound, const std::vector<std::pair<int, int>> &dHashFound) const // matches from the hash indexes results
+{
+    std::vector<struct_catalog_match> matches;
+
+    if (thresholds.checksum) { // exact pixels
+        auto found = checksums.find(std::string(reinterpret_cast<const char*>(signature.checksum.data()), 16));
+        if (found != checksums.end())
+            for (const int &id : found->second)
+                if (id != exclude)
+                    matches.push_back({id, img_similarity_checksum, 0, 100.0f});
+    }
+
+    for (const auto &found : pHashFound)
+        if ((found.first != exclude) and (OrientationsMatch(signature, signatures[found.first])))
+            matches.push_back({found.first, img_similarity_pHash, found.second, (64.0f - float(found.second)) / 0.64f});
+    for (const auto &found : dHashFound)
+        if ((found.first != exclude) and (OrientationsMatch(signature, signatures[found.first])))
+            matches.push_back({found.first, img_similarity_dHash, found.second, (64.0f - float(found.second)) / 0.64f});
+
+    std::stable_sort(matches.begin(), matches.end(), [](const struct_catalog_match &a, const struct_catalog_match &b) { return a.similarity > b.similarity; });
+
+    return matches;
+}
+
+std::vector<struct_catalog_result> ImageCatalog::Rank(const struct_image_signature &signature, const std::vector<struct_catalog_match> &matches, const int &maxResults) const // one result per image, best first
+{
+    std::vector<struct_catalog_result> results;
+    std::unordered_map<int, int> positions; // id -> index in results
+
+    for (const struct_catalog_match &match : matches) {
+        auto found = positions.find(match.id);
+        if (found == positions.end()) { // first time this image is found : all its scores, a Hamming distance is only a popcount
+            const struct_image_signature &candidate = signatures[match.id];
+            struct_catalog_result result;
+            result.id = match.id;
+            result.pHash = (64.0f - float(SignatureIndex::Distance(signature.pHash, candidate.pHash))) / 0.64f;
+            result.dHash = (64.0f - float(SignatureIndex::Distance(signature.dHash, candidate.dHash))) / 0.64f;
+            positions[match.id] = int(results.size());
+            results.push_back(result);
+            found = positions.find(match.id);
+        }
+        if (match.algorithm == img_similarity_checksum)
+            results[found->second].exact = true;
+    }
+
+    for (struct_catalog_result &result : results)
+        result.score = result.exact ? 100.0f : (result.pHash + result.dHash) / 2.0f;
+
+    auto better = [](const struct_catalog_result &a, const struct_catalog_result &b) { return (a.score > b.score) or ((a.score == b.score) and (a.id < b.id)); };
+    if ((maxResults > 0) and (int(results.size()) > maxResults)) { // only the best ones are sorted
+        std::partial_sort(results.begin(), results.begin() + maxResults, results.end(), better);
+        results.resize(maxResults);
+    }
+    else
+        std::sort(results.begin(), results.end(), better);
+
+    return results;
+}
+
+void ImageCatalog::WriteRecord(const bool &removed, const struct_image_signature &signature) // append a record to the file
+{
+    if (!file.is_open()) // loading
+        return;
+
+    char buffer[recordHeaderSize];
+    const uint8_t removedFlag = removed ? 1 : 0;
+    const uint32_t pathLength = uint32_t(signature.path.size());
+    std::memcpy(buffer, &removedFlag, 1);
+    std::memcpy(buffer + 1, &pathLength, 4);
+    std::memcpy(buffer + 5, &signature.fileSize, 8);
+    std::memcpy(buffer + 13, &signature.modified, 8);
+    std::memcpy(buffer + 21, &signature.width, 4);
+    std::memcpy(buffer + 25, &signature.height, 4);
+    std::memcpy(buffer + 29, signature.checksum.data(), 16);
+    std::memcpy(buffer + 45, &signature.pHash, 8);
+    std::memcpy(buffer + 53, &signature.dHash, 8);
+    file.write(buffer, recordHeaderSize);
+    file.write(signature.path.data(), pathLength);
+    fileEnd += recordHeaderSize + pathLength;
+}
+
+void ImageCatalog::IndexAdd(const int &id) // add a signature to the indexes
+{
+    const struct_image_signature &signature = signatures[id];
+    if (signature.width == 0) // unreadable image : nothing to match
+        return;
+
+    checksums[std::string(reinterpret_cast<const char*>(signature.checksum.data()), 16)].push_back(id);
+    pHashIndex.Add(id, signature.pHash);
+    dHashIndex.Add(id, signature.dHash);
+}
+
+void ImageCatalog::IndexRemove(const int &id)
+{
+    const struct_image_signature &signature = signatures[id];
+    if (signature.width == 0)
+        return;
+
+    auto found = checksums.find(std::string(reinterpret_cast<const char*>(signature.checksum.data()), 16));
+    if (found != checksums.end()) {
+        found->second.erase(std::remove(found->second.begin(), found->second.end(), id), found->second.end());
+        if (found->second.empty())
+            checksums.erase(found);
+    }
+    pHashIndex.Remove(id);
+    dHashIndex.Remove(id);
+}
+
+bool ImageCatalog::Compact() // rewrite the file with the current records only
+{
+    const std::string tmpName = filename + ".tmp";
+    file.close();
+    file.open(tmpName, std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!file.is_open()) { // keep the old file
+        file.open(filename, std::ios::binary | std::ios::out | std::ios::app);
+        return false;
+    }
+
+    const long long oldEnd = fileEnd;
+    file.write(catalogMagic, 4);
+    file.write(reinterpret_cast<const char*>(&catalogVersion), 4);
+    fileEnd = catalogHeaderSize;
+    for (int id = 0; id < int(signatures.size()); id++)
+        if (valid[id])
+            WriteRecord(false, signatures[id]);
+    bool written = file.good(); // disk full : the new file is incomplete
+    file.close();
+    written = written and (!file.fail());
+
+    std::error_code error;
+    if (written)
+        std::filesystem::rename(tmpName, filename, error);
+    if ((!written) or (error)) { // the old file is still the catalog
+        std::error_code cleanup; // not error : a successful remove would clear it
+        std::filesystem::remove(tmpName, cleanup);
+        fileEnd = oldEnd;
+    }
+    file.open(filename, std::ios::binary | std::ios::out | std::ios::app);
+
+    return (written) and (!error);
+}
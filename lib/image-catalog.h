@@ -0,0 +1,122 @@
+/*#-------------------------------------------------
+#
+#        Image signatures catalog library
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.3 - 2026/10/19
+#
+#   - signatures of image files : checksum of pixels (MD5), pHash, dHash, image size
+#   - kept on disk in one packed file : records appended one after the other, compacted when
+#     more than half of the file is old records - an image file is known by its path, size and modification time
+#   - all signatures in memory, with indexes : exact checksums, and multi-index hashing for pHash and dHash
+#     -> matching a new image costs about the same with 1000 or 1000000 images in the catalog
+#   - v1.1 : ranked query - one result per catalog image with the score of each algorithm
+#   - v1.2 : batch of ranked queries, for a server answering several clients at once
+#   - v1.3 : working images from the per-thread preprocessing pyramid
+#
+#   uses OpenCV Contrib (img_hash)
+#
+#-------------------------------------------------*/
+
+#ifndef IMAGECATALOG_H
+#define IMAGECATALOG_H
+
+#include "signature-index.h"
+
+#include "opencv2/opencv.hpp"
+
+#include <string>
+#include <vector>
+#include <array>
+#include <fstream>
+#include <unordered_map>
+#include <cstdint>
+
+
+struct struct_image_signature { // what the catalog knows about an image file
+    std::string path; // full path of image file
+    long long fileSize = -1; // bytes of the image file
+    long long modified = 0; // last modification time of the image file
+    int width = 0; // 0 = the image file could not be read
+    int height = 0;
+    std::array<uint8_t, 16> checksum = {}; // MD5 of pixel values
+    uint64_t pHash = 0; // 64 bits
+    uint64_t dHash = 0; // 64 bits
+};
+
+struct struct_catalog_match { // an image of the catalog that matches a signature
+    int id; // in catalog
+    int algorithm; // img_similarity_checksum, img_similarity_pHash or img_similarity_dHash
+    int distance; // different bits - 0 for checksum
+    float similarity; // % like ImageHashCompare()
+};
+
+struct struct_catalog_thresholds { // maximum Hamming distances for a match
+    int pHash = 12; // 80% like the "similar" level of data/thresholds.cfg
+    int dHash = 12;
+    bool checksum = true; // exact pixels
+};
+
+struct struct_catalog_result { // a catalog image that matches a signature, with all scores
+    int id; // in catalog
+    bool exact = false; // same pixels (checksum)
+    float pHash = 0; // similarity % of each hash, even the ones under their threshold
+    float dHash = 0;
+    float score = 0; // for ranking : 100 if exact, else the mean of the hash similarities
+};
+
+bool ComputeImageSignature(const std::string &path, const int &reducedSize, struct_image_signature &signature); // read an image file and compute its signature - false if it can't be read (width = 0)
+    // a file that exists but can't be read still gets its size and modification time (fileSize >= 0) : Put() it, so it is not read again until it changes
+int SimilarityToDistance(const float &similarity); // maximum different bits of 64-bit hashes for a % of similarity
+std::string CatalogPath(const std::string &path); // path of an image file like in the catalog : canonical (absolute, symbolic links resolved)
+
+class ImageCatalog // signatures of image files, kept between sessions
+{
+public:
+    ~ImageCatalog();
+
+    bool Open(const std::string &filename); // load an existing catalog file, or create it - false if the file can't be used
+    void Close(); // flush and close the file, compact it if needed
+    bool IsOpen() const;
+    void Flush(); // write buffered records to disk
+
+    int Find(const std::string &path) const; // id of an image file, -1 if not in catalog
+    bool IsUpToDate(const std::string &path, const long long &fileSize, const long long &modified) const; // in catalog with the same file size and modification time ?
+    int Put(const struct_image_signature &signature); // add or replace the signature of an image file - returns its id, which doesn't change while the catalog is open
+    void Remove(const std::string &path); // the image file was deleted
+    bool IsValid(const int &id) const; // id still in catalog ?
+    const struct_image_signature& Signature(const int &id) const;
+    int Count() const; // number of images in catalog
+    int IdsCount() const; // ids are 0 .. IdsCount() - 1, some are not valid anymore
+    std::vector<int> Ids(const std::string &folder = "") const; // valid ids, optionally only images under a folder
+
+    std::vector<struct_catalog_match> Query(const struct_image_signature &signature, const struct_catalog_thresholds &thresholds, const int &exclude = -1) const; // catalog images that match a signature, best first - exclude = an id to ignore
+    std::vector<struct_catalog_result> QueryRanked(const struct_image_signature &signature, const struct_catalog_thresholds &thresholds, const int &maxResults = 0, const int &exclude = -1) const; // same matches, one per catalog image, best score first - 0 = all results
+    std::vector<std::vector<struct_catalog_result>> QueryRankedBatch(const std::vector<struct_image_signature> &batch, const struct_catalog_thresholds &thresholds, const int &maxResults = 0, const std::vector<int> &excludes = {}) const; // QueryRanked() for several signatures at once - excludes = id to ignore for each signature, optional
+
+private:
+    std::vector<struct_catalog_match> Matches(const struct_image_signature &signature, const struct_catalog_thresholds &thresholds, const int &exclude,
+                                              const std::vector<std::pair<int, int>> &pHashFound, const std::vector<std::pair<int, int>> &dHashFound) const; // matches from the hash indexes results
+    std::vector<struct_catalog_result> Rank(const struct_image_signature &signature, const std::vector<struct_catalog_match> &matches, const int &maxResults) const; // one result per image, best first
+    void WriteRecord(const bool &removed, const struct_image_signature &signature); // append a record to the file
+    void IndexAdd(const int &id); // add a signature to the indexes
+    void IndexRemove(const int &id);
+    bool Compact(); // rewrite the file with the current records only
+
+    std::string filename;
+    std::ofstream file; // append only : the catalog is read only by Open()
+    long long fileEnd = 0; // bytes in file
+    long long liveBytes = 0; // bytes used by the current records
+
+    std::vector<struct_image_signature> signatures; // id -> signature
+    std::vector<char> valid; // id -> still in catalog ?
+    std::unordered_map<std::string, int> ids; // path -> id
+    std::unordered_map<std::string, std::vector<int>> checksums; // checksum -> ids
+    SignatureIndex pHashIndex;
+    SignatureIndex dHashIndex;
+    int count = 0;
+};
+
+
+#endif // IMAGECATALOG_H
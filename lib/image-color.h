@@ -4,9 +4,9 @@
 #
 #    by AbsurdePhoton - www.absurdephoton.fr
 #
-#                v2.0 - 2022/12/12
+#                v2.1 - 2026/10/19
 #
-#   - color spaces conversions for images
+#   - color spaces conversions for images - fast float OKLAB and CIELab
 #   - Gradients
 #   - Means  for images
 #   - Dominant colors for images
@@ -37,6 +37,9 @@ cv::Mat ConvertImageLabToGray(const cv::Mat &source); // get a gray image from C
 cv::Mat ConvertImageRGBtoCIELab(const cv::Mat &source); // convert RGB image to CIELab
 cv::Mat ConvertImageRGBtoCIELCHab(const cv::Mat &source); // convert RGB image to CIE LCHab
 cv::Mat ConvertImageRGBtoOKLAB(const cv::Mat &source); // convert RGB image to OKLAB
+cv::Mat ConvertImageRGBtoOKLABFast(const cv::Mat &source); // convert RGB image to OKLAB - fast float version, result is CV_32FC3
+cv::Mat ConvertImageRGBtoCIELabFast(const cv::Mat &source); // convert RGB image to CIELab - fast float version, result is CV_32FC3
+double TestConvertImageLabFastAccuracy(const bool &oklab, const int &step=1); // test : max absolute difference between fast float and double conversions, over the whole RGB cube
 cv::Mat ConvertImageCIELabToRGB(const cv::Mat &source); // convert CIELab image to RGB
 cv::Mat ConvertImageCIELCHabToRGB(const cv::Mat &source); // convert CIE LCHab image to RGB
 cv::Mat ConvertImageRGBtoLinear(const cv::Mat &source); // convert RGB image [0..1] to linear [0..1]
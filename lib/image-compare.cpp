@@ -4,14 +4,16 @@
 #
 #    by AbsurdePhoton - www.absurdephoton.fr
 #
-#                v1.2 - 2026/05/19
+#                v1.6 - 2026/10/19
 #
-#   - OpenCV's and custom hashes algorithms
-#   - Image features and homography
+#   - OpenCV's and custom hashes algorithms - tiny hash inputs in per-thread buffers
+#   - v1.5 : color moments, patch frequency and DNN hashes work in per-thread grow-only buffers : no allocation per image
+#   - v1.6 : pHash, dHash and idHash in canonical orientation : rotated and mirrored copies get the same hash
+#   - Image features and homography - reusable per-thread matcher with early exit
 #   - Compare image palettes
 #   - Image quality
 #   - Image comparison with DNN
-#   - Frequency map comparison
+#   - Frequency map comparison - batched FFT
 #
 #   uses OpenCV Contrib (features and DNN support)
 #
@@ -48,22 +50,112 @@ cv::Mat ImageChecksum(const cv::Mat &source, const QCryptographicHash::Algorithm
     return checksum;
 }
 
-cv::Mat DifferenceHash(const cv::Mat &source)
+//// Dihedral invariance
+//// a rotated (quarter turns) or mirrored copy of an image is one of the 8 transformations of the dihedral group of the square
+//// the tiny square image used by a hash is transformed to a canonical orientation that only depends on its content :
+//// all 8 copies give the same canonical image, so the same hash, and comparing 2 hashes is still one Hamming distance
+
+void DihedralCanonical(const cv::Mat &square, cv::Mat &canonical) // canonical orientation of a square 1-channel image : brightest quadrant top-left, then top-right brighter than bottom-left
+    // quadrant sums are robust to small changes (re-encoding, resizing) - images with nearly the same quadrants can get different orientations
+    // exact ties of the brightest quadrant are not broken : these images may get several canonical forms
+{
+    const int n = square.rows;
+    const int h = n / 2; // odd sizes : the middle row and column are not in any quadrant
+    const double topLeft = cv::sum(square(cv::Rect(0, 0, h, h)))[0];
+    const double topRight = cv::sum(square(cv::Rect(n - h, 0, h, h)))[0];
+    const double bottomLeft = cv::sum(square(cv::Rect(0, n - h, h, h)))[0];
+    const double bottomRight = cv::sum(square(cv::Rect(n - h, n - h, h, h)))[0];
+
+    // brightest quadrant -> top-left with flips
+    const double quadrants[4] = {topLeft, topRight, bottomLeft, bottomRight};
+    int brightest = 0;
+    for (int q = 1; q < 4; q++)
+        if (quadrants[q] > quadrants[brightest])
+            brightest = q;
+    const bool flipX = (brightest % 2 == 1); // right side
+    const bool flipY = (brightest >= 2); // bottom side
+
+    // after the flips, transpose if the bottom-left quadrant is brighter than the top-right one - the top-left stays where it is
+    const double newTopRight = quadrants[(flipY ? 2 : 0) + (flipX ? 0 : 1)];
+    const double newBottomLeft = quadrants[(flipY ? 0 : 2) + (flipX ? 1 : 0)];
+
+    if ((flipX) and (flipY))
+        cv::flip(square, canonical, -1);
+    else if (flipX)
+        cv::flip(square, canonical, 1);
+    else if (flipY)
+        cv::flip(square, canonical, 0);
+    else
+        square.copyTo(canonical);
+
+    bool transpose = (newBottomLeft > newTopRight);
+    if (newBottomLeft == newTopRight) { // tie (symmetric content) : the smallest of the image and its transpose, read line by line
+        cv::Mat transposed;
+        cv::transpose(canonical, transposed);
+        std::vector<cv::Point> different;
+        cv::findNonZero(canonical != transposed, different); // line by line order
+        if (!different.empty()) {
+            cv::Mat values1, values2; // first different value, in double whatever the image type
+            canonical(cv::Rect(different[0], cv::Size(1, 1))).convertTo(values1, CV_64F);
+            transposed(cv::Rect(different[0], cv::Size(1, 1))).convertTo(values2, CV_64F);
+            transpose = (values2.at<double>(0, 0) < values1.at<double>(0, 0));
+        }
+    }
+    if (transpose)
+        cv::transpose(canonical, canonical); // in place : the image is square
+}
+
+cv::Mat PerceptualHashDihedral(const cv::Mat &source) // same steps as OpenCV's pHash, on the 32x32 image in canonical orientation
+    // 8 uchar = 64 bits : DCT low frequencies thresholded by their mean, like OpenCV's hash, but NOT the same values : don't mix both
+{
+    static thread_local cv::Mat resized, gray, grayFloat, canonical, dct; // tiny images : memory reused by the next images of this thread
+
+    cv::resize(source, resized, cv::Size(32, 32), 0, 0, cv::INTER_LINEAR_EXACT);
+    if (source.channels() > 1)
+        cv::cvtColor(resized, gray, cv::COLOR_BGR2GRAY);
+    else
+        resized.copyTo(gray);
+    gray.convertTo(grayFloat, CV_32F);
+    DihedralCanonical(grayFloat, canonical);
+    cv::dct(canonical, dct);
+
+    const cv::Mat topLeft = dct(cv::Rect(0, 0, 8, 8)); // low frequencies
+    const double mean = cv::mean(topLeft)[0];
+    cv::Mat hash = cv::Mat::zeros(1, 8, CV_8U);
+    uchar* hashP = hash.ptr<uchar>(0);
+    for (int y = 0; y < 8; y++) {
+        const float *topLeftP = topLeft.ptr<float>(y);
+        for (int x = 0; x < 8; x++)
+            if (topLeftP[x] > mean)
+                hashP[y] |= uchar(1 << x);
+    }
+
+    return hash;
+}
+
+cv::Mat DifferenceHash(const cv::Mat &source, const bool &dihedral)
     // see : https://www.hackerfactor.com/blog/?/archives/529-Kind-of-Like-That.html
     // a clever and efficient hashing algorithm !
     // works on a very tiny version of original image
     // VERY FAST
+    // dihedral : the tiny image is square (9x9) and put in its canonical orientation first -> rotated and mirrored copies get the same hash
 {
     // step 1 : resize image to 9x8
-    cv::Mat resized;
-    cv::resize(source, resized, cv::Size(8, 9), 0, 0, cv::INTER_LINEAR_EXACT); // LINEAR_EXACT gives the best results
+    static thread_local cv::Mat resized, grayBuffer, canonical; // tiny images : memory reused by the next images of this thread
+    cv::resize(source, resized, dihedral ? cv::Size(9, 9) : cv::Size(8, 9), 0, 0, cv::INTER_LINEAR_EXACT); // LINEAR_EXACT gives the best results
 
     // step 2 : reduce colors (to gray)
     cv::Mat gray;
-    if(source.channels() > 1)
-        cv::cvtColor(resized, gray, cv::COLOR_BGR2GRAY);
+    if(source.channels() > 1) {
+        cv::cvtColor(resized, grayBuffer, cv::COLOR_BGR2GRAY);
+        gray = grayBuffer;
+    }
     else
         gray = resized;
+    if (dihedral) {
+        DihedralCanonical(gray, canonical);
+        gray = canonical;
+    }
 
     // step 3 : compare values in gray image, create hash
     cv::Mat hash = cv::Mat::zeros(1, 8, CV_8U); // final result
@@ -84,24 +176,30 @@ cv::Mat DifferenceHash(const cv::Mat &source)
     return hash;
 }
 
-cv::Mat ImportantDifferenceHash(const cv::Mat &source)
+cv::Mat ImportantDifferenceHash(const cv::Mat &source, const bool &dihedral)
     // derived from DifferenceHash, which only scans the image horizontally : it can miss vertical features
     // this one combines horizontal AND vertical values - my own design
     // comparing hashes gets less matches than DifferenceHash BUT gets some that DifferenceHash missed...
     // it is a little slower than DifferenceHash but still VERY FAST
+    // dihedral : the 9x9 image is put in its canonical orientation first -> rotated and mirrored copies get the same hash
 {
     // step 1 : resize to 9x9
-    cv::Mat resized;
+    static thread_local cv::Mat resized, grayBuffer, grayV, canonical; // tiny images : memory reused by the next images of this thread
     cv::resize(source, resized, cv::Size(9, 9), 0, 0, cv::INTER_LINEAR_EXACT); // LINEAR_EXACT gives the best results
 
     // step 2 : reduce colors (to gray)
     cv::Mat grayH;
-    if(source.channels() > 1)
-        cv::cvtColor(resized, grayH, cv::COLOR_BGR2GRAY);
+    if(source.channels() > 1) {
+        cv::cvtColor(resized, grayBuffer, cv::COLOR_BGR2GRAY);
+        grayH = grayBuffer;
+    }
     else
         grayH = resized;
+    if (dihedral) {
+        DihedralCanonical(grayH, canonical);
+        grayH = canonical;
+    }
     // transpose gray image for vertical scan
-    cv::Mat grayV;
     cv::transpose(grayH, grayV);
 
     // step 3 : compare values in grayH image, create hash
@@ -127,45 +225,45 @@ cv::Mat ImportantDifferenceHash(const cv::Mat &source)
     return hash;
 }
 
+cv::Mat WorkspaceBuffer(cv::Mat &storage, const int &rows, const int &cols, const int &type) // rows x cols header over a grow-only per-thread buffer
+    // an OpenCV call given this header as output writes in it without allocating, if its size and type are the ones expected
+    // the storage only grows : portrait and landscape images of the same area use the same memory
+    // the header is valid until the next call with the same storage
+{
+    const int bytes = rows * cols * int(CV_ELEM_SIZE(type));
+    if (int(storage.total()) < bytes)
+        storage.create(1, bytes, CV_8U);
+
+    return cv::Mat(rows, cols, type, storage.data);
+}
+
+struct struct_moments_workspace { // buffers for ColorMomentsHash, one per thread
+    cv::Mat blurred, colorSpace, channel;
+};
+
 cv::Mat ColorMomentsHash(const cv::Mat &source) // reimplementation of OpenCV's function, looks like there's a leak in it
     // needs a BGR image
 {
-    cv::Mat img;
-    source.copyTo(img);
+    thread_local struct_moments_workspace ws;
+    const int channelType = CV_MAKETYPE(source.depth(), 1);
 
     // blur
-    cv::GaussianBlur(img, img, cv::Size(3,3), 0, 0);
+    cv::Mat img = WorkspaceBuffer(ws.blurred, source.rows, source.cols, source.type());
+    cv::GaussianBlur(source, img, cv::Size(3,3), 0, 0);
     // results
     cv::Mat result = cv::Mat::zeros(1, 42, CV_64F);
-    double *resultP = NULL;
-    // HSV part
-    cv::Mat colorSpace;
-    std::vector<cv::Mat> channels;
-    cv::cvtColor(img, colorSpace, cv::COLOR_BGR2HSV); // convert image to HSV
-    cv::split(colorSpace, channels); // split its channels
-    // HSV moments
-    resultP = result.ptr<double>(0);
+    double *resultP = result.ptr<double>(0);
     int count = 0; // important : advances as results are added
-    for (int channel = 0; channel < 3; channel++) { // for each channel
-        cv::Mat Hu;
-        cv::HuMoments(cv::moments(channels[channel]), Hu); // compute moments
-        double *HuP = Hu.ptr<double>(0);
-        for (int n = 0; n < Hu.cols; n++) { // copy result to hash
-            resultP[count] = HuP[n];
-            count++;
-        }
-    }
-    // YCrCb part - the same as before, but with YCrCb color space
-    cv::cvtColor(img, colorSpace, cv::COLOR_BGR2YCrCb);
-    channels.clear();
-    cv::split(colorSpace, channels);
-    // YCrCb moments
-    for (int channel = 0; channel < 3; channel++) {
-        cv::Mat Hu;
-        cv::HuMoments(cv::moments(channels[channel]), Hu);
-        double *HuP = Hu.ptr<double>(0);
-        for (int n = 0; n < Hu.cols; n++) {
-            resultP[count] = HuP[n];
+    cv::Mat colorSpace = WorkspaceBuffer(ws.colorSpace, source.rows, source.cols, source.type());
+    cv::Mat channel = WorkspaceBuffer(ws.channel, source.rows, source.cols, channelType);
+    const int conversions[2] = {cv::COLOR_BGR2HSV, cv::COLOR_BGR2YCrCb}; // HSV part, then the same with YCrCb color space
+    for (int conversion = 0; conversion < 2; conversion++) {
+        cv::cvtColor(img, colorSpace, conversions[conversion]); // convert image
+        for (int c = 0; c < 3; c++) { // moments of each channel
+            cv::extractChannel(colorSpace, channel, c);
+            double Hu[7];
+            cv::HuMoments(cv::moments(channel), Hu); // compute moments
+            resultP[count] = Hu[0]; // only the first one : the hash always kept one value per channel (Hu was a 7x1 matrix read by columns)
             count++;
         }
     }
@@ -173,17 +271,22 @@ cv::Mat ColorMomentsHash(const cv::Mat &source) // reimplementation of OpenCV's
     return result;
 }
 
-cv::Mat PatchFrequencyHash(const cv::Mat & input) // hash from frequencies, computed by patches over the image
-    // 8-byte patch frequency hash (64 bits)
+//// Patch frequency hash
+//// the image is cut in patches (~32 per side), the mean of each patch's FFT magnitude gives a heatmap, and the 8x8 resized heatmap is thresholded by its median
+
+int PatchFrequencyPrepare(const cv::Mat &input, cv::Mat &gray8, cv::Mat &gray, cv::Mat &padded) // patch size, and float gray image padded to optimal DFT size and full patches
+    // gray8 : intermediate gray image of a BGR input - gray and padded are float
 {
     int patchSize = std::min(input.cols, input.rows) / 32;
     if (patchSize < 3)
         patchSize = 3;
 
-    cv::Mat gray;
-    if (input.channels() == 3) cv::cvtColor(input, gray, cv::COLOR_BGR2GRAY);
-    else gray = input.clone();
-    gray.convertTo(gray, CV_32F);
+    if (input.channels() == 3) {
+        cv::cvtColor(input, gray8, cv::COLOR_BGR2GRAY);
+        gray8.convertTo(gray, CV_32F); // not in place : a new type means a new buffer
+    }
+    else
+        input.convertTo(gray, CV_32F);
 
     // Compute optimal FFT sizes for speed and full patches
     int optimalRows = cv::getOptimalDFTSize(gray.rows);
@@ -193,9 +296,48 @@ cv::Mat PatchFrequencyHash(const cv::Mat & input) // hash from frequencies, comp
     int padRows = ((optimalRows - gray.rows + patchSize - 1) / patchSize) * patchSize;
     int padCols = ((optimalCols - gray.cols + patchSize - 1) / patchSize) * patchSize;
 
-    cv::Mat padded;
     cv::copyMakeBorder(gray, padded, 0, padRows, 0, padCols, cv::BORDER_REPLICATE);
 
+    return patchSize;
+}
+
+cv::Mat PatchFrequencyHeatmapToHash(const cv::Mat &heatmap) // 8-byte hash from patches heatmap
+{
+    // Resize heatmap to 8x8
+    static thread_local cv::Mat resizedHeatmap; // always 8x8 : allocated once per thread
+    cv::resize(heatmap, resizedHeatmap, cv::Size(8,8), 0, 0, cv::INTER_LINEAR);
+
+    // Flatten and threshold by median to create 64-bit Hamming hash
+    float flat[64];
+    for (int i = 0; i < 8; i++)
+        for (int j = 0; j < 8; j++)
+            flat[i*8 + j] = resizedHeatmap.at<float>(i,j);
+
+    float sorted[64];
+    std::copy(flat, flat + 64, sorted);
+    std::nth_element(sorted, sorted + 32, sorted + 64);
+    float median = sorted[32];
+
+    cv::Mat hash = cv::Mat::zeros(1, 8, CV_8U);
+    for (int byteIdx = 0; byteIdx < 8; byteIdx++) {
+        uchar b = 0;
+        for (int bit = 0; bit < 8; bit++) {
+            int idx = byteIdx*8 + bit;
+            if (flat[idx] >= median)
+                b |= (1 << (7-bit));
+        }
+        hash.at<uchar>(0, byteIdx) = b;
+    }
+
+    return hash;
+}
+
+cv::Mat PatchFrequencyHashNaive(const cv::Mat &input) // hash from frequencies, computed by patches over the image - reference version, one DFT per patch
+    // 8-byte patch frequency hash (64 bits)
+{
+    cv::Mat gray8, gray, padded;
+    const int patchSize = PatchFrequencyPrepare(input, gray8, gray, padded);
+
     int nRows = padded.rows / patchSize;
     int nCols = padded.cols / patchSize;
 
@@ -218,36 +360,127 @@ cv::Mat PatchFrequencyHash(const cv::Mat & input) // hash from frequencies, comp
         }
     }
 
-    // Resize heatmap to 8x8
-    cv::Mat resizedHeatmap;
-    cv::resize(heatmap, resizedHeatmap, cv::Size(8,8), 0, 0, cv::INTER_LINEAR);
+    return PatchFrequencyHeatmapToHash(heatmap);
+}
 
-    // Flatten and threshold by median to create 64-bit Hamming hash
-    std::vector<float> flat(64);
-    for (int i = 0; i < 8; i++)
-        for (int j = 0; j < 8; j++)
-            flat[i*8 + j] = resizedHeatmap.at<float>(i,j);
+struct struct_frequency_workspace { // buffers for PatchFrequencyHash, one per thread, grow-only storages for WorkspaceBuffer()
+    cv::Mat gray8, gray, padded; // prepared image
+    cv::Mat patches; // full patches of the padded image, continuous
+    cv::Mat rowsSpectrum; // DFT of each row of each patch
+    cv::Mat columns; // the same, regrouped by patch and frequency
+    cv::Mat integral, integralSquares; // for energy version
+    cv::Mat heatmap;
+};
+
+cv::Mat PatchFrequencyHash(const cv::Mat &input, const bool &energy) // hash from frequencies, computed by patches over the image
+    // 8-byte patch frequency hash (64 bits) - same hash as PatchFrequencyHashNaive() but all patches are transformed together :
+    //   - the padded image reshaped to one patch row per line gives all patches rows : ONE DFT_ROWS call (real input)
+    //   - rows spectrums are regrouped by patch and frequency, then ONE DFT_ROWS call transforms all patches columns
+    //   - the input is real so |F(u,v)| = |F(-u,-v)| : only half the columns frequencies are needed
+    // if "energy" is true, the FFT magnitude mean is replaced by its quadratic mean, computed without any DFT with Parseval's theorem and an integral image
+    //   -> much faster but NOT the same hash, don't mix both
+{
+    thread_local struct_frequency_workspace ws;
+
+    // sizes of the prepared image are known before : all buffers are headers over the thread's storages
+    int patchSize = std::max(3, std::min(input.cols, input.rows) / 32); // the same as PatchFrequencyPrepare()
+    const int paddedRows = input.rows + ((cv::getOptimalDFTSize(input.rows) - input.rows + patchSize - 1) / patchSize) * patchSize;
+    const int paddedCols = input.cols + ((cv::getOptimalDFTSize(input.cols) - input.cols + patchSize - 1) / patchSize) * patchSize;
+    cv::Mat gray8 = WorkspaceBuffer(ws.gray8, input.rows, input.cols, CV_8U);
+    cv::Mat gray = WorkspaceBuffer(ws.gray, input.rows, input.cols, CV_32F);
+    cv::Mat padded = WorkspaceBuffer(ws.padded, paddedRows, paddedCols, CV_32F);
+
+    patchSize = PatchFrequencyPrepare(input, gray8, gray, padded);
+    const int nRows = padded.rows / patchSize;
+    const int nCols = padded.cols / patchSize;
+    cv::Mat heatmap = WorkspaceBuffer(ws.heatmap, nRows, nCols, CV_32F);
+
+    if (energy) {
+        // Parseval : sum(|F|²) = N.sum(x²) with N = patchSize² values -> quadratic mean of |F| = sqrt(sum(x²))
+        cv::Mat integral = WorkspaceBuffer(ws.integral, padded.rows + 1, padded.cols + 1, CV_64F);
+        cv::Mat integralSquares = WorkspaceBuffer(ws.integralSquares, padded.rows + 1, padded.cols + 1, CV_64F);
+        cv::integral(padded, integral, integralSquares, CV_64F, CV_64F);
+        for (int i = 0; i < nRows; i++) {
+            const double *top = integralSquares.ptr<double>(i * patchSize);
+            const double *bottom = integralSquares.ptr<double>((i + 1) * patchSize);
+            float *heatmapP = heatmap.ptr<float>(i);
+            for (int j = 0; j < nCols; j++) {
+                const double squares = bottom[(j + 1) * patchSize] - bottom[j * patchSize] - top[(j + 1) * patchSize] + top[j * patchSize];
+                heatmapP[j] = float(std::sqrt(std::max(0.0, squares)));
+            }
+        }
 
-    std::vector<float> sorted = flat;
-    std::nth_element(sorted.begin(), sorted.begin()+32, sorted.end());
-    float median = sorted[32];
+        return PatchFrequencyHeatmapToHash(heatmap);
+    }
 
-    cv::Mat hash = cv::Mat::zeros(1, 8, CV_8U);
-    for (int byteIdx = 0; byteIdx < 8; byteIdx++) {
-        uchar b = 0;
-        for (int bit = 0; bit < 8; bit++) {
-            int idx = byteIdx*8 + bit;
-            if (flat[idx] >= median)
-                b |= (1 << (7-bit));
+    // DFT of all patches rows at once : each line of "strips" is one row of one patch
+    // the padded image is only padded to the next multiple of patchSize if its optimal DFT size is smaller : its last rows and columns
+    // can be out of the patches (256 columns, patchSize 6 -> 42 patches = 252 columns), like in PatchFrequencyHashNaive() they are left out
+    cv::Mat patches = padded;
+    if ((padded.cols != nCols * patchSize) or (padded.rows != nRows * patchSize) or (!padded.isContinuous())) {
+        patches = WorkspaceBuffer(ws.patches, nRows * patchSize, nCols * patchSize, CV_32F);
+        padded(cv::Rect(0, 0, nCols * patchSize, nRows * patchSize)).copyTo(patches);
+    }
+    cv::Mat strips = patches.reshape(1, patches.rows * nCols);
+    cv::Mat rowsSpectrum = WorkspaceBuffer(ws.rowsSpectrum, strips.rows, strips.cols, CV_32FC2);
+    cv::dft(strips, rowsSpectrum, cv::DFT_ROWS | cv::DFT_COMPLEX_OUTPUT);
+
+    // regroup by patch and frequency u : one line = the column u of one patch
+    const int half = patchSize / 2 + 1; // u in [0..patchSize/2], the other half is symmetric
+    cv::Mat columns = WorkspaceBuffer(ws.columns, nRows * nCols * half, patchSize, CV_32FC2);
+    for (int i = 0; i < nRows; i++)
+        for (int dy = 0; dy < patchSize; dy++)
+            for (int j = 0; j < nCols; j++) {
+                const cv::Vec2f *source = rowsSpectrum.ptr<cv::Vec2f>((i * patchSize + dy) * nCols + j);
+                const int line = (i * nCols + j) * half;
+                for (int u = 0; u < half; u++)
+                    columns.ptr<cv::Vec2f>(line + u)[dy] = source[u];
+            }
+
+    // DFT of all patches columns at once
+    cv::dft(columns, columns, cv::DFT_ROWS);
+
+    // magnitude mean of each patch
+    for (int i = 0; i < nRows; i++) {
+        float *heatmapP = heatmap.ptr<float>(i);
+        for (int j = 0; j < nCols; j++) {
+            const int line = (i * nCols + j) * half;
+            double sum = 0;
+            for (int u = 0; u < half; u++) {
+                const cv::Vec2f *column = columns.ptr<cv::Vec2f>(line + u);
+                float columnSum = 0;
+                for (int v = 0; v < patchSize; v++)
+                    columnSum += std::sqrt(column[v][0] * column[v][0] + column[v][1] * column[v][1]);
+                const bool mirrored = (u > 0) and (2 * u != patchSize); // column patchSize-u has the same magnitudes
+                sum += mirrored ? 2.0 * columnSum : columnSum;
+            }
+            heatmapP[j] = float(sum / double(patchSize * patchSize));
         }
-        hash.at<uchar>(0, byteIdx) = b;
     }
 
-    return hash;
+    return PatchFrequencyHeatmapToHash(heatmap);
 }
 
-cv::Mat ImageHash(const cv::Mat &source, const imageSimilarityAlgorithm &similarityAlgorithm) // return image hash as cv::Mat
+bool TestPatchFrequencyHash(const cv::Mat &image, const int &iterations, double &timeNaive, double &timeFast) // test : compare PatchFrequencyHash with its reference version - returns true if hashes are identical, times are in ms per hash
+{
+    cv::Mat naive, fast;
+
+    int64 start = cv::getTickCount();
+    for (int n = 0; n < iterations; n++)
+        naive = PatchFrequencyHashNaive(image);
+    timeNaive = double(cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency() / double(iterations);
+
+    start = cv::getTickCount();
+    for (int n = 0; n < iterations; n++)
+        fast = PatchFrequencyHash(image);
+    timeFast = double(cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency() / double(iterations);
+
+    return cv::norm(naive, fast, cv::NORM_HAMMING) == 0;
+}
+
+cv::Mat ImageHash(const cv::Mat &source, const imageSimilarityAlgorithm &similarityAlgorithm, const bool &dihedral) // return image hash as cv::Mat
     // not working for features and homography and DNN and dominant colors !
+    // dihedral : pHash, dHash and idHash are computed in canonical orientation, see HashIsDihedral()
 {
     if (source.empty()) {
         return cv::Mat();
@@ -269,6 +502,10 @@ cv::Mat ImageHash(const cv::Mat &source, const imageSimilarityAlgorithm &similar
             break;
         }
         case img_similarity_pHash: {
+            if (dihedral) {
+                hash = PerceptualHashDihedral(source);
+                break;
+            }
             #pragma omp critical
             {
                 cv::Ptr<cv::img_hash::PHash> h = cv::img_hash::PHash::create();
@@ -277,11 +514,11 @@ cv::Mat ImageHash(const cv::Mat &source, const imageSimilarityAlgorithm &similar
             break;
         }
         case img_similarity_dHash: {
-            hash = DifferenceHash(source);
+            hash = DifferenceHash(source, dihedral);
             break;
         }
         case img_similarity_idHash: {
-            hash = ImportantDifferenceHash(source);
+            hash = ImportantDifferenceHash(source, dihedral);
             break;
         }
         case img_similarity_visHash: {
@@ -325,6 +562,11 @@ cv::Mat ImageHash(const cv::Mat &source, const imageSimilarityAlgorithm &similar
     return hash;
 }
 
+bool HashIsDihedral(const int &similarityAlgorithm) // has this algorithm a version invariant to rotations and mirrors ?
+{
+    return (similarityAlgorithm == img_similarity_pHash) or (similarityAlgorithm == img_similarity_dHash) or (similarityAlgorithm == img_similarity_idHash);
+}
+
 ///////////////////////////////////////////////////////////
 //// Compare Hashes
 ///////////////////////////////////////////////////////////
@@ -455,26 +697,22 @@ void ComputeImageDescriptors(const cv::Mat &source, std::vector<cv::KeyPoint> &k
     descriptor->compute(gray, keypoints, descriptors);
 }
 
-float CompareImagesDescriptors(const cv::Mat &descriptors1, const cv::Mat &descriptors2, const float &matchPercent, const int &maxFeatures) // compare two images pre-computed descriptors -> % of similarity
+float CompareImagesDescriptors(const cv::Mat &descriptors1, const cv::Mat &descriptors2, const float &matchPercent, const int &maxFeatures, const float &minScore, const float &maxScore) // compare two images pre-computed descriptors -> % of similarity
+    // the result is exact between minScore and maxScore :
+    //   - below minScore the comparison stops as soon as it can't be reached anymore, the result is then < minScore
+    //   - above maxScore the comparison stops as soon as it is reached, the result is then >= maxScore
+    // default values (0 and 1) always give the exact score
 {
     if ((descriptors1.empty()) or (descriptors2.empty()))
         return 0;
 
-    // find descriptors matches with brute force method and knn
-    cv::Ptr<cv::DescriptorMatcher> matcher = cv::DescriptorMatcher::create(cv::DescriptorMatcher::BRUTEFORCE_HAMMING);
-    std::vector<std::vector<cv::DMatch>> knnMatches;
-    knnMatches.reserve(maxFeatures);
-    matcher->knnMatch(descriptors1, descriptors2, knnMatches, 2);
+    // scores -> number of good matches
+    const int minNeeded = int(std::ceil(minScore * float(maxFeatures)));
+    const int stopAt = (maxScore >= 1.0f) ? -1 : int(std::ceil(maxScore * float(maxFeatures)));
 
-    if (knnMatches.empty())
-        return 0;
-
-    // filter "good" matches with Lowe's ratio test
-    int goodMatches = 0;
-    for (int i = 0; i < int(knnMatches.size()); i++) {
-        if (knnMatches[i][0].distance < matchPercent * knnMatches[i][1].distance) // matchPercent is used here - author suggests 0.8 but tests show that 0.85 is a bit better
-            goodMatches++; // count good matches
-    }
+    // find descriptors matches with brute force method, 2 nearest neighbours and Lowe's ratio test
+    // matchPercent is used here - author suggests 0.8 but tests show that 0.85 is a bit better
+    const int goodMatches = ThreadDescriptorsMatcher().CountGoodMatches(descriptors1, descriptors2, matchPercent, stopAt, minNeeded);
 
     return float(goodMatches) / float(maxFeatures); // percentage is computed from initial number of features
 }
@@ -487,19 +725,8 @@ cv::Mat DrawImageMatchesFromFeatures(const cv::Mat &im1, const cv::Mat &im2,
     if ((im1.empty()) or (im2.empty()) or (keypoints1.empty()) or (keypoints2.empty()) or (descriptors1.empty()) or (descriptors2.empty())) // no keypoints or descriptors, need both for both images
         return cv::Mat(); // return empty image
 
-    // find descriptors matches with brute force method and knn
-    cv::Ptr<cv::DescriptorMatcher> matcher = cv::DescriptorMatcher::create(cv::DescriptorMatcher::BRUTEFORCE_HAMMING);
-    std::vector< std::vector<cv::DMatch>> knnMatches;
-    knnMatches.reserve(maxFeatures);
-    matcher->knnMatch(descriptors1, descriptors2, knnMatches, 2);
-
-    // filter "good" matches with Lowe's ratio test
-    std::vector<cv::DMatch> goodMatches; // good ones will be here
-    goodMatches.reserve(maxFeatures);
-    for (size_t i = 0; i < knnMatches.size(); i++) {
-        if (knnMatches[i][0].distance < matchPercent * knnMatches[i][1].distance)
-            goodMatches.push_back(knnMatches[i][0]);
-    }
+    // find "good" descriptors matches with brute force method, 2 nearest neighbours and Lowe's ratio test
+    std::vector<cv::DMatch> goodMatches = ThreadDescriptorsMatcher().GoodMatches(descriptors1, descriptors2, matchPercent); // copy : the matcher's list is reused by its next call
 
     // draw matches
     cv::Mat imgMatches;
@@ -624,24 +851,11 @@ cv::Mat GetHomographyFromImagesFeatures(const cv::Mat &im1, const cv::Mat &im2,
     if ((keypoints1.empty()) or (keypoints2.empty()) or (descriptors1.empty()) or (descriptors2.empty())) // no keypoints or descriptors found ?
         return cv::Mat(); // return empty H matrix if not found
 
-    // find descriptors matches with brute force method and knn
-    cv::Ptr<cv::DescriptorMatcher> matcher = cv::DescriptorMatcher::create(cv::DescriptorMatcher::BRUTEFORCE_HAMMING);
-    std::vector<std::vector<cv::DMatch>> knnMatches;
-    knnMatches.reserve(maxFeatures);
-    matcher->knnMatch(descriptors1, descriptors2, knnMatches, 2);
+    // find "good" descriptors matches with brute force method, 2 nearest neighbours and Lowe's ratio test
+    // homography theorically needs at least 4 points, in fact it must be at least twice that amount : stop as soon as 8 can't be reached
+    const std::vector<cv::DMatch> &goodMatches = ThreadDescriptorsMatcher().GoodMatches(descriptors1, descriptors2, matchPercent, 8);
 
-    if (knnMatches.empty()) // no matches found ?
-        return cv::Mat(); // return empty H matrix
-
-    // filter "good" matches using Lowe's ratio test
-    std::vector<cv::DMatch> goodMatches;
-    goodMatches.reserve(maxFeatures);
-    for (size_t i = 0; i < knnMatches.size(); i++) {
-        if (knnMatches[i][0].distance < matchPercent * knnMatches[i][1].distance)
-            goodMatches.push_back(knnMatches[i][0]);
-    }
-
-    if (goodMatches.size() < 8) // homography theorically needs at least 4 points, in fact it must be at least twice that amount
+    if (goodMatches.size() < 8) // not enough good matches
         return cv::Mat(); // return empty H matrix
 
     // get keypoints from good matches
@@ -737,23 +951,29 @@ void DNNPrepare(cv::dnn::Net &net, const std::string &model, const std::string &
         net = cv::dnn::readNetFromCaffe(proto, model);
 }
 
+struct struct_dnn_workspace { // buffers for DNNHash, one per thread
+    cv::Mat image; // grow-only storage for WorkspaceBuffer()
+    cv::Mat blob; // always the same size for a model
+};
+
 cv::Mat DNNHash(const cv::Mat &image, cv::dnn::Net &net, const int &size, const cv::Scalar &mean, const int &nbValues) // get hash from model features
     // input image is BGR and optianally resized
     // model should return a list of features in float values
 {
+    thread_local struct_dnn_workspace ws;
+
     // prepare image
-    cv::Mat img;
-    image.copyTo(img);
-    img.convertTo(img, CV_32FC3); // image must be in decimal (float) values
+    cv::Mat img = WorkspaceBuffer(ws.image, image.rows, image.cols, CV_32FC(image.channels()));
+    image.convertTo(img, CV_32F); // image must be in decimal (float) values
 
     // compute blob
-    cv::Mat blob = cv::dnn::blobFromImage(img, 1.0, cv::Size(size, size), mean, false, false, CV_32F); // create blob imput from image
+    cv::dnn::blobFromImage(img, ws.blob, 1.0, cv::Size(size, size), mean, false, false, CV_32F); // create blob imput from image - always the same size : reused
 
     // convolution -> get output
     cv::Mat output;
     #pragma omp critical
     {
-        net.setInput(blob); // use the blob
+        net.setInput(ws.blob); // use the blob
         output =  net.forward(""); // get features
     }
 
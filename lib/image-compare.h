@@ -4,14 +4,16 @@
 #
 #    by AbsurdePhoton - www.absurdephoton.fr
 #
-#                v1.2 - 2026/05/19
+#                v1.6 - 2026/10/19
 #
-#   - OpenCV's and custom hashes algorithms
-#   - Image features and homography
+#   - OpenCV's and custom hashes algorithms - tiny hash inputs in per-thread buffers
+#   - v1.5 : color moments, patch frequency and DNN hashes work in per-thread grow-only buffers : no allocation per image
+#   - v1.6 : pHash, dHash and idHash in canonical orientation : rotated and mirrored copies get the same hash
+#   - Image features and homography - reusable per-thread matcher with early exit
 #   - Compare image palettes
 #   - Image quality
 #   - Image comparison with DNN
-#   - Frequency map comparison
+#   - Frequency map comparison - batched FFT
 #
 #   uses OpenCV Contrib (features and DNN support)
 #
@@ -29,6 +31,7 @@
 #include "color-spaces.h"
 #include "string-utils.h"
 #include "contours.h"
+#include "features-matcher.h"
 
 #include <QCryptographicHash>
 #include <QString>
@@ -65,17 +68,28 @@ static const std::string imageSimilarityDescription[img_similarity_count + 1] =
     "Combine several or all algorithms to compute a final score - set values in the Options tab before launching the comparison"
 };
 
+static const std::string imageSimilarityName[img_similarity_count + 1] = { // short names, like in data/thresholds.cfg
+    "checksum", "ahash", "phash", "dhash", "idhash", "vishash", "blockmean", "colormoments", "marrhildreth", "radialvariance",
+    "dominantcolors", "features", "homography", "dnnclassify", "frequency", "combined"
+};
+
 
 //// Image Hashes
-cv::Mat ImageHash(const cv::Mat &source, const imageSimilarityAlgorithm &similarityAlgorithm); // return image hash as cv::Mat
+cv::Mat ImageHash(const cv::Mat &source, const imageSimilarityAlgorithm &similarityAlgorithm, const bool &dihedral=false); // return image hash as cv::Mat - dihedral : invariant to rotations and mirrors, if HashIsDihedral()
+bool HashIsDihedral(const int &similarityAlgorithm); // has this algorithm a version invariant to rotations and mirrors ? - pHash, dHash and idHash
+void DihedralCanonical(const cv::Mat &square, cv::Mat &canonical); // canonical orientation of a square 1-channel image : the same for its 8 rotations and mirrors
 float ImageHashCompare(const cv::Mat &val1, const cv::Mat &val2, const imageSimilarityAlgorithm &similarityAlgorithm); // compare 2 image hashes, return return % of similarity (NOT for special algorithms)
 std::string Hash8U2String(const cv::Mat &source); // return a hex string from CV_8U hash
 std::string HashChecksum2String(const cv::Mat &source); // return a hex string from checksum hash
+cv::Mat PatchFrequencyHash(const cv::Mat &input, const bool &energy=false); // hash from frequencies by patches - all patches in 2 batched DFTs, or with energy=true from Parseval (faster, different hash)
+cv::Mat PatchFrequencyHashNaive(const cv::Mat &input); // hash from frequencies by patches - reference version, one DFT per patch
+bool TestPatchFrequencyHash(const cv::Mat &image, const int &iterations, double &timeNaive, double &timeFast); // test : compare PatchFrequencyHash with its reference version - returns true if hashes are identical
 //// Image Features and Homography
 void ComputeImageDescriptors(const cv::Mat &source, std::vector<cv::KeyPoint> &keypoints, cv::Mat &descriptors,
                              const bool &resize=true, const int &size=256, const int &maxFeatures=250); // compute image features descriptors with ORB and BEBLID
 float CompareImagesDescriptors(const cv::Mat &descriptors1, const cv::Mat &descriptors2,
-                               const float &matchPercent=0.8f, const int &maxFeatures=250); // compare two images pre-computed descriptors -> % of similarity
+                               const float &matchPercent=0.8f, const int &maxFeatures=250,
+                               const float &minScore=0.0f, const float &maxScore=1.0f); // compare two images pre-computed descriptors -> % of similarity - exact between minScore and maxScore
 cv::Mat DrawImageMatchesFromFeatures(const cv::Mat &im1, const cv::Mat &im2,
                                      std::vector<cv::KeyPoint> &keypoints1, std::vector<cv::KeyPoint> &keypoints2,
                                      cv::Mat &descriptors1, cv::Mat &descriptors2,
@@ -0,0 +1,166 @@
+/*#-------------------------------------------------
+#
+#        Image files library
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.0 - 2026/10/19
+#
+#   - supported image file extensions
+#   - file type and loading engine (OpenCV or Qt) from extension
+#   - load an image file to a BGR cv::Mat - works without a GUI (QImage, not QPixmap)
+#   - list image files in a folder
+#
+#-------------------------------------------------*/
+
+#include "image-files.h"
+#include "image-utils.h"
+#include "string-utils.h"
+
+#include <QImage>
+#include <QString>
+
+#include <filesystem>
+#include <unordered_set>
+
+
+///////////////////////////////////////////////////////////
+//// Extensions and types
+///////////////////////////////////////////////////////////
+
+const std::vector<std::string>& ImageFileExtensions() // all supported extensions, lower case without dot
+{
+    static const std::vector<std::string> extensions = {
+        "jpg", "jpeg", "jpe", "jif", "jfif", // JPEG OK
+        "jp2", "j2k", "jpf", "jpm", "jpg2", "j2c", "jpc", // JPEG2000 OK
+        "jxl", // JPEG XL - supported since OpenCV 4.11
+        "jxr", "wdp", "hdp", // JPEG XR
+        "jps", // JPEG stereoscopic
+        "tif", "tiff", // TIFF OK
+        "png", // PNG OK
+        "webp", // WebP OK
+        "avif", // AVIF OK
+        "bmp", "dib", // Microsoft OK
+        "pbm", "pgm", "ppm", "pam", "pnm", "pfm", // Portable Image Format OK
+        "ras", "sun", "sr", // Sun raster OK
+        "exr", // OpenEXR
+        "hdr", "pic", // Radiance HDR OK
+        // NOT supported by opencv but Qt
+        "heic", "heif", // HEIC
+        "mng", // MNG
+        "tga", // TGA OK
+        "wbmp", // WBMP OK
+        "gif", // GIF OK
+        "xbm", "xpm", // X11 !OK
+        "ico", "cur", // Windows icons and cursors !OK
+        "pcx", // PCX !OK
+        "psd", // Photoshop !OK
+        "sgi", // SGI ? !OK
+        "xwd" // X-windows !OK
+    };
+
+    return extensions;
+}
+
+bool IsImageFile(const std::string &path) // does the file have a supported extension ?
+{
+    static const std::unordered_set<std::string> extensions(ImageFileExtensions().begin(), ImageFileExtensions().end());
+
+    return extensions.count(stringutils::ToLower(stringutils::GetFilenameExtension(path))) > 0;
+}
+
+void ImageFileType(const std::string &extension, std::string &type, std::string &loadwith) // file type (jpeg, png, other...) and loading engine (opencv or qt) from file extension
+{
+    // image file type will tell which engine (OpenCV or Qt) will be used to load it
+    std::string ext = stringutils::ToLower(extension);
+    if ((ext == "jpg") or (ext == "jpeg") or (ext == "jp2") or (ext == "j2k") or (ext == "jpf") or (ext == "jpm") or (ext == "jpg2") or (ext == "j2c") or (ext == "jpc") or (ext == "jpe") or (ext == "jif") or (ext == "jfif") or (ext == "jxl") or (ext == "jxr") or (ext == "wdp") or (ext == "hdp") or (ext == "jps")) { // jxl supported since OpenCV 4.11
+        type = "jpeg";
+        loadwith = "opencv";
+    }
+    else if ((ext == "tif") or (ext == "tiff")) {
+        type = "tiff";
+        loadwith = "opencv";
+    }
+    else if (ext == "png") {
+        type = "png";
+        loadwith = "opencv";
+    }
+    else if (ext == "webp") {
+        type = "webp";
+        loadwith = "opencv";
+    }
+    else if (ext == "avif") {
+        type = "avif";
+        loadwith = "opencv";
+    }
+    else {
+        type = "other";
+
+        if ((ext == "bmp") or (ext == "dib")) // with OpenCV
+            loadwith = "opencv";
+        else if ((ext == "pbm") or (ext == "pgm") or (ext == "ppm") or (ext == "pam") or (ext == "pnm") or (ext == "pfm")) // with OpenCV
+            loadwith = "opencv";
+        else if ((ext == "sr") or (ext == "sun") or (ext == "ras")) // with OpenCV
+            loadwith = "opencv";
+        else if (ext == "exr") // with OpenCV
+            loadwith = "opencv";
+        else if ((ext == "hdr") or (ext == "pic")) // with OpenCV
+            loadwith = "opencv";
+        else if ((ext == "heic") or (ext == "heif")) // with Qt
+            loadwith = "qt";
+        else if (ext == "mng") // with Qt
+            loadwith = "qt";
+        else if (ext == "tga") // with Qt
+            loadwith = "qt";
+        else if (ext == "wbmp") // with Qt
+            loadwith = "qt";
+        else if (ext == "gif") // with Qt
+            loadwith = "qt";
+        else
+            loadwith = "opencv"; // default = OpenCV
+    }
+}
+
+///////////////////////////////////////////////////////////
+//// Load and list
+///////////////////////////////////////////////////////////
+
+cv::Mat LoadImageFile(const std::string &path, const std::string &engine) // BGR image from file with "opencv" or "qt" engine - empty if the file can't be read
+{
+    if (engine == "opencv") {
+        cv::Mat img = cv::imread(path, cv::IMREAD_UNCHANGED);
+
+        img = ImageAnydepthToColor(img);
+
+        return img;
+    }
+    else if (engine == "qt") {
+        QImage img = QImage(QString::fromStdString(path)); // QImage and not QPixmap : can be used in any thread, and without a GUI
+
+        if (!img.isNull())
+            return QImage2Mat(img.convertToFormat(QImage::Format_RGB888)); // this format is copied to a new cv::Mat
+    }
+
+    return cv::Mat();
+}
+
+std::vector<std::string> ListImageFiles(const std::string &folder, const bool &recursive) // image files in a folder, symlinks followed
+{
+    std::vector<std::string> list;
+    std::error_code error;
+
+    if (recursive) {
+        std::filesystem::recursive_directory_iterator dir(folder, std::filesystem::directory_options::follow_directory_symlink | std::filesystem::directory_options::skip_permission_denied, error);
+        for (auto end = std::filesystem::recursive_directory_iterator(); (!error) and (dir != end); dir.increment(error))
+            if ((dir->is_regular_file(error)) and (IsImageFile(dir->path().string())))
+                list.push_back(dir->path().string());
+    }
+    else {
+        std::filesystem::directory_iterator dir(folder, std::filesystem::directory_options::skip_permission_denied, error);
+        for (auto end = std::filesystem::directory_iterator(); (!error) and (dir != end); dir.increment(error))
+            if ((dir->is_regular_file(error)) and (IsImageFile(dir->path().string())))
+                list.push_back(dir->path().string());
+    }
+
+    return list;
+}
@@ -0,0 +1,32 @@
+/*#-------------------------------------------------
+#
+#        Image files library
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.0 - 2026/10/19
+#
+#   - supported image file extensions
+#   - file type and loading engine (OpenCV or Qt) from extension
+#   - load an image file to a BGR cv::Mat - works without a GUI (QImage, not QPixmap)
+#   - list image files in a folder
+#
+#-------------------------------------------------*/
+
+#ifndef IMAGEFILES_H
+#define IMAGEFILES_H
+
+#include "opencv2/opencv.hpp"
+
+#include <string>
+#include <vector>
+
+
+const std::vector<std::string>& ImageFileExtensions(); // all supported extensions, lower case without dot
+bool IsImageFile(const std::string &path); // does the file have a supported extension ?
+void ImageFileType(const std::string &extension, std::string &type, std::string &loadwith); // file type (jpeg, png, other...) and loading engine (opencv or qt) from file extension
+cv::Mat LoadImageFile(const std::string &path, const std::string &engine); // BGR image from file with "opencv" or "qt" engine - empty if the file can't be read
+std::vector<std::string> ListImageFiles(const std::string &folder, const bool &recursive); // image files in a folder, symlinks followed
+
+
+#endif // IMAGEFILES_H
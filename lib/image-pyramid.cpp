@@ -0,0 +1,130 @@
+/*#-------------------------------------------------
+#
+#        Image preprocessing pyramid library
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.0 - 2026/10/19
+#
+#   - one pass per image : INTER_AREA halvings of the original, then the working image,
+#     its normalized and gray versions, and the thumbnail from the same levels
+#   - every intermediate image lives in a per-thread scratch arena
+#
+#   uses OpenCV
+#
+#-------------------------------------------------*/
+
+#include "image-pyramid.h"
+#include "image-transform.h"
+
+
+ImagePyramid &ImagePyramid::ForThread() // the pyramid of the calling thread
+{
+    static thread_local ImagePyramid pyramid;
+
+    return pyramid;
+}
+
+cv::Mat ImagePyramid::Slot(const int &slot, const cv::Size &size, const int &type) // image header on the memory of a slot, grown if needed
+{
+    if (int(arena.size()) <= slot)
+        arena.resize(slot + 1);
+    const size_t bytes = size_t(size.area()) * CV_ELEM_SIZE(type);
+    if (arena[slot].size() < bytes) // only grows : the next images of the batch will fit
+        arena[slot].resize(bytes + bytes / 4);
+
+    return cv::Mat(size, type, arena[slot].data()); // continuous, no allocation by OpenCV as long as the size and type don't change
+}
+
+cv::Mat ImagePyramid::DownScale(const cv::Mat &source, const double &ratio, const int &firstSlot, const int &lastSlot) // QualityDownScaleImage in the arena
+    // halvings alternate between firstSlot and firstSlot + 1, the final resizing goes to lastSlot
+{
+    cv::Mat dest = source;
+    double scale = ratio;
+    int step = 0;
+
+    while (scale < 0.5) { // downscale by 2 as much as needed - same sizes as QualityDownScaleImage
+        cv::Mat half = Slot(firstSlot + (step % 2), cv::Size(int(dest.cols / 2.0), int(dest.rows / 2.0)), dest.type());
+        cv::resize(dest, half, half.size(), 0, 0, cv::INTER_AREA); // INTER_AREA is moire-free for downscale
+        dest = half;
+        scale *= 2.0;
+        step++;
+    }
+
+    if (dest.cols * scale != dest.cols) { // final step
+        cv::Mat last = Slot(lastSlot, cv::Size(int(dest.cols * scale), int(dest.rows * scale)), dest.type());
+        cv::resize(dest, last, last.size(), 0, 0, cv::INTER_AREA);
+        dest = last;
+    }
+
+    return dest;
+}
+
+void ImagePyramid::Build(const cv::Mat &source, const int &reducedSize) // levels, working images - source must stay valid until the next Build
+{
+    const double zoom = std::min(double(reducedSize) / source.cols, double(reducedSize) / source.rows); // like QualityResizeImageAspectRatio
+
+    if (zoom < 1) // most images
+        resized = DownScale(source, zoom, slot_levels, slot_resized);
+    else { // small image : upscaled, not worth the arena
+        cv::Mat upscaled = (zoom == 1) ? source : QualityResizeImageAspectRatio(source, cv::Size(reducedSize, reducedSize));
+        resized = Slot(slot_resized, upscaled.size(), upscaled.type());
+        upscaled.copyTo(resized);
+    }
+
+    reduced = Slot(slot_reduced, resized.size(), resized.type());
+    cv::normalize(resized, reduced, 0, 255, cv::NORM_MINMAX);
+
+    gray = Slot(slot_gray, reduced.size(), CV_MAKETYPE(reduced.depth(), 1));
+    cv::cvtColor(reduced, gray, cv::COLOR_BGR2GRAY);
+}
+
+const cv::Mat &ImagePyramid::Resized() const // working image before normalization
+{
+    return resized;
+}
+
+const cv::Mat &ImagePyramid::Reduced() const // color working image, normalized
+{
+    return reduced;
+}
+
+const cv::Mat &ImagePyramid::Gray() const // gray working image
+{
+    return gray;
+}
+
+cv::Mat ImagePyramid::Thumbnail(const int &size) // resized image fitting in size x size, from the working image
+{
+    const double zoom = std::min(double(size) / resized.cols, double(size) / resized.rows);
+
+    if (zoom < 1)
+        return DownScale(resized, zoom, slot_levels + 2, slot_thumbnail); // its own halving slots : the working image stays valid
+    if (zoom == 1)
+        return resized;
+
+    return QualityResizeImageAspectRatio(resized, cv::Size(size, size)); // working image smaller than the thumbnail
+}
+
+cv::Mat ImagePyramid::Scratch(const cv::Size &size, const int &type) // free arena memory for the caller, valid until the next Build
+{
+    return Slot(slot_scratch, size, type);
+}
+
+size_t ImagePyramid::ArenaBytes() const // memory held by the arena
+{
+    size_t bytes = 0;
+    for (const std::vector<unsigned char> &buffer : arena)
+        bytes += buffer.size();
+
+    return bytes;
+}
+
+void ImagePyramid::Release() // give the arena memory back, at the end of a batch
+{
+    arena.clear();
+    arena.shrink_to_fit();
+    resized = cv::Mat();
+    reduced = cv::Mat();
+    gray = cv::Mat();
+}
@@ -0,0 +1,60 @@
+/*#-------------------------------------------------
+#
+#        Image preprocessing pyramid library
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.0 - 2026/10/19
+#
+#   - one pass per image : INTER_AREA halvings of the original, then the working image,
+#     its normalized and gray versions, and the thumbnail from the same levels
+#   - same pixels as QualityResizeImageAspectRatio + cv::normalize + cv::cvtColor : hashes and scores don't change
+#   - every intermediate image lives in a per-thread scratch arena : buffers only grow,
+#     after the first images of a batch a new image needs no memory allocation
+#   - images returned by the pyramid point to the arena : valid until the next Build() of the same thread,
+#     clone() what must be kept
+#
+#   uses OpenCV
+#
+# Example :
+#   ImagePyramid &pyramid = ImagePyramid::ForThread();
+#   pyramid.Build(original, 256);
+#   image.reduced = pyramid.Reduced().clone(); // kept : copied out of the arena
+#   cv::Mat icon = pyramid.Thumbnail(128); // used now : no copy
+#
+#-------------------------------------------------*/
+
+#ifndef IMAGEPYRAMID_H
+#define IMAGEPYRAMID_H
+
+#include "opencv2/opencv.hpp"
+
+#include <vector>
+
+
+class ImagePyramid // preprocessing of one image at a time, memory reused between images
+{
+public:
+    static ImagePyramid &ForThread(); // the pyramid of the calling thread
+
+    void Build(const cv::Mat &source, const int &reducedSize); // levels, working images - source must stay valid until the next Build
+    const cv::Mat &Resized() const; // working image before normalization, like QualityResizeImageAspectRatio(source, reducedSize)
+    const cv::Mat &Reduced() const; // color working image, normalized
+    const cv::Mat &Gray() const; // gray working image
+    cv::Mat Thumbnail(const int &size); // resized image fitting in size x size, like QualityResizeImageAspectRatio(Resized(), size)
+    cv::Mat Scratch(const cv::Size &size, const int &type); // free arena memory for the caller, valid until the next Build
+    size_t ArenaBytes() const; // memory held by the arena
+    void Release(); // give the arena memory back, at the end of a batch
+
+private:
+    enum arenaSlot {slot_resized, slot_reduced, slot_gray, slot_thumbnail, slot_scratch, slot_levels}; // halvings use the slots after slot_levels
+
+    cv::Mat Slot(const int &slot, const cv::Size &size, const int &type); // image header on the memory of a slot, grown if needed
+    cv::Mat DownScale(const cv::Mat &source, const double &ratio, const int &firstSlot, const int &lastSlot); // QualityDownScaleImage in the arena
+
+    std::vector<std::vector<unsigned char>> arena; // one buffer per slot
+    cv::Mat resized, reduced, gray;
+};
+
+
+#endif // IMAGEPYRAMID_H
@@ -421,7 +421,7 @@ void PasteImageAlphaRotated(cv::Mat &background, const cv::Mat &foreground, cons
     int dY = centerY;
     cv::Mat dst = RotateImage(foreground, angleRad, destX, destY, dX, dY); // get rotated image + shift
 
-    PasteImageAlpha(background, dst, cv::Point(destX + dX, destY + dY)); // paste image on background
+    PasteImageAlphaFast(background, dst, cv::Point(destX + dX, destY + dY)); // paste image on background
 }
 
 ///////////////////////////////////////////////////////////
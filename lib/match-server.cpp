@@ -0,0 +1,417 @@
+/*#-------------------------------------------------
+#
+#        Matching server library
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.0 - 2026/10/19
+#
+#   - one catalog of signatures in memory, shared by all the clients of a Unix domain socket
+#   - queries waiting at the same time are searched as one batch
+#
+#   standard C++ and POSIX only
+#
+#-------------------------------------------------*/
+
+#include "match-server.h"
+
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+
+
+static const size_t latenciesSize = 10000; // queries kept for percentiles
+static const double qpsWindow = 10.0; // seconds, for the current queries per second
+static const int maxClients = 64; // clients connected at the same time, the next ones are turned away
+
+///////////////////////////////////////////////////////////
+//// Server
+///////////////////////////////////////////////////////////
+
+MatchServer::MatchServer(ImageCatalog &catalog, const struct_catalog_thresholds &thresholds, const int &reducedSize)
+    : catalog(catalog), thresholds(thresholds), reducedSize(reducedSize)
+{
+    latencies.reserve(latenciesSize);
+}
+
+MatchServer::~MatchServer() // stopped if running
+{
+    Stop();
+}
+
+bool MatchServer::Start(const std::string &path, std::string &error) // listen on a Unix domain socket - returns immediately
+{
+    if (running)
+        return true;
+
+    struct sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        error = "socket path is too long";
+        return false;
+    }
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0) {
+        error = std::strerror(errno);
+        return false;
+    }
+
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0); // a socket file left by a crashed server is removed, not the one of a running server
+    if (probe >= 0) {
+        if (connect(probe, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0)
+            unlink(path.c_str());
+        close(probe);
+    }
+
+    if ((bind(listener, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) or (listen(listener, 64) != 0)) {
+        error = std::strerror(errno);
+        close(listener);
+        listener = -1;
+        return false;
+    }
+
+    socketPath = path;
+    startTime = std::chrono::steady_clock::now();
+    searcherStopping = false;
+    running = true;
+    searchThread = std::thread(&MatchServer::SearchLoop, this);
+    acceptThread = std::thread(&MatchServer::AcceptLoop, this);
+
+    return true;
+}
+
+void MatchServer::Stop() // close the socket, wait for clients and searches to finish
+{
+    if (!running)
+        return;
+
+    running = false;
+    acceptThread.join(); // it wakes up regularly to check running
+
+    {
+        std::unique_lock<std::mutex> lock(clientsMutex); // clients finish their current request
+        clientsFinished.wait(lock, [this]() { return clients == 0; });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex); // no client left to queue a query : the searcher can stop
+        searcherStopping = true;
+    }
+    queueReady.notify_all();
+    searchThread.join();
+
+    close(listener);
+    listener = -1;
+    unlink(socketPath.c_str());
+}
+
+bool MatchServer::IsRunning() const
+{
+    return running;
+}
+
+void MatchServer::Flush() // write the catalog changes to disk
+{
+    std::unique_lock<std::shared_mutex> lock(catalogMutex);
+    catalog.Flush();
+}
+
+void MatchServer::AcceptLoop() // new clients
+{
+    while (running) {
+        struct pollfd descriptor = {listener, POLLIN, 0};
+        if (poll(&descriptor, 1, 200) <= 0) // timeout : check running again
+            continue;
+
+        int client = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0)
+            continue;
+
+        {
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            if (clients >= maxClients) { // one thread per client : their number is limited
+                const std::string response = "ERROR too many clients\n\n";
+                send(client, response.data(), response.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+                close(client);
+                continue;
+            }
+            clients++;
+        }
+        std::thread(&MatchServer::ClientLoop, this, client).detach(); // one thread per client : the probe image is read and hashed in it
+    }
+}
+
+void MatchServer::ClientLoop(int client) // requests of one client
+{
+    std::string buffer;
+    char data[4096];
+
+    while (running) {
+        struct pollfd descriptor = {client, POLLIN, 0};
+        int ready = poll(&descriptor, 1, 200);
+        if (ready == 0) // timeout : check running again
+            continue;
+        if ((ready < 0) and (errno == EINTR))
+            continue;
+        if (ready < 0)
+            break;
+
+        ssize_t length = read(client, data, sizeof(data));
+        if (length <= 0) // disconnected
+            break;
+        buffer.append(data, length);
+
+        size_t end;
+        bool failed = false;
+        while ((!failed) and ((end = buffer.find('\n')) != std::string::npos)) { // complete requests
+            std::string line = buffer.substr(0, end);
+            buffer.erase(0, end + 1);
+            if ((!line.empty()) and (line.back() == '\r'))
+                line.pop_back();
+
+            const std::string response = Request(line) + "\n"; // empty line = end of response
+            size_t sent = 0;
+            while (sent < response.size()) {
+                ssize_t written = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+                if (written <= 0) {
+                    failed = true;
+                    break;
+                }
+                sent += written;
+            }
+        }
+        if (failed)
+            break;
+    }
+
+    close(client);
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    clients--;
+    clientsFinished.notify_all();
+}
+
+std::string MatchServer::Request(const std::string &line) // answer one request
+{
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        requests++;
+    }
+
+    std::istringstream stream(line);
+    std::string command;
+    stream >> command;
+    std::string argument;
+    std::getline(stream >> std::ws, argument); // the rest of the line : paths can have spaces
+
+    if (command == "PING")
+        return "OK\n";
+
+    if (command == "STATS")
+        return "OK\n" + Stats();
+
+    if (command == "QUERY") {
+        std::istringstream arguments(argument);
+        int top;
+        std::string path;
+        if (!(arguments >> top))
+            return "ERROR usage : QUERY <top> <image path>\n";
+        std::getline(arguments >> std::ws, path);
+        if (path.empty())
+            return "ERROR usage : QUERY <top> <image path>\n";
+        return Query(top, CatalogPath(path)); // like the paths in catalog : the probe is excluded from its own results
+    }
+
+    if (command == "INSERT") {
+        if (argument.empty())
+            return "ERROR usage : INSERT <image path>\n";
+        struct_image_signature signature;
+        if (!ComputeImageSignature(CatalogPath(argument), reducedSize, signature)) // outside the lock : the slow part
+            return "ERROR the image could not be read\n";
+        int id;
+        {
+            std::unique_lock<std::shared_mutex> lock(catalogMutex);
+            id = catalog.Put(signature);
+        }
+        std::lock_guard<std::mutex> lock(statsMutex);
+        inserts++;
+        return "OK " + std::to_string(id) + "\n";
+    }
+
+    if (command == "DELETE") {
+        if (argument.empty())
+            return "ERROR usage : DELETE <image path>\n";
+        const std::string path = CatalogPath(argument); // a deleted file can't be resolved : only absolute and normalized
+        {
+            std::unique_lock<std::shared_mutex> lock(catalogMutex);
+            if (catalog.Find(path) < 0)
+                return "ERROR not in catalog\n";
+            catalog.Remove(path);
+        }
+        std::lock_guard<std::mutex> lock(statsMutex);
+        deletes++;
+        return "OK\n";
+    }
+
+    return "ERROR unknown command, use PING, QUERY, INSERT, DELETE or STATS\n";
+}
+
+std::string MatchServer::Query(const int &top, const std::string &path) // signature here, search by the searcher thread
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    struct_pending_query query;
+    query.top = std::max(0, top);
+    query.signature.path = path; // the searcher excludes the probe itself if it is in catalog
+    if (!ComputeImageSignature(path, reducedSize, query.signature))
+        return "ERROR the image could not be read\n";
+
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        queue.push_back(&query);
+        queueReady.notify_one();
+        queryDone.wait(lock, [&query]() { return query.done; });
+    }
+
+    std::ostringstream response;
+    response << std::fixed << std::setprecision(2);
+    response << "OK " << query.results.size() << "\n";
+    for (size_t n = 0; n < query.results.size(); n++)
+        response << query.results[n].score << "\t" << (query.results[n].exact ? "yes" : "no") << "\t"
+                 << query.results[n].pHash << "\t" << query.results[n].dHash << "\t" << query.paths[n] << "\n";
+
+    RecordLatency(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+    return response.str();
+}
+
+void MatchServer::SearchLoop() // batches of queries
+{
+    while (true) {
+        std::vector<struct_pending_query*> batch;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueReady.wait(lock, [this]() { return (!queue.empty()) or (searcherStopping); });
+            if (queue.empty()) // stopped : all clients are gone, no query can arrive anymore
+                return;
+            batch.assign(queue.begin(), queue.end()); // all the queries that arrived during the last search
+            queue.clear();
+        }
+
+        std::vector<struct_image_signature> signatures;
+        int top = 0; // the largest request, 0 = all
+        bool all = false;
+        for (struct_pending_query *query : batch) {
+            signatures.push_back(query->signature);
+            if (query->top == 0)
+                all = true;
+            top = std::max(top, query->top);
+        }
+        if (all)
+            top = 0;
+
+        {
+            std::shared_lock<std::shared_mutex> lock(catalogMutex);
+            std::vector<int> excludes;
+            for (const struct_image_signature &signature : signatures)
+                excludes.push_back(catalog.Find(signature.path));
+
+            std::vector<std::vector<struct_catalog_result>> results = catalog.QueryRankedBatch(signatures, thresholds, top, excludes);
+            for (size_t n = 0; n < batch.size(); n++) {
+                if ((batch[n]->top > 0) and (int(results[n].size()) > batch[n]->top))
+                    results[n].resize(batch[n]->top);
+                for (const struct_catalog_result &result : results[n])
+                    batch[n]->paths.push_back(catalog.Signature(result.id).path);
+                batch[n]->results = std::move(results[n]);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            for (struct_pending_query *query : batch)
+                query->done = true;
+        }
+        queryDone.notify_all();
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        batches++;
+        batchedQueries += batch.size();
+    }
+}
+
+///////////////////////////////////////////////////////////
+//// Statistics
+///////////////////////////////////////////////////////////
+
+void MatchServer::RecordLatency(const double &milliseconds)
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    queries++;
+    const auto entry = std::make_pair(std::chrono::steady_clock::now(), milliseconds);
+    if (latencies.size() < latenciesSize)
+        latencies.push_back(entry);
+    else
+        latencies[latencyNext] = entry;
+    latencyNext = (latencyNext + 1) % latenciesSize;
+}
+
+std::string MatchServer::Stats() // name=value lines
+{
+    int images;
+    {
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        images = catalog.Count();
+    }
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    const auto now = std::chrono::steady_clock::now();
+    const double uptime = std::chrono::duration<double>(now - startTime).count();
+
+    std::vector<double> values;
+    values.reserve(latencies.size());
+    auto oldest = now;
+    int recent = 0; // queries in the qps window
+    for (const auto &entry : latencies) {
+        values.push_back(entry.second);
+        oldest = std::min(oldest, entry.first);
+        if (std::chrono::duration<double>(now - entry.first).count() <= qpsWindow)
+            recent++;
+    }
+    double window = std::min(qpsWindow, uptime);
+    if ((latencies.size() == latenciesSize) and (recent == int(latenciesSize))) // more queries than kept in the window : use the kept ones only
+        window = std::chrono::duration<double>(now - oldest).count();
+
+    auto percentile = [&values](const double &p) { // nearest rank
+        if (values.empty())
+            return 0.0;
+        size_t rank = std::min(values.size() - 1, size_t(p * double(values.size())));
+        std::nth_element(values.begin(), values.begin() + rank, values.end());
+        return values[rank];
+    };
+
+    std::ostringstream stats;
+    stats << std::fixed << std::setprecision(3);
+    stats << "images=" << images << "\n"
+          << "uptime_s=" << uptime << "\n"
+          << "requests=" << requests << "\n"
+          << "queries=" << queries << "\n"
+          << "inserts=" << inserts << "\n"
+          << "deletes=" << deletes << "\n"
+          << "qps=" << ((window > 0) ? double(recent) / window : 0.0) << "\n"
+          << "qps_total=" << ((uptime > 0) ? double(queries) / uptime : 0.0) << "\n"
+          << "query_p50_ms=" << percentile(0.50) << "\n"
+          << "query_p99_ms=" << percentile(0.99) << "\n"
+          << "batches=" << batches << "\n"
+          << "average_batch=" << ((batches > 0) ? double(batchedQueries) / double(batches) : 0.0) << "\n";
+
+    return stats.str();
+}
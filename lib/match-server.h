@@ -0,0 +1,110 @@
+/*#-------------------------------------------------
+#
+#        Matching server library
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.0 - 2026/10/19
+#
+#   - one catalog of signatures in memory, shared by all the clients of a Unix domain socket
+#   - text protocol, one request per line, each response ends with an empty line :
+#       PING                       -> OK
+#       QUERY <top> <image path>   -> OK <n>, then n lines : score, exact, phash %, dhash %, catalog image (tab-separated)
+#       INSERT <image path>        -> OK <id>
+#       DELETE <image path>        -> OK, or ERROR not in catalog
+#       STATS                      -> OK, then name=value lines : images, queries, qps, p50 and p99 latency (ms)...
+#     errors : ERROR <message>
+#     more than 64 clients at the same time : ERROR too many clients, then the connection is closed
+#     image paths are resolved like the catalog paths (see CatalogPath) : relative paths are relative to the server's folder
+#   - signatures of probe images are computed by the clients threads, in parallel
+#   - queries waiting at the same time are searched as one batch, see ImageCatalog::QueryRankedBatch
+#   - reads (queries) share the catalog, writes (insert, delete) are exclusive
+#
+#   standard C++ and POSIX only
+#
+# Example :
+#   MatchServer server(catalog, thresholds, 256);
+#   server.Start("/tmp/image-match.sock", error);
+#   ... server.Stats() ...
+#   server.Stop();
+#
+#-------------------------------------------------*/
+
+#ifndef MATCHSERVER_H
+#define MATCHSERVER_H
+
+#include "image-catalog.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <chrono>
+
+
+class MatchServer // answers match requests on a local socket
+{
+public:
+    MatchServer(ImageCatalog &catalog, const struct_catalog_thresholds &thresholds, const int &reducedSize);
+    ~MatchServer(); // stopped if running
+
+    bool Start(const std::string &socketPath, std::string &error); // listen on a Unix domain socket - returns immediately
+    void Stop(); // close the socket, wait for clients and searches to finish - the searcher stops after the last client
+    bool IsRunning() const;
+    std::string Stats(); // name=value lines
+    void Flush(); // write the catalog changes to disk
+
+private:
+    struct struct_pending_query { // a query waiting for the searcher
+        struct_image_signature signature;
+        int top; // maximum results, 0 = all
+        std::vector<struct_catalog_result> results;
+        std::vector<std::string> paths; // paths of results, copied while the catalog is locked
+        bool done = false;
+    };
+
+    void AcceptLoop(); // new clients
+    void ClientLoop(int client); // requests of one client
+    void SearchLoop(); // batches of queries
+    std::string Request(const std::string &line); // answer one request
+    std::string Query(const int &top, const std::string &path);
+    void RecordLatency(const double &milliseconds);
+
+    ImageCatalog &catalog;
+    struct_catalog_thresholds thresholds;
+    int reducedSize;
+    std::shared_mutex catalogMutex; // queries share, insert and delete are exclusive
+
+    int listener = -1; // listening socket
+    std::string socketPath;
+    std::atomic<bool> running {false};
+    std::thread acceptThread;
+    std::thread searchThread;
+    int clients = 0; // client threads still running
+    std::mutex clientsMutex;
+    std::condition_variable clientsFinished;
+
+    std::deque<struct_pending_query*> queue; // queries waiting for the searcher
+    std::mutex queueMutex;
+    std::condition_variable queueReady; // new queries for the searcher
+    std::condition_variable queryDone; // results for the clients
+    bool searcherStopping = false; // set by Stop() once all clients are gone, protected by queueMutex
+
+    std::mutex statsMutex; // statistics
+    std::vector<std::pair<std::chrono::steady_clock::time_point, double>> latencies; // last queries : end time and latency (ms), ring buffer
+    size_t latencyNext = 0;
+    long long requests = 0;
+    long long queries = 0;
+    long long inserts = 0;
+    long long deletes = 0;
+    long long batches = 0;
+    long long batchedQueries = 0;
+    std::chrono::steady_clock::time_point startTime;
+};
+
+
+#endif // MATCHSERVER_H
@@ -4,9 +4,10 @@
 #
 #    by AbsurdePhoton - www.absurdephoton.fr
 #
-#                v1.0 - 2021/04/19
+#                v1.1 - 2026/10/19
 #
 #   - Header-only
+#   - v1.1 : RandomizeSeed() for reproducible sequences - each thread has its own generator
 #
 #-------------------------------------------------*/
 
@@ -14,6 +15,7 @@
 #define RANDOMIZER_H
 
 #include <random>
+#include <cstdint>
 
 // randomizer, call it with random<type>(min_val, max_val) - e.g. : random<double>(0.3, 1.75)
 template<class T>
@@ -28,13 +30,24 @@ typename std::conditional<
     >::type
 >::type;
 
+inline std::mt19937_64& RandomizerEngine() // generator of the calling thread
+{
+    static thread_local std::mt19937_64 mt(std::random_device{}());
+
+    return mt;
+}
+
+inline void RandomizeSeed(const uint64_t &seed) // same seed = same sequence of numbers, in the calling thread only
+{
+    RandomizerEngine().seed(seed);
+}
+
 template <class T>
 T Randomize(T lower, T upper)
 {
-    static thread_local std::mt19937_64 mt(std::random_device{}());
     uniform_distribution<T> dist(lower,upper);
 
-    return dist(mt);
+    return dist(RandomizerEngine());
 }
 
 #endif // RANDOMIZER_H
@@ -0,0 +1,195 @@
+/*#-------------------------------------------------
+#
+#     64-bit hashes index library
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.1 - 2026/10/19
+#
+#   - find all hashes within a Hamming distance of a query hash, without comparing it to all of them
+#   - multi-index hashing : each hash is cut in 4 chunks of 16 bits, one table per chunk
+#     if 2 hashes are within distance d, at least one of their chunks is within d/4 (pigeonhole)
+#     -> only the table entries close to the query chunks are read, then candidates are verified
+#   - the cost of a query depends on the distance, not on the number of hashes
+#   - v1.1 : batch of queries - a large distance reads the hashes array once for the whole batch
+#
+#   standard C++ only
+#
+#-------------------------------------------------*/
+
+#include "signature-index.h"
+
+#include <algorithm>
+#include <bitset>
+
+
+static inline uint16_t Chunk(const uint64_t &hash, const int &chunk) // 16 bits of a hash
+{
+    return uint16_t(hash >> (16 * chunk));
+}
+
+static void ChunkNeighbors(const uint16_t &value, const int &radius, std::vector<uint16_t> &neighbors) // all 16-bit values within radius bits of value
+{
+    neighbors.clear();
+    neighbors.push_back(value);
+    if (radius >= 1)
+        for (int a = 0; a < 16; a++) {
+            neighbors.push_back(value ^ uint16_t(1 << a));
+            if (radius >= 2)
+                for (int b = a + 1; b < 16; b++) {
+                    neighbors.push_back(value ^ uint16_t((1 << a) | (1 << b)));
+                    if (radius >= 3)
+                        for (int c = b + 1; c < 16; c++) {
+                            neighbors.push_back(value ^ uint16_t((1 << a) | (1 << b) | (1 << c)));
+                            if (radius >= 4)
+                                for (int d = c + 1; d < 16; d++)
+                                    neighbors.push_back(value ^ uint16_t((1 << a) | (1 << b) | (1 << c) | (1 << d)));
+                        }
+                }
+        }
+}
+
+SignatureIndex::SignatureIndex()
+{
+    for (int c = 0; c < chunksCount; c++)
+        tables[c].resize(1 << 16);
+}
+
+void SignatureIndex::Clear()
+{
+    for (int c = 0; c < chunksCount; c++)
+        for (auto &bucket : tables[c])
+            bucket.clear();
+    hashes.clear();
+    present.clear();
+    count = 0;
+}
+
+void SignatureIndex::Add(const int &id, const uint64_t &hash) // id >= 0 - adding an id again replaces its hash
+{
+    if (id < 0)
+        return;
+    if (Contains(id))
+        Remove(id);
+
+    if (id >= int(hashes.size())) {
+        hashes.resize(id + 1, 0);
+        present.resize(id + 1, false);
+    }
+    hashes[id] = hash;
+    present[id] = true;
+    for (int c = 0; c < chunksCount; c++)
+        tables[c][Chunk(hash, c)].push_back(id);
+    count++;
+}
+
+void SignatureIndex::Remove(const int &id)
+{
+    if (!Contains(id))
+        return;
+
+    for (int c = 0; c < chunksCount; c++) {
+        std::vector<int> &bucket = tables[c][Chunk(hashes[id], c)];
+        auto found = std::find(bucket.begin(), bucket.end(), id);
+        if (found != bucket.end()) { // order in a bucket doesn't matter : swap with the last one
+            *found = bucket.back();
+            bucket.pop_back();
+        }
+    }
+    present[id] = false;
+    count--;
+}
+
+bool SignatureIndex::Contains(const int &id) const
+{
+    return (id >= 0) and (id < int(present.size())) and (present[id]);
+}
+
+int SignatureIndex::Count() const // number of hashes in index
+{
+    return count;
+}
+
+int SignatureIndex::Distance(const uint64_t &hash1, const uint64_t &hash2) // number of different bits
+{
+    return int(std::bitset<64>(hash1 ^ hash2).count()); // popcount
+}
+
+std::vector<std::pair<int, int>> SignatureIndex::Query(const uint64_t &hash, const int &maxDistance) const // all (id, distance) within maxDistance bits, sorted by distance
+{
+    std::vector<std::pair<int, int>> result;
+    if (maxDistance < 0)
+        return result;
+    if (maxDistance >= 20) // too many neighbors to enumerate : reading everything is faster
+        return QueryBruteForce(hash, maxDistance);
+
+    const int radius = maxDistance / chunksCount; // pigeonhole : at least one chunk is within this radius
+    std::vector<uint16_t> neighbors;
+    std::vector<int> candidates;
+    for (int c = 0; c < chunksCount; c++) {
+        ChunkNeighbors(Chunk(hash, c), radius, neighbors);
+        for (const uint16_t &value : neighbors) {
+            const std::vector<int> &bucket = tables[c][value];
+            candidates.insert(candidates.end(), bucket.begin(), bucket.end());
+        }
+    }
+    std::sort(candidates.begin(), candidates.end()); // a hash can be found in several chunks
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    for (const int &id : candidates) { // verify the whole hash
+        const int distance = Distance(hash, hashes[id]);
+        if (distance <= maxDistance)
+            result.push_back(std::make_pair(id, distance));
+    }
+    std::stable_sort(result.begin(), result.end(), [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.second < b.second; });
+
+    return result;
+}
+
+std::vector<std::vector<std::pair<int, int>>> SignatureIndex::QueryBatch(const std::vector<uint64_t> &queries, const int &maxDistance) const // Query() for several hashes at once
+{
+    std::vector<std::vector<std::pair<int, int>>> results(queries.size());
+    if (maxDistance < 0)
+        return results;
+
+    if (maxDistance < 20) { // few candidates per query : the tables are better than any scan
+        for (size_t q = 0; q < queries.size(); q++)
+            results[q] = Query(queries[q], maxDistance);
+        return results;
+    }
+
+    // scan : the hashes are read in blocks that stay in the L1 cache while all the queries are compared to them
+    const int blockSize = 2048; // 16 KB of hashes
+    for (int start = 0; start < int(hashes.size()); start += blockSize) {
+        const int end = std::min(int(hashes.size()), start + blockSize);
+        for (size_t q = 0; q < queries.size(); q++) {
+            const uint64_t query = queries[q];
+            for (int id = start; id < end; id++) {
+                if (!present[id])
+                    continue;
+                const int distance = Distance(query, hashes[id]);
+                if (distance <= maxDistance)
+                    results[q].push_back(std::make_pair(id, distance));
+            }
+        }
+    }
+    for (std::vector<std::pair<int, int>> &result : results)
+        std::stable_sort(result.begin(), result.end(), [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.second < b.second; });
+
+    return results;
+}
+
+std::vector<std::pair<int, int>> SignatureIndex::QueryBruteForce(const uint64_t &hash, const int &maxDistance) const // same result, comparing all hashes - reference for tests
+{
+    std::vector<std::pair<int, int>> result;
+    for (int id = 0; id < int(hashes.size()); id++) {
+        if (!present[id])
+            continue;
+        const int distance = Distance(hash, hashes[id]);
+        if (distance <= maxDistance)
+            result.push_back(std::make_pair(id, distance));
+    }
+    std::stable_sort(result.begin(), result.end(), [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.second < b.second; });
+
+    return result;
+}
@@ -0,0 +1,59 @@
+/*#-------------------------------------------------
+#
+#     64-bit hashes index library
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.1 - 2026/10/19
+#
+#   - find all hashes within a Hamming distance of a query hash, without comparing it to all of them
+#   - multi-index hashing : each hash is cut in 4 chunks of 16 bits, one table per chunk
+#     if 2 hashes are within distance d, at least one of their chunks is within d/4 (pigeonhole)
+#     -> only the table entries close to the query chunks are read, then candidates are verified
+#   - the cost of a query depends on the distance, not on the number of hashes
+#   - v1.1 : batch of queries - a large distance reads the hashes array once for the whole batch
+#
+#   standard C++ only
+#
+# Example :
+#   SignatureIndex index;
+#   index.Add(image, hash);
+#   std::vector<std::pair<int, int>> found = index.Query(hash, 12); // (image, distance)
+#
+#-------------------------------------------------*/
+
+#ifndef SIGNATUREINDEX_H
+#define SIGNATUREINDEX_H
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+
+class SignatureIndex // hashes of 64 bits, searched by Hamming distance
+{
+public:
+    SignatureIndex();
+
+    void Clear();
+    void Add(const int &id, const uint64_t &hash); // id >= 0 - adding an id again replaces its hash
+    void Remove(const int &id);
+    bool Contains(const int &id) const;
+    int Count() const; // number of hashes in index
+
+    std::vector<std::pair<int, int>> Query(const uint64_t &hash, const int &maxDistance) const; // all (id, distance) within maxDistance bits, sorted by distance
+    std::vector<std::vector<std::pair<int, int>>> QueryBatch(const std::vector<uint64_t> &queries, const int &maxDistance) const; // Query() for several hashes at once
+    std::vector<std::pair<int, int>> QueryBruteForce(const uint64_t &hash, const int &maxDistance) const; // same result, comparing all hashes - reference for tests
+
+    static int Distance(const uint64_t &hash1, const uint64_t &hash2); // number of different bits
+
+private:
+    static const int chunksCount = 4; // 4 x 16 bits
+    std::vector<std::vector<int>> tables[chunksCount]; // chunk value -> ids
+    std::vector<uint64_t> hashes; // id -> hash
+    std::vector<char> present; // id -> in index ?
+    int count = 0;
+};
+
+
+#endif // SIGNATUREINDEX_H
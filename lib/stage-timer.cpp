@@ -0,0 +1,235 @@
+/*#-------------------------------------------------
+#
+#        Stage timers library
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.0 - 2026/10/19
+#
+#   - scoped timers around the stages of a long operation
+#   - each thread writes to its own counters : no lock and no shared cache line while measuring
+#   - Chrome trace-event JSON export
+#
+#   standard C++ only
+#
+#-------------------------------------------------*/
+
+#include "stage-timer.h"
+
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <fstream>
+#include <algorithm>
+#include <limits>
+
+
+///////////////////////////////////////////////////////////
+//// Per-thread data
+///////////////////////////////////////////////////////////
+
+struct struct_stage_counter { // one stage in one thread - written by its thread only, read by Summary()
+    std::atomic<long long> calls {0}; // relaxed atomics : same cost as plain integers for the owner, and safe to read from another thread
+    std::atomic<long long> total {0}; // ns
+    std::atomic<long long> min {std::numeric_limits<long long>::max()};
+    std::atomic<long long> max {0};
+};
+
+struct struct_stage_event { // one timed call, for the trace
+    int stage;
+    long long start; // ns
+    long long duration; // ns
+};
+
+struct struct_stage_thread { // all the measures of one thread
+    int id; // small number for the trace
+    struct_stage_counter counters[StageTimer::maxStages];
+    std::vector<struct_stage_event> events;
+    std::mutex eventsMutex; // only locked by its thread, and by exports : never contended while measuring
+};
+
+struct struct_stage_registry { // stages names and threads list - not used while measuring
+    std::mutex mutex;
+    std::vector<std::string> stageNames;
+    std::vector<std::unique_ptr<struct_stage_thread>> threads; // never deleted : a thread can end, its measures stay
+    std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+};
+
+static struct_stage_registry& Registry() // created on first use : stages can be created by static variables of other files
+{
+    static struct_stage_registry registry;
+
+    return registry;
+}
+
+static std::atomic<bool> enabled {true};
+
+static struct_stage_thread& ThreadData() // counters of the calling thread, created on first use
+{
+    static thread_local struct_stage_thread *data = nullptr;
+    if (data == nullptr) {
+        struct_stage_registry &registry = Registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.threads.push_back(std::make_unique<struct_stage_thread>());
+        data = registry.threads.back().get();
+        data->id = int(registry.threads.size());
+    }
+
+    return *data;
+}
+
+///////////////////////////////////////////////////////////
+//// Stage timer
+///////////////////////////////////////////////////////////
+
+int StageTimer::Stage(const std::string &name) // id of a stage, created if needed
+{
+    struct_stage_registry &registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::vector<std::string> &stageNames = registry.stageNames;
+    for (int n = 0; n < int(stageNames.size()); n++)
+        if (stageNames[n] == name)
+            return n;
+    if (int(stageNames.size()) >= maxStages) // all stages used : the last one is shared
+        return maxStages - 1;
+    stageNames.push_back(name);
+
+    return int(stageNames.size()) - 1;
+}
+
+void StageTimer::SetEnabled(const bool &value) // disabled = ScopedStage does nothing
+{
+    enabled = value;
+}
+
+bool StageTimer::IsEnabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+long long StageTimer::Now() // ns since the first use
+{
+    static const std::chrono::steady_clock::time_point origin = Registry().origin;
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+void StageTimer::Record(const int &stage, const long long &start, const long long &duration) // one timed call
+{
+    if ((stage < 0) or (stage >= maxStages))
+        return;
+
+    struct_stage_thread &data = ThreadData();
+    struct_stage_counter &counter = data.counters[stage];
+    counter.calls.store(counter.calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); // only this thread writes : no read-modify-write needed
+    counter.total.store(counter.total.load(std::memory_order_relaxed) + duration, std::memory_order_relaxed);
+    if (duration < counter.min.load(std::memory_order_relaxed))
+        counter.min.store(duration, std::memory_order_relaxed);
+    if (duration > counter.max.load(std::memory_order_relaxed))
+        counter.max.store(duration, std::memory_order_relaxed);
+
+    if (data.events.size() < size_t(maxEventsPerThread)) {
+        std::lock_guard<std::mutex> lock(data.eventsMutex);
+        data.events.push_back({stage, start, duration});
+    }
+}
+
+void StageTimer::Reset() // forget all measures
+{
+    struct_stage_registry &registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (std::unique_ptr<struct_stage_thread> &data : registry.threads) {
+        for (struct_stage_counter &counter : data->counters) {
+            counter.calls = 0;
+            counter.total = 0;
+            counter.min = std::numeric_limits<long long>::max();
+            counter.max = 0;
+        }
+        std::lock_guard<std::mutex> eventsLock(data->eventsMutex);
+        data->events.clear();
+        data->events.shrink_to_fit();
+    }
+}
+
+std::vector<struct_stage_summary> StageTimer::Summary() // all stages with at least one call, in creation order
+{
+    struct_stage_registry &registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    const std::vector<std::string> &stageNames = registry.stageNames;
+    std::vector<struct_stage_summary> summary;
+
+    for (int stage = 0; stage < int(stageNames.size()); stage++) {
+        struct_stage_summary line;
+        line.name = stageNames[stage];
+        long long total = 0;
+        long long min = std::numeric_limits<long long>::max();
+        long long max = 0;
+        for (const std::unique_ptr<struct_stage_thread> &data : registry.threads) {
+            const struct_stage_counter &counter = data->counters[stage];
+            const long long calls = counter.calls.load(std::memory_order_relaxed);
+            if (calls == 0)
+                continue;
+            line.calls += calls;
+            line.threads++;
+            total += counter.total.load(std::memory_order_relaxed);
+            min = std::min(min, counter.min.load(std::memory_order_relaxed));
+            max = std::max(max, counter.max.load(std::memory_order_relaxed));
+        }
+        if (line.calls == 0)
+            continue;
+        line.total = double(total) / 1e6;
+        line.mean = line.total / double(line.calls);
+        line.min = double(min) / 1e6;
+        line.max = double(max) / 1e6;
+        summary.push_back(line);
+    }
+
+    return summary;
+}
+
+static std::string JsonEscape(const std::string &text)
+{
+    std::string result;
+    for (const char &c : text) {
+        if ((c == '"') or (c == '\\'))
+            result += '\\';
+        result += ((unsigned char)(c) < 0x20) ? ' ' : c;
+    }
+
+    return result;
+}
+
+bool StageTimer::ExportTrace(const std::string &filename, std::string &error) // Chrome trace-event JSON
+{
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        error = "the file could not be created";
+        return false;
+    }
+
+    struct_stage_registry &registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const std::unique_ptr<struct_stage_thread> &data : registry.threads) { // thread names
+        file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << data->id
+             << ",\"args\":{\"name\":\"thread " << data->id << "\"}}";
+        first = false;
+    }
+    for (const std::unique_ptr<struct_stage_thread> &data : registry.threads) {
+        std::lock_guard<std::mutex> eventsLock(data->eventsMutex);
+        for (const struct_stage_event &event : data->events) // complete events : start and duration in µs
+            file << (first ? "" : ",\n") << "{\"name\":\"" << JsonEscape(registry.stageNames[event.stage]) << "\",\"cat\":\"stage\",\"ph\":\"X\",\"pid\":1,\"tid\":" << data->id
+                 << ",\"ts\":" << event.start / 1000 << "." << (event.start % 1000) / 100
+                 << ",\"dur\":" << event.duration / 1000 << "." << (event.duration % 1000) / 100 << "}";
+        first = false;
+    }
+    file << "\n]}\n";
+
+    if (!file) {
+        error = "the file could not be written";
+        return false;
+    }
+
+    return true;
+}
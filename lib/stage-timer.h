@@ -0,0 +1,78 @@
+/*#-------------------------------------------------
+#
+#        Stage timers library
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.0 - 2026/10/19
+#
+#   - scoped timers around the stages of a long operation : where does the time go ?
+#   - each thread writes to its own counters : no lock and no shared cache line while measuring
+#   - summary per stage : calls, total, mean, min, max, and the threads that ran it
+#   - trace export in Chrome trace-event JSON (chrome://tracing, Perfetto) : one bar per timed call and thread
+#     the number of events kept per thread is limited, the counters are always exact
+#
+#   standard C++ only
+#
+# Example :
+#   static const int stageDecode = StageTimer::Stage("decode"); // once
+#   {
+#       ScopedStage timer(stageDecode); // measures until the end of the block
+#       ...
+#   }
+#   std::vector<struct_stage_summary> summary = StageTimer::Summary();
+#   StageTimer::ExportTrace("trace.json", error);
+#
+#-------------------------------------------------*/
+
+#ifndef STAGETIMER_H
+#define STAGETIMER_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+
+struct struct_stage_summary { // one stage for all threads
+    std::string name;
+    long long calls = 0;
+    double total = 0; // ms, sum of all threads : can be more than the elapsed time
+    double mean = 0; // ms per call
+    double min = 0; // ms
+    double max = 0; // ms
+    int threads = 0; // threads that ran this stage
+};
+
+class StageTimer // registry of stages and per-thread counters
+{
+public:
+    static const int maxStages = 128;
+    static const int maxEventsPerThread = 200000; // trace events kept, about 5 MB per thread
+
+    static int Stage(const std::string &name); // id of a stage, created if needed - thread-safe, call it once and keep the id
+    static void SetEnabled(const bool &enabled); // disabled = ScopedStage does nothing
+    static bool IsEnabled();
+    static void Reset(); // forget all measures - not while stages are timed
+    static std::vector<struct_stage_summary> Summary(); // all stages with at least one call, in creation order
+    static bool ExportTrace(const std::string &filename, std::string &error); // Chrome trace-event JSON
+
+    static void Record(const int &stage, const long long &start, const long long &duration); // used by ScopedStage - times in ns since Now() origin
+    static long long Now(); // ns since the first use
+};
+
+class ScopedStage // times a block : from construction to destruction
+{
+public:
+    explicit ScopedStage(const int &stage) : stage(stage), start(StageTimer::IsEnabled() ? StageTimer::Now() : -1) {}
+    ~ScopedStage() { Stop(); }
+    void Stop() { if (start >= 0) StageTimer::Record(stage, start, StageTimer::Now() - start); start = -1; } // end the measure before the end of the block
+    ScopedStage(const ScopedStage&) = delete;
+    ScopedStage& operator=(const ScopedStage&) = delete;
+
+private:
+    int stage;
+    long long start; // -1 = not timed
+};
+
+
+#endif // STAGETIMER_H
@@ -0,0 +1,305 @@
+/*#-------------------------------------------------
+#
+#        Thumbnails cache file library
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.0 - 2026/10/19
+#
+#   - one packed file : records appended one after the other,
+#     each record = key + image size + compressed thumbnail blob
+#   - key = file path + file size + last modification time + thumbnail size :
+#     a modified image file or a new thumbnail size is a new record
+#   - offset index in memory, built when the file is opened (blobs are skipped)
+#   - compaction when more than half of the file is old records
+#
+#   standard C++ only - thread-safe
+#
+#-------------------------------------------------*/
+
+#include "thumbnail-cache.h"
+
+#include <filesystem>
+#include <cstring>
+#include <cstdint>
+
+
+///////////////////////////////////////////////////////////
+//// File format
+///////////////////////////////////////////////////////////
+
+    // header : magic "IMTC" + version (uint32)
+    // record : pathLength (uint32) + fileSize (int64) + modified (int64) + thumbnailSize, width, height (int32) + blobLength (uint32) + path + blob
+    // all numbers are little-endian as written by the CPU : the cache is local to this computer
+    // a record cut by a crash at the end of the file is ignored, and overwritten by the next one
+
+static const char cacheMagic[4] = {'I', 'M', 'T', 'C'};
+static const uint32_t cacheVersion = 1;
+static const long long headerSize = 8;
+static const long long recordHeaderSize = 4 + 8 + 8 + 4 + 4 + 4 + 4;
+
+struct struct_record_header { // fixed part of a record
+    uint32_t pathLength;
+    int64_t fileSize;
+    int64_t modified;
+    int32_t thumbnailSize;
+    int32_t width;
+    int32_t height;
+    uint32_t blobLength;
+};
+
+static void WriteRecordHeader(std::ostream &out, const struct_record_header &header) // field by field : no padding in the file
+{
+    out.write(reinterpret_cast<const char*>(&header.pathLength), 4);
+    out.write(reinterpret_cast<const char*>(&header.fileSize), 8);
+    out.write(reinterpret_cast<const char*>(&header.modified), 8);
+    out.write(reinterpret_cast<const char*>(&header.thumbnailSize), 4);
+    out.write(reinterpret_cast<const char*>(&header.width), 4);
+    out.write(reinterpret_cast<const char*>(&header.height), 4);
+    out.write(reinterpret_cast<const char*>(&header.blobLength), 4);
+}
+
+static bool ReadRecordHeader(std::istream &in, struct_record_header &header)
+{
+    char buffer[recordHeaderSize];
+    if (!in.read(buffer, recordHeaderSize))
+        return false;
+
+    std::memcpy(&header.pathLength, buffer, 4);
+    std::memcpy(&header.fileSize, buffer + 4, 8);
+    std::memcpy(&header.modified, buffer + 12, 8);
+    std::memcpy(&header.thumbnailSize, buffer + 20, 4);
+    std::memcpy(&header.width, buffer + 24, 4);
+    std::memcpy(&header.height, buffer + 28, 4);
+    std::memcpy(&header.blobLength, buffer + 32, 4);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////
+//// Cache
+///////////////////////////////////////////////////////////
+
+ThumbnailCache::~ThumbnailCache()
+{
+    Close();
+}
+
+bool ThumbnailCache::Open(const std::string &name) // read the index of an existing cache file, or create it - false if the file can't be used
+{
+    Close();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    filename = name;
+    index.clear();
+    liveBytes = 0;
+
+    // read the index : only the records headers and paths, blobs are skipped
+    bool valid = false;
+    long long end = headerSize; // end of the last complete record
+    std::ifstream in(filename, std::ios::binary);
+    if (in.is_open()) {
+        char magic[4];
+        uint32_t version = 0;
+        if ((in.read(magic, 4)) and (in.read(reinterpret_cast<char*>(&version), 4))
+                and (std::memcmp(magic, cacheMagic, 4) == 0) and (version == cacheVersion)) {
+            valid = true;
+            std::error_code error;
+            const long long size = std::filesystem::file_size(filename, error);
+            struct_record_header header;
+            std::string path;
+            while (ReadRecordHeader(in, header)) {
+                const long long blobOffset = end + recordHeaderSize + header.pathLength;
+                if (blobOffset + header.blobLength > size) // cut record
+                    break;
+                path.resize(header.pathLength);
+                if (!in.read(&path[0], header.pathLength))
+                    break;
+                in.seekg(header.blobLength, std::ios::cur); // skip the blob
+
+                auto found = index.find(path);
+                if (found != index.end()) // an older record for this path
+                    liveBytes -= recordHeaderSize + path.size() + found->second.length;
+                index[path] = {header.fileSize, header.modified, header.thumbnailSize, header.width, header.height, blobOffset, header.blobLength};
+                liveBytes += recordHeaderSize + path.size() + header.blobLength;
+                end = blobOffset + header.blobLength;
+            }
+        }
+        in.close();
+    }
+
+    if (valid) { // keep the records
+        std::error_code error;
+        if (std::filesystem::file_size(filename, error) > std::uintmax_t(end)) // a cut record : remove it, or it could be read as garbage after new records are written
+            std::filesystem::resize_file(filename, end, error);
+        file.open(filename, std::ios::binary | std::ios::in | std::ios::out);
+    }
+    else { // new file - or unknown format : start again
+        index.clear();
+        liveBytes = 0;
+        end = headerSize;
+        file.open(filename, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+        if (file.is_open()) {
+            file.write(cacheMagic, 4);
+            file.write(reinterpret_cast<const char*>(&cacheVersion), 4);
+        }
+    }
+
+    fileEnd = end;
+
+    return file.is_open();
+}
+
+void ThumbnailCache::Close() // flush and close the file, compact it if needed
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.is_open())
+        return;
+
+    file.flush();
+    if (fileEnd - headerSize > 2 * liveBytes) // more than half of the file is old records
+        Compact();
+    file.close();
+}
+
+bool ThumbnailCache::IsOpen() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return file.is_open();
+}
+
+bool ThumbnailCache::Get(const std::string &path, const long long &fileSize, const long long &modified, const int &thumbnailSize,
+                         int &width, int &height, std::vector<unsigned char> &blob) // thumbnail of an image file : false if not in cache or if the file changed
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.is_open())
+        return false;
+
+    auto found = index.find(path);
+    if (found == index.end())
+        return false;
+    const struct_thumbnail_info &info = found->second;
+    if ((info.fileSize != fileSize) or (info.modified != modified) or (info.thumbnailSize != thumbnailSize)) // the image file changed, or a different thumbnail size
+        return false;
+
+    blob.resize(info.length);
+    file.seekg(info.offset);
+    if (!file.read(reinterpret_cast<char*>(blob.data()), info.length)) {
+        file.clear();
+        blob.clear();
+        return false;
+    }
+
+    width = info.width;
+    height = info.height;
+
+    return true;
+}
+
+void ThumbnailCache::Put(const std::string &path, const long long &fileSize, const long long &modified, const int &thumbnailSize,
+                         const int &width, const int &height, const std::vector<unsigned char> &blob) // add or replace the thumbnail of an image file
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.is_open())
+        return;
+
+    struct_record_header header = {uint32_t(path.size()), fileSize, modified, thumbnailSize, width, height, uint32_t(blob.size())};
+    file.seekp(fileEnd); // after the last complete record
+    WriteRecordHeader(file, header);
+    file.write(path.data(), path.size());
+    file.write(reinterpret_cast<const char*>(blob.data()), blob.size());
+    if (!file) { // disk full ?
+        file.clear();
+        return;
+    }
+
+    auto found = index.find(path);
+    if (found != index.end()) // replaced record
+        liveBytes -= recordHeaderSize + path.size() + found->second.length;
+    const long long blobOffset = fileEnd + recordHeaderSize + path.size();
+    index[path] = {fileSize, modified, thumbnailSize, width, height, blobOffset, uint32_t(blob.size())};
+    liveBytes += recordHeaderSize + path.size() + blob.size();
+    fileEnd = blobOffset + blob.size();
+}
+
+void ThumbnailCache::Flush() // write buffered records to disk
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file.is_open())
+        file.flush();
+}
+
+int ThumbnailCache::Count() const // number of thumbnails in cache
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return int(index.size());
+}
+
+bool ThumbnailCache::Compact() // rewrite the file with the current records only - the mutex is already locked
+{
+    const std::string tmpName = filename + ".tmp";
+    std::ofstream out(tmpName, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+        return false;
+
+    out.write(cacheMagic, 4);
+    out.write(reinterpret_cast<const char*>(&cacheVersion), 4);
+
+    std::unordered_map<std::string, struct_thumbnail_info> newIndex;
+    newIndex.reserve(index.size());
+    long long end = headerSize;
+    std::vector<char> blob;
+    for (auto &entry : index) {
+        const struct_thumbnail_info &info = entry.second;
+        blob.resize(info.length);
+        file.seekg(info.offset);
+        if (!file.read(blob.data(), info.length)) { // unreadable : dropped
+            file.clear();
+            continue;
+        }
+        struct_record_header header = {uint32_t(entry.first.size()), info.fileSize, info.modified, info.thumbnailSize, info.width, info.height, info.length};
+        WriteRecordHeader(out, header);
+        out.write(entry.first.data(), entry.first.size());
+        out.write(blob.data(), blob.size());
+
+        struct_thumbnail_info newInfo = info;
+        newInfo.offset = end + recordHeaderSize + entry.first.size();
+        newIndex[entry.first] = newInfo;
+        end = newInfo.offset + info.length;
+    }
+    out.close();
+    if (!out)
+        return false;
+
+    file.close();
+    std::error_code error;
+    std::filesystem::rename(tmpName, filename, error);
+    file.open(filename, std::ios::binary | std::ios::in | std::ios::out);
+    if (error) { // old file kept
+        std::filesystem::remove(tmpName, error);
+        return false;
+    }
+
+    index.swap(newIndex);
+    fileEnd = end;
+
+    return true;
+}
+
+bool ThumbnailCache::FileStamp(const std::string &path, long long &fileSize, long long &modified) // size and last modification time of a file - false if it doesn't exist
+{
+    std::error_code error;
+    const std::uintmax_t size = std::filesystem::file_size(path, error);
+    if (error)
+        return false;
+    const std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+    if (error)
+        return false;
+
+    fileSize = size;
+    modified = time.time_since_epoch().count();
+
+    return true;
+}
@@ -0,0 +1,69 @@
+/*#-------------------------------------------------
+#
+#        Thumbnails cache file library
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.0 - 2026/10/19
+#
+#   - one packed file : records appended one after the other,
+#     each record = key + image size + compressed thumbnail blob
+#   - key = file path + file size + last modification time + thumbnail size :
+#     a modified image file or a new thumbnail size is a new record
+#   - offset index in memory, built when the file is opened (blobs are skipped)
+#   - compaction when more than half of the file is old records
+#
+#   standard C++ only - thread-safe
+#
+#-------------------------------------------------*/
+
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+
+
+struct struct_thumbnail_info { // what the cache knows about an image file, without reading the blob
+    long long fileSize = 0; // bytes of the image file
+    long long modified = 0; // last modification time of the image file
+    int thumbnailSize = 0; // thumbnail was made for this size
+    int width = 0; // size of the original image
+    int height = 0;
+    long long offset = 0; // position of the blob in the cache file
+    unsigned int length = 0; // blob size in bytes
+};
+
+class ThumbnailCache // thumbnails of image files, kept between sessions in one packed file
+{
+public:
+    ~ThumbnailCache();
+
+    bool Open(const std::string &filename); // read the index of an existing cache file, or create it - false if the file can't be used
+    void Close(); // flush and close the file, compact it if needed
+    bool IsOpen() const;
+    bool Get(const std::string &path, const long long &fileSize, const long long &modified, const int &thumbnailSize,
+             int &width, int &height, std::vector<unsigned char> &blob); // thumbnail of an image file : false if not in cache or if the file changed
+    void Put(const std::string &path, const long long &fileSize, const long long &modified, const int &thumbnailSize,
+             const int &width, const int &height, const std::vector<unsigned char> &blob); // add or replace the thumbnail of an image file
+    void Flush(); // write buffered records to disk
+    int Count() const; // number of thumbnails in cache
+
+    static bool FileStamp(const std::string &path, long long &fileSize, long long &modified); // size and last modification time of a file - false if it doesn't exist
+
+private:
+    bool Compact(); // rewrite the file with the current records only
+
+    std::string filename;
+    std::fstream file;
+    std::unordered_map<std::string, struct_thumbnail_info> index; // path -> last record for this path
+    long long fileEnd = 0; // where the next record is written
+    long long liveBytes = 0; // bytes used by the records in index
+    mutable std::mutex mutex; // one file for all threads
+};
+
+
+#endif // THUMBNAILCACHE_H
@@ -0,0 +1,256 @@
+/*#-------------------------------------------------
+#
+#        Tile hashes library with openCV
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.1 - 2026/10/19
+#
+#   - crops and partial overlaps defeat global hashes : a part of an image is hashed like a whole image
+#   - tile hashes : dHash of overlapping square tiles at several scales - the tiles of a crop are found among the tiles of its original
+#   - 64-bit hashes computed from an integral image : no resize per tile, no allocation per tile
+#   - low-contrast tiles (sky, walls) are left out : they would match everywhere
+#   - inverted index from tile hash to image : a query counts the tiles of each indexed image that are near one of its own tiles
+#   - candidates only : verify them, for example with GetHomographyFromImagesFeatures
+#
+#   - v1.1 : few indexed tiles (~200 per image), many query tiles (~10000 per image)
+#            bit-sampling tables (12 x 24 bits) instead of SignatureIndex : small buckets, cost per query grows slowly with the number of images
+#
+#-------------------------------------------------*/
+
+#include "tile-hash.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <random>
+
+
+///////////////////////////////////////////////////////////
+//// Tile hashes
+///////////////////////////////////////////////////////////
+
+    // a crop of a factor c (its shorter side is c times the original's) is resized to the same working size :
+    // its tiles are 1/c times bigger than the same content in the original
+    // -> the index only holds a few tiles of each image : 3 sizes, overlapping by 2/3
+    // -> the query looks for them at many sizes and positions : sizes follow a geometric scale (x1.05) up to the whole image,
+    //    tiles overlap by 15/16 -> one query tile is within ~3% of the size and ~1/32 of the position of an indexed tile
+    //    most work is on the query side : the index, and the cost of each lookup, stay small
+
+static const float tileIndexScales[] = {0.5f, 0.35f, 0.25f}; // indexed tile side, in parts of the image's shorter side
+static const int tileIndexStride = 3; // stride = side / 3
+static const float tileQueryMinScale = 0.35f; // query tile sides : from 0.35 to 1 of the shorter side...
+static const float tileQueryRatio = 1.05f; // ... 5% bigger each time
+static const int tileQueryStride = 16; // stride = side / 16
+static const int tileMinSide = 18; // pixels : 2 pixels per dHash cell at least
+static const double tileMinDeviation = 10.0; // standard deviation of gray values under which a tile is left out
+
+static inline double BoxSum(const cv::Mat &integral, const int &x0, const int &y0, const int &x1, const int &y1) // sum of pixels in [x0..x1[ x [y0..y1[
+{
+    return integral.at<double>(y1, x1) - integral.at<double>(y0, x1) - integral.at<double>(y1, x0) + integral.at<double>(y0, x0);
+}
+
+std::vector<uint64_t> TileHashIndex::ComputeTileHashes(const cv::Mat &gray, const bool &forQuery) // dHash of overlapping tiles at several scales of a gray image (CV_8U) - for Add(), or forQuery
+    // same bits as DifferenceHash() : 8 lines of 9 cells, a bit is 1 if the left cell is brighter
+{
+    std::vector<uint64_t> hashes;
+    if (gray.empty())
+        return hashes;
+
+    static thread_local cv::Mat grayBuffer, sum, squares; // memory reused by the next images of this thread
+    const cv::Mat *source = &gray;
+    if (gray.channels() > 1) {
+        cv::cvtColor(gray, grayBuffer, cv::COLOR_BGR2GRAY);
+        source = &grayBuffer;
+    }
+    cv::integral(*source, sum, squares, CV_64F, CV_64F);
+
+    std::vector<float> scales;
+    if (forQuery)
+        for (float scale = tileQueryMinScale; scale <= 1.0001f; scale *= tileQueryRatio)
+            scales.push_back(std::min(scale, 1.0f));
+    else
+        scales.assign(std::begin(tileIndexScales), std::end(tileIndexScales));
+
+    const int minSide = std::min(source->cols, source->rows);
+    int xEdges[10], yEdges[9]; // cells of a tile
+    double cells[9];
+    for (const float &scale : scales) {
+        const int side = int(float(minSide) * scale);
+        if (side < tileMinSide)
+            continue;
+        const int stride = std::max(1, side / (forQuery ? tileQueryStride : tileIndexStride));
+        const double area = double(side) * double(side);
+
+        for (int y = 0; y + side <= source->rows; y += stride)
+            for (int x = 0; x + side <= source->cols; x += stride) {
+                // contrast
+                const double mean = BoxSum(sum, x, y, x + side, y + side) / area;
+                const double variance = BoxSum(squares, x, y, x + side, y + side) / area - mean * mean;
+                if (variance < tileMinDeviation * tileMinDeviation) // flat tile
+                    continue;
+
+                // dHash of the tile from the cells means
+                for (int k = 0; k <= 9; k++)
+                    xEdges[k] = x + k * side / 9;
+                for (int k = 0; k <= 8; k++)
+                    yEdges[k] = y + k * side / 8;
+                uint64_t hash = 0;
+                for (int line = 0; line < 8; line++) {
+                    for (int k = 0; k < 9; k++)
+                        cells[k] = BoxSum(sum, xEdges[k], yEdges[line], xEdges[k + 1], yEdges[line + 1])
+                                 / double((xEdges[k + 1] - xEdges[k]) * (yEdges[line + 1] - yEdges[line]));
+                    for (int i = 0; i < 8; i++)
+                        if (cells[i + 1] < cells[i]) // left cell is brighter
+                            hash |= uint64_t(1) << (line * 8 + i);
+                }
+                hashes.push_back(hash);
+            }
+    }
+
+    return hashes;
+}
+
+///////////////////////////////////////////////////////////
+//// Index
+///////////////////////////////////////////////////////////
+
+    // bit sampling : the key of a table is made of 24 bits of the hash, chosen at random (fixed seed) - exact lookup in each table
+    // -> two hashes 3 bits apart share a key in at least one of 12 tables with a probability of ~96%, and the many query tiles make up for misses
+    // -> 2^24 keys : buckets stay small when images are added, unlike the 16-bit chunks of SignatureIndex that hold thousands of tiles each
+    // -> candidates are verified with their real Hamming distance
+    // -> a directory on the first bits of the keys (~1 tile per entry) gives the range of a key without searching
+
+static const int tileTables = 12; // number of lookup tables
+static const int tileKeyBits = 24; // bits of a key
+
+struct struct_tile_keys { // bits of the hash sampled by each table, as lookup tables : key = OR of the values of the 8 bytes of the hash
+    uint32_t bytes[tileTables][8][256];
+
+    struct_tile_keys()
+    {
+        std::mt19937 generator(12345); // same keys at each run
+        for (int t = 0; t < tileTables; t++) {
+            int bits[64];
+            for (int i = 0; i < 64; i++)
+                bits[i] = i;
+            for (int i = 0; i < tileKeyBits; i++) // first tileKeyBits of a partial shuffle
+                std::swap(bits[i], bits[i + int(generator() % uint32_t(64 - i))]);
+
+            for (int b = 0; b < 8; b++)
+                for (int v = 0; v < 256; v++) {
+                    uint32_t key = 0;
+                    for (int i = 0; i < tileKeyBits; i++)
+                        if ((bits[i] / 8 == b) and ((v >> (bits[i] % 8)) & 1))
+                            key |= uint32_t(1) << i;
+                    bytes[t][b][v] = key;
+                }
+        }
+    }
+};
+
+static inline uint32_t TileKey(const struct_tile_keys &keys, const int &table, const uint64_t &hash) // key of a tile hash in a table
+{
+    const uint32_t (&bytes)[8][256] = keys.bytes[table];
+    return bytes[0][hash & 255] | bytes[1][(hash >> 8) & 255] | bytes[2][(hash >> 16) & 255] | bytes[3][(hash >> 24) & 255]
+         | bytes[4][(hash >> 32) & 255] | bytes[5][(hash >> 40) & 255] | bytes[6][(hash >> 48) & 255] | bytes[7][hash >> 56];
+}
+
+static const struct_tile_keys &TileKeys()
+{
+    static const struct_tile_keys keys; // computed once
+    return keys;
+}
+
+void TileHashIndex::Clear()
+{
+    tileHashes.clear();
+    tileImages.clear();
+    tables.clear();
+    directories.clear();
+    imagesCount = 0;
+    built = false;
+}
+
+void TileHashIndex::Add(const int &imageId, const std::vector<uint64_t> &tiles) // add the tile hashes of one image - call Build() once all images are added
+{
+    tileHashes.insert(tileHashes.end(), tiles.begin(), tiles.end());
+    tileImages.insert(tileImages.end(), tiles.size(), imageId);
+    imagesCount++;
+    built = false;
+}
+
+void TileHashIndex::Build() // sort the lookup tables
+{
+    const struct_tile_keys &keys = TileKeys();
+    directoryBits = 8; // ~1 tile for each directory entry
+    while ((directoryBits < tileKeyBits) and ((size_t(1) << (directoryBits + 1)) <= tileHashes.size()))
+        directoryBits++;
+
+    tables.assign(tileTables, std::vector<std::pair<uint32_t, int>>());
+    directories.assign(tileTables, std::vector<int>());
+    #pragma omp parallel for
+    for (int t = 0; t < tileTables; t++) {
+        std::vector<std::pair<uint32_t, int>> &table = tables[t];
+        table.reserve(tileHashes.size());
+        for (int tile = 0; tile < int(tileHashes.size()); tile++)
+            table.emplace_back(TileKey(keys, t, tileHashes[tile]), tile);
+        std::sort(table.begin(), table.end());
+
+        std::vector<int> &directory = directories[t]; // first entry of the table for each value of the first bits of the key
+        directory.assign((size_t(1) << directoryBits) + 1, 0);
+        for (const std::pair<uint32_t, int> &entry : table)
+            directory[(entry.first >> (tileKeyBits - directoryBits)) + 1]++;
+        for (size_t d = 1; d < directory.size(); d++)
+            directory[d] += directory[d - 1];
+    }
+    built = true;
+}
+
+int TileHashIndex::Size() const // number of indexed images
+{
+    return imagesCount;
+}
+
+std::vector<std::pair<int, int>> TileHashIndex::Query(const std::vector<uint64_t> &tiles, const int &maxDistance, const int &minTiles, const int &exclude) const // (image, matching tiles), most tiles first
+    // a query tile votes once for each image having a tile within maxDistance bits - exclude : the image of the query, if it is indexed
+{
+    std::vector<std::pair<int, int>> result;
+    if ((!built) or (tiles.empty()))
+        return result;
+
+    std::vector<uint64_t> query(tiles); // identical query tiles (flat areas at several positions) are only looked for once
+    std::sort(query.begin(), query.end());
+    query.erase(std::unique(query.begin(), query.end()), query.end());
+
+    const struct_tile_keys &keys = TileKeys();
+    std::unordered_map<int, int> votes; // image id -> matching query tiles
+    std::vector<int> voted; // images voted for by the current query tile
+    for (const uint64_t &hash : query) {
+        voted.clear();
+        for (int t = 0; t < tileTables; t++) {
+            const std::vector<std::pair<uint32_t, int>> &table = tables[t];
+            const uint32_t key = TileKey(keys, t, hash);
+            const uint32_t first = key >> (tileKeyBits - directoryBits);
+            const int end = directories[t][first + 1];
+            for (int e = directories[t][first]; e < end; e++)
+                if (table[e].first == key) {
+                    const int tile = table[e].second;
+                    const int image = tileImages[tile];
+                    if ((image != exclude) and (__builtin_popcountll(tileHashes[tile] ^ hash) <= maxDistance))
+                        voted.push_back(image);
+                }
+        }
+        std::sort(voted.begin(), voted.end());
+        voted.erase(std::unique(voted.begin(), voted.end()), voted.end());
+        for (const int &image : voted)
+            votes[image]++;
+    }
+
+    for (const auto &vote : votes)
+        if (vote.second >= minTiles)
+            result.push_back(vote);
+    std::sort(result.begin(), result.end(), [](const std::pair<int, int> &a, const std::pair<int, int> &b) {
+        return (a.second > b.second) or ((a.second == b.second) and (a.first < b.first)); });
+
+    return result;
+}
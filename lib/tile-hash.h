@@ -0,0 +1,60 @@
+/*#-------------------------------------------------
+#
+#        Tile hashes library with openCV
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.1 - 2026/10/19
+#
+#   - crops and partial overlaps defeat global hashes : a part of an image is hashed like a whole image
+#   - tile hashes : dHash of overlapping square tiles at several scales - the tiles of a crop are found among the tiles of its original
+#   - 64-bit hashes computed from an integral image : no resize per tile, no allocation per tile
+#   - low-contrast tiles (sky, walls) are left out : they would match everywhere
+#   - inverted index from tile hash to image : a query counts the tiles of each indexed image that are near one of its own tiles
+#   - candidates only : verify them, for example with GetHomographyFromImagesFeatures
+#
+#   - v1.1 : few indexed tiles (~200 per image), many query tiles (~10000 per image)
+#            bit-sampling tables (12 x 24 bits) instead of SignatureIndex : small buckets, cost per query grows slowly with the number of images
+#
+# Example :
+#   TileHashIndex index;
+#   index.Add(image, TileHashIndex::ComputeTileHashes(gray));
+#   index.Build();
+#   std::vector<std::pair<int, int>> candidates = index.Query(TileHashIndex::ComputeTileHashes(otherGray, true)); // (image, matching tiles)
+#
+#-------------------------------------------------*/
+
+#ifndef TILEHASH_H
+#define TILEHASH_H
+
+#include "opencv2/opencv.hpp"
+
+#include <vector>
+#include <cstdint>
+
+
+class TileHashIndex // tile hashes of many images, searched by Hamming distance
+{
+public:
+    static std::vector<uint64_t> ComputeTileHashes(const cv::Mat &gray, const bool &forQuery=false); // dHash of overlapping tiles at several scales of a gray image (CV_8U)
+        // for Add() : ~200 hashes for a 256x192 image - forQuery : ~10000 hashes, finer scales and positions
+
+    void Clear();
+    void Add(const int &imageId, const std::vector<uint64_t> &tiles); // add the tile hashes of one image - call Build() once all images are added
+    void Build(); // sort the lookup tables
+    int Size() const; // number of indexed images
+    std::vector<std::pair<int, int>> Query(const std::vector<uint64_t> &tiles, const int &maxDistance=6, const int &minTiles=2,
+                                           const int &exclude=-1) const; // (image, matching tiles) of images with at least minTiles tiles near a query tile, most tiles first
+
+private:
+    std::vector<uint64_t> tileHashes; // tile id -> hash
+    std::vector<int> tileImages; // tile id -> image id
+    std::vector<std::vector<std::pair<uint32_t, int>>> tables; // one per bit sample : (key, tile id) sorted by key
+    std::vector<std::vector<int>> directories; // one per table : first entry for each value of the first directoryBits bits of the key
+    int directoryBits = 8;
+    int imagesCount = 0;
+    bool built = false;
+};
+
+
+#endif // TILEHASH_H
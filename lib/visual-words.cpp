@@ -0,0 +1,329 @@
+/*#-------------------------------------------------
+#
+#    Bag of visual words library with openCV
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.1 - 2026/10/19
+#
+#   - vocabulary of binary words with k-majority clustering
+#   - save / load vocabulary with cv::FileStorage
+#   - quantization error : is a vocabulary still fit for the current images ?
+#   - TF-IDF visual words vectors
+#   - inverted file : top-k most similar images
+#
+#-------------------------------------------------*/
+
+#include "visual-words.h"
+
+#include <random>
+#include <cstring>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+
+///////////////////////////////////////////////////////////
+//// Vocabulary
+///////////////////////////////////////////////////////////
+
+    // k-majority = k-means for binary descriptors : distance is Hamming, and the "mean" of a cluster is the majority vote of each bit
+    // reference : Grana et al., "A fast approach for integrating ORB descriptors in the bag of words model"
+
+int GetVisualWord(const cv::Mat &vocabulary, const uchar *descriptor, int *distance) // nearest word index of a binary descriptor
+{
+    int best = INT_MAX;
+    int word = -1;
+
+    if (vocabulary.cols == 64) { // packed 512-bit descriptors : SIMD kernel
+        for (int w = 0; w < vocabulary.rows; w++) {
+            const int d = HammingDistance512(descriptor, vocabulary.ptr<uchar>(w));
+            if (d < best) {
+                best = d;
+                word = w;
+            }
+        }
+    }
+    else {
+        for (int w = 0; w < vocabulary.rows; w++) {
+            const int d = HammingDistance(descriptor, vocabulary.ptr<uchar>(w), vocabulary.cols);
+            if (d < best) {
+                best = d;
+                word = w;
+            }
+        }
+    }
+
+    if (distance)
+        *distance = best;
+
+    return word;
+}
+
+static std::vector<const uchar*> GatherSamples(const std::vector<cv::Mat> &descriptorsList, const int &maxSamples, std::mt19937 &generator, int &bytes) // at most maxSamples descriptors rows, picked at random
+    // all rows must have the same size (bytes) : rows of another size are left out
+{
+    std::vector<const uchar*> samples;
+    bytes = 0;
+    for (size_t n = 0; n < descriptorsList.size(); n++) {
+        const cv::Mat &descriptors = descriptorsList[n];
+        if ((descriptors.empty()) or (descriptors.type() != CV_8U))
+            continue;
+        if (bytes == 0)
+            bytes = descriptors.cols;
+        if (descriptors.cols != bytes) // all descriptors must have the same size
+            continue;
+        for (int r = 0; r < descriptors.rows; r++)
+            samples.push_back(descriptors.ptr<uchar>(r));
+    }
+
+    std::shuffle(samples.begin(), samples.end(), generator);
+    if (int(samples.size()) > maxSamples)
+        samples.resize(maxSamples);
+
+    return samples;
+}
+
+cv::Mat BuildVisualVocabulary(const std::vector<cv::Mat> &descriptorsList, const int &nbWords, const int &iterations, const int &maxSamples) // k-majority clustering of binary descriptors -> one word per row (CV_8U)
+    // at most maxSamples descriptors are used, picked at random but always the same for the same input
+{
+    std::mt19937 generator(0); // fixed seed : same vocabulary for the same images
+    int bytes;
+    std::vector<const uchar*> samples = GatherSamples(descriptorsList, maxSamples, generator, bytes);
+    if (samples.empty())
+        return cv::Mat();
+
+    const int nbSamples = samples.size();
+    const int words = std::min(nbWords, nbSamples);
+
+    // initial words : first shuffled samples
+    cv::Mat vocabulary(words, bytes, CV_8U);
+    for (int w = 0; w < words; w++)
+        std::memcpy(vocabulary.ptr<uchar>(w), samples[w], bytes);
+
+    std::vector<int> assignment(nbSamples, -1); // word of each sample
+    std::vector<int> bitCount(words * bytes * 8); // number of "1" for each bit of each word
+    std::vector<int> members(words); // number of samples for each word
+
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        // assign each sample to its nearest word
+        int changed = 0;
+        #pragma omp parallel for reduction(+:changed)
+        for (int s = 0; s < nbSamples; s++) {
+            const int word = GetVisualWord(vocabulary, samples[s]);
+            if (word != assignment[s]) {
+                assignment[s] = word;
+                changed++;
+            }
+        }
+
+        if (changed == 0) // converged
+            break;
+
+        // majority vote of each bit
+        std::fill(bitCount.begin(), bitCount.end(), 0);
+        std::fill(members.begin(), members.end(), 0);
+        for (int s = 0; s < nbSamples; s++) {
+            const int word = assignment[s];
+            members[word]++;
+            int *count = &bitCount[word * bytes * 8];
+            for (int b = 0; b < bytes; b++) {
+                const uchar value = samples[s][b];
+                for (int bit = 0; bit < 8; bit++)
+                    count[b * 8 + bit] += (value >> bit) & 1;
+            }
+        }
+
+        for (int w = 0; w < words; w++) {
+            if (members[w] == 0) { // empty cluster : restart it from a random sample
+                std::memcpy(vocabulary.ptr<uchar>(w), samples[generator() % nbSamples], bytes);
+                continue;
+            }
+            uchar *word = vocabulary.ptr<uchar>(w);
+            const int *count = &bitCount[w * bytes * 8];
+            for (int b = 0; b < bytes; b++) {
+                uchar value = 0;
+                for (int bit = 0; bit < 8; bit++)
+                    if (2 * count[b * 8 + bit] > members[w]) // majority of "1"
+                        value |= uchar(1 << bit);
+                word[b] = value;
+            }
+        }
+    }
+
+    return vocabulary;
+}
+
+float VisualVocabularyError(const cv::Mat &vocabulary, const std::vector<cv::Mat> &descriptorsList, const int &maxSamples) // mean Hamming distance of the descriptors to their nearest word - -1 if no descriptors
+    // a vocabulary built from other images quantizes the current ones worse : compare with the error of the images it was built from
+{
+    std::mt19937 generator(0); // fixed seed : same error for the same images
+    int bytes;
+    const std::vector<const uchar*> samples = GatherSamples(descriptorsList, maxSamples, generator, bytes);
+    if ((samples.empty()) or (vocabulary.empty()) or (bytes != vocabulary.cols))
+        return -1;
+
+    double sum = 0;
+    #pragma omp parallel for reduction(+:sum)
+    for (int s = 0; s < int(samples.size()); s++) {
+        int distance;
+        GetVisualWord(vocabulary, samples[s], &distance);
+        sum += distance;
+    }
+
+    return float(sum / double(samples.size()));
+}
+
+bool SaveVisualVocabulary(const std::string &filename, const cv::Mat &vocabulary, const float &error) // save vocabulary and its quantization error with cv::FileStorage
+{
+    if (vocabulary.empty())
+        return false;
+
+    cv::FileStorage fs(filename, cv::FileStorage::WRITE);
+    if (!fs.isOpened())
+        return false;
+
+    fs << "VisualWords" << vocabulary;
+    fs << "QuantizationError" << error;
+    fs.release();
+
+    return true;
+}
+
+cv::Mat LoadVisualVocabulary(const std::string &filename, float *error) // load vocabulary saved with SaveVisualVocabulary - empty if not found - error = -1 if not saved
+{
+    cv::Mat vocabulary;
+    if (error)
+        *error = -1;
+
+    cv::FileStorage fs(filename, cv::FileStorage::READ);
+    if (!fs.isOpened())
+        return vocabulary;
+
+    fs["VisualWords"] >> vocabulary;
+    if ((error) and (!fs["QuantizationError"].empty()))
+        fs["QuantizationError"] >> *error;
+    fs.release();
+
+    if ((!vocabulary.empty()) and (vocabulary.type() != CV_8U)) // not a binary vocabulary
+        return cv::Mat();
+
+    return vocabulary;
+}
+
+///////////////////////////////////////////////////////////
+//// Inverted file
+///////////////////////////////////////////////////////////
+
+void VisualWordsIndex::SetVocabulary(const cv::Mat &words) // also clears the index
+{
+    vocabulary = words;
+    Clear();
+}
+
+bool VisualWordsIndex::HasVocabulary() const // vocabulary is set ?
+{
+    return !vocabulary.empty();
+}
+
+const cv::Mat &VisualWordsIndex::Vocabulary() const // one word per row
+{
+    return vocabulary;
+}
+
+void VisualWordsIndex::Clear() // empty index, the vocabulary is kept
+{
+    imageIds.clear();
+    indexes.clear();
+    vectors.clear();
+    invertedFile.clear();
+    built = false;
+}
+
+void VisualWordsIndex::Add(const int &imageId, const cv::Mat &descriptors) // add the descriptors of one image
+    // images without descriptors are added too, they just won't have any candidate
+{
+    std::vector<struct_word_weight> tf;
+
+    if ((!vocabulary.empty()) and (!descriptors.empty()) and (descriptors.type() == CV_8U) and (descriptors.cols == vocabulary.cols)) {
+        // histogram of words
+        std::vector<int> words(descriptors.rows);
+        for (int r = 0; r < descriptors.rows; r++)
+            words[r] = GetVisualWord(vocabulary, descriptors.ptr<uchar>(r));
+        std::sort(words.begin(), words.end());
+
+        // sparse TF vector
+        for (int r = 0; r < descriptors.rows; r++) {
+            if ((tf.empty()) or (tf.back().word != words[r]))
+                tf.push_back({words[r], 0.0f});
+            tf.back().weight += 1.0f / float(descriptors.rows); // term frequency
+        }
+    }
+
+    indexes[imageId] = imageIds.size();
+    imageIds.push_back(imageId);
+    vectors.push_back(tf);
+    built = false;
+}
+
+void VisualWordsIndex::Build() // compute IDF weights, normalized TF-IDF vectors and the inverted file
+{
+    // document frequency of each word
+    std::vector<int> documents(vocabulary.rows, 0);
+    for (size_t n = 0; n < vectors.size(); n++)
+        for (size_t e = 0; e < vectors[n].size(); e++)
+            documents[vectors[n][e].word]++;
+
+    // TF-IDF, normalized to unit length -> dot product = cosine similarity
+    invertedFile.assign(vocabulary.rows, std::vector<std::pair<int, float>>());
+    for (size_t n = 0; n < vectors.size(); n++) {
+        float norm = 0;
+        for (size_t e = 0; e < vectors[n].size(); e++) {
+            vectors[n][e].weight *= std::log(float(vectors.size()) / float(documents[vectors[n][e].word])); // IDF : words found in every image are worthless
+            norm += vectors[n][e].weight * vectors[n][e].weight;
+        }
+        if (norm == 0)
+            continue;
+        norm = std::sqrt(norm);
+        for (size_t e = 0; e < vectors[n].size(); e++) {
+            vectors[n][e].weight /= norm;
+            if (vectors[n][e].weight > 0)
+                invertedFile[vectors[n][e].word].emplace_back(n, vectors[n][e].weight);
+        }
+    }
+
+    built = true;
+}
+
+std::vector<std::pair<int, float>> VisualWordsIndex::TopCandidates(const int &imageId, const int &k) const // (imageId, cosine similarity) of the k most similar indexed images, best first
+    // only images sharing at least one visual word can be returned, so there can be less than k candidates
+{
+    std::vector<std::pair<int, float>> result;
+
+    auto found = indexes.find(imageId);
+    if ((!built) or (found == indexes.end()))
+        return result;
+    const int index = found->second;
+
+    // accumulate dot products using only the words of the query image
+    std::unordered_map<int, float> scores;
+    const std::vector<struct_word_weight> &query = vectors[index];
+    for (size_t e = 0; e < query.size(); e++) {
+        const std::vector<std::pair<int, float>> &images = invertedFile[query[e].word];
+        for (size_t n = 0; n < images.size(); n++)
+            if (images[n].first != index)
+                scores[images[n].first] += query[e].weight * images[n].second;
+    }
+
+    result.reserve(scores.size());
+    for (auto &score : scores)
+        result.emplace_back(imageIds[score.first], score.second);
+
+    // k best
+    const int nb = std::min(k, int(result.size()));
+    std::partial_sort(result.begin(), result.begin() + nb, result.end(),
+                      [](const std::pair<int, float> &a, const std::pair<int, float> &b) { return a.second > b.second; });
+    result.resize(nb);
+
+    return result;
+}
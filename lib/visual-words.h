@@ -0,0 +1,65 @@
+/*#-------------------------------------------------
+#
+#    Bag of visual words library with openCV
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.1 - 2026/10/19
+#
+#   - vocabulary of binary words with k-majority clustering
+#   - save / load vocabulary with cv::FileStorage
+#   - quantization error : is a vocabulary still fit for the current images ?
+#   - TF-IDF visual words vectors
+#   - inverted file : top-k most similar images
+#
+#-------------------------------------------------*/
+
+#ifndef VISUALWORDS_H
+#define VISUALWORDS_H
+
+#include "opencv2/opencv.hpp"
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+#include "features-matcher.h"
+
+
+//// Vocabulary
+cv::Mat BuildVisualVocabulary(const std::vector<cv::Mat> &descriptorsList, const int &nbWords=1000,
+                              const int &iterations=10, const int &maxSamples=100000); // k-majority clustering of binary descriptors -> one word per row (CV_8U)
+bool SaveVisualVocabulary(const std::string &filename, const cv::Mat &vocabulary, const float &error=-1); // save vocabulary and its quantization error with cv::FileStorage
+cv::Mat LoadVisualVocabulary(const std::string &filename, float *error=nullptr); // load vocabulary saved with SaveVisualVocabulary - empty if not found - error = -1 if not saved
+int GetVisualWord(const cv::Mat &vocabulary, const uchar *descriptor, int *distance=nullptr); // nearest word index of a binary descriptor
+float VisualVocabularyError(const cv::Mat &vocabulary, const std::vector<cv::Mat> &descriptorsList,
+                            const int &maxSamples=20000); // mean Hamming distance of the descriptors to their nearest word - -1 if no descriptors
+
+//// Inverted file
+class VisualWordsIndex // TF-IDF vectors + inverted file over the descriptors of many images
+{
+public:
+    void SetVocabulary(const cv::Mat &vocabulary); // also clears the index
+    bool HasVocabulary() const; // vocabulary is set ?
+    const cv::Mat &Vocabulary() const; // one word per row
+    void Add(const int &imageId, const cv::Mat &descriptors); // add the descriptors of one image - call Build() once all images are added
+    void Build(); // compute IDF weights, normalized TF-IDF vectors and the inverted file
+    void Clear(); // empty index, the vocabulary is kept
+    std::vector<std::pair<int, float>> TopCandidates(const int &imageId, const int &k) const; // (imageId, cosine similarity) of the k most similar indexed images, best first
+
+private:
+    struct struct_word_weight { // one non-zero entry of a sparse TF-IDF vector
+        int word;
+        float weight;
+    };
+
+    cv::Mat vocabulary; // one word per row
+    std::vector<int> imageIds; // internal index -> caller image id
+    std::unordered_map<int, int> indexes; // caller image id -> internal index
+    std::vector<std::vector<struct_word_weight>> vectors; // sparse TF (then TF-IDF after Build) vector of each image
+    std::vector<std::vector<std::pair<int, float>>> invertedFile; // word -> (internal index, weight) of images containing it
+    bool built = false;
+};
+
+
+#endif // VISUALWORDS_H
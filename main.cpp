@@ -4,15 +4,24 @@
 #
 #    by AbsurdePhoton - www.absurdephoton.fr
 #
-#                v2.0 - 2020/02/06
+#                v2.1 - 2026/10/19
+#
+#   - v2.1 : headless commands (image-match watch ...) run without the GUI, see cli/cli.h
 #
 #-------------------------------------------------*/
 
 #include "mainwindow.h"
+#include "cli/cli.h"
 #include <QApplication>
+#include <QCoreApplication>
 
 int main(int argc, char *argv[])
 {
+    if ((argc > 1) and (IsCommand(argv[1]))) { // no display needed
+        QCoreApplication a(argc, argv); // QImage loading plugins
+        return RunCommand(argc, argv);
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
@@ -13,6 +13,31 @@
 #include "ui_mainwindow.h"
 
 
+/////////////////// Stage timers //////////////////////
+// where the time goes, shown in the Performance tab
+
+static std::vector<int> AlgorithmStages(const std::string &prefix) // one stage per algorithm
+{
+    std::vector<int> stages;
+    for (int algorithm = 0; algorithm <= img_similarity_count; algorithm++)
+        stages.push_back(StageTimer::Stage(prefix + " " + imageSimilarityName[algorithm]));
+
+    return stages;
+}
+
+static const int stageCrawl = StageTimer::Stage("crawl"); // images lists
+static const int stageDecode = StageTimer::Stage("decode");
+static const int stageResize = StageTimer::Stage("resize");
+static const int stageThumbnail = StageTimer::Stage("thumbnail");
+static const std::vector<int> stageExtract = AlgorithmStages("extract"); // comparison
+static const std::vector<int> stageCompare = AlgorithmStages("compare");
+static const int stageVisualWords = StageTimer::Stage("visual words");
+static const int stageTileHashes = StageTimer::Stage("tile hashes");
+static const int stageSortScores = StageTimer::Stage("sort scores"); // duplicates list
+static const int stageClustering = StageTimer::Stage("clustering");
+static const int stageWidgets = StageTimer::Stage("widgets");
+
+
 /////////////////// Window init //////////////////////
 
 MainWindow::MainWindow(QWidget *parent) :
@@ -111,16 +136,21 @@ MainWindow::MainWindow(QWidget *parent) :
     ui->comboBox_level->setCurrentIndex(2); // set dummy value to combobox
     ui->comboBox_level->blockSignals(false); // restore signals listening to combobox
 
-    // images list
-    ui->treeWidget_duplicates->setWordWrap(true); // text of items is word-wrapped
-    ui->treeWidget_duplicates->setColumnWidth(0, 50); // set columns size
-    ui->treeWidget_duplicates->setColumnWidth(1, 200);
-    ui->treeWidget_duplicates->setColumnWidth(2, 70);
-    ui->treeWidget_duplicates->setColumnWidth(3, 100);
-    ui->treeWidget_duplicates->setColumnWidth(4, 70);
-    ui->treeWidget_duplicates->setColumnWidth(5, 500);
+    // duplicates list
+    duplicatesTreeModel = new DuplicatesTreeModel(this); // virtualized view : rows are created only when shown
+    duplicatesTreeModel->SetRowLoader([this](const int &image) { return GetDuplicateRow(image); });
+    duplicatesTreeModel->SetIconLoader([this](const int &image) { return GetImageIconData(image); }); // icons are decoded only when shown, in background
+    ui->treeView_duplicates->setModel(duplicatesTreeModel); // the model must be set before the columns sizes
+    ui->treeView_duplicates->setWordWrap(true); // text of items is word-wrapped
+    ui->treeView_duplicates->setColumnWidth(0, 50); // set columns size
+    ui->treeView_duplicates->setColumnWidth(1, 200);
+    ui->treeView_duplicates->setColumnWidth(2, 70);
+    ui->treeView_duplicates->setColumnWidth(3, 100);
+    ui->treeView_duplicates->setColumnWidth(4, 70);
+    ui->treeView_duplicates->setColumnWidth(5, 500);
     for (int i = 0; i < 6; i++) // set alignment for all columns
-        ui->treeWidget_duplicates->header()->setDefaultAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
+        ui->treeView_duplicates->header()->setDefaultAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
+    ui->treeView_duplicates->sortByColumn(duplicates_column_resolution, Qt::DescendingOrder); // images sorted by resolution inside each group, done by the model
 
     // options tab
     for (int i = img_similarity_checksum; i < img_similarity_count; i++) { // hide all algorithms in options tab
@@ -131,19 +161,22 @@ MainWindow::MainWindow(QWidget *parent) :
     ui->frame_group_reduced_size->setDisabled(false);
 
     // slots : for mouse clicks on images list and duplicates list
-    connect(ui->listWidget_image_list, SIGNAL(itemClicked(QListWidgetItem*)), this, SLOT(ImagesListClick(QListWidgetItem*))); // single click on images list
-    connect(ui->listWidget_image_list, SIGNAL(itemDoubleClicked(QListWidgetItem*)), this, SLOT(ImagesListDoubleClick(QListWidgetItem*))); // double click on images list
-    connect(ui->treeWidget_duplicates, SIGNAL(itemClicked(QTreeWidgetItem*, int)), this, SLOT(DuplicatesListClick(QTreeWidgetItem*, int))); // single click on duplicates list
-    connect(ui->treeWidget_duplicates, SIGNAL(itemDoubleClicked(QTreeWidgetItem*, int)), this, SLOT(DuplicatesListDoubleClick(QTreeWidgetItem*, int))); // double click on duplicates list
+    imagesListModel = new ImagesListModel(this); // images list : virtualized view, only visible rows are drawn
+    imagesListModel->SetIconLoader([this](const int &image) { return GetImageIconData(image); }); // icons are decoded only when shown, in background
+    ui->listView_image_list->setModel(imagesListModel);
+    connect(ui->listView_image_list, SIGNAL(clicked(QModelIndex)), this, SLOT(ImagesListClick(QModelIndex))); // single click on images list
+    connect(ui->listView_image_list, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(ImagesListDoubleClick(QModelIndex))); // double click on images list
+    connect(ui->treeView_duplicates, SIGNAL(clicked(QModelIndex)), this, SLOT(DuplicatesListClick(QModelIndex))); // single click on duplicates list
+    connect(ui->treeView_duplicates, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(DuplicatesListDoubleClick(QModelIndex))); // double click on duplicates list
 
     // initial variable values
     InitializeValues(); // intial variable values and other GUI elements
 
-    // draw supplemental lines on child widgets in QTreeWidget (duplicates list) and QListWidget (images list)
+    // draw supplemental lines on child widgets in QTreeView (duplicates list) and QListView (images list)
     treeWidgetDelegate = new TreeWidgetDelegate; // new delegate
-    ui->treeWidget_duplicates->setItemDelegate(treeWidgetDelegate); // use this delegate
+    ui->treeView_duplicates->setItemDelegate(treeWidgetDelegate); // use this delegate
     listWidgetDelegate = new ListWidgetDelegate; // same here
-    ui->listWidget_image_list->setItemDelegate(listWidgetDelegate);
+    ui->listView_image_list->setItemDelegate(listWidgetDelegate);
 
     // initial values for options and combobox -> also sets important values like thumbnailSize, reducedSize and nbFeatures
     ui->comboBox_algo->setCurrentIndex(0); // should also set threshold
@@ -151,6 +184,10 @@ MainWindow::MainWindow(QWidget *parent) :
     ui->spinBox_thumbnails_size->setValue(176); // thumbnails size default is 176x176px
     ui->spinBox_reduced_size->setValue(256); // default working images size is 256x256px
     ui->spinBox_nb_features->setValue(150); // default number of image features to find (also for homography algorithm)
+    dihedralHashes = false; // rotated and mirrored copies are not found by default : hashes in canonical orientation can miss some duplicates
+    ui->checkBox_dihedral->setChecked(false);
+    featuresPruning = true; // features and homography only compare the candidates of each image by default : all pairs are too slow for big collections
+    ui->checkBox_features_pruning->setChecked(true);
 
     // other objects
     ui->label_algorithm_arrow->setVisible(false); // hide arrow from algorithm description
@@ -224,6 +261,9 @@ void MainWindow::InitializeValues() // Global variables and GUI elements init
     images.clear(); // list of loaded images
     pairs.clear(); // list of images pairs scores
 
+    //// thumbnails cache
+    thumbnailCache.Open("data/thumbnails.cache"); // thumbnails of images scanned in previous sessions - if it can't be opened, thumbnails are just not cached
+
     //// config files
     // thresholds config file
     for (int i = img_similarity_checksum; i < img_similarity_count + 1; i++) {
@@ -241,6 +281,9 @@ void MainWindow::on_tabWidget_currentChanged(int) // tab changed ?
     bool showDescription = (ui->tabWidget->currentWidget() == ui->tab_duplicates);
     ui->label_algorithm->setVisible(showDescription);
     ui->label_algorithm_arrow->setVisible(showDescription);
+
+    if (ui->tabWidget->currentWidget() == ui->tab_performance) // latest measures
+        on_button_performance_refresh_clicked();
 }
 
 void MainWindow::on_comboBox_algo_currentIndexChanged(int algo) // change algo -> set value to threshold
@@ -297,6 +340,7 @@ void MainWindow::on_comboBox_algo_currentIndexChanged(int algo) // change algo -
     }
 
     ui->doubleSpinBox_threshold->setValue(thresholds[similarityAlgorithm][ui->comboBox_level->currentIndex()]); // set current threshold value for this similarity algorithm
+    UpdateDuplicatesFromThreshold(); // show the results of this algorithm if it was already computed - needed if the threshold value didn't change
     ui->label_algorithm->setText(QString::fromStdString(imageSimilarityDescription[similarityAlgorithm]));
     ui->label_algorithm_arrow->setVisible(true);
 }
@@ -524,6 +568,63 @@ bool MainWindow::DeleteFile(const std::string &filePath) // delete a file to tra
         return (std::remove(filePath.c_str()) == 0);
 }
 
+//// Bulk file operations ////
+
+bool MainWindow::AskFileConflicts(FileOperations &operations, const QString &title) // one question for all existing destinations - false if the user cancels
+{
+    int conflicts = operations.FindConflicts(); // all destinations are checked at once, before anything is done
+    if (conflicts == 0) // nothing would be replaced
+        return true;
+
+    QString list = ""; // show the first ones
+    int shown = 0;
+    for (int n = 0; (n < operations.Count()) and (shown < 10); n++) {
+        const struct_file_operation &operation = operations.Operation(n);
+        if ((operation.exists) and (!operation.sameDestination) and (operation.result == file_result_waiting)) {
+            list += QString::fromStdString(operation.destination) + "\n";
+            shown++;
+        }
+    }
+    if (conflicts > shown)
+        list += "... and " + QString::number(conflicts - shown) + " more\n";
+
+    int confirm = QMessageBox::question(this, title,
+                                        QString::number(conflicts) + " file(s) already exist in the destination folder:\n\n" + list
+                                            + "\nDo you want to replace them?\n('No' keeps the existing files and skips these images)",
+                                        QMessageBox::Yes|QMessageBox::No|QMessageBox::Cancel); // replace, are you sure ?
+    if ((confirm != QMessageBox::Yes) and (confirm != QMessageBox::No)) // cancel or window closed
+        return false;
+
+    operations.SetReplace(confirm == QMessageBox::Yes);
+
+    return true;
+}
+
+void MainWindow::RunFileOperations(FileOperations &operations, const fileOperationType &type, const QString &message) // run a batch in background, with progress and stop button
+{
+    ShowProgress(progress_prepare);
+    ShowProgress(progress_run, message, 0, operations.Count());
+
+    operations.Start(type); // worker threads
+    while (!operations.Wait(100)) { // the GUI thread only shows progress
+        if (stop) // stop button : files not processed yet are left untouched
+            operations.Cancel();
+        ShowProgress(progress_update, "", operations.Done());
+    }
+}
+
+QString MainWindow::FileOperationsErrors(const FileOperations &operations) // errors log of a batch
+{
+    QString errors = "";
+    for (int n = 0; n < operations.Count(); n++) {
+        const struct_file_operation &operation = operations.Operation(n);
+        if ((operation.result == file_result_error) or ((operation.result == file_result_skipped) and (operation.error != ""))) // failed, or skipped for another reason than the user's choice
+            errors += QString::fromStdString(operation.source) + " : " + QString::fromStdString(operation.error) + "\n";
+    }
+
+    return errors;
+}
+
 
 //// Events ////
 
@@ -608,23 +709,7 @@ QPixmap MainWindow::LoadImagePix(const std::string &path, const std::string &eng
 
 cv::Mat MainWindow::LoadImageMat(const std::string &path, const std::string &engine) // return an OpenCV Mat from image file using different loading engines
 {
-    // comments are almost the same as LoadImagePix
-
-    if (engine == "opencv") {
-        cv::Mat img = cv::imread(path, cv::IMREAD_UNCHANGED);
-
-        img = ImageAnydepthToColor(img);
-
-        return img;
-    }
-    else if (engine == "qt") {
-        QPixmap img = QPixmap(QString::fromStdString(path));
-
-        if (!img.isNull())
-            return QPixmap2Mat(img);
-    }
-
-    return cv::Mat();
+    return LoadImageFile(path, engine); // shared with the headless commands - safe in the omp threads
 }
 
 void MainWindow::on_button_add_images_clicked() // button pressed -> add images to list
@@ -649,7 +734,7 @@ void MainWindow::on_button_images_clear_clicked() // button pressed -> clear ima
     images.clear(); // clear internal images list
 
     // images list
-    ui->listWidget_image_list->clear(); // no images shown in images list
+    imagesListModel->Clear(); // no images shown in images list
     ShowImagesListCount(); // show 0 files in images list
 
     // clear duplicates
@@ -658,14 +743,12 @@ void MainWindow::on_button_images_clear_clicked() // button pressed -> clear ima
     ui->frame_group_reduced_size->setDisabled(false);
 }
 
-void MainWindow::ImagesListClick(QListWidgetItem *item) // click on item in images list -> toggle checked status
+void MainWindow::ImagesListClick(const QModelIndex &index) // click on item in images list -> toggle checked status
 {
-    if (item->checkState() == Qt::Checked) { // is the item checked ?
-        item->setCheckState(Qt::Unchecked); // so uncheck it
-    }
-    else { // item is unchecked
-        item->setCheckState(Qt::Checked); // so check it
-    }
+    if (!index.isValid())
+        return;
+
+    imagesListModel->SetChecked(index.row(), !imagesListModel->IsChecked(index.row())); // toggle check state
 }
 
 QString MainWindow::GetImageClass(const int &imgNumber) // get DNN class of an image if it exists
@@ -686,9 +769,12 @@ QString MainWindow::GetImageClass(const int &imgNumber) // get DNN class of an i
     return "";
 }
 
-void MainWindow::ImagesListDoubleClick(QListWidgetItem *item) // double-click on item of images list -> show image in new window
+void MainWindow::ImagesListDoubleClick(const QModelIndex &index) // double-click on item of images list -> show image in new window
 {
-    int imgNumber = item->data(Qt::UserRole).toInt(); // get image number in internal images list
+    if (!index.isValid())
+        return;
+
+    int imgNumber = imagesListModel->Image(index.row()); // get image number in internal images list
 
     if ((images[imgNumber].deleted) or (images[imgNumber].error)) // image is not valid ?
         return; // exit
@@ -708,7 +794,7 @@ void MainWindow::ImagesListDoubleClick(QListWidgetItem *item) // double-click on
     label_img->setPixmap(pix); // add the image to widget
     label_img->show(); // show the new window
 
-    ImagesListClick(item); // double-click problem : a single click is detected first so check/uncheck the same image in images list
+    ImagesListClick(index); // double-click problem : a single click is detected first so check/uncheck the same image in images list
 
     // question : is the created QLabel (with "new") properly freed from memory when the window is closed ? should I "delete" it ? valgrinder seems not to mind so probably NO
     // when the window is closed the widget surely "dies"
@@ -718,60 +804,46 @@ void MainWindow::ImagesListDoubleClick(QListWidgetItem *item) // double-click on
 
 void MainWindow::on_button_images_uncheck_all_clicked() // button pressed -> uncheck all images in images list
 {
-    for(int n = 0; n < ui->listWidget_image_list->count(); n++) { // parse all widget items
-        QListWidgetItem* item = ui->listWidget_image_list->item(n); // current item
-        item->setCheckState(Qt::Unchecked); // uncheck it
-    }
+    imagesListModel->SetAllChecked(false); // one update for the whole view
 }
 
 void MainWindow::on_button_images_check_all_clicked() // button pressed -> check all images in images list
 {
-    for(int n = 0; n < ui->listWidget_image_list->count(); n++) { // almost same comment as on_button_images_uncheck_all_clicked()
-        QListWidgetItem* item = ui->listWidget_image_list->item(n);
-        item->setCheckState(Qt::Checked);
-    }
+    imagesListModel->SetAllChecked(true);
 }
 
 void MainWindow::on_button_images_uncheck_all_selected_clicked() // button pressed -> uncheck selected images in images list
 {
-    for(int n = 0; n < ui->listWidget_image_list->count(); n++) { // parse all widget items
-        QListWidgetItem* item = ui->listWidget_image_list->item(n); // current item
-        if (item->isSelected()) // is it selected ?
-            item->setCheckState(Qt::Unchecked); // yes -> uncheck it
-    }
+    const QModelIndexList selected = ui->listView_image_list->selectionModel()->selectedIndexes(); // only selected rows are parsed
+    for (int n = 0; n < selected.size(); n++) // parse selected items
+        imagesListModel->SetChecked(selected[n].row(), false); // uncheck it
 }
 
 void MainWindow::on_button_images_check_all_selected_clicked() // button pressed -> check selected images in images list
 {
-    for(int n = 0; n < ui->listWidget_image_list->count(); n++) { // almost same comment as on_button_images_uncheck_all_selected_clicked()
-        QListWidgetItem* item = ui->listWidget_image_list->item(n);
-        if (item->isSelected())
-            item->setCheckState(Qt::Checked);
-    }
+    const QModelIndexList selected = ui->listView_image_list->selectionModel()->selectedIndexes(); // almost same comment as on_button_images_uncheck_all_selected_clicked()
+    for (int n = 0; n < selected.size(); n++)
+        imagesListModel->SetChecked(selected[n].row(), true);
 }
 
 void MainWindow::on_button_images_check_invert_clicked() // button pressed -> invert check state in images list
 {
-    for(int n = 0; n < ui->listWidget_image_list->count(); n++) { // parse all widget items
-        QListWidgetItem* item = ui->listWidget_image_list->item(n); // current item
-        if (item->checkState() == Qt::Checked) // is the item checked ?
-            item->setCheckState(Qt::Unchecked); // uncheck it
-        else // item was not checked ?
-            item->setCheckState(Qt::Checked); // check it
-    }
+    imagesListModel->InvertChecked(); // one update for the whole view
 }
 
 void MainWindow::on_button_images_check_text_clicked() // button pressed -> find words and check images in images list
 {
     Qt::CheckState checkedState = ui->checkBox_images->checkState(); // use the current reference check state near the text field
+    const QString text = ui->lineEdit_images_check_text->text(); // text to find
 
-    for(int n = 0; n < ui->listWidget_image_list->count(); n++) { // parse all widget items
-        QListWidgetItem* item = ui->listWidget_image_list->item(n); // current item
-        if ((item->text().contains(ui->lineEdit_images_check_text->text(), Qt::CaseInsensitive)) or (item->toolTip().contains(ui->lineEdit_images_check_text->text(), Qt::CaseInsensitive))) { // is the searched text found in this item's text ?
-            item->setCheckState(checkedState); // set its check state to reference check state
-            item->setSelected(true);
+    QItemSelection selection; // found items are selected all at once
+    for (int n = 0; n < imagesListModel->Count(); n++) { // parse all rows
+        if ((imagesListModel->Text(n).contains(text, Qt::CaseInsensitive)) or (imagesListModel->ToolTip(n).contains(text, Qt::CaseInsensitive))) { // is the searched text found in this item's text ?
+            imagesListModel->SetChecked(n, checkedState == Qt::Checked); // set its check state to reference check state
+            selection.select(imagesListModel->index(n), imagesListModel->index(n));
         }
     }
+    ui->listView_image_list->selectionModel()->select(selection, QItemSelectionModel::Select);
 }
 
 void MainWindow::on_button_images_check_text_dnn_clicked() // button pressed -> find classes with DNN and check images in images list
@@ -786,7 +858,7 @@ void MainWindow::on_button_images_check_text_dnn_clicked() // button pressed ->
     int progress = 0; // overall progression
     int count = 0; // for gui refresh
     int countLimit = 10;
-    int sum = ui->listWidget_image_list->count(); // number of images to check
+    int sum = imagesListModel->Count(); // number of images to check
     ShowProgress(progress_prepare);
     ShowProgress(progress_run, "Searching images context", 0, sum);
     ShowProgress(progress_update, "", 0);
@@ -795,9 +867,8 @@ void MainWindow::on_button_images_check_text_dnn_clicked() // button pressed ->
         PrepareDNN();
     }
 
-    for (int n = 0; n < ui->listWidget_image_list->count(); n++) { // parse all widget items
-        QListWidgetItem* item = ui->listWidget_image_list->item(n); // current item
-        int nbImage = item->data(Qt::UserRole).toInt();
+    for (int n = 0; n < imagesListModel->Count(); n++) { // parse all rows
+        int nbImage = imagesListModel->Image(n);
 
         if ((!images[nbImage].error) and (!images[nbImage].deleted)) {
             if (images[nbImage].hashDNN.empty())  // if classes are not already computed
@@ -808,8 +879,8 @@ void MainWindow::on_button_images_check_text_dnn_clicked() // button pressed ->
                     std::string text = classes[images[nbImage].hashDNN.at<int>(0, current)];
                     std::size_t pos = text.find(toFind);
                     if (pos != std::string::npos) { // text found ?
-                        item->setCheckState(checkedState); // set its check state to reference check state
-                        item->setSelected(true);
+                        imagesListModel->SetChecked(n, checkedState == Qt::Checked); // set its check state to reference check state
+                        ui->listView_image_list->selectionModel()->select(imagesListModel->index(n), QItemSelectionModel::Select);
                         break;
                     }
                 }
@@ -832,11 +903,9 @@ void MainWindow::on_button_images_check_text_dnn_clicked() // button pressed ->
 
 //// Remove and delete and move
 
-void MainWindow::RemoveImageFromListImages(QListWidgetItem *item) // remove one item from image list by its pointer
+void MainWindow::RemoveImagesFromListImages(const std::vector<int> &imagesToRemove) // remove images from images list view
 {
-    int numImageItem = ui->listWidget_image_list->row(item); // get the image index from QListWidget images list
-    QListWidgetItem *imageItem = ui->listWidget_image_list->takeItem(numImageItem); // delete it from view
-    delete imageItem; // free item memory
+    imagesListModel->RemoveImages(imagesToRemove); // all at once : the view is laid out only once
 }
 
 void MainWindow::on_button_images_hide_clicked() // button pressed -> hide checked images from list
@@ -846,19 +915,12 @@ void MainWindow::on_button_images_hide_clicked() // button pressed -> hide check
     ShowProgress(progress_run, "Removing images", 0, 1);
     ShowProgress(progress_update, 0);
 
-    bool removed = false; // indicates if at least one image was removed
-    for (int n = 0; n < ui->listWidget_image_list->count(); n++) { // parse all images in images list
-        QListWidgetItem *item = ui->listWidget_image_list->item(n); // current item
-        if (item->checkState() == Qt::Checked) { // is it checked ?
-            int ref = item->data(Qt::UserRole).toInt(); // get image index in internal list
-            images[ref].deleted = true; // set its flag to deleted
-            RemoveImageFromListImages(item); // remove image from images list
-            removed = true; // at least one image was removed
-            n--; // one item left -> decrease current item index by 1
-        }
-    }
+    std::vector<int> checked = imagesListModel->CheckedImages(); // checked images
+    for (int n = 0; n < int(checked.size()); n++) // parse them
+        images[checked[n]].deleted = true; // set its flag to deleted
+    RemoveImagesFromListImages(checked); // remove images from images list
 
-    if (removed) { // was at least one image removed from the list ?
+    if (!checked.empty()) { // was at least one image removed from the list ?
         ShowImagesListCount();
         ClearDuplicates(); // clear duplicates list and enable gui items and clear some variables too
     }
@@ -874,12 +936,14 @@ void MainWindow::on_button_images_hide_error_clicked() // button pressed -> hide
     ShowProgress(progress_run, "Removing images with errors", 0, 1);
     ShowProgress(progress_update, 0);
 
+    std::vector<int> errors; // images to remove from view
     for (int n = 0; n < int(images.size()); n++) { // parse all internal images list
         if ((images[n].error) and (!images[n].deleted)) { // is the image tagged as error ?
-            RemoveImageFromListImages(images[n].imageItem); // remove it from view
+            errors.push_back(n); // remove it from view
             images[n].deleted = true; // tag image as deleted
         }
     }
+    RemoveImagesFromListImages(errors);
 
     // GUI elements
     ShowProgress(progress_finished, "Images with errors removed");
@@ -894,32 +958,26 @@ void MainWindow::on_button_images_delete_clicked() // butoon pressed -> delete i
     if (sure == QMessageBox::No) // don't delete files !
         return;
 
-    // progress - this operation can be long if the images list is huge
-    ShowProgress(progress_prepare);
-    ShowProgress(progress_run, "Deleting images", 0, 1);
-    ShowProgress(progress_update, 0);
-
-    QString errors = ""; // get track of problems when deleting images
+    std::vector<int> checked = imagesListModel->CheckedImages(); // checked images
+    FileOperations operations; // all files are deleted in background
+    for (int n = 0; n < int(checked.size()); n++) // parse checked images
+        operations.Add(checked[n], images[checked[n]].fullPath);
+    operations.SetDeleteFunction([this](const std::string &path) { return DeleteFile(path); }); // to trash bin if possible
 
-    bool deleted = false; // indicate if at least one image file was deleted
-    for (int n = 0; n < ui->listWidget_image_list->count(); n++) { // parse images list
-        QListWidgetItem *item = ui->listWidget_image_list->item(n); // this item
-        if (item->checkState() == Qt::Checked) { // is it checked ?
-            int ref = item->data(Qt::UserRole).toInt(); // get internal image index
+    // progress - this operation can be long if the images list is huge
+    RunFileOperations(operations, file_operation_delete, "Deleting images");
 
-            if (!DeleteFile(images[ref].fullPath.c_str())) { // error deleting image file ?
-                errors += QString::fromStdString(images[ref].fullPath) + "\n"; // add entry to errors log
-            }
-            else { // file image was deleted successfully : remove it from images list
-                images[ref].deleted = true; // set image flag as deleted
-                RemoveImageFromListImages(item); // hide it from view
-                deleted = true; // at least one image was deleted
-                n--; // one image less -> decrease current image index by 1
-            }
+    std::vector<int> deleted; // images which file was deleted
+    for (int n = 0; n < operations.Count(); n++) { // parse results
+        if (operations.Operation(n).result == file_result_done) { // file image was deleted successfully : remove it from images list
+            int ref = operations.Operation(n).id; // internal image index
+            images[ref].deleted = true; // set image flag as deleted
+            deleted.push_back(ref); // hide it from view
         }
     }
+    RemoveImagesFromListImages(deleted);
 
-    if (deleted) { // at least one image file was deleted ?
+    if (!deleted.empty()) { // at least one image file was deleted ?
         ShowImagesListCount();
         ClearDuplicates(); // clear duplicates list and enable gui items and clear some variables too
     }
@@ -927,6 +985,7 @@ void MainWindow::on_button_images_delete_clicked() // butoon pressed -> delete i
     // GUI elements
     ShowProgress(progress_finished, "Images deleted");
 
+    QString errors = FileOperationsErrors(operations); // get track of problems when deleting images
     if (errors != "") { // errors were found ?
         QMessageBox::warning(this, "Errors deleting image files", "Some images files could not be deleted.\nHere is the list of images that failed:\n\n" + errors); // show them in message box
     }
@@ -942,59 +1001,43 @@ void MainWindow::on_button_images_move_clicked() // button pressed -> move files
     dir += "/";
     std::string folder = dir.toUtf8().constData();
 
+    std::vector<int> checked = imagesListModel->CheckedImages();
+    FileOperations operations;
+    for (int i = 0; i < int(checked.size()); i++)
+        operations.Add(checked[i], images[checked[i]].fullPath, folder + images[checked[i]].basename);
+    if (!AskFileConflicts(operations, "Moving image files...")) // existing files : replace, skip or cancel - asked once for all
+        return;
+
     // progress
-    ShowProgress(progress_prepare);
-    ShowProgress(progress_run, "Moving image files", 0, 1);
-    ShowProgress(progress_update, 0);
+    RunFileOperations(operations, file_operation_move, "Moving image files");
+
+    std::unordered_map<std::string, int> paths; // images in the list by file path : a moved file can replace one of them
+    for (int n = 0; n < int(images.size()); n++)
+        if (!images[n].deleted)
+            paths[images[n].fullPath] = n;
 
-    QString errors = "";
-    bool moveConfirm = false;
     bool moved = false; // indicate that at least one file was moved
-    for (int i = 0; i < ui->listWidget_image_list->count(); i++) {
-        QListWidgetItem *item = ui->listWidget_image_list->item(i);
-        bool confirmThisTime = moveConfirm;
-        if (item->checkState() == Qt::Checked) {
-            int imgNumber = item->data(Qt::UserRole).toInt();
-
-            std::string newFilename = folder + images[imgNumber].basename;
-            std::ifstream inFile(newFilename);
-            if (inFile.good()) { // that means file already exists
-                if (!confirmThisTime) {
-                    int confirm = QMessageBox::question(this, "Moving file image...", "Are you sure you want to move the file image?\n" + QString::fromStdString(images[imgNumber].fullPath), QMessageBox::Yes|QMessageBox::No|QMessageBox::YesToAll); // move, are you sure ?
-                    if (confirm == QMessageBox::YesToAll) {
-                        moveConfirm = true;
-                    }
-                    else if (confirm == QMessageBox::Yes) {
-                        confirmThisTime = true;
-                    }
-                }
-            }
-            else {
-                confirmThisTime = true;
-            }
+    std::vector<int> removed; // images replaced by a moved file
+    for (int i = 0; i < operations.Count(); i++) {
+        const struct_file_operation &operation = operations.Operation(i);
+        if (operation.result != file_result_done)
+            continue;
 
-            if ((moveConfirm) or (confirmThisTime)) {
-                if (std::rename(images[imgNumber].fullPath.c_str(), newFilename.c_str()) != 0) { // error moving image file ?
-                    errors += QString::fromStdString(images[imgNumber].fullPath) + "\n"; // add entry to errors log
-                }
-                else { // file image was moved successfully : update image data (internal and images list and duplicates)
-                    moved = true; // at least one file was moved
-                    images[imgNumber].fullPath = newFilename; // change full path in internal images list
-                    images[imgNumber].folder = folder; // change folder in internal images list
-                    item->setToolTip(QString::fromStdString(newFilename)); // change tooltip in images list
-
-                    for (int n = 0; n < int(images.size()); n++) { // check for duplicates in internal images list with new filename
-                        if ((n != imgNumber) and (images[n].fullPath == newFilename)) { // don't test current image itself ! is the filename the same ?
-                            images[n].deleted = true; // delete it, it's a duplicate !
-                            RemoveImageFromListImages(images[n].imageItem); // remove image from displayed images list
-                            break; // duplicate found, no need to test the other children
-                        }
-                    }
-                }
-            }
+        // file image was moved successfully : update image data (internal and images list and duplicates)
+        int imgNumber = operation.id;
+        moved = true; // at least one file was moved
+        auto replaced = paths.find(operation.destination); // check for duplicates in internal images list with new filename
+        if ((replaced != paths.end()) and (replaced->second != imgNumber)) { // don't test current image itself !
+            images[replaced->second].deleted = true; // delete it, it's a duplicate !
+            removed.push_back(replaced->second); // remove image from displayed images list
         }
+        images[imgNumber].fullPath = operation.destination; // change full path in internal images list
+        images[imgNumber].folder = folder; // change folder in internal images list
+        imagesListModel->SetToolTip(imgNumber, QString::fromStdString(operation.destination)); // change tooltip in images list
     }
 
+    RemoveImagesFromListImages(removed);
+
     if (moved) { // at least one file was moved
         ShowImagesListCount();
         ClearDuplicates();
@@ -1002,6 +1045,7 @@ void MainWindow::on_button_images_move_clicked() // button pressed -> move files
 
     ShowProgress(progress_finished, "Image files moved");
 
+    QString errors = FileOperationsErrors(operations);
     if (errors != "") {
         QMessageBox::warning(this, "Errors moving image files", "Some images files could not be moved.\nHere is the list of images that failed:\n\n" + errors);
     }
@@ -1014,10 +1058,10 @@ void MainWindow::on_spinBox_thumbnails_size_valueChanged(int size) // change thu
 {
     thumbnailsSize = size; // new thumbnails size
 
-    ui->listWidget_image_list->setIconSize(QSize(thumbnailsSize, thumbnailsSize)); // set new thumbnail size in images list
-    ui->listWidget_image_list->setGridSize(QSize(230 - 180 + thumbnailsSize, 250 - 180 + thumbnailsSize)); // and also change the grid size accordingly
-    ui->treeWidget_duplicates->setIconSize(QSize(thumbnailsSize, thumbnailsSize - 30)); // set new thumbnail size in duplicates list
-    ui->treeWidget_duplicates->setColumnWidth(1, thumbnailsSize + 20); // and also change the corresponding column size accordingly
+    ui->listView_image_list->setIconSize(QSize(thumbnailsSize, thumbnailsSize)); // set new thumbnail size in images list
+    ui->listView_image_list->setGridSize(QSize(230 - 180 + thumbnailsSize, 250 - 180 + thumbnailsSize)); // and also change the grid size accordingly
+    ui->treeView_duplicates->setIconSize(QSize(thumbnailsSize, thumbnailsSize - 30)); // set new thumbnail size in duplicates list
+    ui->treeView_duplicates->setColumnWidth(1, thumbnailsSize + 20); // and also change the corresponding column size accordingly
 }
 
 void MainWindow::on_spinBox_reduced_size_valueChanged(int size) // change working image size
@@ -1032,10 +1076,23 @@ void MainWindow::on_spinBox_nb_features_valueChanged(int nb) // change number of
     nbFeatures = nb;
 }
 
+void MainWindow::on_checkBox_dihedral_toggled(bool checked) // find rotated and mirrored copies with pHash, dHash and idHash
+    // options are not available if one of these hashes was computed so no need to recompute anything else
+{
+    dihedralHashes = checked;
+}
+
+void MainWindow::on_checkBox_features_pruning_toggled(bool checked) // features and homography : only compare the candidates of each image, or all pairs
+    // options are not available if features or homography were computed so no need to recompute anything else
+{
+    featuresPruning = checked;
+}
+
 void MainWindow::on_doubleSpinBox_threshold_valueChanged(double nb) // change threshold
-    // options are not available if images were loaded so no need to recompute anything else
+    // if the current algorithm was already computed, the duplicates are updated from the scores in cache, no need to compare images again
 {
     threshold = nb;
+    UpdateDuplicatesFromThreshold();
 }
 
 /// Duplicates
@@ -1052,14 +1109,18 @@ void MainWindow::ClearDuplicates() // clear duplicates list and associated GUI e
     // variables
     pairs.clear(); // clear images pairs scores
     groups.clear(); // clear images groups list
+    thresholdEdges.clear(); // no more sorted scores
+    shownAlgorithm = -1; // nothing displayed
 
     // duplicates list
-    ui->treeWidget_duplicates->clear(); // no images shown in duplicates list
+    duplicatesTreeModel->Clear(); // no images shown in duplicates list
 
     // options in options tab
     ui->frame_group_thumbnails_size->setDisabled(true);
     ui->frame_group_reduced_size->setDisabled(true);
     ui->frame_group_nb_features->setDisabled(false);
+    ui->frame_group_dihedral->setDisabled(false);
+    ui->frame_group_features_pruning->setDisabled(false);
 
     // disable algorithms in ui
     for (int i = img_similarity_checksum; i < img_similarity_count; i++) {
@@ -1084,161 +1145,79 @@ void MainWindow::on_button_duplicates_clear_clicked() // button pressed -> clear
 
 // Check
 
-void MainWindow::DuplicatesListClick(QTreeWidgetItem *item, int column) // click anywhere (except the image) on duplicate item to check it
+void MainWindow::DuplicatesListClick(const QModelIndex &index) // click anywhere (except the image) on duplicate item to check it
 {
-    if (!item->parent()) // black items are also clickable but are not real items
+    const int image = duplicatesTreeModel->Image(index); // index in internal images list
+    if (image == -1) // group bars are also clickable but are not real items
         return; // exit
 
-    if (column != 1) { // you have to click anywhere BUT the image to check an item
-        int state = item->checkState(0); // get item's check state
-        if (state == Qt::Checked) { // is it checked ?
-            item->setCheckState(0, Qt::Unchecked); // uncheck it !
-            for (int i = 3; i < 6; i++) // change item colors to indicate it is unchecked (only on right side)
-                item->setBackground(i, QColor(148, 148, 148)); // gray
-        }
-        else { // item was NOT checked
-            item->setCheckState(0, Qt::Checked); // check it
-            for (int i = 3; i < 6; i++) // change item colors to indicate it is checked (only on right side)
-                item->setBackground(i, QColor(255, 153, 153)); // pale red
-        }
-    }
+    if (index.column() > duplicates_column_icon) // you have to click anywhere BUT the image to check an item - the checkbox itself is handled by the model
+        duplicatesTreeModel->SetChecked(image, !duplicatesTreeModel->IsChecked(image)); // toggle check state, the model changes the colors of the right side too
 }
 
 void MainWindow::on_button_duplicates_uncheck_all_clicked() // button pressed -> uncheck all duplicates in duplicates list
 {
-    for (int i = 0; i < ui->treeWidget_duplicates->topLevelItemCount(); i++) { // parse all top duplicates items (groups)
-        QTreeWidgetItem *topItem = ui->treeWidget_duplicates->topLevelItem(i); // current top item
-        for (int j = 0; j < topItem->childCount(); j++) { // parse its children
-            QTreeWidgetItem *item = topItem->child(j); // current child
-            item->setCheckState(0, Qt::Unchecked); // uncheck it
-            for (int k = 3; k < 7; k++) // change item colors to indicate it is unchecked (only on right side)
-                item->setBackground(k, QColor(148, 148, 148)); // gray
-        }
-    }
+    duplicatesTreeModel->SetAllChecked(false); // uncheck all, rows turn gray
 }
 
 void MainWindow::on_button_duplicates_check_all_clicked() // button pressed -> check all duplicates in duplicates list
 {
-    for (int i = 0; i < ui->treeWidget_duplicates->topLevelItemCount(); i++) { // almost same comments as on_button_duplicates_uncheck_all_clicked()
-        QTreeWidgetItem *topItem = ui->treeWidget_duplicates->topLevelItem(i);
-        for (int j = 0; j < topItem->childCount(); j++) {
-            QTreeWidgetItem *item = topItem->child(j);
-            item->setCheckState(0, Qt::Checked); // check it
-            for (int k = 3; k < 7; k++)
-                item->setBackground(k, QColor(255, 153, 153)); // pale red
-        }
-    }
+    duplicatesTreeModel->SetAllChecked(true); // check all, rows turn pale red
 }
 
 void MainWindow::on_button_duplicates_check_invert_clicked() // button pressed -> invert all checks in duplicates list
 {
-    for (int i = 0; i < ui->treeWidget_duplicates->topLevelItemCount(); i++) { // almost same comments as on_button_duplicates_uncheck_all_clicked()
-        QTreeWidgetItem *topItem = ui->treeWidget_duplicates->topLevelItem(i);
-        for (int j = 0; j < topItem->childCount(); j++) {
-            QTreeWidgetItem *item = topItem->child(j);
-            if (item->checkState(0) == Qt::Unchecked) { // if unchecked check it
-                item->setCheckState(0, Qt::Checked);
-                for (int k = 3; k < 7; k++)
-                    item->setBackground(k, QColor(255, 153, 153)); // pale red
-            }
-            else {
-                item->setCheckState(0, Qt::Unchecked); // if checked uncheck it
-                for (int k = 3; k < 7; k++)
-                    item->setBackground(k, QColor(148, 148, 148)); // gray
-            }
-        }
-    }
+    duplicatesTreeModel->InvertChecked();
 }
 
 void MainWindow::on_button_duplicates_check_first_clicked() // button pressed -> check first duplicate in each group in duplicates list
 {
-    Qt::CheckState checkedState = ui->checkBox_duplicates->checkState(); // get reference checked state
+    bool checkedState = (ui->checkBox_duplicates->checkState() == Qt::Checked); // get reference checked state
 
-    for (int i = 0; i < ui->treeWidget_duplicates->topLevelItemCount(); i++) { // almost same comments as on_button_duplicates_uncheck_all_clicked()
-        QTreeWidgetItem *topItem = ui->treeWidget_duplicates->topLevelItem(i);
-        QTreeWidgetItem *item = topItem->child(0); // only test first child
-        if (item) {
-            item->setCheckState(0, checkedState);
-            if (checkedState == Qt::Checked) {
-                for (int k = 3; k < 7; k++)
-                    item->setBackground(k, QColor(255, 153, 153));
-            }
-            else {
-                for (int k = 3; k < 7; k++)
-                    item->setBackground(k, QColor(148, 148, 148));
-            }
-        }
-    }
+    std::vector<int> first; // first image of each group, as displayed
+    first.reserve(duplicatesTreeModel->GroupsCount());
+    for (int i = 0; i < duplicatesTreeModel->GroupsCount(); i++) // parse all groups
+        first.push_back(duplicatesTreeModel->GroupImages(i)[0]); // only first image
+    duplicatesTreeModel->SetImagesChecked(first, checkedState);
 }
 
 void MainWindow::on_button_duplicates_check_rest_clicked() // button pressed -> check all duplicates in each group but first one in duplicates list
 {
-    Qt::CheckState checkedState = ui->checkBox_duplicates->checkState(); // almost same comments as oon_button_duplicates_check_first_clicked()
+    bool checkedState = (ui->checkBox_duplicates->checkState() == Qt::Checked); // almost same comments as on_button_duplicates_check_first_clicked()
 
-    for (int i = 0; i < ui->treeWidget_duplicates->topLevelItemCount(); i++) {
-        QTreeWidgetItem *topItem = ui->treeWidget_duplicates->topLevelItem(i);
-        for (int j = 1; j < topItem->childCount(); j++) { // parse all children BUT the first one
-            QTreeWidgetItem *item = topItem->child(j);
-            item->setCheckState(0, checkedState);
-            if (checkedState == Qt::Checked) {
-                for (int k = 3; k < 7; k++)
-                    item->setBackground(k, QColor(255, 153, 153));
-            }
-            else {
-                for (int k = 3; k < 7; k++)
-                    item->setBackground(k, QColor(148, 148, 148));
-            }
-        }
+    std::vector<int> rest;
+    for (int i = 0; i < duplicatesTreeModel->GroupsCount(); i++) {
+        const std::vector<int> &group = duplicatesTreeModel->GroupImages(i);
+        rest.insert(rest.end(), group.begin() + 1, group.end()); // all images BUT the first one
     }
+    duplicatesTreeModel->SetImagesChecked(rest, checkedState);
 }
 
 void MainWindow::on_button_duplicates_check_text_clicked() // button pressed -> find words and check duplicates in duplicates list
 {
-    Qt::CheckState checkedState = ui->checkBox_duplicates->checkState(); // get reference checked state
-
-    for (int i = 0; i < ui->treeWidget_duplicates->topLevelItemCount(); i++) { // parse all top items (groups)
-        QTreeWidgetItem *topItem = ui->treeWidget_duplicates->topLevelItem(i); // current top item
-        for (int j = 0; j < topItem->childCount(); j++) { // parse all its children
-            QTreeWidgetItem *item = topItem->child(j); // current child
-            int imageNumber = item->data(0, Qt::UserRole).toInt(); // get image index in internal images list
-            if (QString::fromStdString(images[imageNumber].fullPath).contains(ui->lineEdit_duplicates_check_text->text(), Qt::CaseInsensitive)) { // does the full image path contains the searched words ?
-                item->setCheckState(0, checkedState); // current item
-                if (checkedState == Qt::Checked) { // as in other functions before, check or uncheck
-                    for (int k = 3; k < 6; k++)
-                        item->setBackground(k, QColor(255, 153, 153));
-                }
-                else {
-                    for (int k = 3; k < 6; k++)
-                        item->setBackground(k, QColor(148, 148, 148));
-                }
-            }
-        }
+    bool checkedState = (ui->checkBox_duplicates->checkState() == Qt::Checked); // get reference checked state
+    QString text = ui->lineEdit_duplicates_check_text->text(); // searched words
+
+    std::vector<int> found; // images with the searched words
+    for (int i = 0; i < duplicatesTreeModel->GroupsCount(); i++) { // parse all groups
+        const std::vector<int> &group = duplicatesTreeModel->GroupImages(i); // images of current group
+        for (int j = 0; j < int(group.size()); j++) // parse them
+            if (QString::fromStdString(images[group[j]].fullPath).contains(text, Qt::CaseInsensitive)) // does the full image path contains the searched words ?
+                found.push_back(group[j]);
     }
+    duplicatesTreeModel->SetImagesChecked(found, checkedState); // check or uncheck them all at once
 }
 
 //// Remove and delete
 
 void MainWindow::on_button_duplicates_hide_clicked() // button pressed -> hide checked duplicates in duplicates list
 {
-    bool hidden = false; // indicate at least one item was hidden
-    for (int i = 0; i < ui->treeWidget_duplicates->topLevelItemCount(); i++) {
-        QTreeWidgetItem *topItem = ui->treeWidget_duplicates->topLevelItem(i);
-        for (int j = 0; j < topItem->childCount(); j++) {
-            QTreeWidgetItem *item = topItem->child(j);
-            if (item->checkState(0) == Qt::Checked) { // is current item checked ?
-                delete item; // delete it from duplicates view
-                j--; // one duplicate less -> decrease current item index by 1
-                hidden = true; // at least one item was hidden
-            }
-        }
-        if (topItem->childCount() <= 1) { // if a top item is empty or only contains 1 item
-            delete topItem; // delete it
-            i--; // one top item less -> decrease current top item index by 1
-        }
-    }
+    std::vector<int> hidden = duplicatesTreeModel->CheckedImages(); // checked images are hidden
+    if (hidden.empty()) // nothing to hide
+        return;
 
-    if (hidden) // at least one item was hidden ?
-        ShowDuplicatesListCount(); // show new duplicates count
+    duplicatesTreeModel->RemoveImages(hidden); // remove them from duplicates view, groups with only 1 image left too
+    ShowDuplicatesListCount(); // show new duplicates count
 }
 
 void MainWindow::on_button_duplicates_delete_clicked() // button pressed -> remove checked duplicates in duplicates list and delete the image file
@@ -1247,45 +1226,35 @@ void MainWindow::on_button_duplicates_delete_clicked() // button pressed -> remo
     if (sure == QMessageBox::No) // don't delete files !
         return;
 
+    std::vector<int> checkedImages = duplicatesTreeModel->CheckedImages(); // checked images in duplicates list
+    FileOperations operations; // all files are deleted in background
+    for (int n = 0; n < int(checkedImages.size()); n++) // parse them
+        operations.Add(checkedImages[n], images[checkedImages[n]].fullPath);
+    operations.SetDeleteFunction([this](const std::string &path) { return DeleteFile(path); }); // to trash bin if possible
+
     // progress - operation can be long if duplicates list is huge
-    ShowProgress(progress_prepare);
-    ShowProgress(progress_run, "Deleting images files", 0, 1);
-    ShowProgress(progress_update, 0);
+    RunFileOperations(operations, file_operation_delete, "Deleting images files");
 
-    QString errors = ""; // error log
-    bool deleted = false; // indicate that at least one duplicate image file was deleted
-    for (int i = 0; i < ui->treeWidget_duplicates->topLevelItemCount(); i++) { // parse all top items (groups)
-        QTreeWidgetItem *topItem = ui->treeWidget_duplicates->topLevelItem(i); // current top item
-        for (int j = 0; j < topItem->childCount(); j++) { // parse all its children
-            QTreeWidgetItem *item = topItem->child(j); // current child
-            if (item->checkState(0) == Qt::Checked) { // is it checked ?
-                int imgNumber = item->data(0, Qt::UserRole).toInt(); // get internal image list index
-
-                if (!DeleteFile(images[imgNumber].fullPath.c_str())) { // error deleting image file ?
-                    errors += QString::fromStdString(images[imgNumber].fullPath) + "\n"; // add entry to errors log
-                }
-                else { // file image was deleted successfully : remove it from all lists
-                    images[imgNumber].deleted = true;
-                    delete item; // remove image from duplicates list
-                    RemoveImageFromListImages(images[imgNumber].imageItem); // remove image from displayed images list
-                    j--; // one duplicate less -> decrease current item index by 1
-                    deleted = true; // at least one duplicate image file was deleted
-                }
-            }
-        }
-        if (topItem->childCount() <= 1) { // if a top item is empty or only contains 1 item
-            delete topItem; // delete it
-            i--; // one top item less -> decrease current top item index by 1
+    std::vector<int> deletedImages; // to remove from images list and duplicates list, all at once
+    for (int n = 0; n < operations.Count(); n++) { // parse results
+        if (operations.Operation(n).result == file_result_done) { // file image was deleted successfully : remove it from all lists
+            int imgNumber = operations.Operation(n).id; // internal image list index
+            images[imgNumber].deleted = true;
+            deletedImages.push_back(imgNumber); // remove image from displayed lists
         }
     }
 
-    if (deleted) { // at least one duplicate image file was deleted ?
+    duplicatesTreeModel->RemoveImages(deletedImages); // groups with only 1 image left are removed too
+    RemoveImagesFromListImages(deletedImages);
+
+    if (!deletedImages.empty()) { // at least one duplicate image file was deleted ?
         ShowImagesListCount(); // show images and duplicates new count
         ShowDuplicatesListCount();
     }
 
     ShowProgress(progress_finished, "Images removed");
 
+    QString errors = FileOperationsErrors(operations); // error log
     if (errors != "") { // error log not empty ? There were errors !
         QMessageBox::warning(this, "Errors deleting image files", "Some images files could not be deleted.\nHere is the list of images that failed:\n\n" + errors); // show log in message box
     }
@@ -1301,51 +1270,19 @@ void MainWindow::on_button_duplicates_copy_clicked() // button pressed -> copy f
     dir += "/"; // add a folder separator to folder : this will be the base for all copied files
     std::string folder = dir.toUtf8().constData(); // convert it to std::string
 
-    // progress - it could take some time if the duplicates list is huge
-    ShowProgress(progress_prepare);
-    ShowProgress(progress_run, "Copying image files", 0, 1);
-    ShowProgress(progress_update, 0);
-
-    QString errors = ""; // error log
-    bool copyConfirm = false; // indicator for user's choice to confirm file replacement
-    for (int i = 0; i < ui->treeWidget_duplicates->topLevelItemCount(); i++) { // parse all top items (groups)
-        QTreeWidgetItem *topItem = ui->treeWidget_duplicates->topLevelItem(i); // current top item
-        for (int j = 0; j < topItem->childCount(); j++) { // parse all its children
-            bool confirmThisTime = copyConfirm; // indicator for user's choice to confirm file replacement - ONCE - if "replace all" was chosen by user, it is always confirmed for this time...
-            QTreeWidgetItem *item = topItem->child(j); // current child item
-            if (item->checkState(0) == Qt::Checked) { // is it checked ? then we have to copy it
-                int imgNumber = item->data(0, Qt::UserRole).toInt(); // get internal image index
-
-                std::string newFilename = folder + images[imgNumber].basename; // destination full file path
-                std::ifstream inFile(newFilename); // does it already exist ?
-                if (inFile.good()) { // that means file already exists
-                    if (!confirmThisTime) { // confirm replacement indicator ONCE not set ?
-                        int confirm = QMessageBox::question(this, "Copying file image...",
-                                                            "The file already exists.\nAre you sure you want to copy the file image?\n" + QString::fromStdString(images[imgNumber].fullPath),
-                                                            QMessageBox::Yes|QMessageBox::No|QMessageBox::YesToAll); // copy, are you sure ?
-                        if (confirm == QMessageBox::YesToAll) { // user confirmed replacement for all files ?
-                            copyConfirm = true; // set indicator to copy file
-                        }
-                        else if (confirm == QMessageBox::Yes) { // user confirmed replacement for this file ?
-                            confirmThisTime = true; // yes for ONCE
-                        }
-                    }
-                }
-                else { // file didn't exist in destination folder
-                    confirmThisTime = true; // so copy it
-                }
+    std::vector<int> checkedImages = duplicatesTreeModel->CheckedImages(); // checked images in duplicates list : we have to copy them
+    FileOperations operations; // all files are copied in background
+    for (int n = 0; n < int(checkedImages.size()); n++) // parse them
+        operations.Add(checkedImages[n], images[checkedImages[n]].fullPath, folder + images[checkedImages[n]].basename); // destination full file path
+    if (!AskFileConflicts(operations, "Copying image files...")) // existing files : replace, skip or cancel - asked once for all
+        return;
 
-                if ((copyConfirm) or (confirmThisTime)) { // confirmation to copy the file ?
-                    if (!std::filesystem::copy_file(images[imgNumber].fullPath.c_str(), newFilename.c_str(), std::filesystem::copy_options::overwrite_existing)) { // error copying image file ?
-                        errors += QString::fromStdString(images[imgNumber].fullPath) + "\n"; // add entry to errors log
-                    }
-                }
-            }
-        }
-    }
+    // progress - it could take some time if the duplicates list is huge
+    RunFileOperations(operations, file_operation_copy, "Copying image files");
 
     ShowProgress(progress_finished, "Image files copied");
 
+    QString errors = FileOperationsErrors(operations); // error log
     if (errors != "") { // errors were found ?
         QMessageBox::warning(this, "Errors copying image files", "Some images files could not be copied.\nHere is the list of images that failed:\n\n" + errors); // show log in message box
     }
@@ -1363,69 +1300,45 @@ void MainWindow::on_button_duplicates_move_clicked() // button pressed -> move f
     dir += "/";
     std::string folder = dir.toUtf8().constData();
 
+    std::vector<int> checkedImages = duplicatesTreeModel->CheckedImages();
+    FileOperations operations;
+    for (int c = 0; c < int(checkedImages.size()); c++)
+        operations.Add(checkedImages[c], images[checkedImages[c]].fullPath, folder + images[checkedImages[c]].basename);
+    if (!AskFileConflicts(operations, "Moving image files..."))
+        return;
+
     // progress
-    ShowProgress(progress_prepare);
-    ShowProgress(progress_run, "Moving image files", 0, 1);
-    ShowProgress(progress_update, 0);
+    RunFileOperations(operations, file_operation_move, "Moving image files");
+
+    std::unordered_map<std::string, int> paths; // images in the list by file path : a moved file can replace one of them
+    for (int n = 0; n < int(images.size()); n++)
+        if (!images[n].deleted)
+            paths[images[n].fullPath] = n;
 
-    QString errors = "";
-    bool moveConfirm = false;
     bool moved = false; // indicate that at least one file was moved
-    for (int i = 0; i < ui->treeWidget_duplicates->topLevelItemCount(); i++) {
-        QTreeWidgetItem *topItem = ui->treeWidget_duplicates->topLevelItem(i);
-        for (int j = 0; j < topItem->childCount(); j++) {
-            bool confirmThisTime = moveConfirm;
-            QTreeWidgetItem *item = topItem->child(j);
-            if (item->checkState(0) == Qt::Checked) {
-                int imgNumber = item->data(0, Qt::UserRole).toInt();
-
-                std::string newFilename = folder + images[imgNumber].basename;
-                std::ifstream inFile(newFilename);
-                if (inFile.good()) { // that means file already exists
-                    if (!confirmThisTime) {
-                        int confirm = QMessageBox::question(this, "Moving file image...", "Are you sure you want to move the file image?\n" + QString::fromStdString(images[imgNumber].fullPath), QMessageBox::Yes|QMessageBox::No|QMessageBox::YesToAll); // move, are you sure ?
-                        if (confirm == QMessageBox::YesToAll) {
-                            moveConfirm = true;
-                        }
-                        else if (confirm == QMessageBox::Yes) {
-                            confirmThisTime = true;
-                        }
-                    }
-                }
-                else {
-                    confirmThisTime = true;
-                }
+    std::vector<int> removed; // images replaced by a moved file
+    for (int c = 0; c < operations.Count(); c++) {
+        const struct_file_operation &operation = operations.Operation(c);
+        if (operation.result != file_result_done)
+            continue;
 
-                if ((moveConfirm) or (confirmThisTime)) {
-                    if (std::rename(images[imgNumber].fullPath.c_str(), newFilename.c_str()) != 0) { // error moving image file ?
-                        errors += QString::fromStdString(images[imgNumber].fullPath) + "\n"; // add entry to errors log
-                    }
-                    else { // file image was moved successfully : update image data (internal and images list and duplicates)
-                        moved = true; // at least one file was moved
-                        images[imgNumber].fullPath = newFilename; // change full path in internal images list
-                        images[imgNumber].folder = folder; // change folder in internal images list
-                        item->setText(6, QString::fromStdString(images[imgNumber].folder)); // change folder in duplicates list
-                        item->setToolTip(6, QString::fromStdString(images[imgNumber].fullPath)); // change tooltip in duplicates list
-                        images[imgNumber].imageItem->setToolTip(QString::fromStdString(newFilename)); // change tooltip in images list
-
-                        for (int n = 0; n < int(images.size()); n++) { // check for duplicates in internal images list with new filename
-                            if ((n != imgNumber) and (images[n].fullPath == newFilename)) { // don't test current image itself ! is the filename the same ?
-                                images[n].deleted = true; // delete it, it's a duplicate !
-                                RemoveImageFromListImages(images[n].imageItem); // remove image from displayed images list
-                                QTreeWidgetItem *top = images[n].duplicateItem->parent(); // get this duplicate's group in duplicates list
-                                if (images[n].duplicateItem) // this duplicate was listed ?
-                                    delete images[n].duplicateItem; // delete it from the list
-                                if ((top) and (top->childCount() <= 1)) // is the parent valid ? is the group still valid ?
-                                    delete top; // delete it
-                                break; // duplicate found, no need to test the other children
-                            }
-                        }
-                    }
-                }
-            }
+        // file image was moved successfully : update image data (internal and images list and duplicates)
+        int imgNumber = operation.id;
+        moved = true; // at least one file was moved
+        auto replaced = paths.find(operation.destination); // check for duplicates in internal images list with new filename
+        if ((replaced != paths.end()) and (replaced->second != imgNumber)) { // don't test current image itself !
+            images[replaced->second].deleted = true; // delete it, it's a duplicate !
+            removed.push_back(replaced->second);
         }
+        images[imgNumber].fullPath = operation.destination; // change full path in internal images list
+        images[imgNumber].folder = folder; // change folder in internal images list
+        duplicatesTreeModel->UpdateImage(imgNumber); // change folder in duplicates list
+        imagesListModel->SetToolTip(imgNumber, QString::fromStdString(operation.destination)); // change tooltip in images list
     }
 
+    RemoveImagesFromListImages(removed); // remove replaced images from displayed images list
+    duplicatesTreeModel->RemoveImages(removed); // and from duplicates list if they were listed - their group too if it is not a group anymore
+
     if (moved) { // at least one file was moved
         ShowImagesListCount();
         ShowDuplicatesListCount();
@@ -1433,21 +1346,176 @@ void MainWindow::on_button_duplicates_move_clicked() // button pressed -> move f
 
     ShowProgress(progress_finished, "Image files moved");
 
+    QString errors = FileOperationsErrors(operations);
     if (errors != "") {
         QMessageBox::warning(this, "Errors moving image files", "Some images files could not be moved.\nHere is the list of images that failed:\n\n" + errors);
     }
 }
 
+void MainWindow::on_button_duplicates_link_clicked() // button pressed -> replace checked exact duplicates with links to the unchecked image of their group
+{
+    if (similarityAlgorithm != img_similarity_checksum) { // only exact duplicates can share their data
+        QMessageBox::warning(this, "Linking image files...", "Links are only made for exact duplicates.\nPlease compare images with the 'Checksum' algorithm first.");
+        return;
+    }
+
+    FileOperations operations; // source = kept file, destination = duplicate to replace
+    int skippedGroups = 0; // groups with all images checked : no file to keep
+    for (int g = 0; g < duplicatesTreeModel->GroupsCount(); g++) { // parse groups
+        const std::vector<int> &group = duplicatesTreeModel->GroupImages(g);
+        int kept = -1; // first unchecked image of the group
+        int checkedCount = 0;
+        for (int n = 0; n < int(group.size()); n++) {
+            if (duplicatesTreeModel->IsChecked(group[n]))
+                checkedCount++;
+            else if (kept == -1)
+                kept = group[n];
+        }
+        if (checkedCount == 0) // nothing to link in this group
+            continue;
+        if (kept == -1) {
+            skippedGroups++;
+            continue;
+        }
+        for (int n = 0; n < int(group.size()); n++)
+            if (duplicatesTreeModel->IsChecked(group[n]))
+                operations.Add(group[n], images[kept].fullPath, images[group[n]].fullPath);
+    }
+
+    if (operations.Count() == 0) {
+        QMessageBox::warning(this, "Linking image files...", "There is no image to link.\nIn each group, check the duplicates to replace and leave the image to keep unchecked.");
+        return;
+    }
+
+    QString message = "Are you sure you want to replace " + QString::number(operations.Count()) + " checked image file(s) with a link to the unchecked image of their group?\n"
+                      "Files are compared byte by byte first, and each link is written to a log that can undo it.";
+    if (skippedGroups > 0)
+        message += "\n\n" + QString::number(skippedGroups) + " group(s) with all images checked will be skipped.";
+    int sure = QMessageBox::question(this, "Linking image files...", message, QMessageBox::Yes|QMessageBox::No); // link, are you sure ?
+    if (sure == QMessageBox::No)
+        return;
+
+    std::string logName = "data/links-" + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss").toStdString() + ".log"; // one log per batch
+    if (!operations.SetLinksLog(logName)) { // no log = no undo : don't link anything
+        QMessageBox::critical(this, "Linking image files...", "The links log could not be created:\n" + QString::fromStdString(logName));
+        return;
+    }
+
+    // progress - files are compared in background
+    RunFileOperations(operations, file_operation_link, "Linking duplicate files");
+
+    long long reclaimed = 0; // bytes not stored twice anymore
+    std::vector<int> linked; // linked images are unchecked : they don't use space anymore
+    for (int n = 0; n < operations.Count(); n++) {
+        const struct_file_operation &operation = operations.Operation(n);
+        if (operation.result == file_result_done) {
+            reclaimed += operation.original.size;
+            linked.push_back(operation.id);
+        }
+    }
+    duplicatesTreeModel->SetImagesChecked(linked, false);
+
+    ShowProgress(progress_finished, "Duplicates linked");
+
+    if (!linked.empty())
+        QMessageBox::information(this, "Linking image files...", QString::number(linked.size()) + " image file(s) linked, "
+                                     + QString::number(double(reclaimed) / 1024.0 / 1024.0, 'f', 1) + " MB reclaimed.\n\n"
+                                     + "To undo, use this links log:\n" + QString::fromStdString(logName));
+
+    QString errors = FileOperationsErrors(operations);
+    if (errors != "") {
+        QMessageBox::warning(this, "Errors linking image files", "Some images files could not be linked.\nHere is the list of images that failed:\n\n" + errors);
+    }
+}
+
+void MainWindow::on_button_duplicates_unlink_clicked() // button pressed -> undo the links written in a links log
+{
+    QString filename = QFileDialog::getOpenFileName(this, "Undo links...", "data", "Links log (*.log)"); // logs are in the data folder
+
+    if (filename.isNull() || filename.isEmpty()) // cancel ?
+        return;
+
+    FileOperations operations;
+    if (!operations.LoadLinksLog(filename.toUtf8().constData())) {
+        QMessageBox::warning(this, "Undoing links...", "This file is not a links log:\n" + filename);
+        return;
+    }
+    if (operations.Count() == 0) {
+        QMessageBox::warning(this, "Undoing links...", "There is no link in this log:\n" + filename);
+        return;
+    }
+
+    int sure = QMessageBox::question(this, "Undoing links...", "Are you sure you want to undo " + QString::number(operations.Count()) + " link(s)?\n"
+                                     "Each linked image file gets its own copy of the data again, with its original permissions and date.",
+                                     QMessageBox::Yes|QMessageBox::No); // undo, are you sure ?
+    if (sure == QMessageBox::No)
+        return;
+
+    // progress - each file is copied again
+    RunFileOperations(operations, file_operation_unlink, "Undoing links");
+
+    ShowProgress(progress_finished, "Links undone");
+
+    QString errors = FileOperationsErrors(operations);
+    if (errors != "") {
+        QMessageBox::warning(this, "Errors undoing links", "Some links could not be undone.\nHere is the list of files that failed:\n\n" + errors);
+    }
+}
+
+/// Performance
+
+void MainWindow::on_button_performance_refresh_clicked() // button pressed -> show time spent in each stage
+{
+    std::vector<struct_stage_summary> summary = StageTimer::Summary(); // stages with at least one call
+
+    ui->tableWidget_performance->setSortingEnabled(false); // rows are filled in place
+    ui->tableWidget_performance->clear();
+    ui->tableWidget_performance->setColumnCount(7);
+    ui->tableWidget_performance->setHorizontalHeaderLabels({"Stage", "Calls", "Total ms", "Mean ms", "Min ms", "Max ms", "Threads"});
+    ui->tableWidget_performance->setRowCount(int(summary.size()));
+    for (int row = 0; row < int(summary.size()); row++) {
+        const double values[6] = {double(summary[row].calls), summary[row].total, summary[row].mean, summary[row].min, summary[row].max, double(summary[row].threads)};
+        const int decimals[6] = {0, 1, 3, 3, 3, 0};
+        ui->tableWidget_performance->setItem(row, 0, new QTableWidgetItem(QString::fromStdString(summary[row].name)));
+        for (int column = 0; column < 6; column++) {
+            QTableWidgetItem *item = new QTableWidgetItem;
+            item->setData(Qt::DisplayRole, QString::number(values[column], 'f', decimals[column]).toDouble()); // numbers : sorted as numbers
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            ui->tableWidget_performance->setItem(row, column + 1, item);
+        }
+    }
+    ui->tableWidget_performance->setSortingEnabled(true);
+    ui->tableWidget_performance->resizeColumnsToContents();
+}
+
+void MainWindow::on_button_performance_export_clicked() // button pressed -> save all timed stages to a Chrome trace file
+{
+    QString filename = QFileDialog::getSaveFileName(this, "Export trace...", "data/trace.json", "Chrome trace (*.json)"); // open it in chrome://tracing or Perfetto
+
+    if (filename.isNull() || filename.isEmpty()) // cancel ?
+        return;
+
+    std::string error;
+    if (!StageTimer::ExportTrace(filename.toUtf8().constData(), error))
+        QMessageBox::warning(this, "Exporting trace...", "The trace could not be saved:\n" + QString::fromStdString(error));
+}
+
+void MainWindow::on_button_performance_clear_clicked() // button pressed -> forget all measures
+{
+    StageTimer::Reset();
+    on_button_performance_refresh_clicked(); // empty table
+}
+
 //// Loading
 
-void MainWindow::DuplicatesListDoubleClick(QTreeWidgetItem *item, int column) // double-click duplicate image to open it in a new window
+void MainWindow::DuplicatesListDoubleClick(const QModelIndex &index) // double-click duplicate image to open it in a new window
 {
-    int imgNumber = item->data(0, Qt::UserRole).toInt(); // get index in internal images list
+    int imgNumber = duplicatesTreeModel->Image(index); // get index in internal images list
 
-    if ((images[imgNumber].deleted) or (images[imgNumber].error)) // image can't be shown ?
+    if ((imgNumber == -1) or (images[imgNumber].deleted) or (images[imgNumber].error)) // group bar or image can't be shown ?
         return; // exit
 
-    if (column == 1) { // only image column can do this
+    if (index.column() == duplicates_column_icon) { // only image column can do this
         QPixmap pix = LoadImagePix(images[imgNumber].fullPath, images[imgNumber].loadwith); // load this image file
         int width = pix.width(); // size
         int height = pix.height();
@@ -1497,6 +1565,21 @@ QColor MainWindow::ImageTypeColor(const std::string &extension) // returns image
     return QColor(204,204,255); // other formats : violet
 }
 
+QByteArray MainWindow::GetImageIconData(const int &image) // compressed thumbnail of an image, or the error icon - decoded by the views
+{
+    if ((image >= int(images.size())) or (images[image].thumbnail.empty())) { // no thumbnail : image could not be read
+        static QByteArray errorIcon; // show an error icon - read only once
+        if (errorIcon.isEmpty()) {
+            QFile file(":/icons/image-error.png");
+            if (file.open(QIODevice::ReadOnly))
+                errorIcon = file.readAll();
+        }
+        return errorIcon;
+    }
+
+    return QByteArray(reinterpret_cast<const char*>(images[image].thumbnail.data()), int(images[image].thumbnail.size())); // JPEG
+}
+
 /// Images list
 
 // Manage image list
@@ -1505,83 +1588,8 @@ void MainWindow::PopulateImagesList(const std::string &folder, const bool &recur
 {
     // image extensions to search
     QStringList fileExtension;
-    // JPEG and JPEG2000 OK
-    fileExtension << "*.jpg";
-    fileExtension << "*.jpeg";
-    fileExtension << "*.jpe";
-    fileExtension << "*.jif";
-    fileExtension << "*.jfif";
-    // JPEG2000 OK
-    fileExtension << "*.jp2";
-    fileExtension << "*.j2k";
-    fileExtension << "*.jpf";
-    fileExtension << "*.jpm";
-    fileExtension << "*.jpg2";
-    fileExtension << "*.j2c";
-    fileExtension << "*.jpc";
-    // JPEG XL
-    fileExtension << "*.jxl"; // supported since OpenCV 4.11
-    // JPEG XR
-    fileExtension << "*.jxr";
-    fileExtension << "*.wdp";
-    fileExtension << "*.hdp";
-    // JPEG stereoscopic
-    fileExtension << "*.jps";
-    // TIFF OK
-    fileExtension << "*.tif";
-    fileExtension << "*.tiff";
-    // PNG OK
-    fileExtension << "*.png";
-    // WebP OK
-    fileExtension << "*.webp";
-    // AVIF OK
-    fileExtension << "*.avif";
-    // Microsoft OK
-    fileExtension << "*.bmp";
-    fileExtension << "*.dib";
-    // Portable Image Format OK
-    fileExtension << "*.pbm";
-    fileExtension << "*.pgm";
-    fileExtension << "*.ppm";
-    fileExtension << "*.pam";
-    fileExtension << "*.pnm";
-    fileExtension << "*.pfm";
-    // Sun raster OK
-    fileExtension << "*.ras";
-    fileExtension << "*.sun";
-    fileExtension << "*.sr";
-    //// OpenEXR
-    fileExtension << "*.exr";
-    // Radiance HDR OK
-    fileExtension << "*.hdr";
-    fileExtension << "*.pic";
-    //// NOT supported by opencv but Qt
-    // HEIC
-    fileExtension << "*.heic";
-    fileExtension << "*.heif";
-    // MNG
-    fileExtension << "*.mng";
-    // TGA OK
-    fileExtension << "*.tga";
-    // WBMP OK
-    fileExtension << "*.wbmp";
-    // GIF OK
-    fileExtension << "*.gif";
-    //// X11 !OK
-    fileExtension << "*.xbm";
-    fileExtension << "*.xpm";
-    //// Windows icons and cursors !OK
-    fileExtension << "*.ico";
-    fileExtension << "*.cur";
-    //// PCX !OK
-    fileExtension << "*.pcx";
-    //// Photoshop !OK
-    fileExtension << "*.psd";
-    //// SGI ? !OK
-    fileExtension << "*.sgi";
-    //// X-windows !OK
-    fileExtension << "*.xwd";
-
+    for (const std::string &extension : ImageFileExtensions()) // all supported file types
+        fileExtension << QString::fromStdString("*." + extension);
 
     std::vector<QString> list; // to store dir results
     list.reserve(50000); // reserve memory for lists
@@ -1593,10 +1601,13 @@ void MainWindow::PopulateImagesList(const std::string &folder, const bool &recur
     else
         flags = QDirIterator::FollowSymlinks; // follow symlinks
 
-    QDirIterator dir(QString::fromStdString(folder), fileExtension, QDir::Files, flags); // get files list
-    while (dir.hasNext()) { // is there at least a file in list ?
-        QFile f(dir.next()); // next item
-        list.push_back(dir.filePath()); // store value
+    {
+        ScopedStage timer(stageCrawl);
+        QDirIterator dir(QString::fromStdString(folder), fileExtension, QDir::Files, flags); // get files list
+        while (dir.hasNext()) { // is there at least a file in list ?
+            QFile f(dir.next()); // next item
+            list.push_back(dir.filePath()); // store value
+        }
     }
 
     if (list.size() == 0) { // is the list empty ?
@@ -1617,54 +1628,7 @@ void MainWindow::PopulateImagesList(const std::string &folder, const bool &recur
             img.extension = stringutils::GetFilenameExtension(img.basename);
             img.deleted = false;
 
-            // image file type will tell which engine (OpenCV or Qt) will be used to load it
-            std::string ext = stringutils::ToLower(img.extension);
-            if ((ext == "jpg") or (ext == "jpeg") or (ext == "jp2") or (ext == "j2k") or (ext == "jpf") or (ext == "jpm") or (ext == "jpg2") or (ext == "j2c") or (ext == "jpc") or (ext == "jpe") or (ext == "jif") or (ext == "jfif") or (ext == "jxl") or (ext == "jxr") or (ext == "wdp") or (ext == "hdp") or (ext == "jps")) { // jxl supported since OpenCV 4.11
-                img.type = "jpeg";
-                img.loadwith = "opencv";
-            }
-            else if ((ext == "tif") or (ext == "tiff")) {
-                img.type = "tiff";
-                img.loadwith = "opencv";
-            }
-            else if (ext == "png") {
-                img.type = "png";
-                img.loadwith = "opencv";
-            }
-            else if (ext == "webp") {
-                img.type = "webp";
-                img.loadwith = "opencv";
-            }
-            else if (ext == "avif") {
-                img.type = "avif";
-                img.loadwith = "opencv";
-            }
-            else {
-                img.type = "other";
-
-                if ((ext == "bmp") or (ext == "dib")) // with OpenCV
-                    img.loadwith = "opencv";
-                else if ((ext == "pbm") or (ext == "pgm") or (ext == "ppm") or (ext == "pam") or (ext == "pnm") or (ext == "pfm")) // with OpenCV
-                    img.loadwith = "opencv";
-                else if ((ext == "sr") or (ext == "sun") or (ext == "ras")) // with OpenCV
-                    img.loadwith = "opencv";
-                else if (ext == "exr") // with OpenCV
-                    img.loadwith = "opencv";
-                else if ((ext == "hdr") or (ext == "pic")) // with OpenCV
-                    img.loadwith = "opencv";
-                else if ((ext == "heic") or (ext == "heif")) // with Qt
-                    img.loadwith = "qt";
-                else if (ext == "mng") // with Qt
-                    img.loadwith = "qt";
-                else if (ext == "tga") // with Qt
-                    img.loadwith = "qt";
-                else if (ext == "wbmp") // with Qt
-                    img.loadwith = "qt";
-                else if (ext == "gif") // with Qt
-                    img.loadwith = "qt";
-                else
-                    img.loadwith = "opencv"; // default = OpenCV
-            }
+            ImageFileType(img.extension, img.type, img.loadwith); // image file type will tell which engine (OpenCV or Qt) will be used to load it
 
             img.duplicates.reserve(50); // why 50 ? is it enough ?
 
@@ -1709,6 +1673,34 @@ void MainWindow::CleanImagesList() // delete duplicates and some marked images i
 
 void MainWindow::ComputeImagesListInfo() // compute all other required info in images list
 {
+    // thumbnails cache : new images already scanned in a previous session don't need a new thumbnail
+    std::vector<long long> fileSizes(images.size(), -1); // size and last modification time of new images files - -1 = unknown, not cached
+    std::vector<long long> modifiedTimes(images.size(), 0);
+    std::vector<char> cached(images.size(), false); // thumbnail found in cache - not std::vector<bool> : written by several threads
+    int nbNewImages = 0;
+    int nbCached = 0;
+    #pragma omp parallel for reduction(+:nbNewImages, nbCached)
+    for (int n = 0; n < int(images.size()); n++) { // parse images list
+        if (!images[n].newImage) // only new images
+            continue;
+        nbNewImages++;
+        if (!ThumbnailCache::FileStamp(images[n].fullPath, fileSizes[n], modifiedTimes[n])) { // can't read file info
+            fileSizes[n] = -1;
+            continue;
+        }
+        int width, height;
+        if (thumbnailCache.Get(images[n].fullPath, fileSizes[n], modifiedTimes[n], thumbnailsSize, width, height, images[n].thumbnail)) { // same file, same thumbnail size
+            images[n].width = width; // the image size is cached too
+            images[n].height = height;
+            images[n].imageSize = width * height;
+            cached[n] = true;
+            nbCached++;
+        }
+    }
+
+    if ((nbNewImages > 0) and (nbCached == nbNewImages)) // all thumbnails in cache : show the images list now, without waiting for the working images
+        ShowImagesList();
+
     // progress - this operation could be long if the image list is huge
     ShowProgress(progress_prepare);
     ShowProgress(progress_run, "Creating thumbnails", 0, int(images.size()));
@@ -1721,7 +1713,11 @@ void MainWindow::ComputeImagesListInfo() // compute all other required info in i
         #pragma omp for
         for (int n = 0; n < int(images.size()); n++) { // parse images list
             if ((!stop) and (images[n].newImage)) { // is this a new image ?
-                cv::Mat pix = LoadImageMat(images[n].fullPath, images[n].loadwith); // load the current image file
+                cv::Mat pix;
+                {
+                    ScopedStage timer(stageDecode);
+                    pix = LoadImageMat(images[n].fullPath, images[n].loadwith); // load the current image file
+                }
 
                 if (pix.empty()) { // error reading image file ?
                     images[n].error = true; // marks image as not readable
@@ -1729,7 +1725,7 @@ void MainWindow::ComputeImagesListInfo() // compute all other required info in i
                     images[n].width = 0; // image width
                     images[n].height = 0; // image height
                     images[n].imageSize = 0; // image size = width x height
-                    images[n].icon = QPixmap(":/icons/image-error.png"); // show an error icon
+                    // the thumbnail is cleared after the loop : a cached one may be shown right now
                     images[n].newImage = false; // not a new image anymore
                     images[n].used = false; // won't be used anyway...
                 }
@@ -1738,20 +1734,30 @@ void MainWindow::ComputeImagesListInfo() // compute all other required info in i
                     images[n].width = pix.cols; // get image width
                     images[n].height = pix.rows; // get image height
                     images[n].imageSize = images[n].width * images[n].height; // size = width x height
-                    pix = QualityResizeImageAspectRatio(pix, cv::Size(reducedSize, reducedSize)); // resize image to working image size (see Options tab)
+                    // working images : one pass in the pyramid of this thread, no allocation for the intermediate images
+                    ImagePyramid &pyramid = ImagePyramid::ForThread();
+                    {
+                        ScopedStage timer(stageResize);
+                        pyramid.Build(pix, reducedSize); // resize image to working image size (see Options tab), normalized and gray versions
+                    }
 
                     // icon
-                    cv::Mat icon = cv::Mat(thumbnailsSize, thumbnailsSize - 1, CV_8UC3); // size - 1 in vertical for display reasons (line under item in duplicates list)
-                    icon = cv::Vec3b(148, 148, 148); // fill the icon image with gray
-                    cv::Mat reduced = QualityResizeImageAspectRatio(pix, cv::Size(thumbnailsSize, thumbnailsSize)); // image icon
-                    PasteImageFast(icon, reduced, (thumbnailsSize - reduced.cols) / 2, (thumbnailsSize - reduced.rows) / 2); // paste it upon the gray block
-                    cv::line(icon, cv::Point(0, 0), cv::Point(0, icon.rows - 1), cv::Vec3b(0, 0, 0), 1, cv::LINE_8); // draw vertical lines on left and right of the icon
-                    cv::line(icon, cv::Point(icon.cols - 1, 0), cv::Point(icon.cols - 1, icon.rows - 1), cv::Vec3b(0, 0, 0), 1, cv::LINE_8);
-                    images[n].icon = Mat2QPixmap(icon); // convert cv::Mat to QPixmap, store it in image item
+                    if (!cached[n]) { // not already in thumbnails cache
+                        ScopedStage timer(stageThumbnail);
+                        cv::Mat icon = pyramid.Scratch(cv::Size(thumbnailsSize - 1, thumbnailsSize), CV_8UC3); // size - 1 in vertical for display reasons (line under item in duplicates list)
+                        icon = cv::Vec3b(148, 148, 148); // fill the icon image with gray
+                        cv::Mat reduced = pyramid.Thumbnail(thumbnailsSize); // image icon, from the working image
+                        PasteImageFast(icon, reduced, (thumbnailsSize - reduced.cols) / 2, (thumbnailsSize - reduced.rows) / 2); // paste it upon the gray block
+                        cv::line(icon, cv::Point(0, 0), cv::Point(0, icon.rows - 1), cv::Vec3b(0, 0, 0), 1, cv::LINE_8); // draw vertical lines on left and right of the icon
+                        cv::line(icon, cv::Point(icon.cols - 1, 0), cv::Point(icon.cols - 1, icon.rows - 1), cv::Vec3b(0, 0, 0), 1, cv::LINE_8);
+                        cv::imencode(".jpg", icon, images[n].thumbnail, {cv::IMWRITE_JPEG_QUALITY, 90}); // store it compressed : about 10x smaller than a QPixmap, and no QPixmap outside the GUI thread
+                        if (fileSizes[n] != -1) // file info is known
+                            thumbnailCache.Put(images[n].fullPath, fileSizes[n], modifiedTimes[n], thumbnailsSize, images[n].width, images[n].height, images[n].thumbnail); // for the next sessions
+                    }
 
                     // cached reduced image
-                    images[n].imageReduced = pix; // reduced color image, store it too
-                    cv::normalize(images[n].imageReduced, images[n].imageReduced, 0, 255, cv::NORM_MINMAX);
+                    ScopedStage timer(stageResize); // until the gray image
+                    images[n].imageReduced = pyramid.Reduced().clone(); // reduced color image, store it too - out of the arena
 
                     /*// equalize histogram of reduced image
                     cv::Mat ycrcb; // will do it in YCrCb color space
@@ -1766,7 +1772,7 @@ void MainWindow::ComputeImagesListInfo() // compute all other required info in i
                     cv::cvtColor(ycrcb, images[n].imageReduced, cv::COLOR_YCrCb2BGR); // convert back image from color space, store it*/
 
                     // gray reduced image
-                    cv::cvtColor(images[n].imageReduced, images[n].imageReducedGray, cv::COLOR_BGR2GRAY); // convert reduced image to gray, store it
+                    images[n].imageReducedGray = pyramid.Gray().clone(); // store it
 
                     // flags
                     images[n].newImage = false; // not a new image anymore
@@ -1790,7 +1796,17 @@ void MainWindow::ComputeImagesListInfo() // compute all other required info in i
         }
     }
 
+    #pragma omp parallel
+    ImagePyramid::ForThread().Release(); // the arenas are sized for the biggest images : free them until the next images are added
+
+    thumbnailCache.Flush(); // new thumbnails are written to disk
+
+    for (int n = 0; n < int(images.size()); n++) // images that could not be read
+        if (images[n].error)
+            images[n].thumbnail.clear(); // an error icon will be shown
+
     if (stop) {
+        imagesListModel->Clear(); // the images list may be shown already : its rows point to the images
         images.clear();
         ShowProgress(progress_finished, "Thumbnails creation canceled");
     }
@@ -1806,23 +1822,21 @@ void MainWindow::ShowImagesList() // display images list from images information
     // (re)initialize widgets and lists
     ClearDuplicates(); // reset duplicates list
 
-    // add images to widget
+    ScopedStage timer(stageWidgets);
+    // one row per image : icons are not decoded here, the view asks for the visible ones only
+    std::vector<struct_images_list_row> rows;
+    rows.reserve(images.size());
     for (int n = 0; n < int(images.size()); n++) { // parse images list
         if (!images[n].deleted) { // valid image ?
-            QListWidgetItem *item = new QListWidgetItem; // create new image item for images list
-            item->setIcon(images[n].icon); // icon
-            item->setToolTip(QString::number(images[n].width) + "x" + QString::number(images[n].height) + " - " + QString::fromStdString(images[n].fullPath)); // tooltip
-            item->setText(QString::fromStdString(images[n].basename)); // display image filename
-            item->setTextAlignment(Qt::AlignHCenter | Qt::AlignVCenter); // alignment
-            item->setFlags(Qt::ItemIsUserCheckable | Qt::ItemIsEnabled | Qt::ItemIsSelectable); // item is enzbled, checkable and selectable
-            item->setCheckState(Qt::Unchecked); // uncheck it (important, checkbox isn't shown if its state isn't set once)
-            item->setData(Qt::UserRole, n); // insert index of images list in the widget, to retrieve it when needed
-            item->setBackground(ImageTypeColor(images[n].type)); // color the background with image file type color
-
-            ui->listWidget_image_list->addItem(item); // add image to widget
-            images[n].imageItem = item; // keep track of item pointer in internal images list
+            struct_images_list_row row; // new row for images list
+            row.image = n; // index of images list, to retrieve it when needed
+            row.text = QString::fromStdString(images[n].basename); // display image filename
+            row.toolTip = QString::number(images[n].width) + "x" + QString::number(images[n].height) + " - " + QString::fromStdString(images[n].fullPath); // tooltip
+            row.background = ImageTypeColor(images[n].type); // color the background with image file type color
+            rows.push_back(row);
         }
     }
+    imagesListModel->SetRows(rows); // all unchecked
 
     ShowImagesListCount(); // show number of images in GUI
 
@@ -1840,7 +1854,7 @@ void MainWindow::ShowImagesListCount() // show number of images in images list i
 
     ui->lcdNumber_nb_images->display(count); // display count in LCD widget
 
-    if (ui->listWidget_image_list->count() == 0) { // no images to display ?
+    if (imagesListModel->Count() == 0) { // no images to display ?
         ui->label_no_images->setVisible(true); // show this information
     }
 }
@@ -1901,7 +1915,11 @@ float MainWindow::CombinedScore(const int &i, const int &j) // get combined scor
             case img_similarity_frequency:          activated = ui->checkBox_combined_frequency->checkState();break;
         }
 
-        if ((activated) and (pairScore->second.score[n] != -1)) { // if the score is to be processed and it is not invalid
+        const imageSimilarityAlgorithm algorithm = static_cast<imageSimilarityAlgorithm>(n);
+        if ((activated) and (pairScore->second.score[n] == -1) and (thresholdEdges.count(algorithm))
+                and (ImagePartitionKey(i, algorithm) != ImagePartitionKey(j, algorithm))) // algorithm computed, but the pair was not in the same partition : it was never compared
+            count++; // counts as a 0 score, like when these pairs were compared
+        else if ((activated) and (pairScore->second.score[n] != -1)) { // if the score is to be processed and it is not invalid
             count ++; // count one more
             sum += pairScore->second.score[n] * float(GetLevelFromScore(static_cast<imageSimilarityAlgorithm>(n), pairScore->second.score[n])); // update sum with weight from thresholds
         }
@@ -1910,9 +1928,21 @@ float MainWindow::CombinedScore(const int &i, const int &j) // get combined scor
     return sum / (float(count) * 3.0f); // final result is the sum of scores divided by 3 times (4 - 1) levels and the count -> percentage
 }
 
-bool MainWindow::ImagesAreDuplicates(const int &i, const int &j, const imageSimilarityAlgorithm &similarityAlgorithm, const float &threshold, float &similarity) // compare a pair of images
+bool MainWindow::ImageIsPortrait(const int &n) // is image N portrait-oriented ? - square images too
 {
-    //// image orientation test
+    float ratio = float(images[n].width) / float(images[n].height); // compute ratio
+    /*if (ratio < 0.95f)
+        return true; // it is portrait !
+    else */if (ratio > 1.05f) // test if image is landscape-oriented - some algorithms use a heavy resizing of images so 5% of difference is not a difference
+        return false;
+
+    return true;
+}
+
+bool MainWindow::AlgorithmNeedsOrientation(const imageSimilarityAlgorithm &similarityAlgorithm) // can this algorithm only compare images oriented the same way ?
+{
+    if ((dihedralHashes) and (HashIsDihedral(similarityAlgorithm))) // hashes in canonical orientation : rotated copies are compared too
+        return false;
 
     switch (similarityAlgorithm) { // some algorithms won't work if images are not oriented the same way
         case img_similarity_checksum:
@@ -1921,77 +1951,118 @@ bool MainWindow::ImagesAreDuplicates(const int &i, const int &j, const imageSimi
         case img_similarity_idHash:
         case img_similarity_block_mean:
         case img_similarity_marr_hildreth:
-        case img_similarity_radial_variance: {
-            // find orientation for image I
-            float ratioI = float(images[i].width) / float(images[i].height); // compute ratio
-            bool imIPortrait = true; // indicator if the image is portrait-oriented
-            /*if (ratioI < 0.95f)
-                imIPortrait = true; // it is portrait !
-            else */if (ratioI > 1.05f) // test if image is landscape-oriented - some algorithms use a heavy resizing of images so 5% of difference is not a difference
-                imIPortrait = false;
-            // do the same for image J
-            float ratioJ = float(images[j].width) / float(images[j].height);
-            bool imJPortrait = true;
-            if (ratioJ > 1.05f)
-                imJPortrait = false;
-            // final result
-            if (imIPortrait != imJPortrait) { // orientation is not the same ?
-                similarity = 0; // no similarity
-                return false; // exit with value false
-            }
-            break;
-        }
+        case img_similarity_radial_variance:
+            return true;
+    }
+
+    return false; // other algorithms don't care
+}
+
+bool MainWindow::ImagesOrientationsMatch(const int &i, const int &j, const imageSimilarityAlgorithm &similarityAlgorithm) // are images I and J oriented the same way, for algorithms that need it ?
+{
+    if (!AlgorithmNeedsOrientation(similarityAlgorithm))
+        return true;
+
+    return ImageIsPortrait(i) == ImageIsPortrait(j); // orientation is the same ?
+}
+
+long long MainWindow::ImagePartitionKey(const int &n, const imageSimilarityAlgorithm &similarityAlgorithm) // images with different keys are never duplicates for this algorithm
+{
+    if (similarityAlgorithm == img_similarity_checksum) // checksum : same data means same dimensions
+        return (long long)(images[n].width) * 1000000LL + images[n].height;
+    if (AlgorithmNeedsOrientation(similarityAlgorithm))
+        return ImageIsPortrait(n) ? 1 : 2;
+
+    return 0; // one partition
+}
+
+std::vector<std::vector<int>> MainWindow::PartitionImages(const imageSimilarityAlgorithm &similarityAlgorithm) // valid images grouped by partition key, indexes ascending
+    // only pairs inside a partition are compared : on mixed libraries, portrait/landscape pairs are about half of all pairs
+{
+    std::map<long long, std::vector<int>> keys;
+    for (int n = 0; n < int(images.size()); n++)
+        if ((!images[n].deleted) and (!images[n].error))
+            keys[ImagePartitionKey(n, similarityAlgorithm)].push_back(n);
+
+    std::vector<std::vector<int>> partitions;
+    partitions.reserve(keys.size());
+    for (auto &key : keys)
+        if (key.second.size() > 1) // a single image has no pair
+            partitions.push_back(std::move(key.second));
+
+    return partitions;
+}
+
+bool MainWindow::ImagesAreDuplicates(const int &i, const int &j, const imageSimilarityAlgorithm &similarityAlgorithm, const float &threshold, float &similarity) // compare a pair of images
+{
+    //// image orientation test
+
+    if (!ImagesOrientationsMatch(i, j, similarityAlgorithm)) { // orientation is not the same ?
+        similarity = 0; // no similarity
+        return false; // exit with value false
     }
 
     bool duplicate = false; // duplicate is false until proven true !
 
     //// create image hash/features/etc - keep result in cache
+    //// only computations are timed, one call per image : most pairs find both values in cache
 
+    const int extractStage = stageExtract[similarityAlgorithm];
     if (similarityAlgorithm == img_similarity_dominant_colors) { // dominant colors : color image
         #pragma omp critical // because std::vectors will be used
         {
             if (images[i].dominantColors.empty()) { // for image I - if palette is not already computed
+                ScopedStage timer(extractStage);
                 cv::Mat reduced = ResizeImageAspectRatio(images[i].imageReduced, cv::Size(64, 64)); // resize image to a tiny size
-                //reduced = ConvertImageRGBtoOKLAB(reduced); // convert it to OKLAB color space
-                reduced = ConvertImageToColorSpace(reduced, color_space_RGB, color_space_OKLAB, true);
+                reduced = ConvertImageRGBtoOKLABFast(reduced); // convert it to OKLAB color space - float values in [0..1] ranges, no need to normalize
                 cv::Mat quantized;
-                images[i].dominantColors = DominantColorsEigenLab(reduced, 8, quantized); // quantize it with Eigen method, keep the resulting palette
+                images[i].dominantColors = DominantColorsEigenFast(reduced, 8, quantized, false); // quantize it with Eigen method, keep the resulting palette - the quantized image is not needed
             }
             if (images[j].dominantColors.empty()) { // same for image J
+                ScopedStage timer(extractStage);
                 cv::Mat reduced = ResizeImageAspectRatio(images[j].imageReduced, cv::Size(64, 64));
-                //reduced = ConvertImageRGBtoOKLAB(reduced);
-                reduced = ConvertImageToColorSpace(reduced, color_space_RGB, color_space_OKLAB, true);
+                reduced = ConvertImageRGBtoOKLABFast(reduced);
                 cv::Mat quantized;
-                images[j].dominantColors = DominantColorsEigenLab(reduced, 8, quantized);
+                images[j].dominantColors = DominantColorsEigenFast(reduced, 8, quantized, false);
             }
         }
     }
     else if (similarityAlgorithm == img_similarity_features) { // image features (keypoints and descriptors) - gray image
         #pragma omp critical // because std::vectors will be used
         {
-            if (images[i].keypoints.empty()) // for image I - if keypoints were not already computed
+            if (images[i].keypoints.empty()) { // for image I - if keypoints were not already computed
+                ScopedStage timer(extractStage);
                 ComputeImageDescriptors(images[i].imageReducedGray, images[i].keypoints, images[i].descriptors, false, reducedSize, nbFeatures); // compute keypoints
-            if (images[j].keypoints.empty()) // same for image J
+            }
+            if (images[j].keypoints.empty()) { // same for image J
+                ScopedStage timer(extractStage);
                 ComputeImageDescriptors(images[j].imageReducedGray, images[j].keypoints, images[j].descriptors, false, reducedSize, nbFeatures);
+            }
         }
 
     }
     else if (similarityAlgorithm == img_similarity_homography) { // homography - same comments than features : homography is just a supplementary step from features - gray image
         #pragma omp critical
         {
-            if (images[i].keypoints.empty())
+            if (images[i].keypoints.empty()) {
+                ScopedStage timer(extractStage);
                 ComputeImageDescriptors(images[i].imageReducedGray, images[i].keypoints, images[i].descriptors, false, reducedSize, nbFeatures);
-            if (images[j].keypoints.empty())
+            }
+            if (images[j].keypoints.empty()) {
+                ScopedStage timer(extractStage);
                 ComputeImageDescriptors(images[j].imageReducedGray, images[j].keypoints, images[j].descriptors, false, reducedSize, nbFeatures);
+            }
         }
     }
     else if (similarityAlgorithm == img_similarity_dnn_classify) { // DNN classification
         if (images[i].hashDNN.empty()) { // image I - if classes are not already computed
+            ScopedStage timer(extractStage);
             // VGG-16 : size=224, mean=(123.68, 116.779, 103.939))
             // Inception-21k : size=224, mean=(117, 117, 117)
             images[i].hashDNN = DNNHash(images[i].imageReduced, dnnInception, 224, cv::Scalar(117, 117, 117), 16); // compute classes using Inception-21k model
         }
         if (images[j].hashDNN.empty()) { // same for image J
+            ScopedStage timer(extractStage);
             images[j].hashDNN = DNNHash(images[j].imageReduced, dnnInception, 224, cv::Scalar(117, 117, 117), 16);
         }
     }
@@ -2003,17 +2074,23 @@ bool MainWindow::ImagesAreDuplicates(const int &i, const int &j, const imageSimi
     }*/
     else if (similarityAlgorithm != img_similarity_count) { // NOT combined scores
         if (similarityAlgorithm != img_similarity_checksum) { // all other algorithms but checksum : gray image
-            if (images[i].hashTmp.empty()) // image I - if the hash is not already computed
-                images[i].hashTmp = ImageHash(images[i].imageReducedGray, similarityAlgorithm); // get it from corresponding algorithm
-            if (images[j].hashTmp.empty()) // same for image J
-                images[j].hashTmp = ImageHash(images[j].imageReducedGray, similarityAlgorithm);
+            if (images[i].hashTmp.empty()) { // image I - if the hash is not already computed
+                ScopedStage timer(extractStage);
+                images[i].hashTmp = ImageHash(images[i].imageReducedGray, similarityAlgorithm, dihedralHashes); // get it from corresponding algorithm
+            }
+            if (images[j].hashTmp.empty()) { // same for image J
+                ScopedStage timer(extractStage);
+                images[j].hashTmp = ImageHash(images[j].imageReducedGray, similarityAlgorithm, dihedralHashes);
+            }
         }
         else { // checksum uses the original images
             if (images[i].hashTmp.empty()) { // image I - if the hash is not already computed
+                ScopedStage timer(extractStage);
                 cv::Mat image = LoadImageMat(images[i].fullPath, images[i].loadwith); // load original image
                 images[i].hashTmp = ImageHash(image, similarityAlgorithm); // hash it with MD5
             }
             if (images[j].hashTmp.empty()) { // same for image J
+                ScopedStage timer(extractStage);
                 cv::Mat image = LoadImageMat(images[j].fullPath, images[j].loadwith);
                 images[j].hashTmp = ImageHash(image, similarityAlgorithm); // MD5
             }
@@ -2024,6 +2101,7 @@ bool MainWindow::ImagesAreDuplicates(const int &i, const int &j, const imageSimi
     //// the score is computed or in cache
     //// all scores are percentages, the highest (100%) the better !
 
+    ScopedStage compareTimer(stageCompare[similarityAlgorithm]);
     // keep the score in a pair
     cv::Point pairPoint = OrderedPair(i, j); // index for images I and J, index-ordered
     auto pair = pairs.find(pairPoint); // find the pair
@@ -2041,36 +2119,29 @@ bool MainWindow::ImagesAreDuplicates(const int &i, const int &j, const imageSimi
         match = (1.0f - CompareImagesDominantColorsFromEigen(images[i].dominantColors, images[j].dominantColors)) * 100.0f;
     }
     else if (similarityAlgorithm == img_similarity_features) { // features : compare image descriptors
-        #pragma omp critical // because std::vectors are created
-        {
-            // if (images[i].imageReducedGray.cols * images[i].imageReducedGray.rows <= images[j].imageReducedGray.cols * images[j].imageReducedGray.rows)
-                match = CompareImagesDescriptors(images[i].descriptors, images[j].descriptors, 0.8f, nbFeatures);
-            /*else
-                match = CompareImagesDescriptors(images[j].descriptors, images[i].descriptors, 0.8f, nbFeatures);*/
-
-            match *= 100.0f;
-        }
+        // no critical section : descriptors are only read here, and each thread has its own matcher
+        // exact score (no early exit) because scores are kept in cache and the threshold can be changed later
+        match = CompareImagesDescriptors(images[i].descriptors, images[j].descriptors, 0.8f, nbFeatures) * 100.0f;
     }
     else if (similarityAlgorithm == img_similarity_homography) { // homography : get homography 3x3 matrix first, then compare the projection applied to one image
-        cv::Mat homography = cv::Mat();
-        #pragma omp critical // because std::vectors are created
-        {
+        // no critical section either, but keypoints MUST already exist : GetHomographyFromImagesFeatures would compute them if they are empty
+        if ((!images[i].keypoints.empty()) and (!images[j].keypoints.empty())) { // no keypoints found for one image -> score stays 0
             std::vector<cv::Point2f> goodPoints1, goodPoints2; // not really used here but "good matching points" are needed/computed anyway
 
             if (images[i].imageReducedGray.cols * images[i].imageReducedGray.rows <= images[j].imageReducedGray.cols * images[j].imageReducedGray.rows) // works better if 2nd image is bigger than the 1st
-                homography = GetHomographyFromImagesFeatures(images[i].imageReducedGray, images[j].imageReducedGray,
-                                                             images[i].keypoints, images[j].keypoints,
-                                                             images[i].descriptors, images[j].descriptors,
-                                                             goodPoints1, goodPoints2,
-                                                             match,
-                                                             false, reducedSize, false, 0.8f, nbFeatures); // get the 3x3 homography matrix
+                GetHomographyFromImagesFeatures(images[i].imageReducedGray, images[j].imageReducedGray,
+                                                images[i].keypoints, images[j].keypoints,
+                                                images[i].descriptors, images[j].descriptors,
+                                                goodPoints1, goodPoints2,
+                                                match,
+                                                false, reducedSize, false, 0.8f, nbFeatures); // get the 3x3 homography matrix -> score
             else // 1st image is bigger
-                homography = GetHomographyFromImagesFeatures(images[j].imageReducedGray, images[i].imageReducedGray,
-                                                             images[j].keypoints, images[i].keypoints,
-                                                             images[j].descriptors, images[i].descriptors,
-                                                             goodPoints1, goodPoints2,
-                                                             match,
-                                                             false, reducedSize, false, 0.8f, nbFeatures);
+                GetHomographyFromImagesFeatures(images[j].imageReducedGray, images[i].imageReducedGray,
+                                                images[j].keypoints, images[i].keypoints,
+                                                images[j].descriptors, images[i].descriptors,
+                                                goodPoints1, goodPoints2,
+                                                match,
+                                                false, reducedSize, false, 0.8f, nbFeatures);
             match *= 100.0f;
         }
     }
@@ -2147,6 +2218,105 @@ void MainWindow::PrepareDNN() // prepare DNN and classes structures
     }
 }
 
+void MainWindow::PrepareFeaturesCandidates() // compute all images descriptors, then retrieve candidates with visual words and tile hashes
+    // instead of matching all pairs of images, only the top-k most similar images (TF-IDF visual words) of each image are matched
+    // plus the top-k images sharing the most tiles (crops, partial overlaps) - features or homography verify all candidates
+{
+    featuresCandidates.clear(); // all pairs by default
+
+    // descriptors of all images - needed by the vocabulary and the index, timed like in ImagesAreDuplicates()
+    #pragma omp parallel for
+    for (int n = 0; n < int(images.size()); n++) {
+        if ((!images[n].deleted) and (!images[n].error) and (images[n].keypoints.empty())) { // each image has its own keypoints and descriptors
+            ScopedStage extractTimer(stageExtract[similarityAlgorithm]);
+            ComputeImageDescriptors(images[n].imageReducedGray, images[n].keypoints, images[n].descriptors, false, reducedSize, nbFeatures);
+        }
+    }
+
+    ScopedStage timer(stageVisualWords);
+
+    if ((!featuresPruning) or (int(images.size()) <= visualWordsTopK + 1)) // option off, or not enough images : all pairs are compared
+        return;
+
+    // vocabulary : stored with the thresholds, built again from the current images if not found or if it doesn't fit them
+    std::vector<cv::Mat> descriptorsList;
+    descriptorsList.reserve(images.size());
+    for (int n = 0; n < int(images.size()); n++)
+        if ((!images[n].deleted) and (!images[n].error))
+            descriptorsList.push_back(images[n].descriptors);
+    if (!visualWords.HasVocabulary()) {
+        cv::Mat vocabulary = LoadVisualVocabulary("data/visual-words.yml.gz", &visualWordsError);
+        if (!vocabulary.empty())
+            visualWords.SetVocabulary(vocabulary);
+    }
+    const float error = visualWords.HasVocabulary() ? VisualVocabularyError(visualWords.Vocabulary(), descriptorsList) : -1;
+    if ((!visualWords.HasVocabulary()) or (visualWordsError < 0) or (error < 0) or (error > visualWordsError * visualWordsMaxDrift)) { // missing, or built from other images
+        const cv::Mat vocabulary = BuildVisualVocabulary(descriptorsList, 1000, 10);
+        if (vocabulary.empty()) // no descriptors at all
+            return;
+        visualWordsError = VisualVocabularyError(vocabulary, descriptorsList);
+        SaveVisualVocabulary("data/visual-words.yml.gz", vocabulary, visualWordsError);
+        visualWords.SetVocabulary(vocabulary);
+    }
+    std::vector<cv::Mat>().swap(descriptorsList);
+
+    // index all images
+    visualWords.Clear();
+    for (int n = 0; n < int(images.size()); n++)
+        if ((!images[n].deleted) and (!images[n].error))
+            visualWords.Add(n, images[n].descriptors);
+    visualWords.Build();
+
+    // top-k candidates of each image
+    featuresCandidates.resize(images.size());
+    #pragma omp parallel for
+    for (int n = 0; n < int(images.size()); n++) {
+        std::vector<std::pair<int, float>> candidates = visualWords.TopCandidates(n, visualWordsTopK);
+        featuresCandidates[n].reserve(candidates.size());
+        for (size_t c = 0; c < candidates.size(); c++)
+            featuresCandidates[n].push_back(candidates[c].first);
+        std::sort(featuresCandidates[n].begin(), featuresCandidates[n].end()); // sorted for binary search
+    }
+    timer.Stop();
+
+    // crops : a crop has few visual words of its original, but the same content at another scale -> images that share tiles are candidates too
+    // the index is only kept while candidates are retrieved : ~27 KB per image
+    ScopedStage tilesTimer(stageTileHashes);
+    std::vector<std::vector<uint64_t>> tiles(images.size());
+    #pragma omp parallel for
+    for (int n = 0; n < int(images.size()); n++)
+        if ((!images[n].deleted) and (!images[n].error))
+            tiles[n] = TileHashIndex::ComputeTileHashes(images[n].imageReducedGray); // few tiles for the index
+    TileHashIndex tileIndex;
+    for (int n = 0; n < int(images.size()); n++) {
+        tileIndex.Add(n, tiles[n]);
+        std::vector<uint64_t>().swap(tiles[n]); // the index has its own copy
+    }
+    tileIndex.Build();
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int n = 0; n < int(images.size()); n++) {
+        if ((images[n].deleted) or (images[n].error))
+            continue;
+        std::vector<std::pair<int, int>> crops = tileIndex.Query(TileHashIndex::ComputeTileHashes(images[n].imageReducedGray, true), 6, 2, n); // (image, matching tiles), best first
+        const int count = std::min(int(crops.size()), tileHashesTopK);
+        for (int c = 0; c < count; c++)
+            featuresCandidates[n].push_back(crops[c].first);
+        std::sort(featuresCandidates[n].begin(), featuresCandidates[n].end()); // sorted for binary search
+        featuresCandidates[n].erase(std::unique(featuresCandidates[n].begin(), featuresCandidates[n].end()), featuresCandidates[n].end());
+    }
+}
+
+bool MainWindow::IsFeaturesCandidate(const int &i, const int &j) // can images I and J be compared with features or homography ?
+    // the pair is kept if one image is in the other one's candidates
+{
+    if ((featuresCandidates.empty()) or ((similarityAlgorithm != img_similarity_features) and (similarityAlgorithm != img_similarity_homography))) // all pairs
+        return true;
+
+    return (std::binary_search(featuresCandidates[i].begin(), featuresCandidates[i].end(), j))
+        or (std::binary_search(featuresCandidates[j].begin(), featuresCandidates[j].end(), i));
+}
+
 void MainWindow::CompareImages() // compare images in images list
 {
     //// image list empty ?
@@ -2156,13 +2326,17 @@ void MainWindow::CompareImages() // compare images in images list
     }
 
     //// reset duplicates list in gui
-    ui->treeWidget_duplicates->clear(); // clear duplicates list widget - it is NOT a complete clear, just the shown images -> don't use ClearDuplicates() !
+    duplicatesTreeModel->Clear(); // clear duplicates list view - it is NOT a complete clear, just the shown images -> don't use ClearDuplicates() !
     ShowDuplicatesListCount(); // count should be zero
     ui->label_no_duplicates->setVisible(false); // hide the "no images" sign... until proven right
 
     //// gui
-    if ((similarityAlgorithm == img_similarity_features) or (similarityAlgorithm == img_similarity_homography)) // for features and homography
+    if ((similarityAlgorithm == img_similarity_features) or (similarityAlgorithm == img_similarity_homography)) { // for features and homography
         ui->frame_group_nb_features->setDisabled(true); // hide nb of features option in options tab
+        ui->frame_group_features_pruning->setDisabled(true); // the pairs in cache depend on the option
+    }
+    if (HashIsDihedral(similarityAlgorithm)) // for pHash, dHash and idHash : the scores in cache depend on the option
+        ui->frame_group_dihedral->setDisabled(true);
 
     //// clean cached info in images list
     for (int n = 0; n < int(images.size()); n++) { // parse all images
@@ -2181,7 +2355,10 @@ void MainWindow::CompareImages() // compare images in images list
         countLimit = 40;
     else if (similarityAlgorithm == img_similarity_dnn_classify)
              countLimit = 10;
-    int sum = images.size() * (images.size() - 1) / 2; // number of comparisons to perform = 1+2+3+4+... images - formula is n(n+1)/2
+    std::vector<std::vector<int>> partitions = PartitionImages(similarityAlgorithm); // images that can't be duplicates are never paired : orientation, or dimensions for checksum
+    int sum = 0; // number of comparisons to perform = n(n-1)/2 pairs in each partition
+    for (const std::vector<int> &partition : partitions)
+        sum += int(partition.size()) * (int(partition.size()) - 1) / 2;
     ShowProgress(progress_prepare);
     ShowProgress(progress_run, "Comparing images", 0, sum);
     ShowProgress(progress_update, "", 0);
@@ -2191,24 +2368,31 @@ void MainWindow::CompareImages() // compare images in images list
         PrepareDNN();
     }
 
-    //// find duplicates in images list
-    for (int i = 0; i < int(images.size()) - 1; i++) { // parse images list minus last one, first pass
-        if ((!images[i].deleted) and (!images[i].error)) { // valid image ?
+    //// the sorted scores of this algorithm will change
+    thresholdEdges.erase(similarityAlgorithm);
+    shownAlgorithm = -1;
+
+    //// features and homography : only compare images that share enough visual words
+    if ((similarityAlgorithm == img_similarity_features) or (similarityAlgorithm == img_similarity_homography))
+        PrepareFeaturesCandidates();
+    else
+        featuresCandidates.clear();
+
+    //// find duplicates in images list - pairs of each partition only
+    for (const std::vector<int> &partition : partitions) { // parse partitions
+        for (int a = 0; (a < int(partition.size()) - 1) and (!stop); a++) { // parse partition minus last one, first pass
+            const int i = partition[a];
             #pragma omp parallel
             {
                 #pragma omp for
-                for (int j = i + 1; j < int(images.size()); j++) { // parse images list, second pass - all preceding images have already been tested
-                    if ((!stop) and (!images[j].deleted) and (!images[j].error)) { // image J valid ?
+                for (int b = a + 1; b < int(partition.size()); b++) { // parse partition, second pass - all preceding images have already been tested
+                    const int j = partition[b];
+                    if ((!stop) and (IsFeaturesCandidate(i, j))) { // pairs that are not candidates are not compared, their score stays unknown - images are valid
                         float similarity = -1; // default similarity : score not possible (should be 0 to 100%)
-                        bool duplicates = ImagesAreDuplicates(i, j, similarityAlgorithm, threshold, similarity); // check if images I and J are duplicates, get also the score
+                        ImagesAreDuplicates(i, j, similarityAlgorithm, threshold, similarity); // compare images I and J, get the score - duplicates lists are derived from all scores once comparison is done
 
-                        #pragma omp critical // because std::vectors will be used
+                        #pragma omp critical // because std::map will be used
                         {
-                            if (duplicates) { // images are duplicates ?
-                                images[i].duplicates.push_back(j); // add each image to the duplicates list of the other one
-                                images[j].duplicates.push_back(i);
-                            }
-
                             cv::Point imagePair = OrderedPair(i, j); // index for images I and J, index-ordered
                             auto pair = pairs.find(imagePair); // get their similarity score if it exists
 
@@ -2231,10 +2415,6 @@ void MainWindow::CompareImages() // compare images in images list
                             count = 0; // reset counter
                         }
                     }
-                    if (stop) {
-                        i = images.size() - 1;
-                        j = images.size() - 1;
-                    }
                 }
             }
 
@@ -2249,6 +2429,7 @@ void MainWindow::CompareImages() // compare images in images list
         ui->label_no_duplicates->setVisible(true);
     }
     else {
+        PrepareThresholdEdges(similarityAlgorithm); // sort all scores of this algorithm once : changing the threshold later won't need another comparison
         ShowDuplicatesList(); // display the similarity check results
 
         ShowProgress(progress_finished, "Images compared"); // end the current progress (that hides the animated wainting icon and restores the mouse cursor
@@ -2260,103 +2441,24 @@ void MainWindow::CompareImages() // compare images in images list
 
 // Display
 
-QTreeWidgetItem* MainWindow::GetDuplicateItem(const int &ref) // add dpulicate info to item in duplicates view
+struct_duplicates_row MainWindow::GetDuplicateRow(const int &ref) // texts of a duplicate image for the duplicates view - called by the model only when the image is shown
 {
-    QTreeWidgetItem *item = new QTreeWidgetItem(); // add an item in list
+    struct_duplicates_row row;
 
-    // column 0 - checkbox and image index
-    item->setText(0, "");
-    item->setTextAlignment(0, Qt::AlignHCenter | Qt::AlignVCenter);
-    item->setData(0, Qt::UserRole, ref); // internal data = image index in images list -> this way a selected row can be associated with the original image
-    // column 1 - icon
-    item->setIcon(1, QIcon(images[ref].icon)); // column 1
+    // column 0 - checkbox and column 1 - icon : handled by the model
     // column 2 - image file extension/type
-    item->setText(2, QString::fromStdString(stringutils::ToUpper(images[ref].type))); // image file type text
-    item->setBackground(2, ImageTypeColor(images[ref].type)); // set background color according to image type
-    item->setTextAlignment(2, Qt::AlignHCenter | Qt::AlignVCenter);
+    row.type = QString::fromStdString(stringutils::ToUpper(images[ref].type)); // image file type text
+    row.typeColor = ImageTypeColor(images[ref].type); // background color according to image type
     // column 3 - size
-    item->setText(3, QString::number(images[ref].width) + "x" + QString::number(images[ref].height));
-    item->setTextAlignment(3, Qt::AlignHCenter | Qt::AlignVCenter);
+    row.size = QString::number(images[ref].width) + "x" + QString::number(images[ref].height);
     // column 4 - resolution
-    item->setText(4, QString::number(float(images[ref].width * images[ref].height) / 1000000.0f, 'f', 2)); // megapixels
-    item->setTextAlignment(4, Qt::AlignHCenter | Qt::AlignVCenter);
+    row.resolution = QString::number(float(images[ref].width * images[ref].height) / 1000000.0f, 'f', 2); // megapixels
     // column 5 - filename
-    item->setText(5, QString::fromStdString(images[ref].basename));
-    item->setToolTip(5, QString::fromStdString(images[ref].basename));
+    row.name = QString::fromStdString(images[ref].basename);
     // column 6 - file path
-    item->setText(6, QString::fromStdString(images[ref].folder));
-    item->setToolTip(6, QString::fromStdString(images[ref].folder));
-    // general : new item options
-    item->setFlags(Qt::ItemIsUserCheckable | Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-    item->setCheckState(0, Qt::Unchecked); // necessary, if the initial value is not set, the checkbox won't appear
-    item->setSelected(false); // don't select the current line
-    images[ref].duplicateItem = item; // keep the pointer to the item in the internal images list
-
-    return item; // return lovingly handcrafted item
-}
-
-int MainWindow::GetClosestNeighbourNotUsed(const int &imageNumber, const imageSimilarityAlgorithm &algo) // get closest imageNumber of a imageNumber NOT used
-    // used for 1st pass of clustering process
-{
-    int neighbour = -1; // means no image neighbour found
-    float scoreMax = threshold; // initialize highest score found to threshold value (minimum score to attain) for this algorithm
-
-    for (int currentNeighbour = 0; currentNeighbour < int(images[imageNumber].duplicates.size()); currentNeighbour++) { // parse all duplicates ("neighbours") for current image
-        int ref = images[imageNumber].duplicates[currentNeighbour]; // get neighbour index in internal images list
-        if ((ref != imageNumber) and (!images[ref].error) and (!images[ref].deleted) and (!images[ref].used)) { // neighbour valid and NOT equal to the tested image AND it is not already used
-            auto pairScore = pairs.find(OrderedPair(imageNumber, ref)); // find the score for this pair
-            if (pairScore->second.score[algo] >= scoreMax) { // is the current score more than highest score found ?
-                neighbour = ref; // this image neighbour looks good !
-                scoreMax = pairScore->second.score[algo]; // update highest score found
-            }
-        }
-    }
-
-    return neighbour; // return the image neighbour with the highest score... or -1 if no neighbour was found
-}
-
-int MainWindow::GetClosestNeighbour(const int &imageNumber, const imageSimilarityAlgorithm &algo) // get closest imageNumber of a imageNumber
-    // only difference with GetClosestNeighbourNotUsed() is that we find a neighbour without checking if it already used
-    // used for 1st and 2nd pass of clustering process
-    // almost same comments as the other function
-{
-    int neighbour = -1;
-    float scoreMax = ui->doubleSpinBox_threshold->value();
-
-    for (int n = 0; n < int(images[imageNumber].duplicates.size()); n++) {
-        int ref = images[imageNumber].duplicates[n];
-        if ((ref != imageNumber) and (!images[ref].error) and (!images[ref].deleted)) {
-            auto pairScore = pairs.find(OrderedPair(imageNumber, ref));
-            if (pairScore->second.score[algo] >= scoreMax) {
-                neighbour = ref;
-                scoreMax = pairScore->second.score[algo];
-            }
-        }
-    }
-
-    return neighbour;
-}
-
-int MainWindow::GetClosestNeighbourHasGroup(const int &imageNumber, const imageSimilarityAlgorithm &algo) // get closest imageNumber of a imageNumber with a group
-    // only difference with GetClosestNeighbourNotUsed() and GetClosestNeighbourNotUsed() is that we find a neighbour already used in a group
-    // used only for 2nd pass of clustering process
-    // almost same comments as the other functions
-{
-    int neighbour = -1;
-    float scoreMax = ui->doubleSpinBox_threshold->value();
-
-    for (int n = 0; n < int(images[imageNumber].duplicates.size()); n++) {
-        int ref = images[imageNumber].duplicates[n];
-        if ((ref != imageNumber) and (!images[ref].error) and (!images[ref].deleted) and (!groups[ref].empty())) {
-            auto pairScore = pairs.find(OrderedPair(imageNumber, ref));
-            if (pairScore->second.score[algo] >= scoreMax) {
-                neighbour = ref;
-                scoreMax = pairScore->second.score[algo];
-            }
-        }
-    }
+    row.path = QString::fromStdString(images[ref].folder);
 
-    return neighbour;
+    return row; // return lovingly handcrafted row
 }
 
 float MainWindow::GetScore(const int &im1, const int &im2, const imageSimilarityAlgorithm &algo) // get algo distance from 2 images
@@ -2366,7 +2468,7 @@ float MainWindow::GetScore(const int &im1, const int &im2, const imageSimilarity
     if (pairScore != pairs.end()) // score found ?
         return pairScore->second.score[algo]; // return it for current algorithm
 
-    return 0; // not found -> return lowest score (should NEVER happen !)
+    return 0; // not found -> return lowest score (happens for pairs discarded by visual words candidates)
 }
 
 void MainWindow::AddImageToGroup(const int &group, const int &image) // add an image to a group
@@ -2376,30 +2478,46 @@ void MainWindow::AddImageToGroup(const int &group, const int &image) // add an i
     images[image].used = true;
 }
 
-void MainWindow::AddImageToGroupCheckScores(const int &group, const int &image, const imageSimilarityAlgorithm &algo) // add an image to a group with minimum score
+int MainWindow::CountInvalidImages() // number of deleted or invalid images
+{
+    int count = 0;
+    for (int n = 0; n < int(images.size()); n++)
+        if ((images[n].deleted) or (images[n].error))
+            count++;
+
+    return count;
+}
+
+void MainWindow::PrepareThresholdEdges(const imageSimilarityAlgorithm &algorithm) // gather all scores of an algorithm from pairs, sorted
+    // pairs that can't be duplicates whatever the threshold are left out : invalid images, different orientations, checksums of images with different sizes
 {
-    // check all group members, if only one has a bad score with the tested image, don't add it
-    // this naturally creates very "close" images groups
-    int count = 0; // counter for sufficiently similar images
-    for (int ref = 0; ref < int(groups[group].size()); ref++) { // parse all images in this group
-        int neighbour = groups[group][ref]; // current image neighbour
-        auto pairScore = pairs.find(OrderedPair(image, neighbour)); // find pair's score
-        if (pairScore->second.score[algo] >= threshold) // the score between current tested images is sufficient (>= threshold)
-            count++; // one more image close to the image to add
+    ScopedStage timer(stageSortScores);
+    std::vector<struct_cluster_edge> edges;
+    for (auto &pair : pairs) { // parse all compared pairs
+        const int i = pair.first.x; // pairs are ordered : i < j
+        const int j = pair.first.y;
+        const float score = pair.second.score[algorithm];
+
+        if ((score == -1) or (images[i].deleted) or (images[i].error) or (images[j].deleted) or (images[j].error)) // no score for this algorithm or invalid image
+            continue;
+        if (ImagePartitionKey(i, algorithm) != ImagePartitionKey(j, algorithm)) // these pairs are never duplicates - scored by another algorithm's run, or before partitions
+            continue;
+
+        edges.push_back({i, j, score});
     }
 
-    // also check "head" of the group
-    auto pairScore = pairs.find(OrderedPair(image, group));
-    if (pairScore->second.score[algo] >= threshold)
-        count++;
+    thresholdEdges[algorithm].clustering.SetEdges(images.size(), edges); // sorted best first
+    thresholdEdges[algorithm].invalidImages = CountInvalidImages();
+}
 
-    float percentage = float(count) / float(groups[group].size() + 1); // percentage of "good" matches ?
-    if (percentage <= 0.5) // if less than half of the images in this group match sufficiently with the main tested image
-        return; // don't add the image to the group
+void MainWindow::UpdateDuplicatesFromThreshold() // re-derive duplicates and groups for the current algorithm and threshold from scores in cache
+{
+    if ((shownAlgorithm == similarityAlgorithm) and (shownThreshold == threshold)) // already displayed
+        return;
+    if (thresholdEdges.find(similarityAlgorithm) == thresholdEdges.end()) // this algorithm was not computed : the current results stay
+        return;
 
-    groups[group].push_back(image); // add this image to the group
-    images[group].used = true; // indicate that both the "head" image and the main tested image are now used
-    images[image].used = true;
+    ShowDuplicatesList(); // duplicates, groups and display - only the groups that changed are clustered again
 }
 
 void MainWindow::ShowDuplicatesList() // show list of duplicate images
@@ -2411,7 +2529,6 @@ void MainWindow::ShowDuplicatesList() // show list of duplicate images
     }
 
     //// GUI
-    ui->treeWidget_duplicates->clear(); // clear duplicates list widget
     ui->label_no_duplicates->setVisible(false); // hide the "no image to display" message... until proven wrong
 
     //// create groups empty skeleton from images list
@@ -2422,151 +2539,90 @@ void MainWindow::ShowDuplicatesList() // show list of duplicate images
         groups.push_back(group);
     }
 
-    //// add images to groups - 1st pass
-    // group #n is the #n image's group, it can be empty
-
-    for (int currentImage = 0; currentImage < int(images.size()); currentImage++) { // parse all images
-        if ((!images[currentImage].deleted) and (!images[currentImage].error) and (!images[currentImage].used)) { // current image is valid and not used ?
-            int neighbour = GetClosestNeighbourNotUsed(currentImage, similarityAlgorithm); // find its closest neighbour in its duplicates list
-            int oldNeighbour = -1; // keep track of last neighbour found
-            while (neighbour != -1) { // while there is a neighbour
-                float scoreCurrent = GetScore(currentImage, neighbour, similarityAlgorithm); // get the score for the current pair of images
-                int neighbourClosestNeighbour = GetClosestNeighbourNotUsed(neighbour, similarityAlgorithm); // find the neighbour of the neighbour, NOT used
-                if (neighbourClosestNeighbour != -1) { // a neighbour of the neighbour found ?
-                    if (neighbourClosestNeighbour == currentImage) { // if the neighbour of the neighbour is the tested image itself
-                        AddImageToGroupCheckScores(currentImage, neighbour, similarityAlgorithm); // add it to tested image's group, it's the best match we can find !
-                    }
-                    else { // no neighbour of the neighbour found
-                        float scoreNeighbour = GetScore(neighbour, neighbourClosestNeighbour, similarityAlgorithm); // get the score between the image and its closest neighbour
+    //// duplicates of each image : all pairs with a score >= threshold, from the sorted scores of the current algorithm
+    struct_threshold_edges &sorted = thresholdEdges[similarityAlgorithm];
+    if ((sorted.clustering.Empty()) or (sorted.invalidImages != CountInvalidImages())) // images were deleted since the scores were sorted
+        PrepareThresholdEdges(similarityAlgorithm);
 
-                        if (scoreCurrent >= scoreNeighbour) { // if the neighbour is sufficiently similar to the image
-                            AddImageToGroupCheckScores(currentImage, neighbour, similarityAlgorithm); // add it to the tested image's group
-                        }
-                    }
-                }
+    ScopedStage clusteringTimer(stageClustering);
 
-                oldNeighbour = neighbour; // keep the last neighbour tested
-                neighbour = GetClosestNeighbourNotUsed(currentImage, similarityAlgorithm); // find another one
-                if (neighbour == oldNeighbour) // not any new neighbour found ?
-                    neighbour = -1; // set exit condition for the while loop
-            }
-        }
+    for (int n = 0; n < int(images.size()); n++) // parse images
+        images[n].duplicates.clear();
+    const std::vector<struct_cluster_edge> &edges = sorted.clustering.SortedEdges(); // best first
+    const long long nbDuplicates = sorted.clustering.EdgesAbove(threshold); // binary search
+    for (long long e = 0; e < nbDuplicates; e++) { // pairs of duplicates
+        images[edges[e].a].duplicates.push_back(edges[e].b); // add each image to the duplicates list of the other one
+        images[edges[e].b].duplicates.push_back(edges[e].a);
     }
-    /*simplest culstering !
-        for (int currentImage = 0; currentImage < int(images.size()); currentImage++) { // parse all images
-        if ((!images[currentImage].deleted) and (!images[currentImage].error) and (!images[currentImage].used) and (!images[currentImage].duplicates.empty())) { // current image is not used
-            for (int indexNeighbour = 0; indexNeighbour < int(images[currentImage].duplicates.size()); indexNeighbour++) {
-                int neighbour = images[currentImage].duplicates[indexNeighbour];
-                if (!images[neighbour].used) { // current image is not used
-                    AddImageToGroup(currentImage, neighbour);
-                    images[neighbour].used = true;
-                }
-            }
-            images[currentImage].used = true;
-        }
-    }*/
-
-    //// add images to groups - 2nd pass
-    // check if an image was not used at all (it happens !), in this case add it to the closest neighbours's group
-
-    for (int currentImage = 0; currentImage < int(images.size()); currentImage++) { // parse all images
-        if ((!images[currentImage].error) and (!images[currentImage].deleted) and (!images[currentImage].duplicates.empty()) and (!images[currentImage].used)) { // image is valid, has duplicates but is not used yet
-            int neighbour = GetClosestNeighbourHasGroup(currentImage, similarityAlgorithm); // find the closest neighbour already assigned to a group
-            if (neighbour != -1) { // valid neighbour found ?
-                AddImageToGroup(neighbour, currentImage); // add unused image to this neighbour's group
-            }
-            else { // no closest neighbour with a group was found
-                neighbour = GetClosestNeighbour(currentImage, similarityAlgorithm); // check if a closest neighbour exists (without an assigned group ! that was tested before)
 
-                if (neighbour != -1) { // valid neighbour found ?
-                    int neighbourNeighbour = GetClosestNeighbourHasGroup(neighbour, similarityAlgorithm); // check if this neighbour has a neighbour with a group
+    //// add images to groups
+    // group #n is the #n image's group, it can be empty
+    // the duplicates lists form a graph : connected components, then inside each one an image (or a group) only joins a group
+    // if it is a duplicate of more than half of its members - images left alone join the group of their closest duplicate
+    // when only the threshold changed, only the components touched by the scores between the old and new thresholds are clustered again
 
-                    if (neighbourNeighbour != -1) // valid neighbour of neighbour ?
-                        AddImageToGroup(neighbourNeighbour, currentImage); // add current image to this "far" group
-                }
-            }
+    std::vector<std::vector<int>> clusters = sorted.clustering.Clusters(threshold, cluster_linkage_majority, 0.5f, true); // same ">50% of the group" rule as before
+    shownAlgorithm = similarityAlgorithm;
+    shownThreshold = threshold;
 
-            if (!images[currentImage].used) { // image didn't make it but has similarity... problem !
-                qDebug() << "No group : image " << currentImage << " - " << QString::fromStdString(images[currentImage].fullPath); // log this error (should not often happen)
-            }
-        }
-    }
+    for (int c = 0; c < int(clusters.size()); c++) // parse clusters
+        for (int n = 1; n < int(clusters[c].size()); n++) // the first image (lowest index) is the "head" of the group
+            AddImageToGroup(clusters[c][0], clusters[c][n]);
+    clusteringTimer.Stop();
 
-    //// display image duplicates in groups : create tree widget items from groups list
+    //// display image duplicates in groups : the model only gets the image indexes, rows are created when they are shown
 
+    ScopedStage widgetsTimer(stageWidgets);
+    std::vector<std::vector<int>> shownGroups; // groups for duplicates list : first image is the image itself
     for (int group = 0; group < int(groups.size()); group++) { // parse groups list - group number is also the image's number
         if (groups[group].size() > 0) { // this image's group contains members ?
-            // create a blue ligne = top
-            QTreeWidgetItem *top = new QTreeWidgetItem(ui->treeWidget_duplicates); // new item
-            for (int n = 0; n < 7; n++) // color this line in light cyan
-                top->setBackground(n, QColor(230, 255, 255));
-            // first item of this group is the image itself
-            QTreeWidgetItem *first = GetDuplicateItem(group); // create first child item
-            top->addChild(first); // add it to top item
+            std::vector<int> shown(1, group); // first image of this group is the image itself
             images[group].group = group; // set image's group to new group number
-
-            // settooltip to group bar ?
-
-            // now add image's duplicates to current group
-            for (int j = 0; j < int(groups[group].size()); j++) { // parse this group's members
+            for (int j = 0; j < int(groups[group].size()); j++) { // now add image's duplicates to current group
                 int ref = groups[group][j]; // current image number of this group
-                QTreeWidgetItem *child = GetDuplicateItem(ref); // create new child item for this group
-                top->addChild(child); // add it to top item
+                shown.push_back(ref);
                 images[ref].group = group; // set current image's group to new group number
             }
-
-            top->setExpanded(true); // expand this top item
+            shownGroups.push_back(shown);
         }
     }
 
-    // clean duplicates list - should never happen
-    /*for (int n = 0; n < ui->treeWidget_duplicates->topLevelItemCount(); n++) {
-        QTreeWidgetItem *topItem = ui->treeWidget_duplicates->topLevelItem(n);
-        if (topItem->childCount() <= 1) {
-            if (topItem->childCount() == 1) {
-                int ref = topItem->child(0)->data(0, Qt::UserRole).toInt();
-                images[ref].used = false;
-                delete topItem->child(0);
-            }
-            delete topItem;
-            n--;
-        }
-    }*/
+    std::vector<int> resolutions(images.size()); // sort key of images inside groups
+    for (int n = 0; n < int(images.size()); n++)
+        resolutions[n] = images[n].width * images[n].height;
+
+    duplicatesTreeModel->SetGroups(shownGroups, resolutions); // images are sorted in each group by the model, by resolution descending unless another column was clicked
+    ui->treeView_duplicates->expandAll(); // expand all groups
 
     //// set color found or not in images list
     // green = used in a group, red = NOT used
     // we loose the information of file type color this way, but it helps looking for images to test further
 
+    std::vector<QColor> colors(images.size()); // all images list colors are updated at once
     for (int n = 0; n < int(images.size()); n++) { // parse all images
         if ((!images[n].deleted) and (!images[n].error)) { // image valid ?
             if (images[n].used) // if it is used in a group
-                images[n].imageItem->setBackground(QColor(0,255,0)); // color it in green in images list
+                colors[n] = QColor(0,255,0); // color it in green in images list
             else // not used ?
-                images[n].imageItem->setBackground(QColor(255,0,0)); // color it red
+                colors[n] = QColor(255,0,0); // color it red
         }
+        else
+            colors[n] = ImageTypeColor(images[n].type); // unchanged
     }
-
-    //// sort list by resolution, descending in each group
-    ui->treeWidget_duplicates->sortItems(4, Qt::DescendingOrder); // column 4 is the image resolution
+    imagesListModel->SetBackgrounds(colors);
 
     ShowDuplicatesListCount(); // show the number of matched images in duplicates list
 }
 
 int MainWindow::ShowDuplicatesListCount() // show number of images in duplicates list
 {
-    int countGroups = ui->treeWidget_duplicates->topLevelItemCount(); // count the nuber of groups in duplicates list
+    int countGroups = duplicatesTreeModel->GroupsCount(); // the nuber of groups in duplicates list, kept by the model
     ui->lcdNumber_nb_duplicates_groups->display(countGroups); // show this result
 
-    QTreeWidgetItemIterator it(ui->treeWidget_duplicates); // iterator to parse all element of the QTreeWidget
-    int countImages = 0; // counter for found images
-    while (*it) { // all duplicates entry are tested
-        countImages++; // count current one
-        ++it; // next QTreeWidgetItem
-    }
-    countImages -= countGroups; // number of duplicates = number of items minus the group bars
+    int countImages = duplicatesTreeModel->ImagesCount(); // number of images in all groups, kept by the model too
     ui->lcdNumber_nb_duplicates_images->display(countImages); // display the result
 
-    if (ui->treeWidget_duplicates->topLevelItemCount() == 0) { // if no group was found
+    if (countGroups == 0) { // if no group was found
         ui->label_no_duplicates->setVisible(true); // show the message
     }
 
@@ -2685,27 +2741,10 @@ void MainWindow::on_button_examine_clicked() // set as a test at the beginning,
     int im1 = -1;
     int im2 = -1;
 
-    for (int n = 0; n < ui->treeWidget_duplicates->topLevelItemCount(); n++) { // for each top-level item
-        QTreeWidgetItem *topItem = ui->treeWidget_duplicates->topLevelItem(n); // current top-level item
-        if (topItem->childCount() > 0) { // does it have children ? (should be yes all the time)
-            for (int i = 0; i < int(topItem->childCount()); i++) { // parse all children of the top item
-                 QTreeWidgetItem *child = topItem->child(i); // this child
-
-                 int state = child->checkState(0); // is it checked ?
-                 if (state == Qt::Checked) { // yes !
-                     int ref = child->data(0, Qt::UserRole).toInt(); // get this child's index in internal images list
-
-                     if (im1 == -1) { // is it the first image to test ?
-                         im1 = ref;
-                     }
-                     else if (im2 == -1) { // is it the 2nd image to test ?
-                         im2 = ref;
-                         n = ui->treeWidget_duplicates->topLevelItemCount(); // end the main loop now that we have what we were looking for
-                         break; // finished !
-                     }
-                 }
-            }
-        }
+    std::vector<int> checkedImages = duplicatesTreeModel->CheckedImages(); // checked images, in displayed order
+    if (checkedImages.size() >= 2) { // the first two
+        im1 = checkedImages[0];
+        im2 = checkedImages[1];
     }
 
     if ((im1 == -1) or (im2 == -1)) // at least two images checked !
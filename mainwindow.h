@@ -18,29 +18,40 @@
 #include <QMainWindow>
 #include <QMessageBox>
 #include <QElapsedTimer>
-#include <QListWidget>
-#include <QTreeWidget>
+#include <QListView>
+#include <QTreeView>
 #include <QStyledItemDelegate>
 #include <QPainter>
 #include <QScreen>
 #include <QMovie>
 #include <QWhatsThis>
 #include <QDirIterator>
+#include <QDateTime>
 
 #include <thread>
 #include <omp.h>
 
 #include "dialogs/file-dialog.h"
+#include "widgets/images-list-model.h"
+#include "widgets/duplicates-tree-model.h"
 #include "lib/image-compare.h"
+#include "lib/image-files.h"
+#include "lib/visual-words.h"
+#include "lib/tile-hash.h"
+#include "lib/clustering.h"
+#include "lib/thumbnail-cache.h"
+#include "lib/file-operations.h"
+#include "lib/stage-timer.h"
 #include "lib/image-utils.h"
 #include "lib/image-transform.h"
+#include "lib/image-pyramid.h"
 #include "lib/image-color.h"
 #include "lib/dominant-colors.h"
 #include "lib/config-file.h"
 #include "lib/string-utils.h"
 
 
-class TreeWidgetDelegate : public QStyledItemDelegate // delegate to add a line at the bottom of QTreeWidgetItems
+class TreeWidgetDelegate : public QStyledItemDelegate // delegate to add a line at the bottom of duplicates list rows
 {
 
 public:
@@ -54,7 +65,7 @@ public:
     }
 };
 
-class ListWidgetDelegate : public QStyledItemDelegate // delegate to add a border to QListItemWidgets
+class ListWidgetDelegate : public QStyledItemDelegate // delegate to add a border to images list items
 {
 
 public:
@@ -81,10 +92,10 @@ public:
     ~MainWindow();
 
 public slots:
-    void ImagesListClick(QListWidgetItem *item); // click on item in images list -> toggle checked status
-    void ImagesListDoubleClick(QListWidgetItem *item); // double-click on item of images list -> show image in new window
-    void DuplicatesListClick(QTreeWidgetItem *item, int column); // click anywhere (except the image) on duplicate item to check it
-    void DuplicatesListDoubleClick(QTreeWidgetItem *item, int column); // double-click duplicate image to open it in a new window
+    void ImagesListClick(const QModelIndex &index); // click on item in images list -> toggle checked status
+    void ImagesListDoubleClick(const QModelIndex &index); // double-click on item of images list -> show image in new window
+    void DuplicatesListClick(const QModelIndex &index); // click anywhere (except the image) on duplicate item to check it
+    void DuplicatesListDoubleClick(const QModelIndex &index); // double-click duplicate image to open it in a new window
 
 /*// define isnan if fast_math is activated (isnan doesn't work with fast_math
 #if defined __FAST_MATH__
@@ -124,7 +135,7 @@ private slots:
     void on_button_images_check_text_clicked(); // button pressed -> find words and check images in images list
     void on_button_images_check_text_dnn_clicked(); // button pressed -> find classes with DNN and check images in images list
     // Remove and delete
-    void RemoveImageFromListImages(QListWidgetItem *item); // remove one item from image list by its pointer
+    void RemoveImagesFromListImages(const std::vector<int> &imagesToRemove); // remove images from images list view
     void on_button_images_hide_clicked(); // button pressed -> hide checked images from list
     void on_button_images_hide_error_clicked(); // button pressed -> hide images with errors from list
     void on_button_images_delete_clicked(); // button pressed -> delete images from list
@@ -133,6 +144,8 @@ private slots:
     void on_spinBox_thumbnails_size_valueChanged(int size); // change thumbnails size
     void on_spinBox_reduced_size_valueChanged(int size); // change working image size
     void on_spinBox_nb_features_valueChanged(int nb); // change number of features to find for features detection and homography
+    void on_checkBox_dihedral_toggled(bool checked); // find rotated and mirrored copies with pHash, dHash and idHash
+    void on_checkBox_features_pruning_toggled(bool checked); // features and homography : only compare the candidates of each image, or all pairs
     void on_doubleSpinBox_threshold_valueChanged(double nb); // change threshold
     /// duplicates list
     // clear
@@ -152,10 +165,16 @@ private slots:
     void on_button_duplicates_delete_clicked(); // button pressed -> remove checked items in duplicates list and delete the image file
     void on_button_duplicates_copy_clicked(); // button pressed -> copy files of checked duplicates in duplicates list to another folder
     void on_button_duplicates_move_clicked(); // button pressed -> move checked items in duplicates list to another folder
+    void on_button_duplicates_link_clicked(); // button pressed -> replace checked exact duplicates with links to the unchecked image of their group
+    void on_button_duplicates_unlink_clicked(); // button pressed -> undo the links written in a links log
     // save results
     void on_button_duplicates_save_results_clicked(); // button to save results - for debugging purpose only - deactivate it for final version
     // Examine
     void on_button_examine_clicked(); // set as a test at the beginning, this function is useful to estimate the real visual similarity between two images
+    /// Performance
+    void on_button_performance_refresh_clicked(); // button pressed -> show time spent in each stage
+    void on_button_performance_export_clicked(); // button pressed -> save all timed stages to a Chrome trace file
+    void on_button_performance_clear_clicked(); // button pressed -> forget all measures
 
     //// sliders and values
     // none for now !
@@ -213,14 +232,14 @@ private:
         cv::Mat descriptors; // features and homography
         std::vector<cv::Vec3d> dominantColors;
         // miniature cache
-        QPixmap icon; // icon for display in Qt (images list and duplicates)
+        std::vector<uchar> thumbnail; // icon for display in Qt (images list and duplicates), compressed as JPEG - decoded only when shown
         cv::Mat imageReduced; // color miniature
         cv::Mat imageReducedGray; // gray miniature
-        // images list and duplicates entry
-        QListWidgetItem *imageItem;
-        QTreeWidgetItem *duplicateItem;
     };
     std::vector<struct_image_info> images; // contains images list to test
+    ImagesListModel *imagesListModel; // images list view : one row per shown image
+    ThumbnailCache thumbnailCache; // thumbnails of images scanned in previous sessions
+    DuplicatesTreeModel *duplicatesTreeModel; // duplicates list view : groups of image indexes, rows created only when shown
 
     // duplicates
     struct struct_scores { // for one pair of images, keep the computed information - +1 because img_similarity_count is used for combined score
@@ -253,14 +272,33 @@ private:
     cv::dnn::Net dnnInception; // DNN is only defined (and loaded) once
     std::vector<std::string> classes; // classes are only defined (and loaded) once
 
+    // visual words and tile hashes - candidates for features and homography
+    VisualWordsIndex visualWords; // vocabulary is loaded once, built again when it doesn't fit the current images
+    float visualWordsError = -1; // quantization error of the vocabulary on the images it was built from
+    const float visualWordsMaxDrift = 1.15f; // the vocabulary is built again if the current images have a quantization error 15% higher
+    std::vector<std::vector<int>> featuresCandidates; // for each image, sorted list of candidate images - empty = compare all pairs
+    int visualWordsTopK = 50; // number of candidates retrieved for each image
+    int tileHashesTopK = 10; // crops : number of candidates retrieved for each image from the tile hashes
+
+    // score-sorted edges of each compared algorithm : changing the threshold re-clusters without comparing images again
+    struct struct_threshold_edges {
+        ThresholdClustering clustering; // all scored pairs of this algorithm
+        int invalidImages = 0; // number of deleted or invalid images when the edges were gathered - edges are gathered again if it changes
+    };
+    std::map<imageSimilarityAlgorithm, struct_threshold_edges, struct_compareSimilarities> thresholdEdges;
+    int shownAlgorithm = -1; // algorithm and threshold of the duplicates currently displayed - -1 = nothing displayed
+    float shownThreshold = -1;
+
     // options
     int thumbnailsSize;
     int reducedSize;
     int nbFeatures;
+    bool dihedralHashes; // pHash, dHash and idHash invariant to rotations and mirrors
+    bool featuresPruning; // features and homography : only compare the visual words and tile hashes candidates of each image
     float threshold;
     imageSimilarityAlgorithm similarityAlgorithm = img_similarity_checksum;
 
-    // delegates for QTreeWidget and QListWidget
+    // delegates for QTreeWidget and QListView
     TreeWidgetDelegate *treeWidgetDelegate;
     ListWidgetDelegate *listWidgetDelegate;
 
@@ -280,6 +318,10 @@ private:
     // files deletion
     void TrashBinTest(); // test file deletetion to trash bin and set global variables to indicate file deletion method
     bool DeleteFile(const std::string &filePath); // delete a file to trash bin or permanently
+    // bulk file operations
+    bool AskFileConflicts(FileOperations &operations, const QString &title); // one question for all existing destinations - false if the user cancels
+    void RunFileOperations(FileOperations &operations, const fileOperationType &type, const QString &message); // run a batch in background, with progress and stop button
+    QString FileOperationsErrors(const FileOperations &operations); // errors log of a batch
 
     //// save & load functions
     void ChangeBaseDir(QString filename); // set base dir and file
@@ -290,6 +332,7 @@ private:
 	//// Other functions here
     // images list
     QColor ImageTypeColor(const std::string &extension); // returns image file type color
+    QByteArray GetImageIconData(const int &image); // compressed thumbnail of an image, or the error icon - decoded by the views
     void PopulateImagesList(const std::string &folder, const bool &recursive); // parse a directory and add images
     void CleanImagesList(); // clean/delete all duplicates in images list
     void ComputeImagesListInfo(); // compute all other required info in images list
@@ -298,19 +341,25 @@ private:
     QString GetImageClass(const int &imgNumber); // get DNN class of an image if it exists
     // duplicates list
     cv::Point OrderedPair(const int &i, const int &j); // returns a pair of integer (image index) - pairs must have im1 <= im2
-    int GetClosestNeighbourNotUsed(const int &imageNumber, const imageSimilarityAlgorithm &algo); // get closest neighbour's imageNumber of an imageNumber from duplicates of an image
-    int GetClosestNeighbour(const int &imageNumber, const imageSimilarityAlgorithm &algo); // get closest imageNumber of a imageNumber from duplicates of an image
-    int GetClosestNeighbourHasGroup(const int &imageNumber, const imageSimilarityAlgorithm &algo); // get closest imageNumber of a imageNumber that has members in its duplicates list
     float GetScore(const int &im1, const int &im2, const imageSimilarityAlgorithm &algo); // get algo distance/score between 2 images
     void AddImageToGroup(const int &group, const int &image); // add an image to a group
-    void AddImageToGroupCheckScores(const int &group, const int &image, const imageSimilarityAlgorithm &algo); // add an image to a group, checking a minimum score
     int GetLevelFromScore(const imageSimilarityAlgorithm &similarityAlgorithm, const float &score); // get level of a score from thresholds list - categories : 0 < dissimilar < different < similar < ∞ (exact)
     float CombinedScore(const int &i, const int &j); // get combined score for 2 images from previous tests
+    bool ImageIsPortrait(const int &n); // is image N portrait-oriented (or square) ?
+    bool AlgorithmNeedsOrientation(const imageSimilarityAlgorithm &similarityAlgorithm); // can this algorithm only compare images oriented the same way ?
+    bool ImagesOrientationsMatch(const int &i, const int &j, const imageSimilarityAlgorithm &similarityAlgorithm); // are images I and J oriented the same way, for algorithms that need it ?
+    long long ImagePartitionKey(const int &n, const imageSimilarityAlgorithm &similarityAlgorithm); // images with different keys are never duplicates for this algorithm
+    std::vector<std::vector<int>> PartitionImages(const imageSimilarityAlgorithm &similarityAlgorithm); // valid images grouped by partition key : only pairs inside a partition are compared
     bool ImagesAreDuplicates(const int &i, const int &j, const imageSimilarityAlgorithm &similarityAlgorithm, const float &threshold, float &similarity); // compare a pair of images using an algorithm
     std::string GetHashString(const int &imageNumber, const imageSimilarityAlgorithm &similarityAlgorithm); // get hash string from image hash (debug purpose only)
     void PrepareDNN(); // prepare DNN and classes structures
+    void PrepareFeaturesCandidates(); // compute all images descriptors, then retrieve candidates with visual words and tile hashes
+    bool IsFeaturesCandidate(const int &i, const int &j); // can images I and J be compared with features or homography ?
     void CompareImages(); // compare images in images list
-    QTreeWidgetItem* GetDuplicateItem(const int &ref); // get a prepared duplicate item for the duplicates view
+    struct_duplicates_row GetDuplicateRow(const int &ref); // get the texts of a duplicate image for the duplicates view
+    int CountInvalidImages(); // number of deleted or invalid images
+    void PrepareThresholdEdges(const imageSimilarityAlgorithm &algorithm); // gather all scores of an algorithm from pairs, sorted
+    void UpdateDuplicatesFromThreshold(); // re-derive duplicates and groups for the current algorithm and threshold from scores in cache
     void ShowDuplicatesList(); // display alll duplicates : cluster in groups then show the list
     int ShowDuplicatesListCount(); // show number of images in duplicates list
     void SaveResults(); // save results to csv file - for testing purpose only
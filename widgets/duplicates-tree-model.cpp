@@ -0,0 +1,535 @@
+/*#-------------------------------------------------
+#
+#       Qt virtualized duplicates tree model
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.1 - 2026/10/19
+#
+#   - top rows = groups, children = images of a group
+#   - groups only store image indexes of the caller's images list,
+#     sorted inside each group by the model
+#   - children rows (texts, compressed icons) are given by caller functions
+#     the first time they are shown, icons are decoded in a background thread
+#     and kept in a LRU cache
+#   - check states kept in a bitset, groups and images counts kept up to date
+#
+#-------------------------------------------------*/
+
+#include "duplicates-tree-model.h"
+
+#include <algorithm>
+
+
+///////////////////////////////////////////////////////////
+//// Qt model
+///////////////////////////////////////////////////////////
+
+    // internal id of an index : 0 for a group, group id + 1 for an image
+    // group ids don't change when groups are removed or sorted, so children indexes stay valid
+
+DuplicatesTreeModel::DuplicatesTreeModel(QObject *parent) : QAbstractItemModel(parent)
+{
+    SetIconCacheSize(128); // about 1000 icons of 180x150 px
+
+    decoder = new IconDecoder(this);
+    connect(decoder, &IconDecoder::IconDecoded, this, [this](int image, const QImage &icon) { IconDecoded(image, icon); });
+}
+
+QModelIndex DuplicatesTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if ((row < 0) or (column < 0) or (column >= duplicates_column_count))
+        return QModelIndex();
+
+    if (!parent.isValid()) { // group
+        if (row >= int(groups.size()))
+            return QModelIndex();
+        return createIndex(row, column, quintptr(0));
+    }
+
+    if ((parent.internalId() != 0) or (parent.row() >= int(groups.size()))) // images have no children
+        return QModelIndex();
+    const struct_duplicates_group &group = groups[parent.row()];
+    if (row >= int(group.images.size()))
+        return QModelIndex();
+
+    return createIndex(row, column, quintptr(group.id + 1));
+}
+
+QModelIndex DuplicatesTreeModel::parent(const QModelIndex &index) const
+{
+    if ((!index.isValid()) or (index.internalId() == 0)) // groups are top rows
+        return QModelIndex();
+
+    const int group = groupOfId[index.internalId() - 1];
+    if (group == -1)
+        return QModelIndex();
+
+    return createIndex(group, 0, quintptr(0));
+}
+
+int DuplicatesTreeModel::rowCount(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) // groups
+        return int(groups.size());
+    if ((parent.internalId() != 0) or (parent.column() != 0)) // images have no children
+        return 0;
+
+    return int(groups[parent.row()].images.size());
+}
+
+int DuplicatesTreeModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+
+    return duplicates_column_count;
+}
+
+QVariant DuplicatesTreeModel::data(const QModelIndex &index, int role) const // the view only asks for visible rows
+{
+    if (!index.isValid())
+        return QVariant();
+
+    if (index.internalId() == 0) { // group : light cyan bar
+        if (role == Qt::BackgroundRole)
+            return QColor(230, 255, 255);
+        if (role == Qt::UserRole)
+            return -1;
+        return QVariant();
+    }
+
+    const int image = Image(index);
+    if (image == -1)
+        return QVariant();
+    const int column = index.column();
+
+    switch (role) {
+        case Qt::UserRole:
+            return image;
+        case Qt::CheckStateRole:
+            if (column == duplicates_column_check)
+                return checked[image] ? Qt::Checked : Qt::Unchecked;
+            return QVariant();
+        case Qt::DecorationRole: {
+            if (column != duplicates_column_icon)
+                return QVariant();
+            QPixmap *icon = icons.object(image); // already decoded ?
+            if (icon)
+                return *icon;
+            if ((iconLoader) and (!decoder->IsPending(image)))
+                decoder->Request(image, iconLoader(image)); // decode it in background : the row is updated when done
+            return QVariant();
+        }
+        case Qt::DisplayRole:
+            switch (column) {
+                case duplicates_column_type:        return Row(image).type;
+                case duplicates_column_size:        return Row(image).size;
+                case duplicates_column_resolution:  return Row(image).resolution;
+                case duplicates_column_name:        return Row(image).name;
+                case duplicates_column_path:        return Row(image).path;
+            }
+            return QVariant();
+        case Qt::ToolTipRole:
+            if (column == duplicates_column_name)
+                return Row(image).name;
+            if (column == duplicates_column_path)
+                return Row(image).path;
+            return QVariant();
+        case Qt::BackgroundRole:
+            if (column == duplicates_column_type) // according to image type
+                return Row(image).typeColor;
+            if ((column >= duplicates_column_size) and (touched[image])) // right side : checked or unchecked color, once the check state was changed
+                return checked[image] ? QColor(255, 153, 153) : QColor(148, 148, 148); // pale red or gray
+            return QVariant();
+        case Qt::TextAlignmentRole:
+            if (column <= duplicates_column_resolution)
+                return int(Qt::AlignHCenter | Qt::AlignVCenter);
+            return QVariant();
+    }
+
+    return QVariant();
+}
+
+bool DuplicatesTreeModel::setData(const QModelIndex &index, const QVariant &value, int role) // only check state : when the checkbox is clicked
+{
+    const int image = Image(index);
+    if ((image == -1) or (role != Qt::CheckStateRole))
+        return false;
+
+    SetChecked(image, value.toInt() == Qt::Checked);
+
+    return true;
+}
+
+QVariant DuplicatesTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if ((orientation != Qt::Horizontal) or (role != Qt::DisplayRole))
+        return QVariant();
+
+    switch (section) {
+        case duplicates_column_check:       return "X";
+        case duplicates_column_icon:        return "Image";
+        case duplicates_column_type:        return "Type";
+        case duplicates_column_size:        return "Size";
+        case duplicates_column_resolution:  return "Res.";
+        case duplicates_column_name:        return "Name";
+        case duplicates_column_path:        return "Path";
+    }
+
+    return QVariant();
+}
+
+Qt::ItemFlags DuplicatesTreeModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return Qt::NoItemFlags;
+    if (index.internalId() == 0) // groups can't be checked
+        return Qt::ItemIsEnabled;
+
+    return Qt::ItemIsUserCheckable | Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+void DuplicatesTreeModel::sort(int column, Qt::SortOrder order) // sort images inside each group - groups keep their order
+    // size and resolution are sorted with the pixels count, without creating rows - text columns create the rows of all images
+{
+    if ((column <= duplicates_column_icon) or (column >= duplicates_column_count)) // nothing to sort
+        return;
+
+    sortColumn = column;
+    sortOrder = order;
+    if (groups.empty())
+        return;
+
+    emit layoutAboutToBeChanged();
+    QModelIndexList oldIndexes = persistentIndexList(); // indexes kept by the view (expanded groups, current index...)
+    std::vector<int> oldImages(oldIndexes.size());
+    for (int n = 0; n < int(oldIndexes.size()); n++)
+        oldImages[n] = Image(oldIndexes[n]);
+
+    auto Key = [this, column](const int &a, const int &b) { // -1 : a < b, 0 : a == b, 1 : a > b
+        switch (column) {
+            case duplicates_column_size:
+            case duplicates_column_resolution:
+                return (resolutions[a] < resolutions[b]) ? -1 : ((resolutions[a] > resolutions[b]) ? 1 : 0);
+            case duplicates_column_type:
+                return Row(a).type.compare(Row(b).type, Qt::CaseInsensitive);
+            case duplicates_column_name:
+                return Row(a).name.compare(Row(b).name, Qt::CaseInsensitive);
+            case duplicates_column_path:
+                return Row(a).path.compare(Row(b).path, Qt::CaseInsensitive);
+        }
+        return 0;
+    };
+
+    for (size_t g = 0; g < groups.size(); g++)
+        std::sort(groups[g].images.begin(), groups[g].images.end(),
+                  [&Key, order](const int &a, const int &b) {
+                      const int compare = Key(a, b);
+                      if (compare != 0)
+                          return (order == Qt::AscendingOrder) ? (compare < 0) : (compare > 0);
+                      return a < b; // same value : always the same order
+                  });
+
+    QModelIndexList newIndexes; // same groups, images at their new rows
+    newIndexes.reserve(oldIndexes.size());
+    for (int n = 0; n < int(oldIndexes.size()); n++) {
+        if (oldImages[n] == -1) { // group : unchanged
+            newIndexes.append(oldIndexes[n]);
+            continue;
+        }
+        const std::vector<int> &images = groups[groupOfImage[oldImages[n]]].images;
+        const int row = std::find(images.begin(), images.end(), oldImages[n]) - images.begin();
+        newIndexes.append(createIndex(row, oldIndexes[n].column(), oldIndexes[n].internalId()));
+    }
+    changePersistentIndexList(oldIndexes, newIndexes);
+    emit layoutChanged();
+}
+
+///////////////////////////////////////////////////////////
+//// Groups
+///////////////////////////////////////////////////////////
+
+void DuplicatesTreeModel::SetGroups(const std::vector<std::vector<int>> &list, const std::vector<int> &imagesResolutions) // replace all groups, all unchecked
+    // imagesResolutions : pixels of each image index, used to sort images by size or resolution
+    // only image indexes are stored, rows are created later when they are shown
+{
+    beginResetModel();
+
+    resolutions = imagesResolutions;
+    const int nbImages = resolutions.size();
+
+    groups.clear();
+    groups.reserve(list.size());
+    imagesCount = 0;
+    for (size_t g = 0; g < list.size(); g++)
+        if (list[g].size() > 1) { // a group of 1 image is not a group of duplicates
+            groups.push_back({int(groups.size()), list[g]});
+            imagesCount += list[g].size();
+        }
+
+    checked.assign(nbImages, false);
+    touched.assign(nbImages, false);
+    rows.assign(nbImages, struct_duplicates_row());
+    created.assign(nbImages, false);
+    icons.clear(); // image indexes may have changed
+    decoder->Clear();
+    groupOfId.clear(); // new ids
+    UpdateGroupsIndex();
+
+    endResetModel();
+
+    sort(sortColumn, sortOrder); // current sort inside groups
+}
+
+void DuplicatesTreeModel::Clear() // no groups
+{
+    SetGroups(std::vector<std::vector<int>>(), std::vector<int>());
+}
+
+int DuplicatesTreeModel::GroupsCount() const // number of groups
+{
+    return int(groups.size());
+}
+
+int DuplicatesTreeModel::ImagesCount() const // number of images in all groups
+{
+    return imagesCount;
+}
+
+const std::vector<int>& DuplicatesTreeModel::GroupImages(const int &group) const // images of a group, in displayed order
+{
+    return groups[group].images;
+}
+
+int DuplicatesTreeModel::Image(const QModelIndex &index) const // image index of a row, -1 for a group
+{
+    if ((!index.isValid()) or (index.internalId() == 0))
+        return -1;
+
+    const int group = groupOfId[index.internalId() - 1];
+    if ((group == -1) or (index.row() >= int(groups[group].images.size())))
+        return -1;
+
+    return groups[group].images[index.row()];
+}
+
+void DuplicatesTreeModel::RemoveImages(const std::vector<int> &imagesToRemove) // remove these images - groups with less than 2 images left are removed too
+    // one layout change for all : removing rows one by one shifts all the following groups each time
+    // expanded groups stay expanded
+{
+    std::vector<bool> removed(groupOfImage.size(), false);
+    bool found = false;
+    for (size_t n = 0; n < imagesToRemove.size(); n++) {
+        const int image = imagesToRemove[n];
+        if ((image >= 0) and (image < int(groupOfImage.size())) and (groupOfImage[image] != -1)) {
+            removed[image] = true;
+            icons.remove(image);
+            found = true;
+        }
+    }
+    if (!found)
+        return;
+
+    emit layoutAboutToBeChanged();
+    QModelIndexList oldIndexes = persistentIndexList();
+    std::vector<int> oldImages(oldIndexes.size());
+    std::vector<int> oldIds(oldIndexes.size());
+    for (int n = 0; n < int(oldIndexes.size()); n++) {
+        oldImages[n] = Image(oldIndexes[n]);
+        oldIds[n] = (oldIndexes[n].internalId() == 0) ? groups[oldIndexes[n].row()].id : int(oldIndexes[n].internalId()) - 1;
+    }
+
+    size_t kept = 0;
+    imagesCount = 0;
+    for (size_t g = 0; g < groups.size(); g++) {
+        std::vector<int> &images = groups[g].images;
+        images.erase(std::remove_if(images.begin(), images.end(), [&removed](const int &image) { return removed[image]; }), images.end()); // order is kept
+        if (images.size() < 2) // not a group anymore
+            continue;
+        imagesCount += images.size();
+        if (kept != g)
+            groups[kept] = std::move(groups[g]);
+        kept++;
+    }
+    groups.resize(kept);
+    UpdateGroupsIndex();
+
+    QModelIndexList newIndexes;
+    newIndexes.reserve(oldIndexes.size());
+    for (int n = 0; n < int(oldIndexes.size()); n++) {
+        const int group = groupOfId[oldIds[n]];
+        if (group == -1) // group removed
+            newIndexes.append(QModelIndex());
+        else if (oldImages[n] == -1) // group kept
+            newIndexes.append(createIndex(group, oldIndexes[n].column(), quintptr(0)));
+        else if (groupOfImage[oldImages[n]] == -1) // image removed
+            newIndexes.append(QModelIndex());
+        else {
+            const std::vector<int> &images = groups[group].images;
+            const int row = std::find(images.begin(), images.end(), oldImages[n]) - images.begin();
+            newIndexes.append(createIndex(row, oldIndexes[n].column(), oldIndexes[n].internalId()));
+        }
+    }
+    changePersistentIndexList(oldIndexes, newIndexes);
+    emit layoutChanged();
+}
+
+void DuplicatesTreeModel::UpdateImage(const int &image) // image information changed : its row will be created again
+{
+    if ((image < 0) or (image >= int(created.size())))
+        return;
+
+    created[image] = false;
+    icons.remove(image);
+
+    const int group = groupOfImage[image];
+    if (group == -1)
+        return;
+    const std::vector<int> &images = groups[group].images;
+    const int row = std::find(images.begin(), images.end(), image) - images.begin();
+    const QModelIndex parent = index(group, 0);
+    emit dataChanged(index(row, 0, parent), index(row, duplicates_column_count - 1, parent));
+}
+
+void DuplicatesTreeModel::UpdateGroupsIndex() // rebuild group id -> group row, image -> group row
+{
+    int maxId = -1;
+    for (size_t g = 0; g < groups.size(); g++)
+        maxId = std::max(maxId, groups[g].id);
+    groupOfId.assign(std::max(int(groupOfId.size()), maxId + 1), -1); // removed groups keep an entry : -1
+
+    groupOfImage.assign(resolutions.size(), -1);
+    for (size_t g = 0; g < groups.size(); g++) {
+        groupOfId[groups[g].id] = int(g);
+        for (size_t n = 0; n < groups[g].images.size(); n++)
+            groupOfImage[groups[g].images[n]] = int(g);
+    }
+}
+
+void DuplicatesTreeModel::GroupChanged(const int &group, const QList<int> &roles) // emit dataChanged for the children of a group
+{
+    const int nb = groups[group].images.size();
+    if (nb == 0)
+        return;
+
+    const QModelIndex parent = index(group, 0);
+    emit dataChanged(index(0, 0, parent), index(nb - 1, duplicates_column_count - 1, parent), roles);
+}
+
+void DuplicatesTreeModel::AllGroupsChanged(const QList<int> &roles)
+{
+    for (int g = 0; g < int(groups.size()); g++)
+        GroupChanged(g, roles);
+}
+
+///////////////////////////////////////////////////////////
+//// Check states
+///////////////////////////////////////////////////////////
+
+bool DuplicatesTreeModel::IsChecked(const int &image) const
+{
+    return checked[image];
+}
+
+void DuplicatesTreeModel::SetChecked(const int &image, const bool &value)
+{
+    SetImagesChecked({image}, value);
+}
+
+void DuplicatesTreeModel::SetImagesChecked(const std::vector<int> &list, const bool &value) // check or uncheck several images - one update per group
+{
+    std::vector<int> changedGroups;
+    for (size_t n = 0; n < list.size(); n++) {
+        const int image = list[n];
+        if ((image < 0) or (image >= int(groupOfImage.size())) or (groupOfImage[image] == -1))
+            continue;
+        if ((checked[image] == value) and (touched[image]))
+            continue;
+        checked[image] = value;
+        touched[image] = true;
+        changedGroups.push_back(groupOfImage[image]);
+    }
+
+    std::sort(changedGroups.begin(), changedGroups.end());
+    changedGroups.erase(std::unique(changedGroups.begin(), changedGroups.end()), changedGroups.end());
+    for (size_t g = 0; g < changedGroups.size(); g++)
+        GroupChanged(changedGroups[g], {Qt::CheckStateRole, Qt::BackgroundRole});
+}
+
+void DuplicatesTreeModel::SetAllChecked(const bool &value) // check or uncheck all images
+{
+    checked.assign(checked.size(), value);
+    touched.assign(touched.size(), true);
+    AllGroupsChanged({Qt::CheckStateRole, Qt::BackgroundRole});
+}
+
+void DuplicatesTreeModel::InvertChecked() // invert all check states
+{
+    checked.flip();
+    touched.assign(touched.size(), true);
+    AllGroupsChanged({Qt::CheckStateRole, Qt::BackgroundRole});
+}
+
+std::vector<int> DuplicatesTreeModel::CheckedImages() const // checked images in displayed order
+{
+    std::vector<int> result;
+    for (size_t g = 0; g < groups.size(); g++)
+        for (size_t n = 0; n < groups[g].images.size(); n++)
+            if (checked[groups[g].images[n]])
+                result.push_back(groups[g].images[n]);
+
+    return result;
+}
+
+///////////////////////////////////////////////////////////
+//// Loaders
+///////////////////////////////////////////////////////////
+
+const struct_duplicates_row& DuplicatesTreeModel::Row(const int &image) const // created on first use
+{
+    if ((!created[image]) and (rowLoader)) {
+        rows[image] = rowLoader(image);
+        created[image] = true;
+    }
+
+    return rows[image];
+}
+
+void DuplicatesTreeModel::SetRowLoader(const std::function<struct_duplicates_row(const int &image)> &loader) // function that creates the row of an image
+{
+    rowLoader = loader;
+    created.assign(created.size(), false);
+    AllGroupsChanged({});
+}
+
+void DuplicatesTreeModel::SetIconLoader(const std::function<QByteArray(const int &image)> &loader) // function that gives the compressed icon of an image - called in the GUI thread
+{
+    iconLoader = loader;
+    ClearIconCache();
+}
+
+void DuplicatesTreeModel::SetIconCacheSize(const int &megabytes) // maximum size of decoded icons kept in memory
+{
+    icons.setMaxCost(megabytes * 1024); // cost is in KB
+}
+
+void DuplicatesTreeModel::ClearIconCache() // icons will be decoded again
+{
+    icons.clear();
+    decoder->Clear();
+    AllGroupsChanged({Qt::DecorationRole});
+}
+
+void DuplicatesTreeModel::IconDecoded(const int &image, const QImage &icon) // keep a decoded icon and update its row
+{
+    QPixmap *decoded = new QPixmap(QPixmap::fromImage(icon)); // QPixmap only in the GUI thread
+    icons.insert(image, decoded, std::max(1, int(qint64(decoded->width()) * decoded->height() * 4 / 1024))); // the cache deletes the least recently used icons
+
+    if ((image < 0) or (image >= int(groupOfImage.size())) or (groupOfImage[image] == -1)) // not shown anymore
+        return;
+    const int group = groupOfImage[image];
+    const std::vector<int> &images = groups[group].images;
+    const int row = std::find(images.begin(), images.end(), image) - images.begin();
+    const QModelIndex child = index(row, duplicates_column_icon, index(group, 0));
+    emit dataChanged(child, child, {Qt::DecorationRole});
+}
@@ -0,0 +1,127 @@
+/*#-------------------------------------------------
+#
+#       Qt virtualized duplicates tree model
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.1 - 2026/10/19
+#
+#   - top rows = groups, children = images of a group
+#   - groups only store image indexes of the caller's images list,
+#     sorted inside each group by the model
+#   - children rows (texts, compressed icons) are given by caller functions
+#     the first time they are shown, icons are decoded in a background thread
+#     and kept in a LRU cache
+#   - check states kept in a bitset, groups and images counts kept up to date
+#
+# Example :
+#   DuplicatesTreeModel *model = new DuplicatesTreeModel(this);
+#   model->SetRowLoader([this](const int &image) { return GetDuplicateRow(image); });
+#   model->SetIconLoader([this](const int &image) { return GetImageIconData(image); });
+#   ui->treeView->setModel(model);
+#   model->SetGroups(groups, resolutions); // then ui->treeView->expandAll()
+#
+#-------------------------------------------------*/
+
+#ifndef DUPLICATES_TREE_MODEL_H
+#define DUPLICATES_TREE_MODEL_H
+
+#include <QAbstractItemModel>
+#include <QCache>
+#include <QPixmap>
+#include <QColor>
+#include <QByteArray>
+
+#include <vector>
+#include <functional>
+
+#include "icon-decoder.h"
+
+
+enum duplicatesColumn {duplicates_column_check, duplicates_column_icon, duplicates_column_type, duplicates_column_size,
+                       duplicates_column_resolution, duplicates_column_name, duplicates_column_path, duplicates_column_count};
+
+struct struct_duplicates_row { // what the view needs to know about one image - only created when the image is shown
+    QString type; // file type
+    QColor typeColor; // background of file type
+    QString size; // WxH
+    QString resolution; // megapixels
+    QString name; // file name
+    QString path; // folder
+};
+
+struct struct_duplicates_group { // one group of duplicates
+    int id; // stable identifier = row of the group when it was set
+    std::vector<int> images; // image indexes in the caller's images list, sorted
+};
+
+class DuplicatesTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    explicit DuplicatesTreeModel(QObject *parent = nullptr);
+
+    //// Qt model
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &index) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override; // Qt::UserRole = image index, -1 for a group
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override; // only check state
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override; // sort images inside each group - groups keep their order
+
+    //// Groups
+    void SetGroups(const std::vector<std::vector<int>> &list, const std::vector<int> &imagesResolutions); // replace all groups, all unchecked - imagesResolutions = pixels of each image index
+    void Clear(); // no groups
+    int GroupsCount() const; // number of groups
+    int ImagesCount() const; // number of images in all groups
+    const std::vector<int>& GroupImages(const int &group) const; // images of a group, in displayed order
+    int Image(const QModelIndex &index) const; // image index of a row, -1 for a group
+    void RemoveImages(const std::vector<int> &imagesToRemove); // remove these images - groups with less than 2 images left are removed too
+    void UpdateImage(const int &image); // image information changed : its row will be created again
+
+    //// Check states
+    bool IsChecked(const int &image) const;
+    void SetChecked(const int &image, const bool &value);
+    void SetImagesChecked(const std::vector<int> &list, const bool &value); // check or uncheck several images - one update per group
+    void SetAllChecked(const bool &value); // check or uncheck all images
+    void InvertChecked(); // invert all check states
+    std::vector<int> CheckedImages() const; // checked images in displayed order
+
+    //// Loaders
+    void SetRowLoader(const std::function<struct_duplicates_row(const int &image)> &loader); // function that creates the row of an image
+    void SetIconLoader(const std::function<QByteArray(const int &image)> &loader); // function that gives the compressed icon of an image - called in the GUI thread
+    void SetIconCacheSize(const int &megabytes); // maximum size of decoded icons kept in memory
+    void ClearIconCache(); // icons will be decoded again
+
+private:
+    const struct_duplicates_row& Row(const int &image) const; // created on first use
+    void UpdateGroupsIndex(); // rebuild group id -> group row, image -> group row
+    void GroupChanged(const int &group, const QList<int> &roles); // emit dataChanged for the children of a group
+    void AllGroupsChanged(const QList<int> &roles);
+    void IconDecoded(const int &image, const QImage &icon); // keep a decoded icon and update its row
+
+    std::vector<struct_duplicates_group> groups;
+    std::vector<int> groupOfId; // group id -> group row, -1 = removed
+    std::vector<int> groupOfImage; // image index -> group row, -1 = not shown
+    int imagesCount = 0; // number of images in all groups
+    int sortColumn = duplicates_column_resolution; // current sort inside groups
+    Qt::SortOrder sortOrder = Qt::DescendingOrder;
+    std::vector<int> resolutions; // pixels of each image index - sort key
+
+    std::vector<bool> checked; // one bit per image index
+    std::vector<bool> touched; // check state was changed at least once : its row is colored
+
+    std::function<struct_duplicates_row(const int &image)> rowLoader;
+    std::function<QByteArray(const int &image)> iconLoader;
+    IconDecoder *decoder; // decodes icons in background
+    mutable std::vector<struct_duplicates_row> rows; // image index -> row, valid only if created
+    mutable std::vector<bool> created; // row was created ?
+    mutable QCache<int, QPixmap> icons; // image index -> decoded icon, cost in KB
+};
+
+
+#endif // DUPLICATES_TREE_MODEL_H
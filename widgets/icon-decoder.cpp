@@ -0,0 +1,62 @@
+/*#-------------------------------------------------
+#
+#       Qt background icons decoder
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.0 - 2026/10/19
+#
+#   - compressed icons (JPEG, PNG...) are decoded to QImage in a thread pool
+#   - the result is sent back to the GUI thread with a signal
+#   - last requests are decoded first : the rows the user is looking at now
+#
+#-------------------------------------------------*/
+
+#include "icon-decoder.h"
+
+#include <climits>
+
+
+IconDecoder::IconDecoder(QObject *parent) : QObject(parent)
+{
+    pool.setMaxThreadCount(2); // icons are small : 2 threads are enough to keep up with scrolling, the other cores stay free
+}
+
+IconDecoder::~IconDecoder()
+{
+    pool.clear(); // not started requests
+    pool.waitForDone(); // running ones - their results are sent to this object, so it must still exist
+}
+
+void IconDecoder::Request(const int &image, const QByteArray &data) // decode a compressed icon in background - IconDecoded() is emitted in the GUI thread
+    // QImage can be used outside the GUI thread, not QPixmap : the receiver converts the result
+{
+    if (pending.count(image) > 0) // already requested
+        return;
+    pending.insert(image);
+
+    if (priority == INT_MAX) // never happens in practice
+        priority = 0;
+    const int requestGeneration = generation;
+    pool.start([this, image, data, requestGeneration]() {
+        QImage icon = QImage::fromData(data); // decode - format is found from the data
+        QMetaObject::invokeMethod(this, [this, image, icon, requestGeneration]() { // back to the GUI thread
+            if (requestGeneration != generation) // cleared since
+                return;
+            pending.erase(image);
+            emit IconDecoded(image, icon);
+        }, Qt::QueuedConnection);
+    }, priority++); // higher priority = started first
+}
+
+bool IconDecoder::IsPending(const int &image) const // already requested and not decoded yet ?
+{
+    return pending.count(image) > 0;
+}
+
+void IconDecoder::Clear() // forget all pending requests - to call when image indexes change
+{
+    pool.clear(); // not started requests are removed
+    pending.clear();
+    generation++; // results of running requests will be ignored
+}
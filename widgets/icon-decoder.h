@@ -0,0 +1,54 @@
+/*#-------------------------------------------------
+#
+#       Qt background icons decoder
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.0 - 2026/10/19
+#
+#   - compressed icons (JPEG, PNG...) are decoded to QImage in a thread pool
+#   - the result is sent back to the GUI thread with a signal
+#   - last requests are decoded first : the rows the user is looking at now
+#
+# Example :
+#   IconDecoder *decoder = new IconDecoder(this);
+#   connect(decoder, &IconDecoder::IconDecoded, this, [this](int image, const QImage &icon) { ... QPixmap::fromImage(icon) ... });
+#   decoder->Request(image, data); // data = compressed icon
+#
+#-------------------------------------------------*/
+
+#ifndef ICON_DECODER_H
+#define ICON_DECODER_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QImage>
+#include <QByteArray>
+
+#include <unordered_set>
+
+
+class IconDecoder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit IconDecoder(QObject *parent = nullptr);
+    ~IconDecoder();
+
+    void Request(const int &image, const QByteArray &data); // decode a compressed icon in background - IconDecoded() is emitted in the GUI thread
+    bool IsPending(const int &image) const; // already requested and not decoded yet ?
+    void Clear(); // forget all pending requests - to call when image indexes change
+
+signals:
+    void IconDecoded(int image, const QImage &icon); // a decoded icon, null if the data could not be decoded
+
+private:
+    QThreadPool pool;
+    std::unordered_set<int> pending; // requested images - only used in the GUI thread
+    int generation = 0; // incremented by Clear() : results of older requests are ignored
+    int priority = 0; // incremented by each request
+};
+
+
+#endif // ICON_DECODER_H
@@ -0,0 +1,282 @@
+/*#-------------------------------------------------
+#
+#       Qt virtualized images list model
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.1 - 2026/10/19
+#
+#   - one row per image : only an index in the caller's images list
+#   - check states kept in a bitset, not in items
+#   - compressed icons are given on demand by a caller function,
+#     so only for visible rows, decoded in a background thread,
+#     then kept in a LRU cache
+#
+#-------------------------------------------------*/
+
+#include "images-list-model.h"
+
+#include <algorithm>
+
+
+///////////////////////////////////////////////////////////
+//// Qt model
+///////////////////////////////////////////////////////////
+
+ImagesListModel::ImagesListModel(QObject *parent) : QAbstractListModel(parent)
+{
+    SetIconCacheSize(128); // about 1000 icons of 176x176 px
+
+    decoder = new IconDecoder(this);
+    connect(decoder, &IconDecoder::IconDecoded, this, [this](int image, const QImage &icon) { IconDecoded(image, icon); });
+}
+
+int ImagesListModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) // list : no children
+        return 0;
+
+    return int(rows.size());
+}
+
+QVariant ImagesListModel::data(const QModelIndex &index, int role) const // the view only asks for visible rows
+{
+    if ((!index.isValid()) or (index.row() >= int(rows.size())))
+        return QVariant();
+
+    const struct_images_list_row &row = rows[index.row()];
+
+    switch (role) {
+        case Qt::DisplayRole:       return row.text;
+        case Qt::ToolTipRole:       return row.toolTip;
+        case Qt::BackgroundRole:    return row.background;
+        case Qt::TextAlignmentRole: return int(Qt::AlignHCenter | Qt::AlignVCenter);
+        case Qt::CheckStateRole:    return checked[index.row()] ? Qt::Checked : Qt::Unchecked;
+        case Qt::UserRole:          return row.image;
+        case Qt::DecorationRole: {
+            QPixmap *icon = icons.object(row.image); // already decoded ?
+            if (icon)
+                return *icon;
+            if ((iconLoader) and (!decoder->IsPending(row.image)))
+                decoder->Request(row.image, iconLoader(row.image)); // decode it in background : the row is updated when done
+            return QVariant();
+        }
+    }
+
+    return QVariant();
+}
+
+bool ImagesListModel::setData(const QModelIndex &index, const QVariant &value, int role) // only check state : when the checkbox is clicked
+{
+    if ((!index.isValid()) or (index.row() >= int(rows.size())) or (role != Qt::CheckStateRole))
+        return false;
+
+    SetChecked(index.row(), value.toInt() == Qt::Checked);
+
+    return true;
+}
+
+Qt::ItemFlags ImagesListModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return Qt::NoItemFlags;
+
+    return Qt::ItemIsUserCheckable | Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+///////////////////////////////////////////////////////////
+//// Rows
+///////////////////////////////////////////////////////////
+
+void ImagesListModel::SetRows(std::vector<struct_images_list_row> list) // replace all rows, all unchecked
+{
+    beginResetModel();
+    rows.swap(list);
+    checked.assign(rows.size(), false);
+    icons.clear(); // image indexes may have changed
+    decoder->Clear();
+    UpdateRowOfImage();
+    endResetModel();
+}
+
+void ImagesListModel::Clear() // no rows
+{
+    SetRows(std::vector<struct_images_list_row>());
+}
+
+int ImagesListModel::Count() const // number of rows
+{
+    return int(rows.size());
+}
+
+int ImagesListModel::Image(const int &row) const // image index of a row
+{
+    return rows[row].image;
+}
+
+int ImagesListModel::Row(const int &image) const // row of an image, -1 if not shown
+{
+    if ((image < 0) or (image >= int(rowOfImage.size())))
+        return -1;
+
+    return rowOfImage[image];
+}
+
+const QString& ImagesListModel::Text(const int &row) const // text shown under the icon
+{
+    return rows[row].text;
+}
+
+const QString& ImagesListModel::ToolTip(const int &row) const
+{
+    return rows[row].toolTip;
+}
+
+void ImagesListModel::RemoveImages(const std::vector<int> &imagesToRemove) // remove the rows of these images - one update for the whole view
+    // removing rows one by one would make the view lay out all the remaining rows each time
+{
+    std::vector<bool> removed(rows.size(), false);
+    bool found = false;
+    for (size_t n = 0; n < imagesToRemove.size(); n++) {
+        const int row = Row(imagesToRemove[n]);
+        if (row != -1) {
+            removed[row] = true;
+            icons.remove(imagesToRemove[n]);
+            found = true;
+        }
+    }
+    if (!found)
+        return;
+
+    beginResetModel();
+    size_t kept = 0;
+    for (size_t row = 0; row < rows.size(); row++)
+        if (!removed[row]) {
+            if (kept != row) {
+                rows[kept] = std::move(rows[row]);
+                checked[kept] = checked[row];
+            }
+            kept++;
+        }
+    rows.resize(kept);
+    checked.resize(kept);
+    UpdateRowOfImage();
+    endResetModel();
+}
+
+void ImagesListModel::SetToolTip(const int &image, const QString &toolTip)
+{
+    const int row = Row(image);
+    if (row == -1)
+        return;
+
+    rows[row].toolTip = toolTip;
+    RowsChanged(row, row, {Qt::ToolTipRole});
+}
+
+void ImagesListModel::SetBackgrounds(const std::vector<QColor> &colors) // one color per image index - one update for the whole view
+{
+    if (rows.empty())
+        return;
+
+    for (size_t row = 0; row < rows.size(); row++)
+        if (rows[row].image < int(colors.size()))
+            rows[row].background = colors[rows[row].image];
+
+    RowsChanged(0, int(rows.size()) - 1, {Qt::BackgroundRole});
+}
+
+void ImagesListModel::UpdateRowOfImage() // rebuild image -> row index
+{
+    int maxImage = -1;
+    for (size_t row = 0; row < rows.size(); row++)
+        maxImage = std::max(maxImage, rows[row].image);
+
+    rowOfImage.assign(maxImage + 1, -1);
+    for (size_t row = 0; row < rows.size(); row++)
+        rowOfImage[rows[row].image] = int(row);
+}
+
+void ImagesListModel::RowsChanged(const int &first, const int &last, const QList<int> &roles) // emit dataChanged for a range of rows
+{
+    emit dataChanged(index(first), index(last), roles);
+}
+
+///////////////////////////////////////////////////////////
+//// Check states
+///////////////////////////////////////////////////////////
+
+bool ImagesListModel::IsChecked(const int &row) const
+{
+    return checked[row];
+}
+
+void ImagesListModel::SetChecked(const int &row, const bool &value)
+{
+    if (checked[row] == value)
+        return;
+
+    checked[row] = value;
+    RowsChanged(row, row, {Qt::CheckStateRole});
+}
+
+void ImagesListModel::SetAllChecked(const bool &value) // check or uncheck all rows
+{
+    if (rows.empty())
+        return;
+
+    checked.assign(rows.size(), value);
+    RowsChanged(0, int(rows.size()) - 1, {Qt::CheckStateRole});
+}
+
+void ImagesListModel::InvertChecked() // invert all check states
+{
+    if (rows.empty())
+        return;
+
+    checked.flip();
+    RowsChanged(0, int(rows.size()) - 1, {Qt::CheckStateRole});
+}
+
+std::vector<int> ImagesListModel::CheckedImages() const // image indexes of checked rows, in rows order
+{
+    std::vector<int> result;
+    for (size_t row = 0; row < rows.size(); row++)
+        if (checked[row])
+            result.push_back(rows[row].image);
+
+    return result;
+}
+
+///////////////////////////////////////////////////////////
+//// Icons
+///////////////////////////////////////////////////////////
+
+void ImagesListModel::SetIconLoader(const std::function<QByteArray(const int &image)> &loader) // function that gives the compressed icon of an image - called in the GUI thread
+{
+    iconLoader = loader;
+    ClearIconCache();
+}
+
+void ImagesListModel::SetIconCacheSize(const int &megabytes) // maximum size of decoded icons kept in memory
+{
+    icons.setMaxCost(megabytes * 1024); // cost is in KB
+}
+
+void ImagesListModel::ClearIconCache() // icons will be decoded again
+{
+    icons.clear();
+    decoder->Clear();
+    if (!rows.empty())
+        RowsChanged(0, int(rows.size()) - 1, {Qt::DecorationRole});
+}
+
+void ImagesListModel::IconDecoded(const int &image, const QImage &icon) // keep a decoded icon and update its row
+{
+    QPixmap *decoded = new QPixmap(QPixmap::fromImage(icon)); // QPixmap only in the GUI thread
+    icons.insert(image, decoded, std::max(1, int(qint64(decoded->width()) * decoded->height() * 4 / 1024))); // the cache deletes the least recently used icons
+
+    const int row = Row(image);
+    if (row != -1)
+        RowsChanged(row, row, {Qt::DecorationRole});
+}
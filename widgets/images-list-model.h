@@ -0,0 +1,95 @@
+/*#-------------------------------------------------
+#
+#       Qt virtualized images list model
+#
+#    by AbsurdePhoton - www.absurdephoton.fr
+#
+#                v1.1 - 2026/10/19
+#
+#   - one row per image : only an index in the caller's images list
+#   - check states kept in a bitset, not in items
+#   - compressed icons are given on demand by a caller function,
+#     so only for visible rows, decoded in a background thread,
+#     then kept in a LRU cache
+#
+# Example :
+#   ImagesListModel *model = new ImagesListModel(this);
+#   model->SetIconLoader([this](const int &image) { return GetImageIconData(image); });
+#   ui->listView->setModel(model); // with uniformItemSizes = true
+#
+#-------------------------------------------------*/
+
+#ifndef IMAGES_LIST_MODEL_H
+#define IMAGES_LIST_MODEL_H
+
+#include <QAbstractListModel>
+#include <QCache>
+#include <QPixmap>
+#include <QColor>
+#include <QByteArray>
+
+#include <vector>
+#include <functional>
+
+#include "icon-decoder.h"
+
+
+struct struct_images_list_row { // what the view needs to know about one image
+    int image; // index in the caller's images list
+    QString text; // shown under the icon
+    QString toolTip;
+    QColor background;
+};
+
+class ImagesListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit ImagesListModel(QObject *parent = nullptr);
+
+    //// Qt model
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override; // Qt::UserRole = image index
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override; // only check state
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+    //// Rows
+    void SetRows(std::vector<struct_images_list_row> list); // replace all rows, all unchecked
+    void Clear(); // no rows
+    int Count() const; // number of rows
+    int Image(const int &row) const; // image index of a row
+    int Row(const int &image) const; // row of an image, -1 if not shown
+    const QString& Text(const int &row) const; // text shown under the icon
+    const QString& ToolTip(const int &row) const;
+    void RemoveImages(const std::vector<int> &imagesToRemove); // remove the rows of these images - one update for the whole view
+    void SetToolTip(const int &image, const QString &toolTip);
+    void SetBackgrounds(const std::vector<QColor> &colors); // one color per image index - one update for the whole view
+
+    //// Check states
+    bool IsChecked(const int &row) const;
+    void SetChecked(const int &row, const bool &value);
+    void SetAllChecked(const bool &value); // check or uncheck all rows
+    void InvertChecked(); // invert all check states
+    std::vector<int> CheckedImages() const; // image indexes of checked rows, in rows order
+
+    //// Icons
+    void SetIconLoader(const std::function<QByteArray(const int &image)> &loader); // function that gives the compressed icon of an image - called in the GUI thread
+    void SetIconCacheSize(const int &megabytes); // maximum size of decoded icons kept in memory
+    void ClearIconCache(); // icons will be decoded again
+
+private:
+    void UpdateRowOfImage(); // rebuild image -> row index
+    void RowsChanged(const int &first, const int &last, const QList<int> &roles); // emit dataChanged for a range of rows
+    void IconDecoded(const int &image, const QImage &icon); // keep a decoded icon and update its row
+
+    std::vector<struct_images_list_row> rows;
+    std::vector<int> rowOfImage; // image index -> row, -1 = not shown
+    std::vector<bool> checked; // one bit per row
+    std::function<QByteArray(const int &image)> iconLoader;
+    IconDecoder *decoder; // decodes icons in background
+    mutable QCache<int, QPixmap> icons; // image index -> decoded icon, cost in KB
+};
+
+
+#endif // IMAGES_LIST_MODEL_H